@@ -0,0 +1,74 @@
+#pragma once
+/*
+  include/civil_time.h - Sabit UTC+3 için tamsayı takvim aritmetiği
+
+  Cihaz configTime(LOCAL_UTC_OFFSET_SEC, 0, ...) ile DST'siz sabit ofsette çalışır.
+  Bu yüzden YMD <-> epoch, haftanın günü ve gün ekleme işleri newlib
+  mktime/localtime_r (TZ kilidi + normalize) yerine saf tamsayı işlemleriyle yapılır.
+  Sonuçlar libc TZ durumundan bağımsızdır.
+
+  Algoritma: H. Hinnant, "days_from_civil / civil_from_days" (proleptik Gregoryen,
+  gün 0 = 1970-01-01). Fonksiyonlar C++11 constexpr (tek return) kuralına uyar.
+*/
+
+#include <stdint.h>
+#include <time.h>
+
+static constexpr int32_t LOCAL_UTC_OFFSET_SEC = 3 * 3600;
+
+// ---- iç yardımcılar ----
+constexpr int32_t civFloorDiv(int64_t a, int64_t b) {
+  return (int32_t)(a >= 0 ? a / b : -((-a + b - 1) / b));
+}
+constexpr int32_t civEraOfYear(int32_t y) { return (y >= 0 ? y : y - 399) / 400; }
+constexpr int32_t civEraOfDays(int32_t z) { return (z >= 0 ? z : z - 146096) / 146097; }
+constexpr uint32_t civDoy(uint32_t m, uint32_t d) { return (153u * (m > 2 ? m - 3 : m + 9) + 2u) / 5u + d - 1u; }
+constexpr uint32_t civDoe(uint32_t yoe, uint32_t doy) { return yoe * 365u + yoe / 4u - yoe / 100u + doy; }
+
+constexpr int32_t civDaysShifted(int32_t y, uint32_t m, uint32_t d) {
+  return civEraOfYear(y) * 146097 + (int32_t)civDoe((uint32_t)(y - civEraOfYear(y) * 400), civDoy(m, d)) - 719468;
+}
+
+constexpr uint32_t civYmdFromMp(int32_t y, uint32_t doy, uint32_t mp) {
+  return (uint32_t)(y + (mp >= 10 ? 1 : 0)) * 10000u + (mp < 10 ? mp + 3u : mp - 9u) * 100u + (doy - (153u * mp + 2u) / 5u + 1u);
+}
+constexpr uint32_t civYmdFromDoy(int32_t y, uint32_t doy) { return civYmdFromMp(y, doy, (5u * doy + 2u) / 153u); }
+constexpr uint32_t civYmdFromYoe(int32_t era, uint32_t doe, uint32_t yoe) {
+  return civYmdFromDoy((int32_t)yoe + era * 400, doe - (365u * yoe + yoe / 4u - yoe / 100u));
+}
+constexpr uint32_t civYmdFromDoe(int32_t era, uint32_t doe) {
+  return civYmdFromYoe(era, doe, (doe - doe / 1460u + doe / 36524u - doe / 146096u) / 365u);
+}
+constexpr uint32_t civYmdFromZ(int32_t z) { return civYmdFromDoe(civEraOfDays(z), (uint32_t)(z - civEraOfDays(z) * 146097)); }
+
+// ---- gün sayısı (1970-01-01 = 0) ----
+constexpr int32_t daysFromCivil(int32_t y, uint32_t m, uint32_t d) {
+  return civDaysShifted(m <= 2 ? y - 1 : y, m, d);
+}
+// Ay/gün taşması (örn. 20260230) mktime gibi ileri normalize olur
+constexpr int32_t daysFromYmd(uint32_t ymd) {
+  return daysFromCivil((int32_t)(ymd / 10000u), (ymd / 100u) % 100u, ymd % 100u);
+}
+constexpr uint32_t ymdFromDays(int32_t days) { return civYmdFromZ(days + 719468); }
+
+// 0=Pazar .. 6=Cumartesi (tm_wday ile aynı)
+constexpr int weekdayFromDays(int32_t days) { return days >= -4 ? (int)((days + 4) % 7) : (int)((days + 5) % 7 + 6); }
+
+// ---- yerel saat (UTC+3) ----
+constexpr int32_t localDaysFromEpoch(time_t ts) { return civFloorDiv((int64_t)ts + LOCAL_UTC_OFFSET_SEC, 86400); }
+constexpr uint32_t ymdFromEpoch(time_t ts) { return ymdFromDays(localDaysFromEpoch(ts)); }
+constexpr int weekdayFromEpoch(time_t ts) { return weekdayFromDays(localDaysFromEpoch(ts)); }
+// Gece yarısından beri saniye (0..86399)
+constexpr int32_t localSecOfDay(time_t ts) {
+  return (int32_t)((int64_t)ts + LOCAL_UTC_OFFSET_SEC - (int64_t)localDaysFromEpoch(ts) * 86400);
+}
+constexpr time_t epochFromLocalDays(int32_t days, int32_t secOfDay) {
+  return (time_t)((int64_t)days * 86400 + secOfDay - LOCAL_UTC_OFFSET_SEC);
+}
+
+static_assert(daysFromCivil(1970, 1, 1) == 0, "civil epoch");
+static_assert(ymdFromDays(0) == 19700101u, "civil epoch");
+static_assert(daysFromYmd(20000301) - daysFromYmd(20000228) == 2, "2000 artık yıl");
+static_assert(daysFromYmd(21000301) - daysFromYmd(21000228) == 1, "2100 artık yıl değil");
+static_assert(weekdayFromDays(daysFromYmd(20260319)) == 4, "2026-03-19 Perşembe");
+static_assert(ymdFromEpoch(1700000000) == 20231115u, "UTC+3");
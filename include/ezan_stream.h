@@ -0,0 +1,76 @@
+#pragma once
+/*
+  include/ezan_stream.h - Ezan API vakit listesinin akış (streaming) ayrıştırıcısı
+
+  /vakitler/<ilce> yanıtı ~30 kayıtlık bir JSON dizisidir. Tüm yanıtı String'e alıp
+  JsonDocument'a açmak yerine soketten okunan parçalar doğrudan beslenir; her kayıt
+  kapandığında ilgili alanlar (tarih, İmsak, Akşam, HicriTarihUzun) tek bir EzanRecord
+  içinde callback'e verilir. Bellek: parser durumu + tek kayıt (~300 bayt), yanıt
+  boyutundan bağımsız.
+
+  Sadece üst seviye dizinin doğrudan elemanı olan nesnelerin string alanları okunur;
+  diğer alanlar/iç içe değerler atlanır. Arduino bağımsız (host'ta da derlenir).
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "schedule_engine.h"
+
+// Kayıttan okunan alanlar (API alan adları ezan_stream.cpp'de)
+enum EzanField : uint8_t {
+  EZ_F_DATE_UZUN_ISO = 0,  // MiladiTarihUzunIso8601 (öncelikli)
+  EZ_F_DATE_KISA,          // MiladiTarihKisa "17.10.2026"
+  EZ_F_DATE_KISA_ISO,      // MiladiTarihKisaIso8601
+  EZ_F_IMSAK,
+  EZ_F_AKSAM,
+  EZ_F_HICRI,              // HicriTarihUzun
+  EZ_F_COUNT
+};
+
+static const int EZ_VAL_MAX = 40;  // alan başına (sonu kesilir); hicriUzun 28'e sığar
+static const int EZ_KEY_MAX = 24;  // en uzun ilgili anahtar 22
+static const int EZ_DEPTH_MAX = 16;
+
+struct EzanRecord {
+  char    val[EZ_F_COUNT][EZ_VAL_MAX];
+  uint8_t seen;  // bit = alan bulundu
+};
+
+// Kayıt callback'i: false dönerse ayrıştırma durur (ezanStreamFeed false döner)
+typedef bool (*EzanRecordFn)(const EzanRecord& rec, void* ctx);
+
+struct EzanStreamParser {
+  uint16_t   ctr;        // açık kapların tipi (bit i: 1 = nesne), derinlik < EZ_DEPTH_MAX
+  uint8_t    depth;
+  uint8_t    inStr;      // string içinde
+  uint8_t    esc;        // '\' sonrası
+  uint8_t    uLeft;      // \uXXXX kalan hex hane
+  uint16_t   uCode;
+  uint8_t    expectKey;  // nesne içinde sıradaki string anahtar
+  uint8_t    strKind;    // EZ_STR_*
+  int8_t     field;      // değer hedefi (EzanField) ya da -1
+  uint8_t    keyLen;
+  uint8_t    valLen;
+  uint8_t    started;    // ilk kap açıldı
+  uint8_t    done;       // üst seviye kap kapandı
+  uint8_t    error;
+  char       key[EZ_KEY_MAX];
+  EzanRecord rec;
+  uint16_t   records;    // callback'e verilen kayıt
+  uint32_t   bytes;
+};
+
+void ezanStreamInit(EzanStreamParser& p);
+// Parça besle. Sözdizimi hatası ya da callback durdurursa false
+bool ezanStreamFeed(EzanStreamParser& p, const char* data, size_t len, EzanRecordFn fn, void* ctx);
+// Yanıt bitti: üst seviye dizi eksiksiz kapandıysa true (kesik bağlantı -> false)
+bool ezanStreamComplete(const EzanStreamParser& p);
+
+// Kayıt -> DayTimes (tarih önceliği UzunIso > Kisa > KisaIso). Tarih ya da vakit yoksa false
+bool ezanRecordToDay(const EzanRecord& rec, DayTimes& out);
+
+// "2026-10-17..." ya da "17.10.2026" -> 20261017 (tanınmazsa 0)
+uint32_t ezanParseDateYmd(const char* s);
+// "05:41" -> 341 (dakika, 0..1439 sınırlanır)
+uint16_t ezanParseHhmm(const char* s);
@@ -0,0 +1,46 @@
+#pragma once
+/*
+  include/hijri_calendar.h - Çevrimdışı Hicri <-> Miladi dönüşüm (tabular takvim)
+
+  30 yıllık döngülü aritmetik (tabular) Hicri takvim; artık yıllar 2,5,7,10,13,16,18,21,24,26,29.
+  Diyanet takvimi ay gözlemine/hesabına göre bundan ±1..2 gün sapabilir; bu yüzden
+  ezan API'nin HicriTarihUzun metinleriyle kalibre edilen gün ofseti (calOff) ile kullanılır:
+
+    Miladi gün D'nin Hicri tarihi = hijriFromDays(D - calOff)
+    Hicri tarihin Miladi günü     = hijriToDays(y, m, d) + calOff
+
+  Günler civil_time.h epoch-günüdür (1970-01-01 = 0). Ay index: 0=muharrem .. 11=zilhicce
+  (schedule_engine hicriMonthIndex ile aynı).
+*/
+
+#include <stdint.h>
+
+#include "schedule_engine.h"
+
+static const int HIJRI_CAL_OFF_MAX = 3;  // kalibrasyon ofseti sınırı (gün)
+
+int32_t hijriToDays(int year, int monIdx, int day);
+void    hijriFromDays(int32_t days, int& yearOut, int& monIdxOut, int& dayOut);
+
+// Türkçe ay adı ("Şaban"); geçersiz index -> "?"
+const char* hijriMonthName(int monIdx);
+
+// Cache'teki Hicri alanlardan ofset: en güncel (son) geçerli gün esas alınır.
+// agreeOut: bu ofsetle birebir tutan gün sayısı, samplesOut: geçerli gün sayısı.
+// Geçerli gün yoksa ya da ofset sınır dışıysa false.
+bool hijriCalibrate(const DayTimes* days, uint16_t n, int8_t& offOut, uint16_t& agreeOut, uint16_t& samplesOut);
+
+// =====================
+// Cache ufku ötesi özel gün tahmini (pencere saatleri yok, sadece tarih)
+// =====================
+struct HijriPrediction {
+  uint32_t ymd;     // Miladi olay günü (pencere bir önceki akşam başlar)
+  uint16_t hYear;   // Hicri yıl
+  uint8_t  reason;  // SR_SPECIAL / SR_RAMAZAN (Ramazan'ın 1. günü)
+  uint8_t  arg;     // SR_SPECIAL: g_specials index, SR_RAMAZAN: 1
+};
+
+// [fromDay, toDay] aralığındaki aktif özel günler (+ ramazanAll ise 1 Ramazan), ymd'ye göre sıralı.
+// Dönüş: yazılan kayıt sayısı (en fazla cap)
+int hijriPredictSpecials(const SchedInput& in, int8_t calOff, int32_t fromDay, int32_t toDay,
+                         HijriPrediction* out, int cap);
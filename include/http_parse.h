@@ -0,0 +1,122 @@
+#pragma once
+/*
+  include/http_parse.h - HTTP/1.1 istek ayrıştırıcısı (artımlı, sabit tamponlar)
+
+  Web sunucusu soketten okunan parçaları besler; istek satırı ve başlıklar bayt bayt
+  işlenir, istek String'e toplanmaz. Yalnızca sunucunun istediği başlıklar (keep
+  listesi) ve çerçeveleme başlıkları (Content-Length, Content-Type, Connection)
+  saklanır, diğerleri okunup atlanır. Başlık bölümü bitince httpReqFeed tüketilen
+  bayt sayısını döner; gövde bu katmana girmez.
+
+  multipart/form-data (OTA yükleme) için akış ayrıştırıcısı da buradadır: dosya
+  içeriği tamponlanmadan parça parça callback'e verilir, sınır (boundary) iki okuma
+  arasına bölünse de kaçırılmaz. Arduino bağımsız (host'ta derlenir).
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+
+// =====================
+// İstek
+// =====================
+static const int HTTP_PATH_MAX  = 64;    // aşarsa 414
+static const int HTTP_QUERY_MAX = 160;   // aşarsa 414
+static const int HTTP_NAME_MAX  = 32;    // daha uzun başlık adları saklanmaz
+static const int HTTP_VAL_MAX   = 96;    // saklanan başlık değeri (sonu kesilir)
+static const int HTTP_KEEP_MAX  = 6;     // keep listesinden saklanan başlık
+static const int HTTP_HEAD_MAX  = 4096;  // istek satırı + başlıklar (aşarsa 431)
+
+enum HttpMethod : uint8_t {
+  HTTPM_NONE = 0,
+  HTTPM_GET,
+  HTTPM_HEAD,
+  HTTPM_POST,
+  HTTPM_PUT,
+  HTTPM_DELETE,
+  HTTPM_OPTIONS,
+  HTTPM_OTHER,
+};
+
+enum HttpReqError : uint8_t {
+  HTTPE_NONE = 0,
+  HTTPE_BAD,          // 400
+  HTTPE_URI_LONG,     // 414
+  HTTPE_HEAD_LONG,    // 431
+  HTTPE_UNSUPPORTED,  // 501 (chunked istek gövdesi, HTTP/2 ön sözü vb.)
+};
+
+struct HttpReq {
+  uint8_t  state;
+  uint8_t  method;          // HttpMethod
+  uint8_t  minor;           // HTTP/1.x
+  uint8_t  error;           // HttpReqError
+  uint8_t  done;            // başlık bölümü bitti
+  uint8_t  keepAlive;       // sürüm + Connection başlığına göre
+  uint8_t  expect100;       // Expect: 100-continue (gövde öncesi ara yanıt bekleniyor)
+  uint8_t  keepCount;
+  uint8_t  keptMask;        // bit i: keep[i] geldi
+  uint8_t  nameLen;
+  uint8_t  valLen;
+  uint8_t  pathLen;
+  uint8_t  queryLen;
+  uint16_t headBytes;
+  int32_t  contentLength;   // yoksa -1
+  const char* const* keep;  // saklanacak başlık adları (büyük/küçük harf duyarsız)
+  char     path[HTTP_PATH_MAX];
+  char     query[HTTP_QUERY_MAX];   // '?' sonrası, çözülmemiş
+  char     name[HTTP_NAME_MAX];     // okunan başlık adı
+  char     val[HTTP_VAL_MAX];       // okunan başlık değeri
+  char     contentType[HTTP_VAL_MAX];
+  char     kept[HTTP_KEEP_MAX][HTTP_VAL_MAX];
+};
+
+// keep dizisi çağıranındır, istek boyunca yaşamalı (en fazla HTTP_KEEP_MAX ad)
+void httpReqInit(HttpReq& r, const char* const* keep, uint8_t keepCount);
+// Başlık bölümü bitene (r.done) ya da hata olana (r.error) kadar tüketir; tüketilen bayt
+// sayısını döner. Kalan baytlar gövdedir.
+size_t httpReqFeed(HttpReq& r, const char* data, size_t len);
+// Saklanan başlık (keep listesi ya da Content-Type); yoksa nullptr
+const char* httpReqHeader(const HttpReq& r, const char* name);
+
+// Query'den URL-çözülmüş argüman (a=1&b=x%20y). Yoksa false; out her zaman sonlanır.
+bool httpQueryArg(const char* query, const char* name, char* out, size_t cap);
+// Büyük/küçük harf duyarsız eşitlik
+bool httpNameEq(const char* a, const char* b);
+// "Not Found" vb. (bilinmeyen kod -> "")
+const char* httpStatusText(int code);
+
+// =====================
+// multipart/form-data
+// =====================
+static const int HTTP_BOUNDARY_MAX = 70;  // RFC 2046
+
+enum HttpMpEvent : uint8_t {
+  HMP_PART_BEGIN = 0,   // m.name / m.filename dolu
+  HMP_DATA,             // data/len: parça içeriği (bir parçada birden çok kez)
+  HMP_PART_END,
+  HMP_DONE,             // kapanış sınırı
+};
+
+struct HttpMultipart;
+// false dönerse ayrıştırma durur (httpMpFeed false döner)
+typedef bool (*HttpMpFn)(HttpMultipart& m, HttpMpEvent ev, const uint8_t* data, size_t len, void* ctx);
+
+struct HttpMultipart {
+  uint8_t  state;
+  uint8_t  match;           // delim'in eşleşmiş öneki (tutulan baytlar)
+  uint8_t  delimLen;
+  uint8_t  dashes;
+  uint8_t  error;
+  uint16_t lineLen;
+  uint32_t dataBytes;       // dosya/alan içerik toplamı
+  char     delim[HTTP_BOUNDARY_MAX + 5];   // "\r\n--" + boundary
+  char     line[160];       // parça başlık satırı
+  char     name[32];        // Content-Disposition name
+  char     filename[64];    // Content-Disposition filename (yoksa "")
+};
+
+// Content-Type'tan boundary alır; yoksa/geçersizse false
+bool httpMpInit(HttpMultipart& m, const char* contentType);
+bool httpMpFeed(HttpMultipart& m, const uint8_t* data, size_t len, HttpMpFn fn, void* ctx);
+// Kapanış sınırı görüldü
+bool httpMpComplete(const HttpMultipart& m);
@@ -0,0 +1,61 @@
+#pragma once
+/*
+  include/json_out.h - akış halinde JSON / CBOR yazıcı (sabit tampon, belge ağacı yok)
+
+  Büyük API yanıtları (log, ayarlar, WiFi tarama) önce bir JsonDocument'a, sonra
+  String'e kopyalanmadan doğrudan üretilir: değerler JSON_OUT_BUF'lık tampona yazılır,
+  tampon dolunca sink'e (web sunucusunda chunked parça) verilir. Yazıcının kendi
+  belleği yanıt boyutundan bağımsız olarak tampon kadardır; toplam tepe değeri sink'in
+  geri basıncına bağlıdır (web: gönderilmemiş veri WEB_CHUNK_BACKLOG ile sınırlı, sink
+  false dönünce üretim durur).
+
+  Virgüller ve kapanışlar yazıcıda izlenir: çağıran yalnızca sırayla alan yazar.
+  key == nullptr dizi elemanıdır. Metinler JSON kaçışıyla yazılır (UTF-8 olduğu gibi).
+  Sink false dönerse / derinlik aşılırsa error kalır, sonraki yazımlar atılır.
+
+  JO_CBOR: aynı çağrılar CBOR (RFC 8949) üretir (panel/filo için Accept: application/cbor).
+  Nesne ve diziler belirsiz uzunlukta (0xbf/0x9f ... 0xff) yazılır: eleman sayısı
+  önceden bilinmeden akış bozulmaz. Tam sayı değerli jsonNum tam sayı, diğerleri
+  float32'ye kayıpsız sığıyorsa float32, yoksa float64 olarak gider.
+  Arduino bağımsız (host'ta derlenir).
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+
+static const int JSON_OUT_BUF   = 512;
+static const int JSON_OUT_DEPTH = 8;
+
+typedef bool (*JsonSink)(const char* data, size_t len, void* ctx);
+
+enum JsonOutFmt : uint8_t { JO_JSON = 0, JO_CBOR };
+
+struct JsonOut {
+  JsonSink sink;
+  void*    ctx;
+  uint8_t  fmt;          // JsonOutFmt
+  uint16_t len;
+  uint8_t  depth;
+  uint8_t  arrMask;      // bit d: seviye d dizi
+  uint8_t  hasItem;      // bit d: seviye d'de eleman yazıldı (virgül gerekir)
+  bool     error;
+  uint32_t total;        // üretilen bayt
+  char     buf[JSON_OUT_BUF];
+};
+
+void jsonOutInit(JsonOut& j, JsonSink sink, void* ctx, uint8_t fmt = JO_JSON);
+void jsonObjBegin(JsonOut& j, const char* key = nullptr);
+void jsonArrBegin(JsonOut& j, const char* key = nullptr);
+// Son açılan nesne/diziyi kapat
+void jsonEnd(JsonOut& j);
+
+void jsonStr(JsonOut& j, const char* key, const char* v);        // v == nullptr: null
+void jsonInt(JsonOut& j, const char* key, int64_t v);
+void jsonUint(JsonOut& j, const char* key, uint64_t v);
+void jsonBool(JsonOut& j, const char* key, bool v);
+// decimals basamağa yuvarlanır, sondaki sıfırlar atılır; NaN/sonsuz -> null
+void jsonNum(JsonOut& j, const char* key, double v, uint8_t decimals);
+void jsonNull(JsonOut& j, const char* key);
+
+// Açık kalanları kapat, tamponu sink'e boşalt. Dönüş: hata yok
+bool jsonOutFinish(JsonOut& j);
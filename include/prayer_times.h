@@ -0,0 +1,37 @@
+#pragma once
+/*
+  include/prayer_times.h - Çevrimdışı imsak / akşam hesabı (güneş konumu)
+
+  Ezan API'ye ulaşılamadığında ve g_days cache'i bittiğinde zorunlu OFF (imsak) ve
+  akşam ON sürsün diye vakitler koordinattan hesaplanır. Diyanet parametreleri:
+
+    İmsak : güneş ufkun 18° altında (fecr-i sadık), temkin 0 dk
+    Akşam : güneşin üst kenarı ufukta (-0.833°, kırılma + yarıçap), temkin +7 dk
+
+  Yükseklik düzeltmesi yapılmaz (Diyanet deniz seviyesi + temkin kullanır).
+  Yuvarlama güvenli tarafa: imsak aşağı (OFF erken), akşam yukarı (ON geç).
+  Güneş konumu: US Naval Observatory yaklaşık formülleri (1800-2200 arası ~1 dk).
+
+  Gün: civil_time.h epoch-günü (1970-01-01 = 0), dakikalar yerel (UTC+3) 0..1439.
+*/
+
+#include <stdint.h>
+
+#include "schedule_engine.h"
+
+static const double PT_IMSAK_ANGLE       = 18.0;    // ufuk altı derece
+static const double PT_AKSAM_ANGLE       = 0.833;   // kırılma + güneş yarıçapı
+static const int    PT_IMSAK_TEMKIN_MIN  = 0;
+static const int    PT_AKSAM_TEMKIN_MIN  = 7;
+
+// Koordinat mikro-derece (39.917900 -> 39917900); NVS'e int32 olarak yazılır
+static const int32_t PT_COORD_E6_MAX_LAT = 90000000;
+static const int32_t PT_COORD_E6_MAX_LON = 180000000;
+
+bool prayerCoordValid(int32_t latE6, int32_t lonE6);
+
+// Gün için imsak ve akşam dakikası. Kutup bölgesi (açı hiç oluşmuyor) ise false.
+bool prayerCalcDay(int32_t days, int32_t latE6, int32_t lonE6, uint16_t& imsakMinOut, uint16_t& aksamMinOut);
+
+// DayTimes kaydı: vakitler hesaplanır, Hicri alanlar kalibre tabular takvimden (hijri_calendar.h)
+bool prayerFillDay(DayTimes& d, int32_t days, int32_t latE6, int32_t lonE6, int8_t hijriCalOff);
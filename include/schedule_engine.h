@@ -0,0 +1,284 @@
+#pragma once
+/*
+  include/schedule_engine.h - Çizelge motoru (Arduino bağımsız)
+
+  Perşembe->Cuma, dini gün (özel gün + Ramazan günleri) ve zorunlu OFF (imsak)
+  pencere hesapları. Girdi olarak saat (now), DayTimes tablosu ve ayarları alır;
+  Arduino global'lerine dokunmaz. Böylece hem firmware (src/main.cpp) hem de
+  host (env:native) benchmark'ı aynı kodu kullanır.
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <time.h>
+
+#include "civil_time.h"
+
+// =====================
+// NVS vakit verisi
+// =====================
+// v4: Hicri tarih çekimde bir kez sayıya çevrilir (taramalar tamsayı karşılaştırır)
+struct __attribute__((packed)) DayTimes {
+  uint32_t ymd;            // YYYYMMDD
+  uint16_t imsakMin;       // 0..1439
+  uint16_t aksamMin;       // 0..1439
+  uint8_t  hDay;           // Hicri gün 1..30 (0 = parse edilemedi)
+  int8_t   hMon;           // Hicri ay 0=muharrem .. 11=zilhicce (-1 = bilinmiyor)
+  uint16_t hYear;          // Hicri yıl (0 = yok)
+  char     hicriUzun[28];  // örn: "26 Ramazan 1447" (gösterim için)
+};
+
+// v3 NVS kaydı (sadece migration için)
+struct __attribute__((packed)) DayTimesV3 {
+  uint32_t ymd;
+  uint16_t imsakMin;
+  uint16_t aksamMin;
+  char     hicriUzun[28];
+};
+
+static const int SCHED_MAX_DAYS = 45;
+
+// =====================
+// ÖZEL GÜNLER ENABLE (0=kapalı, 1=açık)
+// =====================
+#define EN_1_RECEB_UC_AYLAR_BASLANGIC   1
+#define EN_2_RECEB_REGAIB_KANDILI      1
+#define EN_26_RECEB_MIRAC_KANDILI      1
+#define EN_14_SABAN_BERAT_KANDILI      1
+#define EN_26_RAMAZAN_KADIR_GECESI     1
+#define EN_1_SEVVAL_RB_1               1
+#define EN_2_SEVVAL_RB_2               1
+#define EN_3_SEVVAL_RB_3               1
+#define EN_9_ZILHICCE_AREFE            1
+#define EN_10_ZILHICCE_KB_1            1
+#define EN_11_ZILHICCE_KB_2            1
+#define EN_12_ZILHICCE_KB_3            1
+#define EN_13_ZILHICCE_KB_4            1
+#define EN_11_REBIULEVVEL_MEVLID       1
+// Ramazan ayındaki tüm günleri dini gün gibi dahil et
+#define EN_RAMAZAN_TUM_GUNLER           1
+
+// =====================
+// Özel gün tanımı
+// =====================
+struct SpecialDef {
+  uint8_t   day;
+  const char* monthKey;  // receb/saban/ramazan/sevval/zilhicce/rebiulevvel
+  const char* name;
+  uint8_t   defaultEnabled;
+};
+
+static const SpecialDef g_specials[] = {
+  {  1, "receb",       "Üç Ayların Başlangıcı",          (uint8_t)EN_1_RECEB_UC_AYLAR_BASLANGIC },
+  {  2, "receb",       "Regaib Kandili (2 Receb)",       (uint8_t)EN_2_RECEB_REGAIB_KANDILI },
+  { 26, "receb",       "Mirac Kandili",                  (uint8_t)EN_26_RECEB_MIRAC_KANDILI },
+  { 14, "saban",       "Berat Kandili",                  (uint8_t)EN_14_SABAN_BERAT_KANDILI },
+  { 26, "ramazan",     "Kadir Gecesi",                   (uint8_t)EN_26_RAMAZAN_KADIR_GECESI },
+  {  1, "sevval",      "Ramazan Bayramı 1. Gün",         (uint8_t)EN_1_SEVVAL_RB_1 },
+  {  2, "sevval",      "Ramazan Bayramı 2. Gün",         (uint8_t)EN_2_SEVVAL_RB_2 },
+  {  3, "sevval",      "Ramazan Bayramı 3. Gün",         (uint8_t)EN_3_SEVVAL_RB_3 },
+  {  9, "zilhicce",    "Kurban Bayramı Arefe Günü",      (uint8_t)EN_9_ZILHICCE_AREFE },
+  { 10, "zilhicce",    "Kurban Bayramı 1. Gün",          (uint8_t)EN_10_ZILHICCE_KB_1 },
+  { 11, "zilhicce",    "Kurban Bayramı 2. Gün",          (uint8_t)EN_11_ZILHICCE_KB_2 },
+  { 12, "zilhicce",    "Kurban Bayramı 3. Gün",          (uint8_t)EN_12_ZILHICCE_KB_3 },
+  { 13, "zilhicce",    "Kurban Bayramı 4. Gün",          (uint8_t)EN_13_ZILHICCE_KB_4 },
+  { 11, "rebiulevvel", "Mevlid Kandili",                 (uint8_t)EN_11_REBIULEVVEL_MEVLID },
+};
+static const uint8_t SPECIAL_COUNT = sizeof(g_specials)/sizeof(g_specials[0]);
+
+// =====================
+// Dini gün tarih override (Web üzerinden Hicri gün/ay/yıl seçimi)
+// =====================
+struct __attribute__((packed)) SpOverride {
+  uint8_t  useDefault; // 1=default (g_specials), 0=custom
+  uint8_t  day;        // 1..30
+  uint8_t  month;      // 0..11 (Hicri month index)
+  uint16_t year;       // 1447..1461 (custom için)
+};
+
+// =====================
+// Gün indeksi: g_days ardışık tarih dizisi olduğundan YMD -> slot çıkarma ile (O(1))
+// - Boşluk/tekrar varsa (contiguous=0) sıralı dizide binary search
+// =====================
+struct SchedDayIndex {
+  int32_t  firstDay;    // days[0] epoch-günü (civil_time.h)
+  uint16_t count;       // indeks kurulduğundaki gün sayısı
+  uint8_t  contiguous;  // 1 = days[i] == firstDay + i
+};
+
+// days[] ymd'ye göre sıralı olmalı (schedSortDays)
+void schedDayIndexBuild(const DayTimes* days, uint16_t n, SchedDayIndex& out);
+int  schedDayIndexFind(const SchedDayIndex& ix, const DayTimes* days, uint16_t n, uint32_t ymd);
+// ymd'ye göre O(n log n) sıralama
+void schedSortDays(DayTimes* days, uint16_t n);
+
+// =====================
+// Motor girdisi: tablo + ayarlar (saat her çağrıda ayrıca verilir)
+// =====================
+struct SchedInput {
+  const DayTimes*   days;
+  uint16_t          dayCount;
+  const SchedDayIndex* dayIdx;     // opsiyonel (nullptr -> doğrusal arama)
+  const SpOverride* spOv;          // SPECIAL_COUNT eleman
+  uint32_t          spEnableMask;  // bit=1 -> aktif
+  bool              ramazanAll;
+  int               onOffsetSec;   // Akşam tolerans (Akşam +X)
+  int               offOffsetSec;  // Sabah tolerans (İmsak -X)
+};
+
+// =====================
+// Tarih/saat yardımcı (yerel saat = sabit UTC+3, bkz. civil_time.h)
+// =====================
+uint32_t ymdFromTm(const struct tm& t);
+time_t   epochFromYmdAndMin(uint32_t ymd, uint16_t minutesFromMidnight);
+uint32_t addDaysYmd(uint32_t ymd, int deltaDays);
+int      weekdayOfYmd(uint32_t ymd);   // 0=Pazar .. 6=Cumartesi
+
+// =====================
+// Hicri parse (String'siz): "26 Ramazan 1447" -> 26 / 8 / 1447
+// monIdx: 0=muharrem .. 11=zilhicce, bilinmeyen ay -> -1
+// =====================
+int  hicriMonthIndex(const char* name, size_t len);
+bool parseHicriFields(const char* s, int& dayOut, int& monIdxOut, int& yearOut);
+// hicriUzun'u kopyalar ve hDay/hMon/hYear alanlarını doldurur
+void dayTimesSetHicri(DayTimes& d, const char* hicriUzun);
+
+// =====================
+// Pencere hesapları (tablo taraması)
+// =====================
+int  schedFindIdx(const SchedInput& in, uint32_t ymd);
+// Özel günün geçerli kuralı (override dahil): Hicri gün / ay index / yıl (0 = her yıl)
+bool schedSpecialRule(const SchedInput& in, uint8_t spIdx, int& dayOut, int& monIdxOut, int& yearOut);
+// Özel günün (override dahil) düştüğü ilk g_days slotu, yoksa -1
+int  schedFindSpecialIdx(const SchedInput& in, uint8_t spIdx);
+bool computeWindowForSpecial(const SchedInput& in, uint8_t spIdx, time_t& onTs, time_t& offTs, uint32_t& ymdEvent);
+bool buildWindowForEventIdx(const SchedInput& in, int idxEvent, time_t& onTs, time_t& offTs);
+bool isRamazanIdx(const SchedInput& in, int idx, int& dayNoOut);
+
+// =====================
+// Timeline: sıralı ON/OFF geçiş dizisi (neden kodu ile)
+// =====================
+// SR_CUSTOM: varsayılan sette olmayan kurallar (ek hafta günü, tarih aralığı, özel gece)
+enum SchedReason : uint8_t { SR_THU_FRI=0, SR_SPECIAL=1, SR_RAMAZAN=2, SR_IMSAK_OFF=3, SR_CUSTOM=4 };
+
+static const uint8_t SRM_THU_FRI   = (1u << SR_THU_FRI);
+static const uint8_t SRM_DINI      = (1u << SR_SPECIAL) | (1u << SR_RAMAZAN);
+static const uint8_t SRM_IMSAK_OFF = (1u << SR_IMSAK_OFF);
+static const uint8_t SRM_CUSTOM    = (1u << SR_CUSTOM);
+
+struct SchedTransition {
+  time_t   ts;      // geçiş anı
+  time_t   peer;    // pencerenin karşı ucu (OFF için ON anı, ON için OFF anı; imsak için 0)
+  uint32_t ymd;     // olay günü (Miladi)
+  uint8_t  on;      // 1=ON, 0=OFF
+  uint8_t  reason;  // SchedReason
+  uint8_t  arg;     // SR_SPECIAL: g_specials index, SR_RAMAZAN: Ramazan günü
+  uint8_t  rule;    // kaynağı olan kural (SchedRule index)
+};
+
+// =====================
+// Kural tablosu: röle kararı bildirimsel kurallardan derlenir
+// - Kurallar ayar/veri değişince bir kez günlük maskeye (gün başına kural bitleri),
+//   timeline'a ve birleşik ON aralık tablosuna derlenir; karar tek aralık araması.
+// - Tüm ON pencereleri "olay gününden önceki akşam + onTol -> olay günü imsak - offTol".
+// - Yeni kural türü eklemek için: RK_* + schedRuleMatchesDay; timeline/aralık kodu aynı kalır.
+// =====================
+enum SchedRuleKind : uint8_t {
+  RK_WEEKDAY    = 0,  // olay günü haftanın günü wdayMask içinde (bit 0=Pazar .. 6=Cumartesi)
+  RK_HIJRI_DAY  = 1,  // Hicri gün + ay (+ yıl, 0 = her yıl)
+  RK_HIJRI_MON  = 2,  // Hicri ayın her günü (timeline arg = Hicri gün)
+  RK_DATE_RANGE = 3,  // Miladi olay günü fromYmd..toYmd
+  RK_FORCE_OFF  = 4,  // her gün imsak - offTol anında zorunlu OFF (pencere üretmez)
+};
+
+static const int32_t SCHED_TOL_INHERIT = INT32_MIN;  // toleransı SchedInput'tan al
+
+struct SchedRule {
+  uint8_t  kind;       // SchedRuleKind
+  uint8_t  reason;     // timeline neden kodu (SchedReason)
+  uint8_t  arg;        // SR_SPECIAL: g_specials index
+  uint8_t  wdayMask;   // RK_WEEKDAY
+  uint8_t  hDay;       // RK_HIJRI_DAY
+  int8_t   hMon;       // RK_HIJRI_DAY / RK_HIJRI_MON
+  uint16_t hYear;      // RK_HIJRI_DAY (0 = her yıl; günün yılı bilinmiyorsa ay+gün yeter)
+  uint32_t fromYmd;    // RK_DATE_RANGE
+  uint32_t toYmd;
+  int32_t  onTolSec;   // Akşam + X  (SCHED_TOL_INHERIT -> in.onOffsetSec)
+  int32_t  offTolSec;  // İmsak - X  (SCHED_TOL_INHERIT -> in.offOffsetSec)
+};
+
+static const int SCHED_RULE_MAX = 32;  // gün maskesindeki bit sayısı
+static_assert(3 + (int)SPECIAL_COUNT <= SCHED_RULE_MAX, "varsayılan kurallar gün maskesine sığmalı");
+
+// Ayarlardan varsayılan set: zorunlu OFF, Perşembe->Cuma (olay günü Cuma),
+// aktif özel günler (override uygulanmış), ramazanAll ise Ramazan günleri. Dönüş: kural sayısı
+int  schedDefaultRules(const SchedInput& in, SchedRule* out, int cap);
+bool schedRuleMatchesDay(const SchedRule& r, const DayTimes& d);
+
+// masks[i]: days[i] olay günü olan kuralların bitleri (bit r = rules[r]); masks[] en az in.dayCount
+void schedRuleDayMasks(const SchedInput& in, const SchedRule* rules, int nRules, uint32_t* masks);
+
+// Perşembe pencereleri + özel günler + Ramazan günleri (2 kenar) + her gün imsak OFF (1 kenar).
+// Varsayılan sete göre boyutlu: ek kurallar sığmazsa overflow bildirilir (plan yayınlanmamalı).
+static const int SCHED_TL_MAX = 2 * (SCHED_MAX_DAYS / 7 + 1) + 2 * (int)SPECIAL_COUNT + 2 * SCHED_MAX_DAYS + SCHED_MAX_DAYS;
+
+// Kurallar + gün maskelerinden out[] dizisine kurar, kenar sayısını döndürür.
+// cap dolarsa *overflow = true: sığmayan kenarlar atılır (pencere ON/OFF çifti bölünmez).
+uint16_t schedBuildTimeline(const SchedInput& in, const SchedRule* rules, int nRules, const uint32_t* masks,
+                            SchedTransition* out, uint16_t cap, bool* overflow = nullptr);
+
+// =====================
+// Birleşik ON aralıkları: çakışan/bitişik pencereler tek aralık, zorunlu OFF anında kesilir.
+// Röle kararı = now'ı içeren aralık var mı (binary search).
+// =====================
+struct SchedInterval {
+  time_t   on;
+  time_t   off;
+  uint32_t rules;  // aralığa katkı veren kural bitleri
+};
+
+static const int SCHED_IV_MAX = SCHED_MAX_DAYS;
+
+// cap dolarsa *overflow = true (sonraki aralıklar atıldı)
+uint16_t schedBuildIntervals(const SchedTransition* tl, uint16_t tlN, SchedInterval* out, uint16_t cap,
+                             bool* overflow = nullptr);
+// on <= now < off olan aralığın indeksi, yoksa -1
+int schedIntervalAt(const SchedInterval* iv, uint16_t n, time_t now);
+
+// =====================
+// Röle karar adımları (firmware röle görevi + replay simülatörü çekirdeği)
+// - Firmware ve host replay simülatörü aynı kararı verir; yan etkiler (röle, log) çağırana ait.
+// =====================
+static const time_t SCHED_IMSAK_STALE_SEC = 600;  // bu kadar geçmiş OFF anı bayat: yeniden hesapla
+static const time_t SCHED_IMSAK_FIRE_WIN  = 300;  // OFF anından sonra bu süre içinde tetiklenir
+static const time_t SCHED_FORCE_BLOCK_SEC = 120;  // zorunlu OFF sonrası manuel ON engeli
+
+enum SchedImsakStep : uint8_t { SIS_IDLE = 0, SIS_REFRESH = 1, SIS_FIRE = 2 };
+
+// SIS_REFRESH: nextOffTs bayat/kaçırıldı -> timeline'dan yeniden al; SIS_FIRE: zorunlu OFF şimdi
+uint8_t schedImsakOffStep(time_t nextOffTs, time_t lastEventTs, time_t now);
+
+// scheduledOn (kural aralığı) + manuel latch, manuel OFF süresi ve zorunlu OFF engeli
+bool schedRelayShouldOn(bool scheduledOn, bool manualOnLatched, time_t manualOffUntilTs,
+                        time_t blockOnUntilTs, bool hasTime, time_t now);
+
+// ts > now olan ilk geçişin indeksi (yoksa n)
+int schedUpperBound(const SchedTransition* tl, uint16_t n, time_t now);
+// reasonMask'a uyan, now'dan sonra biten ilk pencerenin OFF kenarı (aktif ya da sıradaki), yoksa -1
+int schedFindWindowEnd(const SchedTransition* tl, uint16_t n, time_t now, uint8_t reasonMask);
+
+// =====================
+// Timeline'sız doğrudan hesaplar (her çağrıda tablo taraması)
+// - Benchmark'ta timeline ile karşılaştırma / referans için.
+// =====================
+struct SchedWindow {
+  time_t   on;
+  time_t   off;
+  uint32_t ymd;     // olay günü
+  uint8_t  reason;  // SR_SPECIAL / SR_RAMAZAN
+  uint8_t  arg;
+};
+
+bool schedThuFriWindowScan(const SchedInput& in, time_t now, time_t& onTs, time_t& offTs);
+bool schedNextImsakOffScan(const SchedInput& in, time_t now, time_t& nextOffTs);
+bool schedNextSpecialScan(const SchedInput& in, time_t now, SchedWindow& out);
@@ -0,0 +1,110 @@
+#pragma once
+/*
+  include/tg_api.h - Telegram Bot API yanıt ayrıştırıcısı (akış, sabit tamponlar)
+
+  Bot API yanıtları ({"ok":..,"result":..}) soketten okunan parçalarla beslenir; JSON
+  belgesi kurulmaz, String kopyası yapılmaz. Kullanılan alanlar doğrudan sabit boyutlu
+  TgUpdate / TgResult alanlarına yazılır, uzun metinler kesilir (komutlar ve
+  callback_data kısa). getUpdates'te her update kapanınca callback'e verilir.
+
+  Alt katman JsonSax: olay tabanlı (SAX) küçük JSON tarayıcı. Her değer olayında
+  s.depth seviyesine kadar anahtar yolu (dizi seviyesi "") jsonSaxAt ile eşlenir.
+  İstek gövdesi için JSON string kaçışı da buradadır. Arduino bağımsız (host'ta derlenir).
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+
+// =====================
+// JsonSax
+// =====================
+static const int JS_DEPTH_MAX = 12;
+static const int JS_KEY_MAX   = 20;   // daha uzun anahtarlar hiçbir yolla eşleşmez
+static const int JS_VAL_MAX   = 256;  // string/sayı değeri (sonu kesilir, s.trunc=1)
+
+enum JsonSaxEvent : uint8_t {
+  JS_OBJ_BEGIN = 0,
+  JS_OBJ_END,
+  JS_ARR_BEGIN,
+  JS_ARR_END,
+  JS_STRING,
+  JS_NUMBER,
+  JS_LITERAL,   // true / false / null
+};
+
+struct JsonSax;
+// Olay anında s.depth = değerin bulunduğu kabın derinliği; değer s.val / s.valLen.
+// false dönerse tarama durur.
+typedef bool (*JsonSaxFn)(JsonSax& s, JsonSaxEvent ev, void* ctx);
+
+struct JsonSax {
+  uint16_t ctr;          // bit d: d. kap nesne mi
+  uint8_t  depth;
+  uint8_t  inStr;
+  uint8_t  inKey;
+  uint8_t  inScalar;
+  uint8_t  esc;
+  uint8_t  uLeft;
+  uint16_t uCode;
+  uint8_t  expectKey;
+  uint8_t  started;
+  uint8_t  done;
+  uint8_t  error;
+  uint8_t  trunc;
+  uint8_t  keyLen;
+  uint16_t valLen;
+  uint32_t bytes;
+  char     key[JS_DEPTH_MAX][JS_KEY_MAX];
+  char     val[JS_VAL_MAX];
+};
+
+void jsonSaxInit(JsonSax& s);
+bool jsonSaxFeed(JsonSax& s, const char* data, size_t len, JsonSaxFn fn, void* ctx);
+// Üst seviye değer eksiksiz kapandı
+bool jsonSaxComplete(const JsonSax& s);
+// "result.*.message.chat.id": segment sayısı s.depth'e eşit olmalı, "*" her anahtarla eşleşir
+bool jsonSaxAt(const JsonSax& s, const char* path);
+
+// JSON string kaçışı (tırnaksız). Parça parça: out dolunca durur, *in ilerler.
+size_t tgJsonEscapedLen(const char* in);
+size_t tgJsonEscapeChunk(const char*& in, char* out, size_t cap);
+
+// =====================
+// Telegram
+// =====================
+static const int TG_TEXT_MAX = 256;   // message.text / callback_query.data
+static const int TG_ID_MAX   = 24;    // sayısal id'ler metin olarak ("-100123...")
+
+struct TgUpdate {
+  long    updateId;
+  int32_t messageId;
+  char    type[16];              // "message", "callback_query", "edited_message", ...
+  char    chatId[TG_ID_MAX];
+  char    fromId[TG_ID_MAX];
+  char    fromName[40];          // from.first_name
+  char    queryId[TG_ID_MAX];    // callback_query.id
+  char    text[TG_TEXT_MAX];     // message.text ya da callback_query.data
+};
+
+struct TgResult {
+  bool    ok;
+  int     errorCode;             // ok=false iken
+  int32_t messageId;             // sendMessage / editMessageText sonucu
+  char    desc[96];              // hata açıklaması
+};
+
+typedef bool (*TgUpdateFn)(const TgUpdate& u, void* ctx);
+
+struct TgResponse {
+  JsonSax    sax;
+  TgResult   res;
+  TgUpdate   upd;
+  TgUpdateFn fn;
+  void*      ctx;
+  uint16_t   updates;       // callback'in kabul ettiği update sayısı
+  long       lastUpdateId;  // kabul edilen son update (yanıt yarıda kesilse de geçerli)
+};
+
+void tgResponseBegin(TgResponse& r, TgUpdateFn fn = nullptr, void* ctx = nullptr);
+bool tgResponseFeed(TgResponse& r, const char* data, size_t len);
+bool tgResponseComplete(const TgResponse& r);
@@ -0,0 +1,243 @@
+/*
+  src/ezan_stream.cpp - Ezan API vakit listesinin akış ayrıştırıcısı
+  Bkz. include/ezan_stream.h
+*/
+
+#include "ezan_stream.h"
+
+#include <string.h>
+
+static const uint8_t EZ_STR_SKIP = 0;
+static const uint8_t EZ_STR_KEY  = 1;
+static const uint8_t EZ_STR_VAL  = 2;
+
+static const char* const EZ_FIELD_KEYS[EZ_F_COUNT] = {
+  "MiladiTarihUzunIso8601",
+  "MiladiTarihKisa",
+  "MiladiTarihKisaIso8601",
+  "Imsak",
+  "Aksam",
+  "HicriTarihUzun",
+};
+
+static int8_t ezFieldOf(const char* key) {
+  for (int i = 0; i < EZ_F_COUNT; i++) {
+    if (strcmp(key, EZ_FIELD_KEYS[i]) == 0) return (int8_t)i;
+  }
+  return -1;
+}
+
+static bool ezTopIsObject(const EzanStreamParser& p) {
+  return p.depth > 0 && ((p.ctr >> (p.depth - 1)) & 1u);
+}
+
+// Kayıt seviyesi: üst seviye dizinin doğrudan elemanı olan nesnenin içi
+static bool ezInRecord(const EzanStreamParser& p) {
+  return p.depth == 2 && (p.ctr & 1u) == 0 && (p.ctr & 2u) != 0;
+}
+
+static void ezPut(EzanStreamParser& p, char c) {
+  if (p.strKind == EZ_STR_KEY) {
+    if (p.keyLen < EZ_KEY_MAX - 1) p.key[p.keyLen++] = c;
+    else p.keyLen = EZ_KEY_MAX;  // taştı: hiçbir alanla eşleşmez
+  } else if (p.strKind == EZ_STR_VAL) {
+    if (p.valLen < EZ_VAL_MAX - 1) p.rec.val[p.field][p.valLen++] = c;
+  }
+}
+
+static void ezPutUtf8(EzanStreamParser& p, uint16_t cp) {
+  if (cp < 0x80) {
+    ezPut(p, (char)cp);
+  } else if (cp < 0x800) {
+    ezPut(p, (char)(0xC0 | (cp >> 6)));
+    ezPut(p, (char)(0x80 | (cp & 0x3F)));
+  } else if (cp >= 0xD800 && cp <= 0xDFFF) {
+    ezPut(p, '?');  // BMP dışı (surrogate) karakterler alanlarımızda yok
+  } else {
+    ezPut(p, (char)(0xE0 | (cp >> 12)));
+    ezPut(p, (char)(0x80 | ((cp >> 6) & 0x3F)));
+    ezPut(p, (char)(0x80 | (cp & 0x3F)));
+  }
+}
+
+static void ezStrEnd(EzanStreamParser& p) {
+  p.inStr = 0;
+  if (p.strKind == EZ_STR_KEY) {
+    if (p.keyLen >= EZ_KEY_MAX) p.keyLen = 0, p.key[0] = '\0';
+    else p.key[p.keyLen] = '\0';
+    p.field = p.key[0] ? ezFieldOf(p.key) : -1;
+    p.expectKey = 0;
+  } else if (p.strKind == EZ_STR_VAL) {
+    p.rec.val[p.field][p.valLen] = '\0';
+    p.rec.seen |= (uint8_t)(1u << p.field);
+    p.field = -1;
+  }
+}
+
+static int ezHex(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+void ezanStreamInit(EzanStreamParser& p) {
+  memset(&p, 0, sizeof(p));
+  p.field = -1;
+}
+
+bool ezanStreamFeed(EzanStreamParser& p, const char* data, size_t len, EzanRecordFn fn, void* ctx) {
+  if (p.error) return false;
+  p.bytes += (uint32_t)len;
+
+  for (size_t i = 0; i < len; i++) {
+    char c = data[i];
+
+    if (p.inStr) {
+      if (p.uLeft) {
+        int h = ezHex(c);
+        if (h < 0) { p.error = 1; return false; }
+        p.uCode = (uint16_t)((p.uCode << 4) | (uint16_t)h);
+        if (--p.uLeft == 0) ezPutUtf8(p, p.uCode);
+      } else if (p.esc) {
+        p.esc = 0;
+        switch (c) {
+          case 'u': p.uLeft = 4; p.uCode = 0; break;
+          case 'n': ezPut(p, '\n'); break;
+          case 't': ezPut(p, '\t'); break;
+          case 'r': ezPut(p, '\r'); break;
+          case 'b': ezPut(p, '\b'); break;
+          case 'f': ezPut(p, '\f'); break;
+          default:  ezPut(p, c); break;  // \" \\ \/
+        }
+      } else if (c == '\\') {
+        p.esc = 1;
+      } else if (c == '"') {
+        ezStrEnd(p);
+      } else {
+        ezPut(p, c);
+      }
+      continue;
+    }
+
+    if (p.done) continue;  // üst seviye kapandı: kalanı yok say
+
+    switch (c) {
+      case ' ': case '\t': case '\r': case '\n':
+        break;
+
+      case '"':
+        p.inStr = 1; p.esc = 0; p.uLeft = 0;
+        p.strKind = EZ_STR_SKIP;
+        if (ezInRecord(p)) {
+          if (p.expectKey)      { p.strKind = EZ_STR_KEY; p.keyLen = 0; }
+          else if (p.field >= 0) { p.strKind = EZ_STR_VAL; p.valLen = 0; }
+        } else if (ezTopIsObject(p) && p.expectKey) {
+          p.expectKey = 0;
+        }
+        break;
+
+      case '{': case '[':
+        if (p.depth >= EZ_DEPTH_MAX) { p.error = 1; return false; }
+        if (c == '{' && p.depth == 1 && (p.ctr & 1u) == 0) memset(&p.rec, 0, sizeof(p.rec));
+        if (c == '{') p.ctr |= (uint16_t)(1u << p.depth);
+        else          p.ctr &= (uint16_t)~(1u << p.depth);
+        p.depth++;
+        p.started = 1;
+        p.expectKey = (c == '{');
+        p.field = -1;
+        break;
+
+      case '}': case ']': {
+        if (p.depth == 0 || ezTopIsObject(p) != (c == '}')) { p.error = 1; return false; }
+        bool recEnd = ezInRecord(p);
+        p.depth--;
+        p.expectKey = 0;
+        p.field = -1;
+        if (recEnd) {
+          p.records++;
+          if (fn && !fn(p.rec, ctx)) { p.error = 1; return false; }
+        }
+        if (p.depth == 0) p.done = 1;
+        break;
+      }
+
+      case ',':
+        if (ezTopIsObject(p)) p.expectKey = 1;
+        p.field = -1;
+        break;
+
+      case ':':
+        p.expectKey = 0;
+        break;
+
+      default:
+        if (!p.started) { p.error = 1; return false; }  // üst seviye dizi/nesne değil
+        break;  // sayı / true / false / null: atlanır
+    }
+  }
+  return true;
+}
+
+bool ezanStreamComplete(const EzanStreamParser& p) {
+  return p.started && p.done && !p.error && !p.inStr;
+}
+
+// =====================
+// Alan çevirileri
+// =====================
+static int ezDigits(const char* s, int n) {
+  int v = 0;
+  for (int i = 0; i < n; i++) {
+    if (s[i] < '0' || s[i] > '9') return -1;
+    v = v * 10 + (s[i] - '0');
+  }
+  return v;
+}
+
+uint32_t ezanParseDateYmd(const char* s) {
+  if (strlen(s) < 10) return 0;
+  int y = -1, m = -1, d = -1;
+  if (s[4] == '-' && s[7] == '-') {
+    y = ezDigits(s, 4); m = ezDigits(s + 5, 2); d = ezDigits(s + 8, 2);
+  } else if (s[2] == '.' && s[5] == '.') {
+    d = ezDigits(s, 2); m = ezDigits(s + 3, 2); y = ezDigits(s + 6, 4);
+  }
+  if (y < 0 || m < 1 || m > 12 || d < 1 || d > 31) return 0;
+  return (uint32_t)y * 10000u + (uint32_t)m * 100u + (uint32_t)d;
+}
+
+uint16_t ezanParseHhmm(const char* s) {
+  if (strlen(s) < 4) return 0;
+  int hh = ezDigits(s, 2);
+  int mm = ezDigits(s + 3, 2);
+  if (hh < 0 || hh > 23) hh = (hh < 0) ? 0 : 23;
+  if (mm < 0 || mm > 59) mm = (mm < 0) ? 0 : 59;
+  return (uint16_t)(hh * 60 + mm);
+}
+
+bool ezanRecordToDay(const EzanRecord& rec, DayTimes& out) {
+  const char* date = rec.val[EZ_F_DATE_UZUN_ISO];
+  if (!date[0]) date = rec.val[EZ_F_DATE_KISA];
+  if (!date[0]) date = rec.val[EZ_F_DATE_KISA_ISO];
+
+  uint32_t ymd = ezanParseDateYmd(date);
+  if (ymd == 0) return false;
+  if (strlen(rec.val[EZ_F_IMSAK]) < 4 || strlen(rec.val[EZ_F_AKSAM]) < 4) return false;
+
+  // HicriTarihUzun: baş/son boşluk kırp
+  char hicri[EZ_VAL_MAX];
+  const char* h = rec.val[EZ_F_HICRI];
+  while (*h == ' ' || *h == '\t') h++;
+  size_t n = strlen(h);
+  while (n > 0 && (h[n - 1] == ' ' || h[n - 1] == '\t' || h[n - 1] == '\r' || h[n - 1] == '\n')) n--;
+  memcpy(hicri, h, n);
+  hicri[n] = '\0';
+
+  memset(&out, 0, sizeof(out));
+  out.ymd      = ymd;
+  out.imsakMin = ezanParseHhmm(rec.val[EZ_F_IMSAK]);
+  out.aksamMin = ezanParseHhmm(rec.val[EZ_F_AKSAM]);
+  dayTimesSetHicri(out, hicri);
+  return true;
+}
@@ -0,0 +1,116 @@
+/*
+  src/hijri_calendar.cpp - Çevrimdışı Hicri takvim (tabular)
+  Bkz. include/hijri_calendar.h
+*/
+
+#include "hijri_calendar.h"
+
+// 1 Muharrem 1 = 16 Temmuz 622 (Julian) -> JDN 1948440; epoch-günü = JDN - 2440588
+static const int32_t HIJRI_EPOCH_DAYS = 1948440 - 2440588;
+
+static int32_t floorDiv32(int32_t a, int32_t b) {
+  return (a >= 0) ? a / b : -((-a + b - 1) / b);
+}
+
+int32_t hijriToDays(int year, int monIdx, int day) {
+  // ceil(29.5 * m) = (59 * m + 1) / 2
+  return (int32_t)day
+       + (int32_t)((59 * monIdx + 1) / 2)
+       + (int32_t)(year - 1) * 354
+       + floorDiv32(3 + 11 * year, 30)
+       + HIJRI_EPOCH_DAYS - 1;
+}
+
+void hijriFromDays(int32_t days, int& yearOut, int& monIdxOut, int& dayOut) {
+  int32_t rel = days - HIJRI_EPOCH_DAYS;
+  int y = (int)floorDiv32(30 * rel + 10646, 10631);
+
+  int32_t fromYearStart = days - hijriToDays(y, 0, 1);
+  // ay: fromYearStart / 29.5 (yukarı değil aşağı yuvarla), 0..11
+  int m = (int)((2 * fromYearStart + 1) / 59);
+  if (m > 11) m = 11;
+  if (m < 0)  m = 0;
+  while (m > 0 && days < hijriToDays(y, m, 1)) m--;
+
+  yearOut   = y;
+  monIdxOut = m;
+  dayOut    = (int)(days - hijriToDays(y, m, 1)) + 1;
+}
+
+static const char* const HIJRI_MONTH_NAMES[12] = {
+  "Muharrem", "Safer", "Rebiülevvel", "Rebiülahir", "Cemaziyelevvel", "Cemaziyelahir",
+  "Recep", "Şaban", "Ramazan", "Şevval", "Zilkade", "Zilhicce",
+};
+
+const char* hijriMonthName(int monIdx) {
+  return (monIdx >= 0 && monIdx < 12) ? HIJRI_MONTH_NAMES[monIdx] : "?";
+}
+
+bool hijriCalibrate(const DayTimes* days, uint16_t n, int8_t& offOut, uint16_t& agreeOut, uint16_t& samplesOut) {
+  agreeOut = 0; samplesOut = 0;
+
+  int32_t off = 0;
+  bool have = false;
+  for (int i = (int)n - 1; i >= 0; i--) {
+    const DayTimes& d = days[i];
+    if (d.hDay == 0 || d.hMon < 0 || d.hYear == 0) continue;
+    off = daysFromYmd(d.ymd) - hijriToDays((int)d.hYear, (int)d.hMon, (int)d.hDay);
+    have = true;
+    break;
+  }
+  if (!have || off < -HIJRI_CAL_OFF_MAX || off > HIJRI_CAL_OFF_MAX) return false;
+
+  for (uint16_t i = 0; i < n; i++) {
+    const DayTimes& d = days[i];
+    if (d.hDay == 0 || d.hMon < 0 || d.hYear == 0) continue;
+    samplesOut++;
+    if (daysFromYmd(d.ymd) - hijriToDays((int)d.hYear, (int)d.hMon, (int)d.hDay) == off) agreeOut++;
+  }
+
+  offOut = (int8_t)off;
+  return true;
+}
+
+// =====================
+// Tahmin
+// =====================
+static void predPush(HijriPrediction* out, int cap, int& n, int32_t day, int hYear, uint8_t reason, uint8_t arg) {
+  if (n >= cap) return;
+  HijriPrediction p;
+  p.ymd = ymdFromDays(day); p.hYear = (uint16_t)hYear; p.reason = reason; p.arg = arg;
+
+  // ymd'ye göre sıralı ekle (eşitlikte özel gün Ramazan'dan önce, timeline ile aynı)
+  int j = n;
+  while (j > 0 && (out[j - 1].ymd > p.ymd || (out[j - 1].ymd == p.ymd && out[j - 1].reason > p.reason))) {
+    out[j] = out[j - 1];
+    j--;
+  }
+  out[j] = p;
+  n++;
+}
+
+int hijriPredictSpecials(const SchedInput& in, int8_t calOff, int32_t fromDay, int32_t toDay,
+                         HijriPrediction* out, int cap) {
+  if (toDay < fromDay || cap <= 0) return 0;
+
+  int yFrom = 0, yTo = 0, m = 0, d = 0;
+  hijriFromDays(fromDay - calOff, yFrom, m, d);
+  hijriFromDays(toDay - calOff, yTo, m, d);
+
+  int n = 0;
+  for (int y = yFrom; y <= yTo; y++) {
+    for (uint8_t k = 0; k < SPECIAL_COUNT; k++) {
+      if (((in.spEnableMask >> k) & 1u) == 0) continue;
+      int rd = 0, rm = -1, ry = 0;
+      if (!schedSpecialRule(in, k, rd, rm, ry) || rm < 0) continue;
+      if (ry != 0 && ry != y) continue;
+      int32_t day = hijriToDays(y, rm, rd) + calOff;
+      if (day >= fromDay && day <= toDay) predPush(out, cap, n, day, y, SR_SPECIAL, k);
+    }
+    if (in.ramazanAll) {
+      int32_t day = hijriToDays(y, 8, 1) + calOff;
+      if (day >= fromDay && day <= toDay) predPush(out, cap, n, day, y, SR_RAMAZAN, 1);
+    }
+  }
+  return n;
+}
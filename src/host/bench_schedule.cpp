@@ -0,0 +1,449 @@
+/*
+  src/host/bench_schedule.cpp - env:native çizelge benchmark'ı
+
+  Çalıştırma:
+    pio run -e native && .pio/build/native/program [tekrar]
+
+  Her fixture (45 günlük g_days kaydı) için:
+    - Tarih yardımcıları ve pencere fonksiyonlarının çağrı başına süresi (ns/op)
+    - Loop simülasyonu: fixture ufku boyunca dakikada bir "tick";
+      eski yol (her tick tablo taraması) vs timeline (bir kez kur + binary search)
+    - Tarama ile timeline sonuçlarının karşılaştırması (uyuşmazlık sayısı)
+    - Kural tablosu: derleme süresi ve röle kararı (aralık araması) vs tarama pencereleri
+
+  Çevrimdışı vakit hesabı (prayer_times.h) fixture koordinatıyla çalıştırılıp fixture'daki
+  imsak/akşam ile dakika farkı (ortalama, |maks|, histogram) raporlanır. Fark sadece
+  recorded=1 (gerçek API cevabından üretilmiş) fixture'larda doğruluk ölçüsüdür; sentetik
+  fixture'lar yaklaşık bir eğridir.
+
+  Başlangıçta civil_time.h aritmetiği 2000..2100 arası her gün için libc
+  (mktime/localtime_r, TZ=UTC+3) ile karşılaştırılır; uyuşmazlık varsa çıkış kodu 1.
+
+  Tablo kapasitesi: her fixture'da varsayılan kural seti (tüm özel günler + Ramazan)
+  SCHED_TL_MAX/SCHED_IV_MAX'a taşmadan sığmalı; tam sınırda taşma bildirilmemeli, bir
+  eksik kapasitede ve tablo ek kurallarla doldurulduğunda overflow bildirilmeli ve
+  kesilen timeline'da eşsiz ON kenarı kalmamalı. Aksi halde çıkış kodu 1.
+
+  Süreler host CPU'sunda ölçülür; cihazdaki mutlak değeri değil, değişiklikler
+  arasındaki göreli farkı (regresyon) görmek içindir.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <chrono>
+
+#include "schedule_engine.h"
+#include "hijri_calendar.h"
+#include "prayer_times.h"
+#include "sched_fixtures.h"
+
+// Cihaz configTime(LOCAL_UTC_OFFSET_SEC, 0, ...) ile sabit UTC+3 çalışır
+static const char* BENCH_TZ = "<+03>-3";
+
+static const int ON_OFFSET_SEC  = 60;
+static const int OFF_OFFSET_SEC = 60;
+static const time_t TICK_SEC    = 60;
+
+static volatile uint64_t g_sink = 0;  // optimizer ölçülen çağrıyı silmesin
+
+typedef std::chrono::steady_clock Clock;
+
+static double nsSince(Clock::time_point t0, uint64_t ops) {
+  double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - t0).count();
+  return ops ? ns / (double)ops : 0.0;
+}
+
+static void printRow(const char* name, double nsPerOp, uint64_t ops) {
+  printf("  %-34s %12.1f ns/op  (%llu op)\n", name, nsPerOp, (unsigned long long)ops);
+}
+
+// ---- civil_time.h vs libc (2000-01-01 .. 2100-12-31, ay taşan günler dahil) ----
+static uint64_t civilVsLibc() {
+  static const int MINS[]   = { 0, 1, 719, 1439 };
+  static const int DELTAS[] = { -366, -30, -7, -1, +1, +7, +30, +366 };
+  uint64_t bad = 0, n = 0;
+
+  for (int y = 2000; y <= 2100; y++) {
+    for (int m = 1; m <= 12; m++) {
+      for (int d = 1; d <= 31; d++) {
+        uint32_t ymd = (uint32_t)y * 10000u + (uint32_t)m * 100u + (uint32_t)d;
+
+        for (int mi : MINS) {
+          tm t{};
+          t.tm_year = y - 1900; t.tm_mon = m - 1; t.tm_mday = d;
+          t.tm_hour = mi / 60; t.tm_min = mi % 60; t.tm_isdst = -1;
+          time_t ref = mktime(&t);
+          n++;
+          if (epochFromYmdAndMin(ymd, (uint16_t)mi) != ref) bad++;
+
+          // Epoch -> yerel gün/hafta günü/saniye (gün sınırlarının iki yanı)
+          const time_t probes[] = { ref, ref - 1, ref + 59 };
+          for (time_t e : probes) {
+            tm lt{}; localtime_r(&e, &lt);
+            n++;
+            if (ymdFromEpoch(e) != ymdFromTm(lt) ||
+                weekdayFromEpoch(e) != lt.tm_wday ||
+                localSecOfDay(e) != lt.tm_hour * 3600 + lt.tm_min * 60 + lt.tm_sec) bad++;
+          }
+        }
+
+        tm noon{};
+        noon.tm_year = y - 1900; noon.tm_mon = m - 1; noon.tm_mday = d; noon.tm_hour = 12; noon.tm_isdst = -1;
+        time_t noonTs = mktime(&noon);
+        for (int dd : DELTAS) {
+          time_t e = noonTs + (time_t)dd * 86400;
+          tm lt{}; localtime_r(&e, &lt);
+          n++;
+          if (addDaysYmd(ymd, dd) != ymdFromTm(lt)) bad++;
+        }
+        tm wt{}; localtime_r(&noonTs, &wt);
+        n++;
+        if (weekdayOfYmd(ymd) != wt.tm_wday) bad++;
+      }
+    }
+  }
+  printf("civil_time vs libc: %llu karşılaştırma, uyuşmazlık=%llu\n",
+         (unsigned long long)n, (unsigned long long)bad);
+  return bad;
+}
+
+static void spDefaults(SpOverride* ov) {
+  for (uint8_t i = 0; i < SPECIAL_COUNT; i++) {
+    int mi = hicriMonthIndex(g_specials[i].monthKey, strlen(g_specials[i].monthKey));
+    ov[i].useDefault = 1;
+    ov[i].day   = g_specials[i].day;
+    ov[i].month = (uint8_t)(mi < 0 ? 0 : mi);
+    ov[i].year  = 0;
+  }
+}
+
+// Kesilmiş timeline tutarlı mı: her pencere ON kenarının OFF eşi de tabloda
+static bool tlPaired(const SchedTransition* tl, uint16_t n) {
+  for (uint16_t i = 0; i < n; i++) {
+    if (tl[i].on == 0 || tl[i].reason == SR_IMSAK_OFF) continue;
+    bool found = false;
+    for (uint16_t j = 0; j < n && !found; j++) {
+      found = tl[j].on == 0 && tl[j].ts == tl[i].peer && tl[j].peer == tl[i].ts && tl[j].rule == tl[i].rule;
+    }
+    if (!found) return false;
+  }
+  return true;
+}
+
+// ---- Tablo kapasitesi (taşma görünür olmalı). Dönüş: hata sayısı ----
+static int capacityCheck(const SchedInput& in) {
+  static SchedRule rules[SCHED_RULE_MAX];
+  static uint32_t masks[SCHED_MAX_DAYS];
+  static SchedTransition tl[SCHED_TL_MAX];
+  static SchedInterval iv[SCHED_IV_MAX];
+  int bad = 0;
+
+  // 1) Varsayılan set en geniş haliyle sığar; tam sınırda taşma yok, bir eksikte var
+  int nRules = schedDefaultRules(in, rules, SCHED_RULE_MAX);
+  schedRuleDayMasks(in, rules, nRules, masks);
+  bool tlFull = true, ivFull = true;
+  uint16_t tlN = schedBuildTimeline(in, rules, nRules, masks, tl, (uint16_t)SCHED_TL_MAX, &tlFull);
+  uint16_t ivN = schedBuildIntervals(tl, tlN, iv, (uint16_t)SCHED_IV_MAX, &ivFull);
+  if (tlFull || ivFull) bad++;
+  if (ivN > 0) {
+    bool exact = true, under = false;
+    schedBuildIntervals(tl, tlN, iv, ivN, &exact);
+    schedBuildIntervals(tl, tlN, iv, (uint16_t)(ivN - 1), &under);
+    if (exact || !under) bad++;
+  }
+  bool exact = true, under = false;
+  schedBuildTimeline(in, rules, nRules, masks, tl, tlN, &exact);
+  uint16_t underN = schedBuildTimeline(in, rules, nRules, masks, tl, (uint16_t)(tlN - 1), &under);
+  if (exact || !under || !tlPaired(tl, underN)) bad++;
+
+  // 2) Kural tablosu sonuna kadar her gün ON olan ek kurallarla dolu: timeline taşar
+  int nFill = nRules;
+  while (nFill < SCHED_RULE_MAX) {
+    SchedRule r{};
+    r.kind = RK_WEEKDAY; r.reason = SR_CUSTOM; r.arg = (uint8_t)nFill; r.wdayMask = 0x7f; r.hMon = -1;
+    r.onTolSec = SCHED_TOL_INHERIT; r.offTolSec = SCHED_TOL_INHERIT;
+    rules[nFill++] = r;
+  }
+  schedRuleDayMasks(in, rules, nFill, masks);
+  bool fillFull = false;
+  uint16_t fillN = schedBuildTimeline(in, rules, nFill, masks, tl, (uint16_t)SCHED_TL_MAX, &fillFull);
+  if (!fillFull || !tlPaired(tl, fillN)) bad++;
+
+  printf("  kapasite: varsayılan kenar=%u/%d aralık=%u/%d  dolu tablo kural=%d kenar=%u taşma=%d  hata=%d\n",
+         (unsigned)tlN, SCHED_TL_MAX, (unsigned)ivN, SCHED_IV_MAX, nFill, (unsigned)fillN, (int)fillFull, bad);
+  return bad;
+}
+
+static int benchFixture(const SchedFixture& fx, int reps) {
+  SpOverride ov[SPECIAL_COUNT];
+  spDefaults(ov);
+
+  SchedDayIndex dayIdx{};
+  schedDayIndexBuild(fx.days, fx.count, dayIdx);
+
+  SchedInput in{};
+  in.days         = fx.days;
+  in.dayCount     = fx.count;
+  in.dayIdx       = &dayIdx;
+  in.spOv         = ov;
+  in.spEnableMask = (1u << SPECIAL_COUNT) - 1u;
+  in.ramazanAll   = true;
+  in.onOffsetSec  = ON_OFFSET_SEC;
+  in.offOffsetSec = OFF_OFFSET_SEC;
+
+  printf("\n[%s] %u gün  %lu..%lu  ardışık=%u\n", fx.name, (unsigned)fx.count,
+         (unsigned long)fx.days[0].ymd, (unsigned long)fx.days[fx.count - 1].ymd, (unsigned)dayIdx.contiguous);
+  int capBad = capacityCheck(in);
+
+  // ---- Tarih yardımcıları ----
+  {
+    uint64_t ops = 0, acc = 0;
+    Clock::time_point t0 = Clock::now();
+    for (int r = 0; r < reps; r++)
+      for (uint16_t i = 0; i < fx.count; i++, ops++) acc += (uint64_t)epochFromYmdAndMin(fx.days[i].ymd, fx.days[i].imsakMin);
+    printRow("epochFromYmdAndMin", nsSince(t0, ops), ops);
+    g_sink += acc;
+  }
+  {
+    uint64_t ops = 0, acc = 0;
+    Clock::time_point t0 = Clock::now();
+    for (int r = 0; r < reps; r++)
+      for (uint16_t i = 0; i < fx.count; i++, ops++) acc += addDaysYmd(fx.days[i].ymd, (i & 1) ? +1 : -1);
+    printRow("addDaysYmd", nsSince(t0, ops), ops);
+    g_sink += acc;
+  }
+
+  // ---- Gün arama: doğrusal vs indeks (son gün + olmayan gün dahil) ----
+  {
+    SchedInput lin = in;
+    lin.dayIdx = nullptr;
+    const SchedInput* modes[2] = { &lin, &in };
+    const char* names[2] = { "schedFindIdx (doğrusal)", "schedFindIdx (gün indeksi)" };
+    for (int mo = 0; mo < 2; mo++) {
+      uint64_t ops = 0, acc = 0;
+      Clock::time_point t0 = Clock::now();
+      for (int r = 0; r < reps; r++)
+        for (int i = 0; i <= (int)fx.count; i++, ops++) {
+          uint32_t ymd = (i < (int)fx.count) ? fx.days[i].ymd : addDaysYmd(fx.days[fx.count - 1].ymd, +1);
+          acc += (uint64_t)(schedFindIdx(*modes[mo], ymd) + 1);
+        }
+      printRow(names[mo], nsSince(t0, ops), ops);
+      g_sink += acc;
+    }
+  }
+
+  // ---- Pencere fonksiyonları ----
+  {
+    uint64_t ops = 0, acc = 0;
+    Clock::time_point t0 = Clock::now();
+    for (int r = 0; r < reps; r++)
+      for (uint8_t k = 0; k < SPECIAL_COUNT; k++, ops++) {
+        time_t on = 0, off = 0; uint32_t ymdEv = 0;
+        if (computeWindowForSpecial(in, k, on, off, ymdEv)) acc += (uint64_t)off;
+      }
+    printRow("computeWindowForSpecial", nsSince(t0, ops), ops);
+    g_sink += acc;
+  }
+  {
+    uint64_t ops = 0, acc = 0;
+    Clock::time_point t0 = Clock::now();
+    for (int r = 0; r < reps; r++)
+      for (int idx = 0; idx < (int)fx.count; idx++, ops++) {
+        time_t on = 0, off = 0;
+        if (buildWindowForEventIdx(in, idx, on, off)) acc += (uint64_t)on;
+      }
+    printRow("buildWindowForEventIdx", nsSince(t0, ops), ops);
+    g_sink += acc;
+  }
+
+  static SchedRule rules[SCHED_RULE_MAX];
+  int nRules = 0;
+  {
+    uint64_t ops = 0;
+    Clock::time_point t0 = Clock::now();
+    for (int r = 0; r < reps; r++, ops++) nRules = schedDefaultRules(in, rules, SCHED_RULE_MAX);
+    printRow("schedDefaultRules", nsSince(t0, ops), ops);
+    g_sink += (uint64_t)nRules;
+  }
+
+  static uint32_t masks[SCHED_MAX_DAYS];
+  {
+    uint64_t ops = 0;
+    Clock::time_point t0 = Clock::now();
+    for (int r = 0; r < reps; r++, ops++) schedRuleDayMasks(in, rules, nRules, masks);
+    printRow("schedRuleDayMasks", nsSince(t0, ops), ops);
+    g_sink += masks[0];
+  }
+
+  static SchedTransition tl[SCHED_TL_MAX];
+  uint16_t tlN = 0;
+  {
+    uint64_t ops = 0;
+    Clock::time_point t0 = Clock::now();
+    for (int r = 0; r < reps; r++, ops++) tlN = schedBuildTimeline(in, rules, nRules, masks, tl, (uint16_t)SCHED_TL_MAX);
+    printRow("schedBuildTimeline", nsSince(t0, ops), ops);
+    g_sink += tlN;
+  }
+
+  static SchedInterval iv[SCHED_IV_MAX];
+  uint16_t ivN = 0;
+  {
+    uint64_t ops = 0;
+    Clock::time_point t0 = Clock::now();
+    for (int r = 0; r < reps; r++, ops++) ivN = schedBuildIntervals(tl, tlN, iv, (uint16_t)SCHED_IV_MAX);
+    printRow("schedBuildIntervals", nsSince(t0, ops), ops);
+    g_sink += ivN;
+  }
+
+  // ---- Loop simülasyonu (dakikada bir tick) ----
+  time_t t0s = epochFromYmdAndMin(fx.days[0].ymd, 0);
+  time_t t1s = epochFromYmdAndMin(fx.days[fx.count - 1].ymd, 23 * 60 + 59);
+  uint64_t ticks = (uint64_t)((t1s - t0s) / TICK_SEC) + 1;
+
+  {
+    uint64_t acc = 0;
+    Clock::time_point t0 = Clock::now();
+    for (time_t now = t0s; now <= t1s; now += TICK_SEC) {
+      time_t on = 0, off = 0, imsakOff = 0; SchedWindow w{};
+      if (schedThuFriWindowScan(in, now, on, off)) acc += (uint64_t)off;
+      if (schedNextImsakOffScan(in, now, imsakOff)) acc += (uint64_t)imsakOff;
+      if (schedNextSpecialScan(in, now, w)) acc += (uint64_t)w.off;
+    }
+    printRow("tick: tarama (thu+imsak+special)", nsSince(t0, ticks), ticks);
+    g_sink += acc;
+  }
+  {
+    uint64_t acc = 0;
+    Clock::time_point t0 = Clock::now();
+    for (time_t now = t0s; now <= t1s; now += TICK_SEC) {
+      int a = schedFindWindowEnd(tl, tlN, now, SRM_THU_FRI);
+      int b = schedFindWindowEnd(tl, tlN, now, SRM_IMSAK_OFF);
+      int c = schedFindWindowEnd(tl, tlN, now, SRM_DINI);
+      if (a >= 0) acc += (uint64_t)tl[a].ts;
+      if (b >= 0) acc += (uint64_t)tl[b].ts;
+      if (c >= 0) acc += (uint64_t)tl[c].ts;
+    }
+    printRow("tick: timeline lookup", nsSince(t0, ticks), ticks);
+    g_sink += acc;
+  }
+  {
+    uint64_t acc = 0;
+    Clock::time_point t0 = Clock::now();
+    for (time_t now = t0s; now <= t1s; now += TICK_SEC) acc += (uint64_t)(schedIntervalAt(iv, ivN, now) + 1);
+    printRow("tick: röle kararı (aralık tablosu)", nsSince(t0, ticks), ticks);
+    g_sink += acc;
+  }
+
+  // ---- Çevrimdışı Hicri takvim: kalibrasyon + 12 aylık tahmin ----
+  {
+    int8_t off = 0; uint16_t agree = 0, samples = 0;
+    bool cal = hijriCalibrate(fx.days, fx.count, off, agree, samples);
+    static HijriPrediction pred[2 * (SPECIAL_COUNT + 1)];
+    int32_t from = daysFromYmd(fx.days[fx.count - 1].ymd) + 1;
+    int np = 0;
+    uint64_t ops = 0;
+    Clock::time_point t0 = Clock::now();
+    for (int r = 0; r < reps; r++, ops++)
+      np = hijriPredictSpecials(in, off, from, daysFromYmd(fx.days[0].ymd) + 365, pred, 2 * (SPECIAL_COUNT + 1));
+    printRow("hijriPredictSpecials (12 ay)", nsSince(t0, ops), ops);
+    printf("  hicri kalibrasyon=%d ofset=%d uyum=%u/%u  tahmin=%d (ilk %lu)\n", (int)cal, (int)off,
+           (unsigned)agree, (unsigned)samples, np, np > 0 ? (unsigned long)pred[0].ymd : 0ul);
+    g_sink += (uint64_t)np;
+  }
+
+  // ---- Çevrimdışı vakit hesabı vs fixture (dakika hatası) ----
+  {
+    int n = 0, sumIm = 0, sumAk = 0, maxIm = 0, maxAk = 0, within1 = 0, within2 = 0;
+    uint64_t ops = 0;
+    Clock::time_point t0 = Clock::now();
+    for (int r = 0; r < reps; r++) {
+      for (uint16_t i = 0; i < fx.count; i++, ops++) {
+        uint16_t im = 0, ak = 0;
+        if (!prayerCalcDay(daysFromYmd(fx.days[i].ymd), fx.latE6, fx.lonE6, im, ak)) continue;
+        if (r > 0) { g_sink += im; continue; }
+        int dIm = (int)im - (int)fx.days[i].imsakMin;
+        int dAk = (int)ak - (int)fx.days[i].aksamMin;
+        n++; sumIm += dIm; sumAk += dAk;
+        if (abs(dIm) > maxIm) maxIm = abs(dIm);
+        if (abs(dAk) > maxAk) maxAk = abs(dAk);
+        if (abs(dIm) <= 1 && abs(dAk) <= 1) within1++;
+        if (abs(dIm) <= 2 && abs(dAk) <= 2) within2++;
+      }
+    }
+    printRow("prayerCalcDay", nsSince(t0, ops), ops);
+    printf("  vakit hesabı (%s) n=%d  imsak ort=%+.2f |maks|=%d  akşam ort=%+.2f |maks|=%d dk  "
+           "±1dk=%d ±2dk=%d%s\n", fx.recorded ? "kayıtlı API" : "sentetik", n,
+           n ? (double)sumIm / n : 0.0, maxIm, n ? (double)sumAk / n : 0.0, maxAk, within1, within2,
+           fx.recorded ? "" : "  (yaklaşık eğri: doğruluk ölçüsü değil)");
+  }
+
+  // ---- Tarama vs timeline karşılaştırması (ikisi de sonuç verdiğinde) ----
+  uint64_t cmpThu = 0, cmpImsak = 0, cmpSp = 0, bad = 0;
+  for (time_t now = t0s; now <= t1s; now += TICK_SEC) {
+    time_t on = 0, off = 0;
+    int a = schedFindWindowEnd(tl, tlN, now, SRM_THU_FRI);
+    if (schedThuFriWindowScan(in, now, on, off) && a >= 0) {
+      cmpThu++;
+      if (tl[a].peer != on || tl[a].ts != off) bad++;
+    }
+
+    time_t imsakOff = 0;
+    int b = schedFindWindowEnd(tl, tlN, now, SRM_IMSAK_OFF);
+    if (schedNextImsakOffScan(in, now, imsakOff) && b >= 0) {
+      cmpImsak++;
+      if (tl[b].ts != imsakOff) bad++;
+    }
+
+    SchedWindow w{};
+    int c = schedFindWindowEnd(tl, tlN, now, SRM_DINI);
+    if (schedNextSpecialScan(in, now, w) && c >= 0) {
+      cmpSp++;
+      if (tl[c].peer != w.on || tl[c].ts != w.off) bad++;
+    }
+  }
+  // ---- Röle kararı: aralık tablosu vs tarama pencereleri (Perşembe || dini gün aktif) ----
+  uint64_t cmpRelay = 0, badRelay = 0;
+  for (time_t now = t0s; now <= t1s; now += TICK_SEC) {
+    time_t on = 0, off = 0;
+    SchedWindow w{};
+    bool thu = schedThuFriWindowScan(in, now, on, off);
+    bool sp  = schedNextSpecialScan(in, now, w);
+    if (!thu || !sp) continue;  // tarama ufuk dışında: karşılaştırma yok
+    cmpRelay++;
+    bool scanOn = (now >= on && now < off) || (now >= w.on && now < w.off);
+    if (scanOn != (schedIntervalAt(iv, ivN, now) >= 0)) badRelay++;
+  }
+  bad += badRelay;
+  printf("  kural=%d aralık=%u  röle kararı karşılaştırma=%llu uyuşmazlık=%llu\n", nRules, (unsigned)ivN,
+         (unsigned long long)cmpRelay, (unsigned long long)badRelay);
+
+  printf("  timeline kenar=%u  karşılaştırma thu=%llu imsak=%llu dini=%llu  uyuşmazlık=%llu\n",
+         (unsigned)tlN, (unsigned long long)cmpThu, (unsigned long long)cmpImsak,
+         (unsigned long long)cmpSp, (unsigned long long)bad);
+  return capBad;
+}
+
+int main(int argc, char** argv) {
+  int reps = (argc > 1) ? atoi(argv[1]) : 200;
+  if (reps < 1) reps = 1;
+
+  setenv("TZ", BENCH_TZ, 1);
+  tzset();
+
+  printf("Cami çizelge benchmark  TZ=%s  tekrar=%d  tick=%lds\n", BENCH_TZ, reps, (long)TICK_SEC);
+  uint64_t civilBad = civilVsLibc();
+  int capBad = 0;
+  int recorded = 0;
+  for (int i = 0; i < FIXTURE_COUNT; i++) {
+    capBad += benchFixture(g_fixtures[i], reps);
+    if (g_fixtures[i].recorded) recorded++;
+  }
+  if (recorded == 0) {
+    printf("\nUYARI: kayıtlı API fixture'ı yok; çevrimdışı vakit hesabının gerçek dakika hatası "
+           "ölçülmedi (tools/gen_sched_fixtures.py --json <cihazdan /vakitler cevabı>)\n");
+  }
+  printf("\nchecksum=%llu\n", (unsigned long long)g_sink);
+  return (civilBad || capBad) ? 1 : 0;
+}
@@ -0,0 +1,281 @@
+/*
+  src/host/http_load.cpp - env:httpload web paneli yük üreteci
+
+  Çalıştırma:
+    pio run -e httpload && .pio/build/httpload/program <ip> [seçenekler]
+
+  Seçenekler:
+    --port <n>          (varsayılan 80)
+    --path <yol>        İstenecek yol (varsayılan /api/public)
+    -c <n>              Eşzamanlı bağlantı (varsayılan 4); her bağlantı ayrı thread,
+                        bir yanıt gelmeden yenisini göndermez (tarayıcı sekmesi gibi)
+    -d <sn>             Süre (varsayılan 10)
+    -n <n>              Bağlantı başına istek sayısı (verilirse -d yerine)
+    --close             Her istekte yeni bağlantı (Connection: close); keep-alive ile
+                        karşılaştırma ve eski tek bağlantılı sunucu davranışı için
+    -H "Ad: değer"      Ek başlık (örn. X-API-KEY); birden fazla verilebilir
+
+  Çıktı: istek/sn, gecikme yüzdelikleri (p50/p90/p99/max, ms), hata ve yeni bağlantı
+  sayısı, istek başına ortalama yanıt boyutu. Gecikme = istek yazılmadan önce ile yanıt
+  gövdesinin son baytı arası (--close'da bağlantı kurulumu dahil). Sunucunun kapattığı
+  boştaki keep-alive bağlantıda istek, tarayıcılar gibi yeni bağlantıda bir kez
+  tekrarlanır ("tekrar"; süresi gecikmeye dahil).
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+
+struct LoadCfg {
+  const char* host = nullptr;
+  int         port = 80;
+  const char* path = "/api/public";
+  int         conns = 4;
+  double      seconds = 10;
+  long        perConn = 0;
+  bool        close = false;
+  std::string extra;          // ek başlıklar ("Ad: değer\r\n"...)
+};
+
+struct LoadResult {
+  std::vector<double> latMs;
+  long errors = 0;
+  long retries = 0;
+  long connects = 0;
+  long long bytes = 0;
+  long status[6] = {};        // 1xx..5xx (index = kod/100)
+};
+
+static void usage() {
+  fprintf(stderr,
+    "kullanım: http_load <ip> [--port n] [--path /api/public] [-c 4] [-d 10] [-n istek]\n"
+    "                   [--close] [-H \"X-API-KEY: ...\"]\n");
+}
+
+static int openConn(const LoadCfg& cfg) {
+  struct addrinfo hints, *res = nullptr;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+  char port[8];
+  snprintf(port, sizeof(port), "%d", cfg.port);
+  if (getaddrinfo(cfg.host, port, &hints, &res) != 0 || !res) return -1;
+
+  int fd = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+  if (fd >= 0) {
+    struct timeval tv = { 5, 0 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    if (connect(fd, res->ai_addr, res->ai_addrlen) != 0) { close(fd); fd = -1; }
+  }
+  freeaddrinfo(res);
+  return fd;
+}
+
+static bool writeAll(int fd, const char* p, size_t n) {
+  while (n > 0) {
+    ssize_t w = send(fd, p, n, MSG_NOSIGNAL);
+    if (w <= 0) return false;
+    p += w; n -= (size_t)w;
+  }
+  return true;
+}
+
+static bool fill(int fd, std::string& buf) {
+  char tmp[4096];
+  ssize_t n = recv(fd, tmp, sizeof(tmp), 0);
+  if (n <= 0) return false;
+  buf.append(tmp, (size_t)n);
+  return true;
+}
+
+// Transfer-Encoding: chunked gövde (buf başında); dönüş: gövde baytı, hata -1
+static long readChunked(int fd, std::string& buf) {
+  long body = 0;
+  for (;;) {
+    size_t eol;
+    while ((eol = buf.find("\r\n")) == std::string::npos) if (!fill(fd, buf)) return -1;
+    long n = strtol(buf.c_str(), nullptr, 16);
+    if (n < 0) return -1;
+    buf.erase(0, eol + 2);
+    while ((long)buf.size() < n + 2) if (!fill(fd, buf)) return -1;
+    buf.erase(0, (size_t)n + 2);          // veri + CRLF (trailer desteklenmiyor)
+    body += n;
+    if (n == 0) return body;
+  }
+}
+
+// Tek yanıt: başlıklar + Content-Length kadar gövde (chunked ise parçalar, yoksa
+// bağlantı sonuna kadar).
+// buf önceki okumadan artan baytları taşır. Dönüş: durum kodu, hata -1.
+static int readResponse(int fd, std::string& buf, bool& keepAlive, long long& bytes) {
+  size_t headEnd;
+  char tmp[4096];
+  while ((headEnd = buf.find("\r\n\r\n")) == std::string::npos) {
+    ssize_t n = recv(fd, tmp, sizeof(tmp), 0);
+    if (n <= 0) return -1;
+    buf.append(tmp, (size_t)n);
+  }
+
+  int code = 0;
+  if (sscanf(buf.c_str(), "HTTP/1.%*d %d", &code) != 1) return -1;
+
+  long clen = -1;
+  keepAlive = true;
+  std::string head = buf.substr(0, headEnd);
+  for (char& ch : head) ch = (char)tolower((unsigned char)ch);
+  size_t p = head.find("\r\ncontent-length:");
+  if (p != std::string::npos) clen = atol(head.c_str() + p + 17);
+  if (head.find("\r\nconnection: close") != std::string::npos) keepAlive = false;
+  bool chunked = head.find("\r\ntransfer-encoding: chunked") != std::string::npos;
+  if (head.compare(0, 8, "http/1.0") == 0 && head.find("\r\nconnection: keep-alive") == std::string::npos) keepAlive = false;
+
+  buf.erase(0, headEnd + 4);
+  if (code == 304 || code == 204 || code < 200) clen = 0;   // gövdesiz yanıtlar
+  else if (chunked) {
+    long n = readChunked(fd, buf);
+    if (n < 0) return -1;
+    bytes += n;
+    return code;
+  }
+  if (clen < 0) {
+    keepAlive = false;
+    for (;;) {
+      ssize_t n = recv(fd, tmp, sizeof(tmp), 0);
+      if (n < 0) return -1;
+      if (n == 0) break;
+      buf.append(tmp, (size_t)n);
+    }
+    clen = (long)buf.size();
+  }
+  while ((long)buf.size() < clen) {
+    ssize_t n = recv(fd, tmp, sizeof(tmp), 0);
+    if (n <= 0) return -1;
+    buf.append(tmp, (size_t)n);
+  }
+  buf.erase(0, (size_t)clen);
+  bytes += clen;
+  return code;
+}
+
+static void worker(const LoadCfg& cfg, Clock::time_point until, LoadResult& r) {
+  std::string req = std::string("GET ") + cfg.path + " HTTP/1.1\r\nHost: " + cfg.host + "\r\n" + cfg.extra +
+                    (cfg.close ? "Connection: close\r\n\r\n" : "\r\n");
+  std::string buf;
+  int fd = -1;
+  bool reused = false;   // fd üzerinde daha önce yanıt alındı
+  long done = 0;
+
+  for (;;) {
+    if (cfg.perConn > 0 ? done >= cfg.perConn : Clock::now() >= until) break;
+
+    Clock::time_point t0 = Clock::now();
+    if (fd < 0) {
+      fd = openConn(cfg);
+      if (fd < 0) { r.errors++; usleep(100000); continue; }
+      r.connects++;
+      buf.clear();
+    }
+    bool keep = false;
+    int code = writeAll(fd, req.data(), req.size()) ? readResponse(fd, buf, keep, r.bytes) : -1;
+    if (code < 0 && reused && buf.empty()) {
+      // Sunucu boştaki keep-alive bağlantıyı kapatmış (zaman aşımı / havuz dolu):
+      // tarayıcılar gibi yeni bağlantıda bir kez tekrarla
+      close(fd);
+      r.retries++;
+      fd = openConn(cfg);
+      if (fd >= 0) {
+        r.connects++;
+        code = writeAll(fd, req.data(), req.size()) ? readResponse(fd, buf, keep, r.bytes) : -1;
+      }
+    }
+    double ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    done++;
+
+    if (code < 0) {
+      r.errors++;
+      if (fd >= 0) close(fd);
+      fd = -1;
+      reused = false;
+      continue;
+    }
+    reused = true;
+    r.latMs.push_back(ms);
+    if (code >= 100 && code < 600) r.status[code / 100]++;
+    if (code >= 400) r.errors++;
+    if (!keep || cfg.close) { close(fd); fd = -1; reused = false; }
+  }
+  if (fd >= 0) close(fd);
+}
+
+static double pct(const std::vector<double>& v, double p) {
+  if (v.empty()) return 0;
+  size_t i = (size_t)(p / 100.0 * (double)(v.size() - 1) + 0.5);
+  return v[std::min(i, v.size() - 1)];
+}
+
+int main(int argc, char** argv) {
+  LoadCfg cfg;
+  for (int i = 1; i < argc; i++) {
+    const char* a = argv[i];
+    bool hasVal = (i + 1 < argc);
+    if (!strcmp(a, "--port") && hasVal)      cfg.port = atoi(argv[++i]);
+    else if (!strcmp(a, "--path") && hasVal) cfg.path = argv[++i];
+    else if (!strcmp(a, "-c") && hasVal)     cfg.conns = atoi(argv[++i]);
+    else if (!strcmp(a, "-d") && hasVal)     cfg.seconds = atof(argv[++i]);
+    else if (!strcmp(a, "-n") && hasVal)     cfg.perConn = atol(argv[++i]);
+    else if (!strcmp(a, "--close"))          cfg.close = true;
+    else if (!strcmp(a, "-H") && hasVal)     { cfg.extra += argv[++i]; cfg.extra += "\r\n"; }
+    else if (a[0] != '-' && !cfg.host)       cfg.host = a;
+    else { usage(); return 2; }
+  }
+  if (!cfg.host || cfg.conns < 1 || cfg.conns > 256) { usage(); return 2; }
+
+  std::vector<LoadResult> res((size_t)cfg.conns);
+  std::vector<std::thread> th;
+  Clock::time_point t0 = Clock::now();
+  Clock::time_point until = t0 + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(cfg.seconds));
+  for (int i = 0; i < cfg.conns; i++) th.emplace_back(worker, std::cref(cfg), until, std::ref(res[(size_t)i]));
+  for (std::thread& t : th) t.join();
+  double secs = std::chrono::duration<double>(Clock::now() - t0).count();
+
+  LoadResult all;
+  for (const LoadResult& r : res) {
+    all.latMs.insert(all.latMs.end(), r.latMs.begin(), r.latMs.end());
+    all.errors += r.errors;
+    all.retries += r.retries;
+    all.connects += r.connects;
+    all.bytes += r.bytes;
+    for (int k = 0; k < 6; k++) all.status[k] += r.status[k];
+  }
+  std::sort(all.latMs.begin(), all.latMs.end());
+  size_t ok = all.latMs.size();
+
+  printf("# hedef %s:%d%s  %s  bağlantı=%d  süre=%.1f s\n", cfg.host, cfg.port, cfg.path,
+         cfg.close ? "close" : "keep-alive", cfg.conns, secs);
+  printf("istek     : %zu (hata %ld, yeni bağlantı %ld, tekrar %ld, 2xx %ld, 3xx %ld, 4xx %ld, 5xx %ld)\n",
+         ok, all.errors, all.connects, all.retries, all.status[2], all.status[3], all.status[4], all.status[5]);
+  printf("istek/sn  : %.1f\n", secs > 0 ? (double)ok / secs : 0.0);
+  printf("gecikme ms: p50 %.2f  p90 %.2f  p99 %.2f  max %.2f\n",
+         pct(all.latMs, 50), pct(all.latMs, 90), pct(all.latMs, 99), ok ? all.latMs.back() : 0.0);
+  printf("bayt/istek: %.0f\n", ok ? (double)all.bytes / (double)ok : 0.0);
+  return (ok == 0) ? 1 : 0;
+}
@@ -0,0 +1,209 @@
+#pragma once
+// src/host/sched_fixtures.h - env:native benchmark fixture'ları
+// tools/gen_sched_fixtures.py ile üretildi (sentetik, API şeklinde 45 gün). Elle düzenlemeyin.
+
+#include "schedule_engine.h"
+
+static const DayTimes fx_receb_1447[] = {
+  { 20251212,  384, 1023, 20,  5, 1447, "20 Cemaziyelahir 1447" },
+  { 20251213,  384, 1023, 21,  5, 1447, "21 Cemaziyelahir 1447" },
+  { 20251214,  385, 1023, 22,  5, 1447, "22 Cemaziyelahir 1447" },
+  { 20251215,  385, 1022, 23,  5, 1447, "23 Cemaziyelahir 1447" },
+  { 20251216,  385, 1022, 24,  5, 1447, "24 Cemaziyelahir 1447" },
+  { 20251217,  385, 1022, 25,  5, 1447, "25 Cemaziyelahir 1447" },
+  { 20251218,  385, 1022, 26,  5, 1447, "26 Cemaziyelahir 1447" },
+  { 20251219,  385, 1022, 27,  5, 1447, "27 Cemaziyelahir 1447" },
+  { 20251220,  385, 1022, 28,  5, 1447, "28 Cemaziyelahir 1447" },
+  { 20251221,  385, 1022, 29,  5, 1447, "29 Cemaziyelahir 1447" },
+  { 20251222,  385, 1022,  1,  6, 1447, "1 Recep 1447" },
+  { 20251223,  385, 1022,  2,  6, 1447, "2 Recep 1447" },
+  { 20251224,  385, 1022,  3,  6, 1447, "3 Recep 1447" },
+  { 20251225,  385, 1022,  4,  6, 1447, "4 Recep 1447" },
+  { 20251226,  385, 1022,  5,  6, 1447, "5 Recep 1447" },
+  { 20251227,  385, 1023,  6,  6, 1447, "6 Recep 1447" },
+  { 20251228,  384, 1023,  7,  6, 1447, "7 Recep 1447" },
+  { 20251229,  384, 1023,  8,  6, 1447, "8 Recep 1447" },
+  { 20251230,  384, 1023,  9,  6, 1447, "9 Recep 1447" },
+  { 20251231,  384, 1024, 10,  6, 1447, "10 Recep 1447" },
+  { 20260101,  384, 1024, 11,  6, 1447, "11 Recep 1447" },
+  { 20260102,  383, 1024, 12,  6, 1447, "12 Recep 1447" },
+  { 20260103,  383, 1025, 13,  6, 1447, "13 Recep 1447" },
+  { 20260104,  383, 1025, 14,  6, 1447, "14 Recep 1447" },
+  { 20260105,  382, 1026, 15,  6, 1447, "15 Recep 1447" },
+  { 20260106,  382, 1026, 16,  6, 1447, "16 Recep 1447" },
+  { 20260107,  382, 1027, 17,  6, 1447, "17 Recep 1447" },
+  { 20260108,  381, 1027, 18,  6, 1447, "18 Recep 1447" },
+  { 20260109,  381, 1028, 19,  6, 1447, "19 Recep 1447" },
+  { 20260110,  381, 1028, 20,  6, 1447, "20 Recep 1447" },
+  { 20260111,  380, 1029, 21,  6, 1447, "21 Recep 1447" },
+  { 20260112,  380, 1029, 22,  6, 1447, "22 Recep 1447" },
+  { 20260113,  379, 1030, 23,  6, 1447, "23 Recep 1447" },
+  { 20260114,  379, 1031, 24,  6, 1447, "24 Recep 1447" },
+  { 20260115,  378, 1031, 25,  6, 1447, "25 Recep 1447" },
+  { 20260116,  378, 1032, 26,  6, 1447, "26 Recep 1447" },
+  { 20260117,  377, 1033, 27,  6, 1447, "27 Recep 1447" },
+  { 20260118,  376, 1034, 28,  6, 1447, "28 Recep 1447" },
+  { 20260119,  376, 1035, 29,  6, 1447, "29 Recep 1447" },
+  { 20260120,  375, 1035, 30,  6, 1447, "30 Recep 1447" },
+  { 20260121,  375, 1036,  1,  7, 1447, "1 \305\236aban 1447" },
+  { 20260122,  374, 1037,  2,  7, 1447, "2 \305\236aban 1447" },
+  { 20260123,  373, 1038,  3,  7, 1447, "3 \305\236aban 1447" },
+  { 20260124,  373, 1039,  4,  7, 1447, "4 \305\236aban 1447" },
+  { 20260125,  372, 1040,  5,  7, 1447, "5 \305\236aban 1447" },
+};
+
+static const DayTimes fx_ramazan_1447[] = {
+  { 20260210,  358, 1059, 21,  7, 1447, "21 \305\236aban 1447" },
+  { 20260211,  357, 1060, 22,  7, 1447, "22 \305\236aban 1447" },
+  { 20260212,  356, 1061, 23,  7, 1447, "23 \305\236aban 1447" },
+  { 20260213,  355, 1063, 24,  7, 1447, "24 \305\236aban 1447" },
+  { 20260214,  354, 1064, 25,  7, 1447, "25 \305\236aban 1447" },
+  { 20260215,  353, 1066, 26,  7, 1447, "26 \305\236aban 1447" },
+  { 20260216,  352, 1067, 27,  7, 1447, "27 \305\236aban 1447" },
+  { 20260217,  351, 1069, 28,  7, 1447, "28 \305\236aban 1447" },
+  { 20260218,  350, 1070, 29,  7, 1447, "29 \305\236aban 1447" },
+  { 20260219,  349, 1072,  1,  8, 1447, "1 Ramazan 1447" },
+  { 20260220,  348, 1073,  2,  8, 1447, "2 Ramazan 1447" },
+  { 20260221,  347, 1075,  3,  8, 1447, "3 Ramazan 1447" },
+  { 20260222,  346, 1076,  4,  8, 1447, "4 Ramazan 1447" },
+  { 20260223,  344, 1078,  5,  8, 1447, "5 Ramazan 1447" },
+  { 20260224,  343, 1079,  6,  8, 1447, "6 Ramazan 1447" },
+  { 20260225,  342, 1081,  7,  8, 1447, "7 Ramazan 1447" },
+  { 20260226,  341, 1082,  8,  8, 1447, "8 Ramazan 1447" },
+  { 20260227,  340, 1084,  9,  8, 1447, "9 Ramazan 1447" },
+  { 20260228,  339, 1085, 10,  8, 1447, "10 Ramazan 1447" },
+  { 20260301,  338, 1087, 11,  8, 1447, "11 Ramazan 1447" },
+  { 20260302,  336, 1089, 12,  8, 1447, "12 Ramazan 1447" },
+  { 20260303,  335, 1090, 13,  8, 1447, "13 Ramazan 1447" },
+  { 20260304,  334, 1092, 14,  8, 1447, "14 Ramazan 1447" },
+  { 20260305,  333, 1094, 15,  8, 1447, "15 Ramazan 1447" },
+  { 20260306,  332, 1095, 16,  8, 1447, "16 Ramazan 1447" },
+  { 20260307,  330, 1097, 17,  8, 1447, "17 Ramazan 1447" },
+  { 20260308,  329, 1099, 18,  8, 1447, "18 Ramazan 1447" },
+  { 20260309,  328, 1100, 19,  8, 1447, "19 Ramazan 1447" },
+  { 20260310,  327, 1102, 20,  8, 1447, "20 Ramazan 1447" },
+  { 20260311,  325, 1104, 21,  8, 1447, "21 Ramazan 1447" },
+  { 20260312,  324, 1105, 22,  8, 1447, "22 Ramazan 1447" },
+  { 20260313,  323, 1107, 23,  8, 1447, "23 Ramazan 1447" },
+  { 20260314,  322, 1109, 24,  8, 1447, "24 Ramazan 1447" },
+  { 20260315,  320, 1110, 25,  8, 1447, "25 Ramazan 1447" },
+  { 20260316,  319, 1112, 26,  8, 1447, "26 Ramazan 1447" },
+  { 20260317,  318, 1114, 27,  8, 1447, "27 Ramazan 1447" },
+  { 20260318,  317, 1116, 28,  8, 1447, "28 Ramazan 1447" },
+  { 20260319,  315, 1117, 29,  8, 1447, "29 Ramazan 1447" },
+  { 20260320,  314, 1119, 30,  8, 1447, "30 Ramazan 1447" },
+  { 20260321,  313, 1121,  1,  9, 1447, "1 \305\236evval 1447" },
+  { 20260322,  312, 1122,  2,  9, 1447, "2 \305\236evval 1447" },
+  { 20260323,  310, 1124,  3,  9, 1447, "3 \305\236evval 1447" },
+  { 20260324,  309, 1126,  4,  9, 1447, "4 \305\236evval 1447" },
+  { 20260325,  308, 1128,  5,  9, 1447, "5 \305\236evval 1447" },
+  { 20260326,  307, 1129,  6,  9, 1447, "6 \305\236evval 1447" },
+};
+
+static const DayTimes fx_kurban_1447[] = {
+  { 20260510,  257, 1197, 22, 10, 1447, "22 Zilkade 1447" },
+  { 20260511,  256, 1198, 23, 10, 1447, "23 Zilkade 1447" },
+  { 20260512,  256, 1199, 24, 10, 1447, "24 Zilkade 1447" },
+  { 20260513,  255, 1200, 25, 10, 1447, "25 Zilkade 1447" },
+  { 20260514,  254, 1201, 26, 10, 1447, "26 Zilkade 1447" },
+  { 20260515,  253, 1202, 27, 10, 1447, "27 Zilkade 1447" },
+  { 20260516,  253, 1203, 28, 10, 1447, "28 Zilkade 1447" },
+  { 20260517,  252, 1204, 29, 10, 1447, "29 Zilkade 1447" },
+  { 20260518,  251, 1205, 30, 10, 1447, "30 Zilkade 1447" },
+  { 20260519,  250, 1206,  1, 11, 1447, "1 Zilhicce 1447" },
+  { 20260520,  250, 1207,  2, 11, 1447, "2 Zilhicce 1447" },
+  { 20260521,  249, 1208,  3, 11, 1447, "3 Zilhicce 1447" },
+  { 20260522,  249, 1209,  4, 11, 1447, "4 Zilhicce 1447" },
+  { 20260523,  248, 1210,  5, 11, 1447, "5 Zilhicce 1447" },
+  { 20260524,  247, 1211,  6, 11, 1447, "6 Zilhicce 1447" },
+  { 20260525,  247, 1211,  7, 11, 1447, "7 Zilhicce 1447" },
+  { 20260526,  246, 1212,  8, 11, 1447, "8 Zilhicce 1447" },
+  { 20260527,  246, 1213,  9, 11, 1447, "9 Zilhicce 1447" },
+  { 20260528,  245, 1214, 10, 11, 1447, "10 Zilhicce 1447" },
+  { 20260529,  245, 1214, 11, 11, 1447, "11 Zilhicce 1447" },
+  { 20260530,  244, 1215, 12, 11, 1447, "12 Zilhicce 1447" },
+  { 20260531,  244, 1216, 13, 11, 1447, "13 Zilhicce 1447" },
+  { 20260601,  243, 1216, 14, 11, 1447, "14 Zilhicce 1447" },
+  { 20260602,  243, 1217, 15, 11, 1447, "15 Zilhicce 1447" },
+  { 20260603,  242, 1217, 16, 11, 1447, "16 Zilhicce 1447" },
+  { 20260604,  242, 1218, 17, 11, 1447, "17 Zilhicce 1447" },
+  { 20260605,  242, 1218, 18, 11, 1447, "18 Zilhicce 1447" },
+  { 20260606,  241, 1219, 19, 11, 1447, "19 Zilhicce 1447" },
+  { 20260607,  241, 1219, 20, 11, 1447, "20 Zilhicce 1447" },
+  { 20260608,  241, 1220, 21, 11, 1447, "21 Zilhicce 1447" },
+  { 20260609,  241, 1220, 22, 11, 1447, "22 Zilhicce 1447" },
+  { 20260610,  240, 1220, 23, 11, 1447, "23 Zilhicce 1447" },
+  { 20260611,  240, 1221, 24, 11, 1447, "24 Zilhicce 1447" },
+  { 20260612,  240, 1221, 25, 11, 1447, "25 Zilhicce 1447" },
+  { 20260613,  240, 1221, 26, 11, 1447, "26 Zilhicce 1447" },
+  { 20260614,  240, 1221, 27, 11, 1447, "27 Zilhicce 1447" },
+  { 20260615,  239, 1221, 28, 11, 1447, "28 Zilhicce 1447" },
+  { 20260616,  239, 1222, 29, 11, 1447, "29 Zilhicce 1447" },
+  { 20260617,  239, 1222, 30, 11, 1447, "30 Zilhicce 1447" },
+  { 20260618,  239, 1222,  1,  0, 1448, "1 Muharrem 1448" },
+  { 20260619,  239, 1222,  2,  0, 1448, "2 Muharrem 1448" },
+  { 20260620,  239, 1222,  3,  0, 1448, "3 Muharrem 1448" },
+  { 20260621,  239, 1222,  4,  0, 1448, "4 Muharrem 1448" },
+  { 20260622,  239, 1222,  5,  0, 1448, "5 Muharrem 1448" },
+  { 20260623,  239, 1222,  6,  0, 1448, "6 Muharrem 1448" },
+};
+
+static const DayTimes fx_mevlid_1448[] = {
+  { 20260810,  264, 1187, 24,  1, 1448, "24 Safer 1448" },
+  { 20260811,  265, 1186, 25,  1, 1448, "25 Safer 1448" },
+  { 20260812,  266, 1185, 26,  1, 1448, "26 Safer 1448" },
+  { 20260813,  267, 1183, 27,  1, 1448, "27 Safer 1448" },
+  { 20260814,  268, 1182, 28,  1, 1448, "28 Safer 1448" },
+  { 20260815,  269, 1180, 29,  1, 1448, "29 Safer 1448" },
+  { 20260816,  270, 1179,  1,  2, 1448, "1 Rebi\303\274levvel 1448" },
+  { 20260817,  271, 1178,  2,  2, 1448, "2 Rebi\303\274levvel 1448" },
+  { 20260818,  272, 1176,  3,  2, 1448, "3 Rebi\303\274levvel 1448" },
+  { 20260819,  274, 1175,  4,  2, 1448, "4 Rebi\303\274levvel 1448" },
+  { 20260820,  275, 1173,  5,  2, 1448, "5 Rebi\303\274levvel 1448" },
+  { 20260821,  276, 1172,  6,  2, 1448, "6 Rebi\303\274levvel 1448" },
+  { 20260822,  277, 1170,  7,  2, 1448, "7 Rebi\303\274levvel 1448" },
+  { 20260823,  278, 1169,  8,  2, 1448, "8 Rebi\303\274levvel 1448" },
+  { 20260824,  279, 1167,  9,  2, 1448, "9 Rebi\303\274levvel 1448" },
+  { 20260825,  280, 1166, 10,  2, 1448, "10 Rebi\303\274levvel 1448" },
+  { 20260826,  281, 1164, 11,  2, 1448, "11 Rebi\303\274levvel 1448" },
+  { 20260827,  282, 1163, 12,  2, 1448, "12 Rebi\303\274levvel 1448" },
+  { 20260828,  284, 1161, 13,  2, 1448, "13 Rebi\303\274levvel 1448" },
+  { 20260829,  285, 1159, 14,  2, 1448, "14 Rebi\303\274levvel 1448" },
+  { 20260830,  286, 1158, 15,  2, 1448, "15 Rebi\303\274levvel 1448" },
+  { 20260831,  287, 1156, 16,  2, 1448, "16 Rebi\303\274levvel 1448" },
+  { 20260901,  288, 1155, 17,  2, 1448, "17 Rebi\303\274levvel 1448" },
+  { 20260902,  289, 1153, 18,  2, 1448, "18 Rebi\303\274levvel 1448" },
+  { 20260903,  291, 1151, 19,  2, 1448, "19 Rebi\303\274levvel 1448" },
+  { 20260904,  292, 1150, 20,  2, 1448, "20 Rebi\303\274levvel 1448" },
+  { 20260905,  293, 1148, 21,  2, 1448, "21 Rebi\303\274levvel 1448" },
+  { 20260906,  294, 1146, 22,  2, 1448, "22 Rebi\303\274levvel 1448" },
+  { 20260907,  295, 1145, 23,  2, 1448, "23 Rebi\303\274levvel 1448" },
+  { 20260908,  297, 1143, 24,  2, 1448, "24 Rebi\303\274levvel 1448" },
+  { 20260909,  298, 1141, 25,  2, 1448, "25 Rebi\303\274levvel 1448" },
+  { 20260910,  299, 1140, 26,  2, 1448, "26 Rebi\303\274levvel 1448" },
+  { 20260911,  300, 1138, 27,  2, 1448, "27 Rebi\303\274levvel 1448" },
+  { 20260912,  302, 1136, 28,  2, 1448, "28 Rebi\303\274levvel 1448" },
+  { 20260913,  303, 1134, 29,  2, 1448, "29 Rebi\303\274levvel 1448" },
+  { 20260914,  304, 1133, 30,  2, 1448, "30 Rebi\303\274levvel 1448" },
+  { 20260915,  305, 1131,  1,  3, 1448, "1 Rebi\303\274lahir 1448" },
+  { 20260916,  307, 1129,  2,  3, 1448, "2 Rebi\303\274lahir 1448" },
+  { 20260917,  308, 1128,  3,  3, 1448, "3 Rebi\303\274lahir 1448" },
+  { 20260918,  309, 1126,  4,  3, 1448, "4 Rebi\303\274lahir 1448" },
+  { 20260919,  310, 1124,  5,  3, 1448, "5 Rebi\303\274lahir 1448" },
+  { 20260920,  312, 1122,  6,  3, 1448, "6 Rebi\303\274lahir 1448" },
+  { 20260921,  313, 1121,  7,  3, 1448, "7 Rebi\303\274lahir 1448" },
+  { 20260922,  314, 1119,  8,  3, 1448, "8 Rebi\303\274lahir 1448" },
+  { 20260923,  315, 1117,  9,  3, 1448, "9 Rebi\303\274lahir 1448" },
+};
+
+// latE6/lonE6: ilçe koordinatı (prayer_times.h karşılaştırması), recorded: gerçek API cevabı
+struct SchedFixture { const char* name; const DayTimes* days; uint16_t count;
+                      int32_t latE6; int32_t lonE6; uint8_t recorded; };
+
+static const SchedFixture g_fixtures[] = {
+  { "receb_1447", fx_receb_1447, (uint16_t)(sizeof(fx_receb_1447) / sizeof(fx_receb_1447[0])), 39917900, 32862700, 0 },
+  { "ramazan_1447", fx_ramazan_1447, (uint16_t)(sizeof(fx_ramazan_1447) / sizeof(fx_ramazan_1447[0])), 39917900, 32862700, 0 },
+  { "kurban_1447", fx_kurban_1447, (uint16_t)(sizeof(fx_kurban_1447) / sizeof(fx_kurban_1447[0])), 39917900, 32862700, 0 },
+  { "mevlid_1448", fx_mevlid_1448, (uint16_t)(sizeof(fx_mevlid_1448) / sizeof(fx_mevlid_1448[0])), 39917900, 32862700, 0 },
+};
+static const int FIXTURE_COUNT = sizeof(g_fixtures) / sizeof(g_fixtures[0]);
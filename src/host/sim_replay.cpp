@@ -0,0 +1,448 @@
+/*
+  src/host/sim_replay.cpp - env:sim yıllık çizelge replay simülatörü
+
+  Çalıştırma:
+    pio run -e sim && .pio/build/sim/program [seçenekler]
+
+  Gün verisi (biri zorunlu):
+    --json <dosya>...   Cihazın çektiği /vakitler cevabı (ezanvakti API JSON); birden fazla
+                        dosya birleştirilir (örn. 12 aylık kayıt), tekrar eden günler atılır
+    --gen <yıl>         Yılı prayer_times.h + hijri_calendar.h ile üret
+      --lat/--lon <derece>  (varsayılan Çankaya)   --caloff <gün> Hicri ofset (varsayılan 0)
+
+  Ayarlar:
+    --settings <dosya>  key=value satırları (# yorum):
+                          onTolMin=1  offTolMin=1  ramazanAll=1  spMask=0x3fff
+                          ov.<k>=<gün>/<ay index>/<yıl>   (k: g_specials index, ay 0=muharrem)
+  Diğer:
+    --tick <sn>         En uzun adım (varsayılan 60); geçiş anlarına her zaman tam basılır
+    --reps <n>          Zamanlama için replay'i n kez koş (çıktı ilk turdan)
+    --quiet             Geçiş listesini basma (sadece özet)
+
+  Cihaz modeli: sağlıklı cache (dünden itibaren SCHED_MAX_DAYS gün, her gece kayar).
+  Her yeni günde kurallar firmware'deki gibi derlenir (schedDefaultRules -> gün maskesi ->
+  timeline -> aralık tablosu). Her adımda firmware röle görevinin sırası izlenir: imsak OFF
+  yenileme, zorunlu OFF (schedImsakOffStep) ve çizelge kararı (schedRelayShouldOn).
+
+  Çıktı: her röle geçişi (zaman, ON/OFF, neden), özet ve geçiş listesinin FNV-1a özeti.
+  Özet, çizelge kodu optimize edilirken regresyon karşılaştırması (oracle) içindir.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <chrono>
+
+#include "schedule_engine.h"
+#include "hijri_calendar.h"
+#include "prayer_times.h"
+
+static const int SIM_MAX_DAYS = 800;  // ~2 yıl
+
+static DayTimes g_year[SIM_MAX_DAYS];
+static uint16_t g_yearCount = 0;
+
+typedef std::chrono::steady_clock Clock;
+
+// =====================
+// Ayarlar
+// =====================
+struct SimSettings {
+  int        onTolMin;
+  int        offTolMin;
+  bool       ramazanAll;
+  uint32_t   spMask;
+  SpOverride ov[SPECIAL_COUNT];
+};
+
+static void settingsDefaults(SimSettings& s) {
+  s.onTolMin = 0; s.offTolMin = 0; s.ramazanAll = (EN_RAMAZAN_TUM_GUNLER != 0);
+  s.spMask = 0;
+  for (uint8_t k = 0; k < SPECIAL_COUNT; k++) {
+    if (g_specials[k].defaultEnabled) s.spMask |= (1u << k);
+    s.ov[k].useDefault = 1;
+    s.ov[k].day   = g_specials[k].day;
+    s.ov[k].month = (uint8_t)hicriMonthIndex(g_specials[k].monthKey, strlen(g_specials[k].monthKey));
+    s.ov[k].year  = 0;
+  }
+}
+
+static char* trimInPlace(char* s) {
+  while (*s == ' ' || *s == '\t') s++;
+  char* e = s + strlen(s);
+  while (e > s && (e[-1] == ' ' || e[-1] == '\t' || e[-1] == '\r' || e[-1] == '\n')) *--e = '\0';
+  return s;
+}
+
+static bool loadSettings(const char* path, SimSettings& s) {
+  FILE* f = fopen(path, "r");
+  if (!f) { fprintf(stderr, "ayar dosyası açılamadı: %s\n", path); return false; }
+  char line[256];
+  int lineNo = 0;
+  while (fgets(line, sizeof(line), f)) {
+    lineNo++;
+    char* p = trimInPlace(line);
+    if (*p == '\0' || *p == '#') continue;
+    char* eq = strchr(p, '=');
+    if (!eq) { fprintf(stderr, "%s:%d: '=' yok\n", path, lineNo); fclose(f); return false; }
+    *eq = '\0';
+    char* key = trimInPlace(p);
+    char* val = trimInPlace(eq + 1);
+
+    if      (!strcmp(key, "onTolMin"))   s.onTolMin   = atoi(val);
+    else if (!strcmp(key, "offTolMin"))  s.offTolMin  = atoi(val);
+    else if (!strcmp(key, "ramazanAll")) s.ramazanAll = atoi(val) != 0;
+    else if (!strcmp(key, "spMask"))     s.spMask     = (uint32_t)strtoul(val, nullptr, 0);
+    else if (!strncmp(key, "ov.", 3)) {
+      int k = atoi(key + 3), d = 0, m = 0, y = 0;
+      if (k < 0 || k >= (int)SPECIAL_COUNT || sscanf(val, "%d/%d/%d", &d, &m, &y) != 3 ||
+          d < 1 || d > 30 || m < 0 || m > 11) {
+        fprintf(stderr, "%s:%d: geçersiz override\n", path, lineNo); fclose(f); return false;
+      }
+      s.ov[k].useDefault = 0; s.ov[k].day = (uint8_t)d; s.ov[k].month = (uint8_t)m; s.ov[k].year = (uint16_t)y;
+    } else {
+      fprintf(stderr, "%s:%d: bilinmeyen anahtar '%s'\n", path, lineNo, key); fclose(f); return false;
+    }
+  }
+  fclose(f);
+  return true;
+}
+
+// =====================
+// Gün verisi: API JSON (düz nesne dizisi; ArduinoJson yok, sadece gereken string alanlar)
+// =====================
+static bool jsonFindString(const char* obj, const char* objEnd, const char* key, char* out, size_t cap) {
+  size_t klen = strlen(key);
+  for (const char* p = obj; p + klen + 2 < objEnd; p++) {
+    if (*p != '"' || strncmp(p + 1, key, klen) != 0 || p[klen + 1] != '"') continue;
+    const char* q = p + klen + 2;
+    while (q < objEnd && (*q == ' ' || *q == ':' || *q == '\t' || *q == '\n' || *q == '\r')) q++;
+    if (q >= objEnd || *q != '"') return false;
+    q++;
+    size_t n = 0;
+    while (q < objEnd && *q != '"' && n + 4 < cap) {
+      if (*q == '\\' && q + 1 < objEnd) {
+        q++;
+        if (*q == 'u' && q + 4 < objEnd) {
+          char hex[5] = { q[1], q[2], q[3], q[4], '\0' };
+          unsigned cp = (unsigned)strtoul(hex, nullptr, 16);
+          if (cp < 0x80) out[n++] = (char)cp;
+          else if (cp < 0x800) { out[n++] = (char)(0xC0 | (cp >> 6)); out[n++] = (char)(0x80 | (cp & 0x3F)); }
+          else { out[n++] = (char)(0xE0 | (cp >> 12)); out[n++] = (char)(0x80 | ((cp >> 6) & 0x3F)); out[n++] = (char)(0x80 | (cp & 0x3F)); }
+          q += 5;
+          continue;
+        }
+        out[n++] = *q++;
+        continue;
+      }
+      out[n++] = *q++;
+    }
+    out[n] = '\0';
+    return true;
+  }
+  return false;
+}
+
+static uint32_t parseYmdAny(const char* s) {
+  int y = 0, m = 0, d = 0;
+  if (sscanf(s, "%4d-%2d-%2d", &y, &m, &d) == 3) return (uint32_t)(y * 10000 + m * 100 + d);
+  if (sscanf(s, "%2d.%2d.%4d", &d, &m, &y) == 3) return (uint32_t)(y * 10000 + m * 100 + d);
+  return 0;
+}
+
+static int parseHhmm(const char* s) {
+  int h = 0, m = 0;
+  if (sscanf(s, "%d:%d", &h, &m) != 2 || h < 0 || h > 23 || m < 0 || m > 59) return -1;
+  return h * 60 + m;
+}
+
+static bool loadJson(const char* path) {
+  FILE* f = fopen(path, "rb");
+  if (!f) { fprintf(stderr, "JSON açılamadı: %s\n", path); return false; }
+  fseek(f, 0, SEEK_END);
+  long sz = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  char* buf = (char*)malloc((size_t)sz + 1);
+  if (!buf || fread(buf, 1, (size_t)sz, f) != (size_t)sz) { fclose(f); free(buf); return false; }
+  buf[sz] = '\0';
+  fclose(f);
+
+  int added = 0;
+  const char* end = buf + sz;
+  for (const char* p = buf; p < end; p++) {
+    if (*p != '{') continue;
+    const char* q = strchr(p, '}');
+    if (!q) break;
+
+    char date[64] = "", im[16] = "", ak[16] = "", hicri[64] = "";
+    if (!jsonFindString(p, q, "MiladiTarihUzunIso8601", date, sizeof(date)) &&
+        !jsonFindString(p, q, "MiladiTarihKisaIso8601", date, sizeof(date)))
+      jsonFindString(p, q, "MiladiTarihKisa", date, sizeof(date));
+    jsonFindString(p, q, "Imsak", im, sizeof(im));
+    jsonFindString(p, q, "Aksam", ak, sizeof(ak));
+    jsonFindString(p, q, "HicriTarihUzun", hicri, sizeof(hicri));
+    p = q;
+
+    uint32_t ymd = parseYmdAny(date);
+    int imMin = parseHhmm(im), akMin = parseHhmm(ak);
+    if (ymd == 0 || imMin < 0 || akMin < 0 || g_yearCount >= SIM_MAX_DAYS) continue;
+
+    DayTimes& d = g_year[g_yearCount++];
+    memset(&d, 0, sizeof(d));
+    d.ymd = ymd; d.imsakMin = (uint16_t)imMin; d.aksamMin = (uint16_t)akMin;
+    dayTimesSetHicri(d, trimInPlace(hicri));
+    added++;
+  }
+  free(buf);
+  fprintf(stderr, "%s: %d gün\n", path, added);
+  return added > 0;
+}
+
+// Sırala + aynı günü tekle (dosyalar çakışırsa o günün kayıtlarından biri kalır)
+static void normalizeYear() {
+  schedSortDays(g_year, g_yearCount);
+  uint16_t w = 0;
+  for (uint16_t i = 0; i < g_yearCount; i++) {
+    if (w > 0 && g_year[w - 1].ymd == g_year[i].ymd) continue;
+    g_year[w++] = g_year[i];
+  }
+  g_yearCount = w;
+}
+
+static bool genYear(int year, int32_t latE6, int32_t lonE6, int8_t calOff) {
+  int32_t from = daysFromCivil(year, 1, 1) - 1;      // 1 Ocak penceresi için 31 Aralık akşamı
+  int32_t to   = daysFromCivil(year + 1, 1, 1);      // 31 Aralık penceresi 1 Ocak imsakta biter
+  for (int32_t d = from; d <= to && g_yearCount < SIM_MAX_DAYS; d++) {
+    if (!prayerFillDay(g_year[g_yearCount], d, latE6, lonE6, calOff)) {
+      fprintf(stderr, "vakit hesaplanamadı: %u\n", (unsigned)ymdFromDays(d));
+      return false;
+    }
+    g_yearCount++;
+  }
+  return true;
+}
+
+// =====================
+// Replay
+// =====================
+struct SimStats {
+  uint32_t onCount;
+  uint32_t offCount;
+  uint32_t forcedCount;
+  uint32_t steps;
+  uint32_t compiles;
+  uint32_t overflows;  // tabloya sığmayan derleme (firmware planı yayınlamaz)
+  int64_t  onSec;
+  uint64_t fnv;
+};
+
+static void fnvMix(uint64_t& h, const void* p, size_t n) {
+  const uint8_t* b = (const uint8_t*)p;
+  for (size_t i = 0; i < n; i++) { h ^= b[i]; h *= 1099511628211ull; }
+}
+
+static void ruleName(const SchedTransition& t, char* out, size_t cap) {
+  switch (t.reason) {
+    case SR_THU_FRI: snprintf(out, cap, "Perşembe->Cuma"); break;
+    case SR_SPECIAL: snprintf(out, cap, "%s", t.arg < SPECIAL_COUNT ? g_specials[t.arg].name : "?"); break;
+    case SR_RAMAZAN: snprintf(out, cap, "Ramazan %u", (unsigned)t.arg); break;
+    case SR_CUSTOM:  snprintf(out, cap, "Özel kural %u", (unsigned)t.rule); break;
+    default:         snprintf(out, cap, "?"); break;
+  }
+}
+
+static void fmtTs(time_t ts, char* out, size_t cap) {
+  int32_t days = localDaysFromEpoch(ts);
+  uint32_t ymd = ymdFromDays(days);
+  int32_t sec = localSecOfDay(ts);
+  snprintf(out, cap, "%04u-%02u-%02u %02d:%02d:%02d", (unsigned)(ymd / 10000), (unsigned)(ymd / 100 % 100),
+           (unsigned)(ymd % 100), (int)(sec / 3600), (int)(sec / 60 % 60), (int)(sec % 60));
+}
+
+static void replay(const SimSettings& st, time_t tickSec, bool print, SimStats& out) {
+  memset(&out, 0, sizeof(out));
+  out.fnv = 1469598103934665603ull;
+
+  static SchedRule       rules[SCHED_RULE_MAX];
+  static uint32_t        masks[SCHED_MAX_DAYS];
+  static SchedTransition tl[SCHED_TL_MAX];
+  static SchedInterval   iv[SCHED_IV_MAX];
+  int nRules = 0; uint16_t tlN = 0, ivN = 0;
+
+  SchedDayIndex dayIdx{};
+  SchedInput in{};
+  in.spOv = st.ov; in.spEnableMask = st.spMask; in.ramazanAll = st.ramazanAll;
+  in.onOffsetSec = st.onTolMin * 60; in.offOffsetSec = st.offTolMin * 60;
+
+  // Firmware global'lerinin karşılığı
+  bool   relay = false;
+  time_t nextImsakOffTs = 0, lastImsakOffEventTs = 0, blockOnUntilTs = 0, onSinceTs = 0;
+  const bool manualOnLatched = false;
+  const time_t manualOffUntilTs = 0;
+
+  time_t t0 = epochFromYmdAndMin(g_year[1].ymd, 0);
+  time_t t1 = epochFromYmdAndMin(g_year[g_yearCount - 1].ymd, 23 * 60 + 59);
+  uint32_t curYmd = 0;
+
+  for (time_t now = t0; now <= t1; ) {
+    out.steps++;
+
+    // ---- Gün değişimi: cache kayar, kurallar yeniden derlenir (schedTick SD_DATE) ----
+    bool dateChanged = false;
+    uint32_t today = ymdFromEpoch(now);
+    if (today != curYmd) {
+      curYmd = today;
+      dateChanged = true;
+      uint32_t yest = addDaysYmd(today, -1);
+      uint16_t s = 0;
+      while (s < g_yearCount && g_year[s].ymd < yest) s++;
+      uint16_t n = (uint16_t)((g_yearCount - s) < SCHED_MAX_DAYS ? (g_yearCount - s) : SCHED_MAX_DAYS);
+      in.days = g_year + s; in.dayCount = n;
+      schedDayIndexBuild(in.days, in.dayCount, dayIdx);
+      in.dayIdx = &dayIdx;
+
+      nRules = schedDefaultRules(in, rules, SCHED_RULE_MAX);
+      schedRuleDayMasks(in, rules, nRules, masks);
+      bool tlFull = false, ivFull = false;
+      tlN = schedBuildTimeline(in, rules, nRules, masks, tl, (uint16_t)SCHED_TL_MAX, &tlFull);
+      ivN = schedBuildIntervals(tl, tlN, iv, (uint16_t)SCHED_IV_MAX, &ivFull);
+      out.compiles++;
+      if (tlFull || ivFull) out.overflows++;
+    }
+
+    // ---- imsak OFF yenileme (yeni plan gelince; kaçırılanı schedImsakOffStep yakalar) ----
+    if (dateChanged || nextImsakOffTs == 0) {
+      int i = schedFindWindowEnd(tl, tlN, now, SRM_IMSAK_OFF);
+      if (i >= 0) nextImsakOffTs = tl[i].ts;
+    }
+
+    // ---- zorunlu OFF (röle görevi) ----
+    bool forced = false;
+    uint8_t step = schedImsakOffStep(nextImsakOffTs, lastImsakOffEventTs, now);
+    if (step == SIS_REFRESH) {
+      int i = schedFindWindowEnd(tl, tlN, now, SRM_IMSAK_OFF);
+      if (i >= 0) nextImsakOffTs = tl[i].ts;
+    } else if (step == SIS_FIRE) {
+      lastImsakOffEventTs = nextImsakOffTs;
+      blockOnUntilTs = now + SCHED_FORCE_BLOCK_SEC;
+      if (relay) forced = true;
+      relay = false;
+      int i = schedFindWindowEnd(tl, tlN, now + 2, SRM_IMSAK_OFF);
+      nextImsakOffTs = (i >= 0) ? tl[i].ts : 0;
+    }
+
+    // ---- çizelge kararı (röle görevi) ----
+    int k = schedIntervalAt(iv, ivN, now);
+    bool shouldOn = schedRelayShouldOn(k >= 0, manualOnLatched, manualOffUntilTs, blockOnUntilTs, true, now);
+
+    bool wasOn = relay || forced;
+    if (shouldOn != wasOn || forced) {
+      char ts[32], why[96] = "";
+      fmtTs(now, ts, sizeof(ts));
+      if (shouldOn) {
+        out.onCount++;
+        onSinceTs = now;
+        // Bu anda açılan pencerelerin kuralları
+        for (int j = schedUpperBound(tl, tlN, now - 1); j < (int)tlN && tl[j].ts == now; j++) {
+          if (!tl[j].on) continue;
+          char nm[48];
+          ruleName(tl[j], nm, sizeof(nm));
+          if (why[0]) strncat(why, " + ", sizeof(why) - strlen(why) - 1);
+          strncat(why, nm, sizeof(why) - strlen(why) - 1);
+        }
+        if (why[0] == '\0') snprintf(why, sizeof(why), "aralık (kural bitleri 0x%x)", (unsigned)(k >= 0 ? iv[k].rules : 0));
+      } else {
+        out.offCount++;
+        if (forced) out.forcedCount++;
+        out.onSec += (int64_t)(now - onSinceTs);
+        snprintf(why, sizeof(why), "%s", forced ? "zorunlu OFF (imsak)" : "pencere sonu");
+      }
+      if (print) printf("%s  %-3s  %s\n", ts, shouldOn ? "ON" : "OFF", why);
+
+      int64_t tsv = (int64_t)now;
+      uint8_t onv = shouldOn ? 1 : 0;
+      fnvMix(out.fnv, &tsv, sizeof(tsv));
+      fnvMix(out.fnv, &onv, 1);
+      fnvMix(out.fnv, why, strlen(why));
+    }
+    relay = shouldOn;
+
+    // ---- Sonraki adım: tick ya da en yakın geçiş / gece yarısı / engel bitişi ----
+    time_t next = now + tickSec;
+    int u = schedUpperBound(tl, tlN, now);
+    if (u < (int)tlN && tl[u].ts < next) next = tl[u].ts;
+    time_t midnight = epochFromLocalDays(localDaysFromEpoch(now) + 1, 0);
+    if (midnight < next) next = midnight;
+    if (blockOnUntilTs > now && blockOnUntilTs < next) next = blockOnUntilTs;
+    now = next;
+  }
+  if (relay) out.onSec += (int64_t)(t1 - onSinceTs);
+}
+
+static void usage() {
+  fprintf(stderr,
+          "kullanım: program (--json <dosya>... | --gen <yıl> [--lat <d>] [--lon <d>] [--caloff <g>])\n"
+          "                  [--settings <dosya>] [--tick <sn>] [--reps <n>] [--quiet]\n");
+}
+
+int main(int argc, char** argv) {
+  SimSettings st;
+  settingsDefaults(st);
+
+  int genYearArg = 0;
+  double lat = 39.9179, lon = 32.8627;
+  int calOff = 0;
+  long tick = 60;
+  int reps = 1;
+  bool quiet = false;
+
+  for (int i = 1; i < argc; i++) {
+    const char* a = argv[i];
+    bool hasVal = (i + 1 < argc);
+    if (!strcmp(a, "--json") && hasVal) {
+      while (i + 1 < argc && strncmp(argv[i + 1], "--", 2) != 0) {
+        if (!loadJson(argv[++i])) return 2;
+      }
+    }
+    else if (!strcmp(a, "--gen") && hasVal)      genYearArg = atoi(argv[++i]);
+    else if (!strcmp(a, "--lat") && hasVal)      lat = atof(argv[++i]);
+    else if (!strcmp(a, "--lon") && hasVal)      lon = atof(argv[++i]);
+    else if (!strcmp(a, "--caloff") && hasVal)   calOff = atoi(argv[++i]);
+    else if (!strcmp(a, "--settings") && hasVal) { if (!loadSettings(argv[++i], st)) return 2; }
+    else if (!strcmp(a, "--tick") && hasVal)     tick = atol(argv[++i]);
+    else if (!strcmp(a, "--reps") && hasVal)     reps = atoi(argv[++i]);
+    else if (!strcmp(a, "--quiet"))              quiet = true;
+    else { usage(); return 2; }
+  }
+
+  if (genYearArg > 0) {
+    if (calOff < -HIJRI_CAL_OFF_MAX || calOff > HIJRI_CAL_OFF_MAX) { usage(); return 2; }
+    if (!genYear(genYearArg, (int32_t)(lat * 1e6 + (lat >= 0 ? 0.5 : -0.5)),
+                 (int32_t)(lon * 1e6 + (lon >= 0 ? 0.5 : -0.5)), (int8_t)calOff)) return 2;
+  }
+  normalizeYear();
+  if (g_yearCount < 3) { usage(); return 2; }
+  if (tick < 1) tick = 1;
+  if (reps < 1) reps = 1;
+
+  printf("# replay %u..%u (%u gün)  tol=+%d/-%d dk  spMask=0x%x  ramazanAll=%d  tick=%lds\n",
+         (unsigned)g_year[0].ymd, (unsigned)g_year[g_yearCount - 1].ymd, (unsigned)g_yearCount,
+         st.onTolMin, st.offTolMin, (unsigned)st.spMask, (int)st.ramazanAll, tick);
+
+  SimStats s{};
+  Clock::time_point t0 = Clock::now();
+  for (int r = 0; r < reps; r++) replay(st, (time_t)tick, !quiet && r == 0, s);
+  double ms = (double)std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - t0).count() / 1000.0 / reps;
+
+  double years = (double)(g_yearCount - 1) / 365.0;
+  printf("# geçiş ON=%u OFF=%u (zorunlu %u)  toplam ON=%.1f saat  adım=%u derleme=%u\n",
+         s.onCount, s.offCount, s.forcedCount, (double)s.onSec / 3600.0, s.steps, s.compiles);
+  printf("# süre %.2f ms/replay  %.2f ms/simüle yıl  (tekrar=%d)\n", ms, years > 0 ? ms / years : ms, reps);
+  printf("# fnv=%016llx\n", (unsigned long long)s.fnv);
+  if (s.overflows) {
+    printf("# HATA: %u derleme tabloya sığmadı (SCHED_TL_MAX/SCHED_IV_MAX)\n", s.overflows);
+    return 1;
+  }
+  return 0;
+}
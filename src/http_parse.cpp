@@ -0,0 +1,450 @@
+/*
+  src/http_parse.cpp - HTTP/1.1 istek ve multipart/form-data akış ayrıştırıcıları
+  Bkz. include/http_parse.h
+*/
+
+#include "http_parse.h"
+
+#include <string.h>
+
+enum : uint8_t {
+  RS_METHOD = 0,
+  RS_PATH,
+  RS_QUERY,
+  RS_VERSION,
+  RS_REQ_LF,
+  RS_NAME,
+  RS_VAL_LWS,
+  RS_VAL,
+  RS_VAL_LF,
+  RS_END_LF,
+};
+
+static char httpLower(char c) {
+  return (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c;
+}
+
+bool httpNameEq(const char* a, const char* b) {
+  while (*a && *b) {
+    if (httpLower(*a) != httpLower(*b)) return false;
+    a++; b++;
+  }
+  return *a == *b;
+}
+
+// a içinde (büyük/küçük harf duyarsız) token geçiyor mu
+static bool httpHasToken(const char* a, const char* tok) {
+  size_t n = strlen(tok);
+  for (; *a; a++) {
+    size_t k = 0;
+    while (k < n && a[k] && httpLower(a[k]) == tok[k]) k++;
+    if (k == n) return true;
+  }
+  return false;
+}
+
+static uint8_t httpMethodOf(const char* m) {
+  if (strcmp(m, "GET") == 0)     return HTTPM_GET;
+  if (strcmp(m, "POST") == 0)    return HTTPM_POST;
+  if (strcmp(m, "HEAD") == 0)    return HTTPM_HEAD;
+  if (strcmp(m, "PUT") == 0)     return HTTPM_PUT;
+  if (strcmp(m, "DELETE") == 0)  return HTTPM_DELETE;
+  if (strcmp(m, "OPTIONS") == 0) return HTTPM_OPTIONS;
+  return HTTPM_OTHER;
+}
+
+void httpReqInit(HttpReq& r, const char* const* keep, uint8_t keepCount) {
+  memset(&r, 0, sizeof(r));
+  r.contentLength = -1;
+  r.keep = keep;
+  r.keepCount = keepCount > HTTP_KEEP_MAX ? HTTP_KEEP_MAX : keepCount;
+}
+
+// Başlık satırı tamamlandı: çerçeveleme başlıklarını işle, keep listesindekileri sakla
+static void httpHeaderDone(HttpReq& r) {
+  r.name[r.nameLen] = '\0';
+  while (r.valLen > 0 && (r.val[r.valLen - 1] == ' ' || r.val[r.valLen - 1] == '\t')) r.valLen--;
+  r.val[r.valLen] = '\0';
+
+  if (httpNameEq(r.name, "content-length")) {
+    if (r.valLen == 0 || r.valLen > 9) { r.error = HTTPE_BAD; return; }
+    int32_t v = 0;
+    for (uint8_t i = 0; i < r.valLen; i++) {
+      if (r.val[i] < '0' || r.val[i] > '9') { r.error = HTTPE_BAD; return; }
+      v = v * 10 + (r.val[i] - '0');
+    }
+    if (r.contentLength >= 0 && r.contentLength != v) { r.error = HTTPE_BAD; return; }
+    r.contentLength = v;
+  } else if (httpNameEq(r.name, "transfer-encoding")) {
+    r.error = HTTPE_UNSUPPORTED;
+    return;
+  } else if (httpNameEq(r.name, "connection")) {
+    if (httpHasToken(r.val, "close")) r.keepAlive = 0;
+    else if (httpHasToken(r.val, "keep-alive")) r.keepAlive = 1;
+  } else if (httpNameEq(r.name, "expect")) {
+    r.expect100 = httpHasToken(r.val, "100-continue") ? 1 : 0;
+  } else if (httpNameEq(r.name, "content-type")) {
+    memcpy(r.contentType, r.val, (size_t)r.valLen + 1);
+  }
+
+  for (uint8_t i = 0; i < r.keepCount; i++) {
+    if (httpNameEq(r.name, r.keep[i])) {
+      memcpy(r.kept[i], r.val, (size_t)r.valLen + 1);
+      r.keptMask |= (uint8_t)(1u << i);
+      break;
+    }
+  }
+}
+
+size_t httpReqFeed(HttpReq& r, const char* data, size_t len) {
+  size_t i = 0;
+  for (; i < len && !r.done && !r.error; i++) {
+    char c = data[i];
+    if (++r.headBytes > HTTP_HEAD_MAX) {
+      r.error = (r.state <= RS_QUERY) ? HTTPE_URI_LONG : HTTPE_HEAD_LONG;
+      break;
+    }
+
+    switch (r.state) {
+      case RS_METHOD:
+        if (c == ' ') {
+          if (r.nameLen == 0) { r.error = HTTPE_BAD; break; }
+          r.name[r.nameLen] = '\0';
+          r.method = httpMethodOf(r.name);
+          r.nameLen = 0;
+          r.state = RS_PATH;
+        } else if (c == '\r' || c == '\n') {
+          if (r.nameLen) r.error = HTTPE_BAD;   // istek öncesi boş satırlar yok sayılır
+        } else if (r.nameLen < 15 && c >= 'A' && c <= 'Z') {
+          r.name[r.nameLen++] = c;
+        } else {
+          r.error = HTTPE_BAD;
+        }
+        break;
+
+      case RS_PATH:
+        if (c == ' ' || c == '?') {
+          if (r.pathLen == 0) { r.error = HTTPE_BAD; break; }
+          r.path[r.pathLen] = '\0';
+          r.state = (c == '?') ? RS_QUERY : RS_VERSION;
+        } else if (c == '\r' || c == '\n') {
+          r.error = HTTPE_BAD;                    // HTTP/0.9
+        } else if (r.pathLen < HTTP_PATH_MAX - 1) {
+          r.path[r.pathLen++] = c;
+        } else {
+          r.error = HTTPE_URI_LONG;
+        }
+        break;
+
+      case RS_QUERY:
+        if (c == ' ') {
+          r.query[r.queryLen] = '\0';
+          r.state = RS_VERSION;
+        } else if (c == '\r' || c == '\n') {
+          r.error = HTTPE_BAD;
+        } else if (r.queryLen < HTTP_QUERY_MAX - 1) {
+          r.query[r.queryLen++] = c;
+        } else {
+          r.error = HTTPE_URI_LONG;
+        }
+        break;
+
+      case RS_VERSION:
+        if (c == '\r' || c == '\n') {
+          r.val[r.valLen] = '\0';
+          if (r.valLen != 8 || memcmp(r.val, "HTTP/1.", 7) != 0) {
+            r.error = (r.valLen >= 5 && memcmp(r.val, "HTTP/", 5) == 0) ? HTTPE_UNSUPPORTED : HTTPE_BAD;
+            break;
+          }
+          if (r.val[7] < '0' || r.val[7] > '9') { r.error = HTTPE_BAD; break; }
+          r.minor = (uint8_t)(r.val[7] - '0');
+          r.keepAlive = (r.minor >= 1) ? 1 : 0;
+          r.valLen = 0;
+          r.state = (c == '\r') ? RS_REQ_LF : RS_NAME;
+        } else if (r.valLen < 8) {
+          r.val[r.valLen++] = c;
+        } else {
+          r.error = HTTPE_BAD;
+        }
+        break;
+
+      case RS_REQ_LF:
+      case RS_VAL_LF:
+        if (c != '\n') { r.error = HTTPE_BAD; break; }
+        r.state = RS_NAME;
+        break;
+
+      case RS_NAME:
+        if (c == '\r' || c == '\n') {
+          if (r.nameLen) { r.error = HTTPE_BAD; break; }
+          if (c == '\r') { r.state = RS_END_LF; break; }
+          r.done = 1;
+        } else if (c == ':') {
+          if (r.nameLen == 0) { r.error = HTTPE_BAD; break; }
+          r.valLen = 0;
+          r.state = RS_VAL_LWS;
+        } else if (c == ' ' || c == '\t') {
+          r.error = HTTPE_BAD;                    // obs-fold / ad içinde boşluk
+        } else if (r.nameLen < HTTP_NAME_MAX - 1) {
+          r.name[r.nameLen++] = c;
+        } else {
+          r.nameLen = HTTP_NAME_MAX - 1;          // uzun ad: hiçbir şeyle eşleşmez
+          r.name[0] = '#';
+        }
+        break;
+
+      case RS_VAL_LWS:
+        if (c == ' ' || c == '\t') break;
+        r.state = RS_VAL;
+        // fallthrough
+      case RS_VAL:
+        if (c == '\r' || c == '\n') {
+          httpHeaderDone(r);
+          r.nameLen = 0;
+          r.valLen = 0;
+          r.state = (c == '\r') ? RS_VAL_LF : RS_NAME;
+        } else if (r.valLen < HTTP_VAL_MAX - 1) {
+          r.val[r.valLen++] = c;
+        }
+        break;
+
+      case RS_END_LF:
+        if (c != '\n') { r.error = HTTPE_BAD; break; }
+        r.done = 1;
+        break;
+    }
+  }
+  return i;
+}
+
+const char* httpReqHeader(const HttpReq& r, const char* name) {
+  for (uint8_t i = 0; i < r.keepCount; i++) {
+    if (httpNameEq(name, r.keep[i])) return (r.keptMask & (1u << i)) ? r.kept[i] : nullptr;
+  }
+  if (httpNameEq(name, "content-type") && r.contentType[0]) return r.contentType;
+  return nullptr;
+}
+
+static int httpHex(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+// [s, e) aralığını çözerek out'a yazar (kesilir); yazılan uzunluk
+static size_t httpUrlDecode(const char* s, const char* e, char* out, size_t cap) {
+  size_t n = 0;
+  while (s < e) {
+    char c = *s++;
+    if (c == '+') {
+      c = ' ';
+    } else if (c == '%' && e - s >= 2 && httpHex(s[0]) >= 0 && httpHex(s[1]) >= 0) {
+      c = (char)((httpHex(s[0]) << 4) | httpHex(s[1]));
+      s += 2;
+    }
+    if (n + 1 < cap) out[n++] = c;
+  }
+  if (cap) out[n] = '\0';
+  return n;
+}
+
+bool httpQueryArg(const char* query, const char* name, char* out, size_t cap) {
+  if (cap) out[0] = '\0';
+  const char* p = query;
+  while (*p) {
+    const char* end = strchr(p, '&');
+    if (!end) end = p + strlen(p);
+    const char* eq = p;
+    while (eq < end && *eq != '=') eq++;
+
+    char key[HTTP_NAME_MAX];
+    httpUrlDecode(p, eq, key, sizeof(key));
+    if (strcmp(key, name) == 0) {
+      if (eq < end) httpUrlDecode(eq + 1, end, out, cap);
+      return true;
+    }
+    p = *end ? end + 1 : end;
+  }
+  return false;
+}
+
+const char* httpStatusText(int code) {
+  switch (code) {
+    case 200: return "OK";
+    case 204: return "No Content";
+    case 304: return "Not Modified";
+    case 400: return "Bad Request";
+    case 401: return "Unauthorized";
+    case 403: return "Forbidden";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 408: return "Request Timeout";
+    case 409: return "Conflict";
+    case 413: return "Payload Too Large";
+    case 414: return "URI Too Long";
+    case 431: return "Request Header Fields Too Large";
+    case 500: return "Internal Server Error";
+    case 501: return "Not Implemented";
+    case 503: return "Service Unavailable";
+    default:  return "";
+  }
+}
+
+// =====================
+// multipart/form-data
+// =====================
+enum : uint8_t {
+  MP_PREAMBLE = 0,
+  MP_AFTER,     // sınır sonrası: "--" (kapanış) ya da CRLF (parça başlıkları)
+  MP_HEAD,
+  MP_DATA,
+  MP_DONE,
+};
+
+// "; name=\"x\"" biçimli parametre (tırnaklı ya da tırnaksız); yoksa false
+static bool httpParam(const char* s, const char* key, char* out, size_t cap) {
+  size_t kl = strlen(key);
+  out[0] = '\0';
+  for (const char* p = strchr(s, ';'); p; p = strchr(p + 1, ';')) {
+    const char* k = p + 1;
+    while (*k == ' ' || *k == '\t') k++;
+    size_t i = 0;
+    while (i < kl && k[i] && httpLower(k[i]) == key[i]) i++;
+    if (i != kl || k[kl] != '=') continue;
+    const char* v = k + kl + 1;
+    size_t n = 0;
+    if (*v == '"') {
+      v++;
+      while (*v && *v != '"') {
+        if (*v == '\\' && v[1]) v++;
+        if (n + 1 < cap) out[n++] = *v;
+        v++;
+      }
+    } else {
+      while (*v && *v != ';' && *v != ' ' && *v != '\t') {
+        if (n + 1 < cap) out[n++] = *v;
+        v++;
+      }
+    }
+    out[n] = '\0';
+    return true;
+  }
+  return false;
+}
+
+bool httpMpInit(HttpMultipart& m, const char* contentType) {
+  memset(&m, 0, sizeof(m));
+  if (!contentType || !httpHasToken(contentType, "multipart/form-data")) return false;
+
+  char b[HTTP_BOUNDARY_MAX + 2];
+  if (!httpParam(contentType, "boundary", b, sizeof(b))) return false;
+  size_t n = strlen(b);
+  if (n == 0 || n > (size_t)HTTP_BOUNDARY_MAX) return false;
+
+  memcpy(m.delim, "\r\n--", 4);
+  memcpy(m.delim + 4, b, n);
+  m.delimLen = (uint8_t)(4 + n);
+  m.state = MP_PREAMBLE;
+  m.match = 2;   // gövde "--boundary" ile başlar: önündeki CRLF görülmüş say
+  return true;
+}
+
+static bool httpMpData(HttpMultipart& m, const uint8_t* d, size_t n, HttpMpFn fn, void* ctx) {
+  if (n == 0) return true;
+  m.dataBytes += (uint32_t)n;
+  return fn(m, HMP_DATA, d, n, ctx);
+}
+
+bool httpMpFeed(HttpMultipart& m, const uint8_t* data, size_t len, HttpMpFn fn, void* ctx) {
+  if (m.error) return false;
+  size_t i = 0;
+
+  while (i < len) {
+    switch (m.state) {
+      case MP_PREAMBLE:
+      case MP_DATA: {
+        // delim'in eşleşen öneki tutulur (veriye yazılmaz); eşleşme bozulursa delim'den
+        // geri verilir. CR sınırda yalnızca başta geçtiği için tek karakter geri dönüş yeter.
+        bool emit = (m.state == MP_DATA);
+        const uint8_t* d = (const uint8_t*)m.delim;
+        size_t run = i;
+        bool hit = false;
+        for (; i < len; i++) {
+          uint8_t c = data[i];
+          if (c == d[m.match]) {
+            if (m.match == 0 && emit && !httpMpData(m, data + run, i - run, fn, ctx)) { m.error = 1; return false; }
+            if (++m.match == m.delimLen) { i++; hit = true; break; }
+          } else if (m.match > 0) {
+            if (emit && !httpMpData(m, d, m.match, fn, ctx)) { m.error = 1; return false; }
+            m.match = 0;
+            if (c == d[0]) m.match = 1;
+            else run = i;
+          }
+        }
+        if (!hit) {
+          if (m.match == 0 && emit && !httpMpData(m, data + run, len - run, fn, ctx)) { m.error = 1; return false; }
+          return true;
+        }
+        m.match = 0;
+        m.dashes = 0;
+        if (emit && !fn(m, HMP_PART_END, nullptr, 0, ctx)) { m.error = 1; return false; }
+        m.state = MP_AFTER;
+        break;
+      }
+
+      case MP_AFTER: {
+        char c = (char)data[i++];
+        if (c == '-') {
+          if (++m.dashes == 2) {
+            m.state = MP_DONE;
+            if (!fn(m, HMP_DONE, nullptr, 0, ctx)) { m.error = 1; return false; }
+          }
+        } else if (c == '\n' && m.dashes == 0) {
+          m.state = MP_HEAD;
+          m.lineLen = 0;
+          m.name[0] = '\0';
+          m.filename[0] = '\0';
+        } else if (c != '\r' && c != ' ' && c != '\t') {
+          m.error = 1;
+          return false;
+        }
+        break;
+      }
+
+      case MP_HEAD: {
+        char c = (char)data[i++];
+        if (c != '\n') {
+          if (m.lineLen < sizeof(m.line) - 1) m.line[m.lineLen++] = c;
+          break;
+        }
+        if (m.lineLen > 0 && m.line[m.lineLen - 1] == '\r') m.lineLen--;
+        m.line[m.lineLen] = '\0';
+        if (m.lineLen == 0) {
+          m.state = MP_DATA;
+          m.match = 0;
+          if (!fn(m, HMP_PART_BEGIN, nullptr, 0, ctx)) { m.error = 1; return false; }
+        } else {
+          char hn[21];   // "content-disposition:"
+          size_t hl = m.lineLen < 20 ? m.lineLen : 20;
+          memcpy(hn, m.line, hl);
+          hn[hl] = '\0';
+          if (httpNameEq(hn, "content-disposition:")) {
+            httpParam(m.line, "name", m.name, sizeof(m.name));
+            httpParam(m.line, "filename", m.filename, sizeof(m.filename));
+          }
+        }
+        m.lineLen = 0;
+        break;
+      }
+
+      default:
+        return true;   // kapanış sonrası (epilog) yok sayılır
+    }
+  }
+  return true;
+}
+
+bool httpMpComplete(const HttpMultipart& m) {
+  return m.state == MP_DONE && !m.error;
+}
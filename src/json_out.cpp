@@ -0,0 +1,224 @@
+/*
+  src/json_out.cpp - akış halinde JSON / CBOR yazıcı
+  Bkz. include/json_out.h
+*/
+
+#include "json_out.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+static void joFlush(JsonOut& j) {
+  if (j.len == 0 || j.error) { j.len = 0; return; }
+  if (!j.sink(j.buf, j.len, j.ctx)) j.error = true;
+  j.len = 0;
+}
+
+static void joRaw(JsonOut& j, const char* s, size_t n) {
+  if (j.error) return;
+  j.total += (uint32_t)n;
+  while (n > 0) {
+    if (j.len == JSON_OUT_BUF) {
+      joFlush(j);
+      if (j.error) return;
+    }
+    size_t room = (size_t)JSON_OUT_BUF - j.len;
+    size_t k = (n < room) ? n : room;
+    memcpy(j.buf + j.len, s, k);
+    j.len = (uint16_t)(j.len + k);
+    s += k;
+    n -= k;
+  }
+}
+
+static void joChar(JsonOut& j, char c) {
+  joRaw(j, &c, 1);
+}
+
+static void joEscaped(JsonOut& j, const char* s) {
+  joChar(j, '"');
+  const char* run = s;   // kaçış gerektirmeyen ardışık baytlar tek seferde
+  for (; *s; s++) {
+    unsigned char c = (unsigned char)*s;
+    if (c >= 0x20 && c != '"' && c != '\\') continue;
+    joRaw(j, run, (size_t)(s - run));
+    char e[8];
+    switch (c) {
+      case '"':  joRaw(j, "\\\"", 2); break;
+      case '\\': joRaw(j, "\\\\", 2); break;
+      case '\n': joRaw(j, "\\n", 2); break;
+      case '\r': joRaw(j, "\\r", 2); break;
+      case '\t': joRaw(j, "\\t", 2); break;
+      default:
+        snprintf(e, sizeof(e), "\\u%04x", (unsigned)c);
+        joRaw(j, e, 6);
+        break;
+    }
+    run = s + 1;
+  }
+  joRaw(j, run, (size_t)(s - run));
+  joChar(j, '"');
+}
+
+// CBOR: ana tip + argüman (en kısa biçim)
+static void cbHead(JsonOut& j, uint8_t major, uint64_t v) {
+  uint8_t b[9];
+  size_t n;
+  major = (uint8_t)(major << 5);
+  if (v < 24)               { b[0] = (uint8_t)(major | v); n = 1; }
+  else if (v <= 0xff)       { b[0] = major | 24; b[1] = (uint8_t)v; n = 2; }
+  else if (v <= 0xffff)     { b[0] = major | 25; n = 3; }
+  else if (v <= 0xffffffff) { b[0] = major | 26; n = 5; }
+  else                      { b[0] = major | 27; n = 9; }
+  if (n > 2) {
+    for (size_t i = n - 1; i >= 1; i--) { b[i] = (uint8_t)v; v >>= 8; }   // büyük uçlu
+  }
+  joRaw(j, (const char*)b, n);
+}
+
+static void cbText(JsonOut& j, const char* s) {
+  size_t n = strlen(s);
+  cbHead(j, 3, n);
+  joRaw(j, s, n);
+}
+
+// Virgül + (nesnedeyse) anahtar
+static void joPrefix(JsonOut& j, const char* key) {
+  if (j.fmt == JO_CBOR) {
+    if (key) cbText(j, key);
+    return;
+  }
+  if (j.depth > 0) {
+    uint8_t bit = (uint8_t)(1u << (j.depth - 1));
+    if (j.hasItem & bit) joChar(j, ',');
+    j.hasItem |= bit;
+  }
+  if (key) {
+    joEscaped(j, key);
+    joChar(j, ':');
+  }
+}
+
+static void joOpen(JsonOut& j, const char* key, bool arr) {
+  if (j.depth >= JSON_OUT_DEPTH) { j.error = true; return; }
+  joPrefix(j, key);
+  if (j.fmt == JO_CBOR) joChar(j, arr ? (char)0x9f : (char)0xbf);   // belirsiz uzunluk
+  else                  joChar(j, arr ? '[' : '{');
+  uint8_t bit = (uint8_t)(1u << j.depth);
+  if (arr) j.arrMask |= bit;
+  else     j.arrMask &= (uint8_t)~bit;
+  j.hasItem &= (uint8_t)~bit;
+  j.depth++;
+}
+
+void jsonOutInit(JsonOut& j, JsonSink sink, void* ctx, uint8_t fmt) {
+  j.sink = sink;
+  j.ctx = ctx;
+  j.fmt = fmt;
+  j.len = 0;
+  j.depth = 0;
+  j.arrMask = 0;
+  j.hasItem = 0;
+  j.error = false;
+  j.total = 0;
+}
+
+void jsonObjBegin(JsonOut& j, const char* key) { joOpen(j, key, false); }
+void jsonArrBegin(JsonOut& j, const char* key) { joOpen(j, key, true); }
+
+void jsonEnd(JsonOut& j) {
+  if (j.depth == 0) return;
+  j.depth--;
+  if (j.fmt == JO_CBOR) joChar(j, (char)0xff);
+  else                  joChar(j, (j.arrMask & (1u << j.depth)) ? ']' : '}');
+}
+
+void jsonStr(JsonOut& j, const char* key, const char* v) {
+  if (!v) { jsonNull(j, key); return; }
+  joPrefix(j, key);
+  if (j.fmt == JO_CBOR) cbText(j, v);
+  else                  joEscaped(j, v);
+}
+
+void jsonInt(JsonOut& j, const char* key, int64_t v) {
+  if (j.fmt == JO_CBOR) {
+    joPrefix(j, key);
+    if (v >= 0) cbHead(j, 0, (uint64_t)v);
+    else        cbHead(j, 1, (uint64_t)(-(v + 1)));
+    return;
+  }
+  char b[24];
+  int n = snprintf(b, sizeof(b), "%lld", (long long)v);
+  joPrefix(j, key);
+  joRaw(j, b, (size_t)n);
+}
+
+void jsonUint(JsonOut& j, const char* key, uint64_t v) {
+  if (j.fmt == JO_CBOR) {
+    joPrefix(j, key);
+    cbHead(j, 0, v);
+    return;
+  }
+  char b[24];
+  int n = snprintf(b, sizeof(b), "%llu", (unsigned long long)v);
+  joPrefix(j, key);
+  joRaw(j, b, (size_t)n);
+}
+
+void jsonBool(JsonOut& j, const char* key, bool v) {
+  joPrefix(j, key);
+  if (j.fmt == JO_CBOR) joChar(j, v ? (char)0xf5 : (char)0xf4);
+  else if (v) joRaw(j, "true", 4);
+  else   joRaw(j, "false", 5);
+}
+
+void jsonNum(JsonOut& j, const char* key, double v, uint8_t decimals) {
+  if (isnan(v) || isinf(v)) { jsonNull(j, key); return; }
+  if (decimals > 9) decimals = 9;
+  if (j.fmt == JO_CBOR) {
+    double p = 1;
+    for (uint8_t i = 0; i < decimals; i++) p *= 10;
+    double r = round(v * p) / p;
+    if (fabs(r) < 9007199254740992.0 && r == floor(r)) { jsonInt(j, key, (int64_t)r); return; }
+    joPrefix(j, key);
+    float f = (float)r;
+    uint8_t b[9];
+    if ((double)f == r) {
+      uint32_t u;
+      memcpy(&u, &f, 4);
+      b[0] = 0xfa;
+      for (int i = 0; i < 4; i++) b[1 + i] = (uint8_t)(u >> (24 - 8 * i));
+      joRaw(j, (const char*)b, 5);
+    } else {
+      uint64_t u;
+      memcpy(&u, &r, 8);
+      b[0] = 0xfb;
+      for (int i = 0; i < 8; i++) b[1 + i] = (uint8_t)(u >> (56 - 8 * i));
+      joRaw(j, (const char*)b, 9);
+    }
+    return;
+  }
+  char b[40];
+  int n = snprintf(b, sizeof(b), "%.*f", (int)decimals, v);
+  if (n <= 0 || n >= (int)sizeof(b)) { jsonNull(j, key); return; }
+  if (decimals > 0) {
+    while (n > 0 && b[n - 1] == '0') n--;
+    if (n > 0 && b[n - 1] == '.') n--;
+  }
+  if (n == 2 && b[0] == '-' && b[1] == '0') { b[0] = '0'; n = 1; }   // "-0"
+  joPrefix(j, key);
+  joRaw(j, b, (size_t)n);
+}
+
+void jsonNull(JsonOut& j, const char* key) {
+  joPrefix(j, key);
+  if (j.fmt == JO_CBOR) joChar(j, (char)0xf6);
+  else                  joRaw(j, "null", 4);
+}
+
+bool jsonOutFinish(JsonOut& j) {
+  while (j.depth > 0) jsonEnd(j);
+  joFlush(j);
+  return !j.error;
+}
@@ -16,43 +16,44 @@
   - "/admin" Yönetim sayfası: sekmeler (Durum / Tolerans / Dini Günler / Komutlar)
   - Toleranslar ve Dini Günler sadece anahtar doğruysa (WEB_KEY) API üzerinden görünür.
   - /api/public (auth yok) sadece durum json döner.
+  - /api/live (auth yok) saat/uptime/heap/RSSI gibi anlık alanları döner.
   - /api/settings ve /api/action (auth ister) ayarlar/komutlar.
 
   Not:
-  - UniversalTelegramBot kütüphanesinde mesaj düzenleme için:
-      sendMessageWithInlineKeyboard(chat_id, text, "", keyboardJson, message_id)
-    kullanılır. (message_id != 0 ise editMessageText çağrılır)
+  - Telegram Bot API istemcisi dosya içinde (TgBot); yanıtlar include/tg_api.h ile
+    akış halinde sabit tamponlara ayrıştırılır. Panel düzenleme editMessageText ile.
 */
 
 #include <WiFi.h>
-#include <WebServer.h>
+#include <lwip/sockets.h>
 #include <Update.h>
 #include <WiFiClientSecure.h>
 #include <HTTPClient.h>
 #include <ArduinoJson.h>
 
-// PSRAM allocator for ArduinoJson (ESP32-S3 8MB PSRAM)
-struct PsramAllocator {
-  void* allocate(size_t size) {
-    if (psramFound()) return ps_malloc(size);
-    return malloc(size);
-  }
-  void deallocate(void* ptr) { free(ptr); }
-  void* reallocate(void* ptr, size_t size) {
-    if (psramFound()) return ps_realloc(ptr, size);
-    return realloc(ptr, size);
-  }
-};
-using PsramJsonDocument = BasicJsonDocument<PsramAllocator>;
 #include <cstring>  // memcmp
 #include <Preferences.h>
 #include <time.h>
-#include <UniversalTelegramBot.h>
 #include <esp_system.h>
 #include <esp_task_wdt.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <esp_timer.h>
+#include <SPIFFS.h>
+#include <sys/time.h>
 #include <esp_ota_ops.h>
 #include <nvs.h>
 #include "secrets.h"
+#include "schedule_engine.h"
+#include "hijri_calendar.h"
+#include "prayer_times.h"
+#include "ezan_stream.h"
+#include "tg_api.h"
+#include "http_parse.h"
+#include "json_out.h"
+#include "web_assets.h"   // tools/build_web_assets.py üretir
 
 #ifndef SECRET_WIFI_SSID
 #define SECRET_WIFI_SSID ""
@@ -83,6 +84,7 @@ static const char* NVS_KEY_HNY_DAY   = "hnyDay";
 static const char* NVS_KEY_HNY_MON   = "hnyMon";
 static const char* NVS_KEY_AUTO_HYR  = "autoHyr";
 static const char* NVS_KEY_HNY_LAST  = "hnyLast";
+static const char* NVS_KEY_HCAL_OFF  = "hcOff";   // Hicri takvim kalibrasyon ofseti (gün)
 static const char* NVS_KEY_ULOG_BLOB = "uLogBlob";
 static const char* NVS_KEY_ULOG_META = "uLogMeta"; // idx + cnt
 static const char* NVS_KEY_SLOG_BLOB = "sLogBlob";
@@ -237,6 +239,17 @@ static const char* NVS_KEY_NET_DNS2 = "netDNS2";
 
 static uint32_t g_ilceId = 9206;
 static const char* NVS_KEY_ILCE = "ilceId";
+
+// İlçe koordinatı (mikro-derece): API'ye ulaşılamazken imsak/akşam hesabı (prayer_times.h)
+// Varsayılan koordinat yalnızca varsayılan ilçe (9206 Çankaya) için; başka ilçede operatör
+// geo girene kadar 0,0 (hesap kapalı) - yanlış şehrin vakti zorunlu kapanmayı sürmesin.
+static const uint32_t ILCE_ID_DEFAULT    = 9206;
+static const int32_t ILCE_LAT_E6_DEFAULT = 39917900;  // Çankaya
+static const int32_t ILCE_LON_E6_DEFAULT = 32862700;
+static int32_t g_latE6 = ILCE_LAT_E6_DEFAULT;
+static int32_t g_lonE6 = ILCE_LON_E6_DEFAULT;
+static const char* NVS_KEY_LAT = "latE6";
+static const char* NVS_KEY_LON = "lonE6";
 static const char* NVS_KEY_HTTP_PORT = "httpPort";
 
 static uint16_t g_httpPort = 80;
@@ -262,29 +275,11 @@ static const int64_t OWNER_ADMIN_ID = SECRET_OWNER_ADMIN_ID;
 static String g_activeChatId = String(SECRET_CHAT_ID);
 static const char* NVS_KEY_ACTIVE_CHAT = "actChat";
 
-// =====================
-// ÖZEL GÜNLER ENABLE (0=kapalı, 1=açık)
-// =====================
-#define EN_1_RECEB_UC_AYLAR_BASLANGIC   1
-#define EN_2_RECEB_REGAIB_KANDILI      1
-#define EN_26_RECEB_MIRAC_KANDILI      1
-#define EN_14_SABAN_BERAT_KANDILI      1
-#define EN_26_RAMAZAN_KADIR_GECESI     1
-#define EN_1_SEVVAL_RB_1               1
-#define EN_2_SEVVAL_RB_2               1
-#define EN_3_SEVVAL_RB_3               1
-#define EN_9_ZILHICCE_AREFE            1
-#define EN_10_ZILHICCE_KB_1            1
-#define EN_11_ZILHICCE_KB_2            1
-#define EN_12_ZILHICCE_KB_3            1
-#define EN_13_ZILHICCE_KB_4            1
-#define EN_11_REBIULEVVEL_MEVLID       1
-// Ramazan ayındaki tüm günleri dini gün gibi dahil et
-#define EN_RAMAZAN_TUM_GUNLER           1
-
-// Telegram poll + spam koruma
-// Not: Daha hızlı tepki için poll süresi biraz düşürüldü.
-static const uint32_t TG_POLL_MS  = 900;
+// ÖZEL GÜNLER ENABLE (EN_*) ve g_specials tablosu: include/schedule_engine.h
+
+// Telegram alım (long polling) + spam koruma
+// Alım ayrı görevde: getUpdates sunucuda TG_LONGPOLL_SEC bekler, güncelleme gelince hemen döner.
+static const int      TG_LONGPOLL_SEC = 25;
 static const uint32_t TG_DEDUP_MS = 25000;
 
 // =====================
@@ -359,18 +354,75 @@ static const char* EZAN_API = "https://ezanvakti.emushaf.net";
 // =====================
 // NVS vakit verisi
 // =====================
-static const uint8_t TIMES_VER = 3;
-
-struct __attribute__((packed)) DayTimes {
-  uint32_t ymd;            // YYYYMMDD
-  uint16_t imsakMin;       // 0..1439
-  uint16_t aksamMin;       // 0..1439
-  char     hicriUzun[28];  // örn: "26 Ramazan 1447"
-};
+static const uint8_t TIMES_VER = 4;  // v4: Hicri gün/ay/yıl alanları (v3 migrate edilir)
 
-static const int MAX_DAYS = 45;
+// DayTimes: include/schedule_engine.h
+static const int MAX_DAYS = SCHED_MAX_DAYS;
 static DayTimes  g_days[MAX_DAYS];
 static uint16_t  g_dayCount = 0;
+// g_days[0..g_dayApiCount) API'den (NVS'e yazılan kısım); sonrası koordinattan hesaplanan günler
+static uint16_t  g_dayApiCount = 0;
+static uint32_t  g_lastUpdYmd = 0;   // NVS "lastUpdYmd" kopyası (son başarılı API güncellemesi)
+// API cache'i bugünden bu kadar gün ilerisini kapsamıyorsa hesaplanan günlerle uzatılır
+static const int32_t ASTRO_AHEAD_DAYS = 10;
+
+// g_days / toleranslar / dini gün ayarları değişince çizelge timeline'ı yeniden kurulur
+static bool      g_tlDirty = true;
+static void tlMarkDirty() { g_tlDirty = true; }
+
+// Gün indeksi (YMD -> g_days slotu); g_days içeriği değişince yeniden kurulur
+static SchedDayIndex g_dayIdx{};
+static bool          g_dayIdxDirty = true;
+
+// Çizelge durumu: hangi girdinin değiştiği (SD_*) tutulur; schedTick sadece etkilenen
+// pencereleri (Perşembe / dini gün / imsak OFF) yeniden hesaplar. Girdi değişmedikçe ve
+// en yakın pencere sınırına (nextDueTs) gelinmedikçe loop çizelge işi yapmaz.
+enum SchedDirty : uint8_t {
+  SD_DAYS    = 0x01,  // g_days tablosu
+  SD_TOL     = 0x02,  // g_onOffsetSec / g_offOffsetSec
+  SD_SPECIAL = 0x04,  // g_spEnableMask / g_spOv
+  SD_RAMAZAN = 0x08,  // g_enableRamazanAll
+  SD_DATE    = 0x10,  // yerel gün değişti (gece yarısı)
+  SD_ALL     = 0x1F,
+};
+
+struct SchedState {
+  uint8_t  dirty;         // SD_* bitleri
+  uint32_t ymd;           // son görülen yerel gün
+  time_t   nextDueTs;     // bir sonraki zorunlu yeniden hesap anı
+  uint32_t recomputeCnt;  // schedTick'in iş yaptığı tur sayısı
+  uint32_t thuCnt;        // Perşembe penceresi hesap sayısı
+  uint32_t spCnt;         // dini gün penceresi hesap sayısı
+  uint32_t imsakCnt;      // imsak OFF hesap sayısı
+  uint32_t tlBuildCnt;    // timeline yeniden kurulum sayısı
+  uint32_t tlOverflow;    // tabloya sığmayan derleme (plan yayınlanmadı)
+};
+static SchedState g_sched = { SD_ALL, 0, 0, 0, 0, 0, 0, 0 };
+
+// =====================
+// Durum sürümü: panel API'lerinin gösterdiği kalıcı durum (röle, vakitler, ayarlar,
+// WiFi, güncelleme, yerel gün) her değiştiğinde artar. /api/public önbellekli yanıtı
+// sürüm ya da dakika dilimi değişmedikçe yeniden üretilmez (bkz. "Önbellekli JSON yanıtı").
+// Röle görevi de artırır: kayıp artış olsa bile değer değişir, yalnızca eşitlik sınanır.
+// =====================
+static volatile uint32_t g_stateVer = 1;
+static void stateBump() { g_stateVer++; }
+
+static void schedMarkDirty(uint8_t bits) {
+  stateBump();
+  g_sched.dirty |= bits;
+  if (bits & (SD_DAYS | SD_TOL | SD_SPECIAL | SD_RAMAZAN)) tlMarkDirty();
+}
+
+// Çevrimdışı Hicri takvim (hijri_calendar.h): API Hicri metinleriyle kalibre edilen gün ofseti.
+// Cache olmadan da (NVS'teki son ofsetle) bugünün Hicri tarihi ve 12 aylık özel gün tahmini yapılır.
+static int8_t   g_hijriCalOff     = 0;
+static uint16_t g_hijriCalAgree   = 0;  // son kalibrasyonda ofsetle tutan gün
+static uint16_t g_hijriCalSamples = 0;  // son kalibrasyondaki geçerli gün
+static const int SP_PREDICT_DAYS  = 365;
+
+static void daysMarkDirty() { g_dayIdxDirty = true; schedMarkDirty(SD_DAYS); }
+static void schedTick(time_t now);
 
 // =====================
 // Admin listesi (NVS)
@@ -379,34 +431,6 @@ static const int MAX_ADMINS = 20;
 static int64_t  g_adminIds[MAX_ADMINS];
 static uint8_t  g_adminCount = 0;
 
-// =====================
-// Özel gün tanımı
-// =====================
-struct SpecialDef {
-  uint8_t   day;
-  const char* monthKey;  // receb/saban/ramazan/sevval/zilhicce/rebiulevvel
-  const char* name;
-  uint8_t   defaultEnabled;
-};
-
-static const SpecialDef g_specials[] = {
-  {  1, "receb",       "Üç Ayların Başlangıcı",          (uint8_t)EN_1_RECEB_UC_AYLAR_BASLANGIC },
-  {  2, "receb",       "Regaib Kandili (2 Receb)",       (uint8_t)EN_2_RECEB_REGAIB_KANDILI },
-  { 26, "receb",       "Mirac Kandili",                  (uint8_t)EN_26_RECEB_MIRAC_KANDILI },
-  { 14, "saban",       "Berat Kandili",                  (uint8_t)EN_14_SABAN_BERAT_KANDILI },
-  { 26, "ramazan",     "Kadir Gecesi",                   (uint8_t)EN_26_RAMAZAN_KADIR_GECESI },
-  {  1, "sevval",      "Ramazan Bayramı 1. Gün",         (uint8_t)EN_1_SEVVAL_RB_1 },
-  {  2, "sevval",      "Ramazan Bayramı 2. Gün",         (uint8_t)EN_2_SEVVAL_RB_2 },
-  {  3, "sevval",      "Ramazan Bayramı 3. Gün",         (uint8_t)EN_3_SEVVAL_RB_3 },
-  {  9, "zilhicce",    "Kurban Bayramı Arefe Günü",      (uint8_t)EN_9_ZILHICCE_AREFE },
-  { 10, "zilhicce",    "Kurban Bayramı 1. Gün",          (uint8_t)EN_10_ZILHICCE_KB_1 },
-  { 11, "zilhicce",    "Kurban Bayramı 2. Gün",          (uint8_t)EN_11_ZILHICCE_KB_2 },
-  { 12, "zilhicce",    "Kurban Bayramı 3. Gün",          (uint8_t)EN_12_ZILHICCE_KB_3 },
-  { 13, "zilhicce",    "Kurban Bayramı 4. Gün",          (uint8_t)EN_13_ZILHICCE_KB_4 },
-  { 11, "rebiulevvel", "Mevlid Kandili",                 (uint8_t)EN_11_REBIULEVVEL_MEVLID },
-};
-static const uint8_t SPECIAL_COUNT = sizeof(g_specials)/sizeof(g_specials[0]);
-
 // =====================
 // Global state
 // =====================
@@ -478,50 +502,12 @@ static const char*   NVS_KEY_SP_OV_BLOB = "spOvBlob";
 static const int HICRI_YEAR_MIN = 1447;
 static const int HICRI_YEAR_MAX = 1461;
 
-struct __attribute__((packed)) SpOverride {
-  uint8_t  useDefault; // 1=default (main.cpp), 0=custom
-  uint8_t  day;        // 1..30
-  uint8_t  month;      // 0..11 (Hicri month index)
-  uint16_t year;       // 1447..1461 (custom için)
-};
-
+// SpOverride: include/schedule_engine.h
 static SpOverride g_spOv[SPECIAL_COUNT];
 
-static String normMonthKey(const String& in);
-
-static int monthIndexFromKey(const String& inKey) {
-  String k = normMonthKey(inKey);
-  if (k == "muharrem") return 0;
-  if (k == "safer") return 1;
-  if (k == "rebiulevvel") return 2;
-  if (k == "rebiulahir") return 3;
-  if (k == "cemaziyelevvel") return 4;
-  if (k == "cemaziyelahir") return 5;
-  if (k == "receb") return 6;
-  if (k == "saban") return 7;
-  if (k == "ramazan") return 8;
-  if (k == "sevval") return 9;
-  if (k == "zilkade") return 10;
-  if (k == "zilhicce") return 11;
-  return -1;
-}
-
-static const char* monthKeyFromIndex(uint8_t idx) {
-  switch (idx) {
-    case 0:  return "muharrem";
-    case 1:  return "safer";
-    case 2:  return "rebiulevvel";
-    case 3:  return "rebiulahir";
-    case 4:  return "cemaziyelevvel";
-    case 5:  return "cemaziyelahir";
-    case 6:  return "receb";
-    case 7:  return "saban";
-    case 8:  return "ramazan";
-    case 9:  return "sevval";
-    case 10: return "zilkade";
-    case 11: return "zilhicce";
-    default: return "ramazan";
-  }
+// Hicri ay anahtarı -> 0..11 (Türkçe harf/alias normalize: schedule_engine hicriMonthIndex)
+static int monthIndexFromKey(const char* key) {
+  return hicriMonthIndex(key, key ? strlen(key) : 0);
 }
 
 static void spOverrideDefaults() {
@@ -583,27 +569,1321 @@ static inline bool isSpecialEnabled(uint8_t idx) {
   return ((g_spEnableMask >> idx) & 1u) != 0;
 }
 
-WiFiClientSecure tgClient;
-UniversalTelegramBot* _pBot = nullptr;
-#define bot (*_pBot)
+// =====================
+// Ağ bağlantıları: host başına DNS önbelleği + kalıcı (keep-alive) soketler
+// - Tüm dış bağlantılar NetClient üzerinden: Telegram gönderim/alım, ezan API, ipify.
+// - connect(host): DNS sonucu NET_DNS_TTL_MS saklanır (lwIP kayıt TTL'ini vermiyor),
+//   bağlantı hatasında silinir. TLS'te SNI için host adı ayrıca verilir.
+// - beginRequest(): yeni istekten önce çağrılır; soket idleMaxMs'den uzun boşta kaldıysa
+//   (sunucu sessizce kapatmış olabilir) kapatılır, kütüphane connected()==0 görüp yarı ölü
+//   sokete yazmak yerine yeniden bağlanır. Yanıt okunurken sınır uygulanmaz: yavaş yanıt
+//   (örn. ezan API, 25 sn) istemcinin kendi zaman aşımına kadar beklenir.
+// - Açık sokette yeni istek = yeniden kullanım (handshake yok); sayaçlar /api/system "net".
+// - TLS oturum yenileme (session ticket) yok: arduino-esp32 ssl_client handshake'i tek
+//   çağrıda yapıyor, araya oturum verilemiyor. Kazanç soketi açık tutmaktan.
+// =====================
+enum NetHost : uint8_t { NH_TELEGRAM = 0, NH_EZAN, NH_IPIFY, NH_COUNT };
+
+static const uint32_t NET_DNS_TTL_MS = 10UL * 60UL * 1000UL;
+static const int      NET_CLIENT_MAX = 6;
+
+struct NetHostInfo {
+  const char* name;
+  uint32_t    idleMaxMs;   // boşta kalma sınırı (sunucu keep-alive süresinin altında)
+  uint32_t    ip;          // önbellekteki adres (0 = yok)
+  uint32_t    ipAtMs;
+  uint32_t    dnsLookups;
+  uint32_t    dnsHits;
+  uint32_t    dnsFails;
+};
+
+static NetHostInfo g_netHosts[NH_COUNT] = {
+  { "api.telegram.org",      60000, 0, 0, 0, 0, 0 },
+  { "ezanvakti.emushaf.net", 10000, 0, 0, 0, 0, 0 },
+  { "api.ipify.org",          5000, 0, 0, 0, 0, 0 },
+};
+static portMUX_TYPE g_netMux = portMUX_INITIALIZER_UNLOCKED;
+
+// Önbellekten ya da DNS'ten adres. Farklı host adı (yönlendirme vb.) önbelleğe girmez.
+static bool netResolve(uint8_t h, const char* host, IPAddress& out) {
+  NetHostInfo& hi = g_netHosts[h];
+  bool same = (strcmp(host, hi.name) == 0);
+  if (same) {
+    uint32_t ip = 0;
+    uint32_t now = millis();
+    portENTER_CRITICAL(&g_netMux);
+    if (hi.ip && now - hi.ipAtMs < NET_DNS_TTL_MS) { ip = hi.ip; hi.dnsHits++; }
+    portEXIT_CRITICAL(&g_netMux);
+    if (ip) { out = IPAddress(ip); return true; }
+  }
+  bool ok = WiFi.hostByName(host, out) && (uint32_t)out != 0;
+  uint32_t now = millis();
+  portENTER_CRITICAL(&g_netMux);
+  hi.dnsLookups++;
+  if (!ok) hi.dnsFails++;
+  else if (same) { hi.ip = (uint32_t)out; hi.ipAtMs = now; }
+  portEXIT_CRITICAL(&g_netMux);
+  return ok;
+}
+
+static void netForget(uint8_t h) {
+  portENTER_CRITICAL(&g_netMux);
+  g_netHosts[h].ip = 0;
+  portEXIT_CRITICAL(&g_netMux);
+}
+
+struct NetClientStats {
+  uint32_t connects;     // yeni bağlantı (TLS'te tam handshake)
+  uint32_t connectFails;
+  uint32_t requests;     // soket üzerinde başlayan istek (yazma fazı)
+  uint32_t reuses;       // açık sokette başlayan istek
+  uint32_t idleCloses;   // idleMaxMs aşıldığı için kapatılan soket
+  uint32_t lastConnMs;   // son bağlantı süresi (DNS hariç, TCP + TLS)
+  uint32_t connMsTotal;
+  uint32_t bytesRx;
+  uint32_t bytesTx;
+};
+
+class NetClientBase;
+static NetClientBase* g_netClients[NET_CLIENT_MAX];
+static int            g_netClientCount = 0;
+
+// Sayaçlar istemci başına: her istemci tek görevden kullanılır, kilit gerekmez
+class NetClientBase {
+ public:
+  NetClientBase(uint8_t host, const char* label) : host(host), label(label) {
+    if (g_netClientCount < NET_CLIENT_MAX) g_netClients[g_netClientCount++] = this;
+  }
+  const uint8_t  host;
+  const char*    label;
+  NetClientStats st = {};
+
+ protected:
+  uint32_t lastIoMs = 0;
+  bool     fresh = false;   // bağlantıdan sonra henüz istek yok
+  bool     txPhase = false; // istek yazılıyor (ilk yazım = yeni istek)
+
+  void noteTx(size_t n) {
+    if (!txPhase) {
+      txPhase = true;
+      st.requests++;
+      if (!fresh) st.reuses++;
+      fresh = false;
+    }
+    st.bytesTx += (uint32_t)n;
+    lastIoMs = millis();
+  }
+  void noteRx(int n) {
+    if (n <= 0) return;
+    txPhase = false;
+    st.bytesRx += (uint32_t)n;
+    lastIoMs = millis();
+  }
+};
+
+static int netConnectIp(WiFiClientSecure& c, IPAddress ip, uint16_t port, const char* host) {
+  return c.connect(ip, port, host, nullptr, nullptr, nullptr);
+}
+static int netConnectIp(WiFiClient& c, IPAddress ip, uint16_t port, const char*) {
+  return c.connect(ip, port);
+}
+
+template <class Base>
+class NetClient : public Base, public NetClientBase {
+ public:
+  NetClient(uint8_t host, const char* label) : NetClientBase(host, label) {}
+  using Base::connect;
+  using Base::write;
+  using Base::read;
+
+  int connect(const char* hostName, uint16_t port) override {
+    IPAddress ip;
+    if (!netResolve(host, hostName, ip)) { st.connectFails++; return 0; }
+    uint32_t t0 = millis();
+    int ok = netConnectIp(*static_cast<Base*>(this), ip, port, hostName);
+    if (!ok) {
+      st.connectFails++;
+      netForget(host);  // adres değişmiş olabilir
+      return 0;
+    }
+    st.lastConnMs = millis() - t0;
+    st.connects++;
+    st.connMsTotal += st.lastConnMs;
+    fresh = true;
+    txPhase = false;
+    lastIoMs = millis();
+    return ok;
+  }
+  // HTTPClient zaman aşımlı sürümü çağırır; soket/handshake süreleri setTimeout ile
+  int connect(const char* hostName, uint16_t port, int32_t) override { return connect(hostName, port); }
+
+  // Yeni istekten önce (yanıt okunurken değil)
+  void beginRequest() {
+    if (Base::connected() && millis() - lastIoMs > g_netHosts[host].idleMaxMs) {
+      Base::stop();
+      st.idleCloses++;
+    }
+  }
+
+  size_t write(uint8_t b) override {
+    size_t n = Base::write(b);
+    noteTx(n);
+    return n;
+  }
+  size_t write(const uint8_t* buf, size_t size) override {
+    size_t n = Base::write(buf, size);
+    noteTx(n);
+    return n;
+  }
+  int read() override {
+    int c = Base::read();
+    if (c >= 0) noteRx(1);
+    return c;
+  }
+  int read(uint8_t* buf, size_t size) override {
+    int n = Base::read(buf, size);
+    noteRx(n);
+    return n;
+  }
+};
+
+using NetTlsClient = NetClient<WiFiClientSecure>;
+using NetTcpClient = NetClient<WiFiClient>;
+
+// =====================
+// Telegram Bot API istemcisi
+// - İstek: POST /bot<token>/<method>, JSON gövde. Başlık + gövde 512 baytlık tamponda
+//   toplanıp yazılır; metinler tampona kaçışlanarak kopyalanır (String birleştirme yok).
+// - Yanıt: başlıklar satır satır, gövde (Content-Length / chunked) doğrudan akış
+//   ayrıştırıcısına (include/tg_api.h); JsonDocument ve mesaj başına String kopyası yok.
+// - Soket keep-alive ile açık kalır (NetClient). Hata/yarım yanıtta kapatılır.
+// - Çağrı başına süre ve heap istatistiği: /api/system "tgApi".
+// =====================
+static const int      TG_TOKEN_MAX   = 96;
+static const char*    TG_API_HOST    = "api.telegram.org";
+static const uint16_t TG_API_PORT    = 443;
+static const int      TG_RX_LIMIT    = 8;    // getUpdates limit (= alım kuyruğu)
+
+enum TgMethod : uint8_t { TGM_GET_UPDATES = 0, TGM_SEND, TGM_EDIT, TGM_ANSWER, TGM_COUNT };
+static const char* const TG_METHOD_NAMES[TGM_COUNT] = {
+  "getUpdates", "sendMessage", "editMessageText", "answerCallbackQuery",
+};
+
+struct TgCallStat {
+  uint32_t calls;
+  uint32_t fails;
+  uint32_t lastMs;
+  uint32_t maxMs;
+  uint32_t totalMs;
+  uint32_t heapDropMax;   // çağrı sırasında boş heap'teki en büyük düşüş (TLS dahil)
+  uint32_t lastMaxAlloc;  // çağrı sonrası en büyük ayrılabilir blok (parçalanma)
+};
+
+struct TgField {
+  const char* key;
+  const char* val;
+  bool        raw;  // sayı / JSON: tırnaksız ve kaçışsız yazılır
+};
+
+class TgBot {
+ public:
+  TgBot(NetTlsClient& c, const char* label) : m_client(c), m_label(label) {}
+
+  void setToken(const char* tok) {
+    strncpy(m_token, tok, sizeof(m_token) - 1);
+    m_token[sizeof(m_token) - 1] = '\0';
+  }
+  void setTimeout(uint32_t ms) { m_timeoutMs = ms; }
+
+  // offset ve sonrası; her update fn'e verilir. Dönüş: update sayısı, hata -1
+  int  getUpdates(long offset, int longPollSec, TgUpdateFn fn, void* ctx);
+  bool sendMessage(const String& chat, const String& text, const String& kbJson = "", int32_t* msgIdOut = nullptr);
+  bool editMessage(const String& chat, int32_t msgId, const String& text, const String& kbJson = "");
+  bool answerCallback(const String& qid, const String& text, bool alert);
+
+  const TgResult& lastResult() const { return m_resp.res; }
+  // editMessageText: içerik aynı (Telegram 400 "message is not modified")
+  bool lastNotModified() const {
+    return !m_resp.res.ok && m_resp.res.errorCode == 400 && strstr(m_resp.res.desc, "message is not modified");
+  }
+  long lastUpdateId() const { return m_resp.lastUpdateId; }
+  const char* label() const { return m_label; }
+
+  TgCallStat stats[TGM_COUNT] = {};
+
+ private:
+  bool call(TgMethod m, const TgField* f, int n, TgUpdateFn fn = nullptr, void* ctx = nullptr);
+  void put(const char* p, size_t n);
+  void putStr(const char* p) { put(p, strlen(p)); }
+  void putEsc(const char* p);
+  void flush();
+  int  rdByte(uint32_t deadline);
+  bool rdLine(char* out, size_t cap, uint32_t deadline);
+  bool rdBody(long n, uint32_t deadline);
+
+  NetTlsClient& m_client;
+  const char* m_label;
+  char        m_token[TG_TOKEN_MAX] = "";
+  uint32_t    m_timeoutMs = 12000;
+  char        m_buf[512];
+  size_t      m_len = 0;
+  bool        m_wfail = false;
+  TgResponse  m_resp;
+};
+
+void TgBot::flush() {
+  if (m_len == 0) return;
+  if (m_client.write((const uint8_t*)m_buf, m_len) != m_len) m_wfail = true;
+  m_len = 0;
+}
+
+void TgBot::put(const char* p, size_t n) {
+  while (n > 0) {
+    if (m_len == sizeof(m_buf)) flush();
+    size_t k = sizeof(m_buf) - m_len;
+    if (k > n) k = n;
+    memcpy(m_buf + m_len, p, k);
+    m_len += k; p += k; n -= k;
+  }
+}
+
+void TgBot::putEsc(const char* p) {
+  while (*p) {
+    size_t k = tgJsonEscapeChunk(p, m_buf + m_len, sizeof(m_buf) - m_len);
+    m_len += k;
+    if (*p) flush();  // tampon doldu (kaçış dizisi sığmadı)
+  }
+}
+
+int TgBot::rdByte(uint32_t deadline) {
+  while (!m_client.available()) {
+    if (!m_client.connected() || (int32_t)(millis() - deadline) > 0) return -1;
+    delay(2);
+  }
+  return m_client.read();
+}
+
+bool TgBot::rdLine(char* out, size_t cap, uint32_t deadline) {
+  size_t n = 0;
+  for (;;) {
+    int c = rdByte(deadline);
+    if (c < 0) return false;
+    if (c == '\n') break;
+    if (c != '\r' && n + 1 < cap) out[n++] = (char)c;
+  }
+  out[n] = '\0';
+  return true;
+}
+
+// n < 0: bağlantı kapanana kadar
+bool TgBot::rdBody(long n, uint32_t deadline) {
+  while (n != 0) {
+    int avail = m_client.available();
+    if (avail <= 0) {
+      if (!m_client.connected()) return n < 0;
+      if ((int32_t)(millis() - deadline) > 0) return false;
+      delay(2);
+      continue;
+    }
+    size_t k = sizeof(m_buf);
+    if ((size_t)avail < k) k = (size_t)avail;
+    if (n > 0 && (size_t)n < k) k = (size_t)n;
+    int r = m_client.read((uint8_t*)m_buf, k);
+    if (r <= 0) continue;
+    if (n > 0) n -= r;
+    if (!tgResponseFeed(m_resp, m_buf, (size_t)r)) return false;
+  }
+  return true;
+}
+
+static inline void tgHeapSample(uint32_t& minFree) {
+  uint32_t f = ESP.getFreeHeap();
+  if (f < minFree) minFree = f;
+}
+
+bool TgBot::call(TgMethod m, const TgField* f, int n, TgUpdateFn fn, void* ctx) {
+  TgCallStat& st = stats[m];
+  uint32_t t0 = millis();
+  uint32_t heap0 = ESP.getFreeHeap();
+  uint32_t heapMin = heap0;
+  st.calls++;
+  tgResponseBegin(m_resp, fn, ctx);
+
+  uint32_t deadline = t0 + m_timeoutMs;
+
+  bool ok = m_token[0] != '\0';
+  if (ok) m_client.beginRequest();
+  if (ok && !m_client.connected()) ok = m_client.connect(TG_API_HOST, TG_API_PORT) != 0;
+  if (ok) {
+    tgHeapSample(heapMin);
+
+    size_t bodyLen = 2;
+    for (int i = 0; i < n; i++) {
+      bodyLen += (i ? 1 : 0) + strlen(f[i].key) + 3;
+      bodyLen += f[i].raw ? strlen(f[i].val) : tgJsonEscapedLen(f[i].val) + 2;
+    }
+    m_wfail = false;
+    m_len = (size_t)snprintf(m_buf, sizeof(m_buf),
+        "POST /bot%s/%s HTTP/1.1\r\nHost: %s\r\nContent-Type: application/json\r\n"
+        "Content-Length: %u\r\nConnection: keep-alive\r\n\r\n",
+        m_token, TG_METHOD_NAMES[m], TG_API_HOST, (unsigned)bodyLen);
+    if (m_len >= sizeof(m_buf)) m_len = sizeof(m_buf) - 1;
+    put("{", 1);
+    for (int i = 0; i < n; i++) {
+      if (i) put(",", 1);
+      put("\"", 1); putStr(f[i].key); put("\":", 2);
+      if (f[i].raw) putStr(f[i].val);
+      else { put("\"", 1); putEsc(f[i].val); put("\"", 1); }
+    }
+    put("}", 1);
+    flush();
+    ok = !m_wfail;
+  }
+
+  // Yanıt başlıkları
+  int status = 0;
+  long clen = -1;
+  bool chunked = false, closeAfter = false;
+  if (ok) {
+    char line[96];
+    ok = rdLine(line, sizeof(line), deadline) && strncmp(line, "HTTP/1.", 7) == 0;
+    if (ok) status = atoi(line + 9);
+    while (ok) {
+      ok = rdLine(line, sizeof(line), deadline);
+      if (!ok || line[0] == '\0') break;
+      if (strncasecmp(line, "Content-Length:", 15) == 0)          clen = atol(line + 15);
+      else if (strncasecmp(line, "Transfer-Encoding:", 18) == 0)  chunked = strstr(line + 18, "chunked") != nullptr;
+      else if (strncasecmp(line, "Connection:", 11) == 0)         closeAfter = strstr(line + 11, "close") != nullptr;
+    }
+    tgHeapSample(heapMin);
+  }
+
+  // Gövde -> akış ayrıştırıcı
+  if (ok) {
+    if (chunked) {
+      char line[24];
+      for (;;) {
+        ok = rdLine(line, sizeof(line), deadline);
+        if (!ok) break;
+        long sz = strtol(line, nullptr, 16);
+        if (sz <= 0) { while (rdLine(line, sizeof(line), deadline) && line[0]) {} break; }
+        ok = rdBody(sz, deadline) && rdLine(line, sizeof(line), deadline);
+        if (!ok) break;
+      }
+    } else {
+      ok = rdBody(clen, deadline);
+      if (clen < 0) closeAfter = true;
+    }
+    ok = ok && tgResponseComplete(m_resp);
+  }
+
+  if (!ok || closeAfter) m_client.stop();  // yarım yanıt: soket kullanılamaz
+  ok = ok && status == 200 && m_resp.res.ok;
+
+  uint32_t dt = millis() - t0;
+  tgHeapSample(heapMin);
+  st.lastMs = dt;
+  st.totalMs += dt;
+  if (dt > st.maxMs) st.maxMs = dt;
+  if (heap0 > heapMin && heap0 - heapMin > st.heapDropMax) st.heapDropMax = heap0 - heapMin;
+  st.lastMaxAlloc = ESP.getMaxAllocHeap();
+  if (!ok) st.fails++;
+  return ok;
+}
+
+int TgBot::getUpdates(long offset, int longPollSec, TgUpdateFn fn, void* ctx) {
+  char off[16], tmo[8], lim[8];
+  snprintf(off, sizeof(off), "%ld", offset);
+  snprintf(tmo, sizeof(tmo), "%d", longPollSec);
+  snprintf(lim, sizeof(lim), "%d", TG_RX_LIMIT);
+  const TgField f[] = {
+    { "offset",          off, true },
+    { "timeout",         tmo, true },
+    { "limit",           lim, true },
+    { "allowed_updates", "[\"message\",\"callback_query\"]", true },
+  };
+  uint32_t saved = m_timeoutMs;
+  m_timeoutMs = (uint32_t)(longPollSec + 10) * 1000u;  // sunucu longPollSec kadar bekletir
+  bool ok = call(TGM_GET_UPDATES, f, 4, fn, ctx);
+  m_timeoutMs = saved;
+  return ok ? (int)m_resp.updates : -1;
+}
+
+bool TgBot::sendMessage(const String& chat, const String& text, const String& kbJson, int32_t* msgIdOut) {
+  String kb;
+  if (kbJson.length()) kb = "{\"inline_keyboard\":" + kbJson + "}";
+  const TgField f[] = {
+    { "chat_id",      chat.c_str(), false },
+    { "text",         text.c_str(), false },
+    { "reply_markup", kb.c_str(),   true  },
+  };
+  bool ok = call(TGM_SEND, f, kb.length() ? 3 : 2);
+  if (ok && msgIdOut) *msgIdOut = m_resp.res.messageId;
+  return ok;
+}
+
+bool TgBot::editMessage(const String& chat, int32_t msgId, const String& text, const String& kbJson) {
+  char mid[16];
+  snprintf(mid, sizeof(mid), "%ld", (long)msgId);
+  String kb;
+  if (kbJson.length()) kb = "{\"inline_keyboard\":" + kbJson + "}";
+  const TgField f[] = {
+    { "chat_id",      chat.c_str(), false },
+    { "message_id",   mid,          true  },
+    { "text",         text.c_str(), false },
+    { "reply_markup", kb.c_str(),   true  },
+  };
+  return call(TGM_EDIT, f, kb.length() ? 4 : 3);
+}
+
+bool TgBot::answerCallback(const String& qid, const String& text, bool alert) {
+  const TgField f[] = {
+    { "callback_query_id", qid.c_str(),  false },
+    { "text",              text.c_str(), false },
+    { "show_alert",        alert ? "true" : "false", true },
+  };
+  return call(TGM_ANSWER, f, 3);
+}
+
+NetTlsClient tgClient(NH_TELEGRAM, "tgTx");
+static TgBot g_bot(tgClient, "tgTx");
+
+// g_bot + tgClient iki görevden kullanılır: loop (panel edit, callback ACK) ve outbox gönderimi
+static SemaphoreHandle_t g_tgLock = nullptr;
+
+static bool tgLockTake(uint32_t waitMs) {
+  return !g_tgLock || xSemaphoreTake(g_tgLock, pdMS_TO_TICKS(waitMs)) == pdTRUE;
+}
+static void tgLockGive() {
+  if (g_tgLock) xSemaphoreGive(g_tgLock);
+}
+
+// Telegram alım görevi kendi bot + TLS nesnesini kullanır (g_bot sadece gönderim için).
+// Token değişince g_tgRxGen artar; görev bir sonraki long poll turunda yeniden kurar.
+static char               g_tgRxToken[TG_TOKEN_MAX] = "";
+static volatile uint32_t  g_tgRxGen = 0;
+// Loop'un işlediği son update; alım görevi bu id'den devam eder (NVS: tgLast)
+static volatile long      g_tgDoneUpdateId = 0;
+static portMUX_TYPE       g_tgRxMux = portMUX_INITIALIZER_UNLOCKED;
 
 static void reinitBot(const String& token) {
-  if (token == g_botToken && _pBot) return; // Aynı token, gereksiz new/delete yapma
+  static bool inited = false;
+  if (token == g_botToken && inited) return;
+  if (inited) g_tgDoneUpdateId = 0;   // yeni bot: update id'leri baştan (loop tekrar filtresi)
+  inited = true;
   g_botToken = token;
-  if (_pBot) delete _pBot;
-  _pBot = new UniversalTelegramBot(token, tgClient);
+  tgLockTake(portMAX_DELAY);  // gönderim sürüyorsa bitmesini bekle
+  g_bot.setToken(token.c_str());
+  tgLockGive();
+
+  const char* tok = token.c_str();
+  portENTER_CRITICAL(&g_tgRxMux);
+  strncpy(g_tgRxToken, tok, sizeof(g_tgRxToken) - 1);
+  g_tgRxToken[sizeof(g_tgRxToken) - 1] = '\0';
+  g_tgRxGen++;
+  portEXIT_CRITICAL(&g_tgRxMux);
 }
 
 // =====================
 // Web Panel (HTTP)
 // =====================
 // WEB_KEY runtime: g_webKey (secrets öncelikli, secrets boşsa NVS)
-static WebServer*  g_web = nullptr;
 
-// HTTP için TLS client artık httpGetPayload() içinde lokal olarak oluşturuluyor.
+// =====================
+// Web sunucusu: olay güdümlü (select), çok bağlantılı, keep-alive
+// - loop başında poll() hazır soketleri işler; loop sonundaki bekleme delay(50) yerine
+//   wait(50): soket olayı gelince hemen uyanır. Handler'lar eskisi gibi loop
+//   bağlamında çalışır (paylaşılan durum için kilit gerekmez).
+// - Soketler bloklamaz: yavaş istemcinin yanıtı soket yazılabildikçe parça parça gider,
+//   diğer bağlantılar ve loop işleri (Telegram, çizelge) beklemez.
+// - İstek ayrıştırma include/http_parse.h (sabit tamponlar). Gövde yalnızca JSON POST
+//   için String'e alınır (WEB_BODY_MAX); OTA multipart gövdesi akış halinde upload
+//   handler'ına verilir. send_P gövdesi (panel dosyaları) flash'tan kopyalanmadan gönderilir.
+// - Handler API'si (on/arg/header/send/upload) WebServer ile aynı biçimde, route
+//   tablosu webSetup'ta. Sayaçlar /api/system "web".
+// - Parçalı yanıt: handler beginChunked() sonrası sendChunk() ile gövdeyi yazdıkça
+//   (Transfer-Encoding: chunked) soket tamponuna gider; büyük JSON bellekte toplanmaz.
+//   Soket dolarsa kalan parçalar out'ta sıraya girer (en fazla WEB_CHUNK_BACKLOG) ve
+//   poll'da gönderilir. Sıra dolunca handler soket boşalana kadar bekler (geri basınç);
+//   WEB_CHUNK_STALL_MS boyunca hiç ilerleme olmazsa yanıt kesilir, bağlantı kapatılır
+//   ve sendChunk false döner (yavaş istemci için gövde RAM'de birikmez).
+// - Akış (SSE): handler beginStream() ile yanıtı açık bırakır; sonraki veriyi loop
+//   streamBroadcast() ile iter. Gönderilemeyen birikim WEB_STREAM_BACKLOG'u aşarsa
+//   bağlantı kapatılır (istemci yeniden bağlanıp tam durumu alır).
+// =====================
+// Soket bütçesi (lwIP varsayılanı CONFIG_LWIP_MAX_SOCKETS = 10): dinleyici 1 + web istemcisi
+// WEB_CONN_MAX (4) + NetClient 4 (Telegram tx/rx, ezan, ipify) = 9; 1 yedek.
+static const int      WEB_CONN_MAX      = 4;      // web istemci yuvası (dinleyici hariç)
+static const int      WEB_ROUTE_MAX     = 24;
+static const uint32_t WEB_IDLE_MS       = 15000;  // keep-alive bağlantı boşta bekleme
+static const uint32_t WEB_REQ_MS        = 10000;  // istek okunurken ilerlemesiz bekleme
+static const uint32_t WEB_SEND_MS       = 20000;  // yanıt yazılırken ilerlemesiz bekleme
+static const int32_t  WEB_BODY_MAX      = 8192;   // JSON gövde (OTA hariç)
+static const uint16_t WEB_KEEPALIVE_MAX = 100;    // bağlantı başına istek
+static const int      WEB_RX_PER_POLL   = 16;     // poll başına bağlantı başı okuma (OTA hızı)
+static const uint8_t  WEB_STREAM_MAX    = 2;      // eşzamanlı akış (kalan yuvalar isteklere)
+static const size_t   WEB_STREAM_BACKLOG = 2048;  // akış başına gönderilmemiş veri sınırı
+static const size_t   WEB_CHUNK_MAX     = 1024;   // sendChunk çerçevesi (daha büyüğü bölünür)
+static const size_t   WEB_CHUNK_BACKLOG = 4096;   // parçalı yanıtta gönderilmemiş veri sınırı
+static const uint32_t WEB_CHUNK_STALL_MS = 3000;  // sıra doluyken ilerlemesiz bekleme (loop durur)
+
+enum WebUploadStatus : uint8_t { WU_START = 0, WU_WRITE, WU_END, WU_ABORTED };
+
+struct WebUpload {
+  uint8_t  status;       // WebUploadStatus
+  String   filename;
+  String   name;
+  uint8_t* buf;          // WU_WRITE: parça (handler dönene kadar geçerli)
+  size_t   currentSize;
+  size_t   totalSize;
+};
+
+// WC_STREAM: akış açık, gönderilecek veri yok (yalnızca kapanış izlenir)
+enum WebConnState : uint8_t { WC_FREE = 0, WC_HEAD, WC_BODY, WC_UPLOAD, WC_SEND, WC_STREAM };
+
+struct WebConn {
+  int         fd = -1;
+  uint8_t     state = WC_FREE;
+  bool        keepAlive = false;
+  bool        responded = false;
+  bool        headOnly = false;
+  bool        stream = false;   // beginStream: yanıt bitince WC_STREAM'e döner
+  bool        chunked = false;  // beginChunked: gövde sonu (0 parça) dispatch'te
+  bool        sendErr = false;  // handler içinde doğrudan yazım başarısız: yanıttan sonra kapat
+  uint16_t    reqs = 0;         // bu bağlantıdaki istek sayısı
+  int16_t     route = -1;
+  int32_t     bodyLeft = 0;
+  uint32_t    lastMs = 0;       // son ilerleme (okuma/yazma/yanıt sonu)
+  HttpReq     req;
+  String      body;
+  String      hdrs;             // sendHeader ile eklenen başlıklar
+  String      out;              // durum satırı + başlıklar (+ RAM gövdesi)
+  const char* outP = nullptr;   // send_P gövdesi (flash)
+  size_t      outPLen = 0;
+  size_t      outOff = 0;       // out + outP üzerindeki ilerleme
+};
+
+struct WebStats {
+  uint32_t accepted;
+  uint32_t requests;
+  uint32_t reused;        // keep-alive bağlantıda 2. ve sonraki istekler
+  uint32_t evicted;       // havuz dolu: boştaki keep-alive bağlantı kapatıldı
+  uint32_t timeouts;
+  uint32_t rejected;      // ayrıştırma hatası / 413 / meşgul
+  uint32_t notModified;   // 304 (ETag eşleşti)
+  uint32_t streams;       // açılan akış
+  uint32_t streamDrops;   // yavaş akış istemcisi kapatıldı
+  uint32_t bytesIn;
+  uint32_t bytesOut;
+  uint32_t handlerUsMax;
+  uint64_t handlerUsSum;
+  uint8_t  peak;          // eşzamanlı bağlantı
+};
+
+class WebSrv {
+ public:
+  typedef void (*Handler)();
+
+  explicit WebSrv(uint16_t port) : m_port(port) {}
+  ~WebSrv();
+
+  void collectHeaders(const char* const* names, uint8_t n);
+  void on(const char* path, uint8_t method, Handler fn, Handler upload = nullptr);
+  void onNotFound(Handler fn) { m_notFound = fn; }
+  bool begin();
+  // Hazır soketleri işle (bloklamaz)
+  void poll();
+  // Soket olayı ya da ms dolana kadar bekle (loop'un boşta beklemesi)
+  void wait(uint32_t ms);
+
+  // --- Aktif istek (handler içinden) ---
+  const char* uri() const { return m_cur ? m_cur->req.path : ""; }
+  String arg(const char* name);          // "plain" = gövde
+  bool   hasArg(const char* name);
+  String header(const char* name);
+  bool   hasHeader(const char* name);
+  // send'den önce: yanıta eklenecek başlık
+  void   sendHeader(const char* name, const char* value);
+  void   send(int code, const char* type, const String& body);
+  void   send(int code, const char* type, const char* body);
+  void   send_P(int code, const char* type, const char* pgm);
+  void   send_P(int code, const char* type, const char* pgm, size_t len);   // ikili (gzip)
+  // Parçalı yanıt (uzunluk bilinmeden): beginChunked + sendChunk...; sonu otomatik.
+  // sendChunk false: istemci almıyor, yanıt kesildi (handler üretmeyi bırakabilir)
+  bool   beginChunked(int code, const char* type);
+  bool   sendChunk(const char* data, size_t len);
+  WebUpload& upload() { return m_upload; }
+  // Akış (text/event-stream): yer yoksa / HEAD ise false (handler kendi yanıtını verir)
+  bool   beginStream(const char* type);
+  void   streamPrint(const String& s);                  // aktif akışa (handler içinden)
+  void   streamBroadcast(const char* s, size_t len);    // tüm açık akışlara (loop'tan)
+
+  uint8_t activeConns() const;
+  uint8_t streamCount() const;
+  WebStats st = {};
+
+ private:
+  struct Route {
+    const char* path;
+    uint8_t     method;
+    Handler     fn;
+    Handler     upload;
+  };
+
+  void accept1();
+  void readConn(WebConn& c);
+  void startRequest(WebConn& c);
+  void dispatch(WebConn& c);
+  void respondError(WebConn& c, int code);
+  bool beginResponse(int code, const char* type, size_t len);
+  void flush(WebConn& c);
+  void finish(WebConn& c);
+  void writeNow(WebConn& c, const char* p, size_t n);
+  bool drainOut(WebConn& c, size_t need);
+  void closeConn(WebConn& c);
+  void uploadEvent(WebConn& c, uint8_t status, const uint8_t* data, size_t len);
+  int  fillFdSets(fd_set& rd, fd_set& wr) const;
+  WebConn* evictable();
+  static bool mpEvent(HttpMultipart& m, HttpMpEvent ev, const uint8_t* data, size_t len, void* ctx);
+
+  uint16_t    m_port;
+  int         m_listen = -1;
+  Route       m_routes[WEB_ROUTE_MAX];
+  int         m_routeCount = 0;
+  Handler     m_notFound = nullptr;
+  const char* m_keep[HTTP_KEEP_MAX];
+  uint8_t     m_keepCount = 0;
+  WebConn     m_conns[WEB_CONN_MAX];
+  WebConn*    m_cur = nullptr;       // handler çalışırken aktif bağlantı
+  WebConn*    m_upConn = nullptr;    // multipart yükleme (aynı anda tek)
+  bool        m_upActive = false;    // dosya parçası açık (WU_START verildi)
+  HttpMultipart m_mp;
+  WebUpload   m_upload;
+  char        m_rx[1460];
+  char        m_tx[WEB_CHUNK_MAX + 12];   // parça çerçevesi: boyut satırı + veri + CRLF
+};
+
+WebSrv::~WebSrv() {
+  for (int i = 0; i < WEB_CONN_MAX; i++) closeConn(m_conns[i]);
+  if (m_listen >= 0) lwip_close(m_listen);
+}
+
+void WebSrv::collectHeaders(const char* const* names, uint8_t n) {
+  m_keepCount = 0;
+  for (uint8_t i = 0; i < n && m_keepCount < HTTP_KEEP_MAX; i++) m_keep[m_keepCount++] = names[i];
+}
+
+void WebSrv::on(const char* path, uint8_t method, Handler fn, Handler upload) {
+  if (m_routeCount >= WEB_ROUTE_MAX) {
+    Serial.printf("[WEB] Route tablosu dolu: %s\n", path);
+    return;
+  }
+  m_routes[m_routeCount++] = { path, method, fn, upload };
+}
+
+bool WebSrv::begin() {
+  m_listen = lwip_socket(AF_INET, SOCK_STREAM, 0);
+  if (m_listen < 0) {
+    Serial.println("[WEB] socket() basarisiz");
+    return false;
+  }
+  int one = 1;
+  lwip_setsockopt(m_listen, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+  struct sockaddr_in sa;
+  memset(&sa, 0, sizeof(sa));
+  sa.sin_family = AF_INET;
+  sa.sin_port = htons(m_port);
+  sa.sin_addr.s_addr = htonl(INADDR_ANY);
+  if (lwip_bind(m_listen, (struct sockaddr*)&sa, sizeof(sa)) < 0 || lwip_listen(m_listen, 4) < 0) {
+    Serial.printf("[WEB] bind/listen basarisiz (port %u)\n", (unsigned)m_port);
+    lwip_close(m_listen);
+    m_listen = -1;
+    return false;
+  }
+  lwip_fcntl(m_listen, F_SETFL, lwip_fcntl(m_listen, F_GETFL, 0) | O_NONBLOCK);
+  return true;
+}
+
+uint8_t WebSrv::activeConns() const {
+  uint8_t n = 0;
+  for (int i = 0; i < WEB_CONN_MAX; i++) if (m_conns[i].fd >= 0) n++;
+  return n;
+}
+
+uint8_t WebSrv::streamCount() const {
+  uint8_t n = 0;
+  for (int i = 0; i < WEB_CONN_MAX; i++) if (m_conns[i].fd >= 0 && m_conns[i].stream) n++;
+  return n;
+}
+
+// Havuz doluyken yeni bağlantıya yer: istek beklemeyen en eski keep-alive bağlantı
+WebConn* WebSrv::evictable() {
+  WebConn* best = nullptr;
+  for (int i = 0; i < WEB_CONN_MAX; i++) {
+    WebConn& c = m_conns[i];
+    if (c.fd < 0 || c.state != WC_HEAD || c.reqs == 0 || c.req.headBytes > 0) continue;
+    if (!best || (int32_t)(c.lastMs - best->lastMs) < 0) best = &c;
+  }
+  return best;
+}
+
+int WebSrv::fillFdSets(fd_set& rd, fd_set& wr) const {
+  FD_ZERO(&rd);
+  FD_ZERO(&wr);
+  int maxFd = -1;
+  bool room = false;
+  for (int i = 0; i < WEB_CONN_MAX; i++) {
+    const WebConn& c = m_conns[i];
+    if (c.fd < 0) { room = true; continue; }
+    if (c.state == WC_SEND) FD_SET(c.fd, &wr);
+    else FD_SET(c.fd, &rd);
+    if (c.fd > maxFd) maxFd = c.fd;
+    if (c.state == WC_HEAD && c.reqs > 0 && c.req.headBytes == 0) room = true;
+  }
+  // Yer yoksa dinleyici izlenmez: bağlantılar backlog'da bekler (boş dönen select yok)
+  if (m_listen >= 0 && room) {
+    FD_SET(m_listen, &rd);
+    if (m_listen > maxFd) maxFd = m_listen;
+  }
+  return maxFd;
+}
+
+void WebSrv::wait(uint32_t ms) {
+  fd_set rd, wr;
+  int maxFd = fillFdSets(rd, wr);
+  if (maxFd < 0) { delay(ms); return; }
+  struct timeval tv;
+  tv.tv_sec = ms / 1000;
+  tv.tv_usec = (ms % 1000) * 1000;
+  if (lwip_select(maxFd + 1, &rd, &wr, nullptr, &tv) < 0) delay(ms);
+}
+
+void WebSrv::poll() {
+  fd_set rd, wr;
+  int maxFd = fillFdSets(rd, wr);
+  if (maxFd < 0) return;
+  struct timeval tv = { 0, 0 };
+  int n = lwip_select(maxFd + 1, &rd, &wr, nullptr, &tv);
+
+  if (n > 0) {
+    if (m_listen >= 0 && FD_ISSET(m_listen, &rd)) accept1();
+    for (int i = 0; i < WEB_CONN_MAX; i++) {
+      WebConn& c = m_conns[i];
+      if (c.fd < 0) continue;
+      if (c.state == WC_SEND) {
+        if (FD_ISSET(c.fd, &wr)) flush(c);
+      } else if (FD_ISSET(c.fd, &rd)) {
+        readConn(c);
+      }
+    }
+  }
+
+  // İlerlemesiz bağlantılar
+  uint32_t now = millis();
+  for (int i = 0; i < WEB_CONN_MAX; i++) {
+    WebConn& c = m_conns[i];
+    if (c.fd < 0 || c.state == WC_STREAM) continue;   // akış: canlılığı loop'un nabzı sınar
+    uint32_t lim = (c.state == WC_SEND) ? WEB_SEND_MS
+                 : (c.state == WC_HEAD && c.req.headBytes == 0) ? WEB_IDLE_MS : WEB_REQ_MS;
+    if (now - c.lastMs > lim) {
+      if (c.state != WC_HEAD || c.req.headBytes > 0) st.timeouts++;
+      closeConn(c);
+    }
+  }
+}
+
+void WebSrv::accept1() {
+  WebConn* slot = nullptr;
+  for (int i = 0; i < WEB_CONN_MAX && !slot; i++) if (m_conns[i].fd < 0) slot = &m_conns[i];
+  if (!slot) {
+    slot = evictable();
+    if (!slot) return;
+    closeConn(*slot);
+    st.evicted++;
+  }
+
+  struct sockaddr_in sa;
+  socklen_t sl = sizeof(sa);
+  int fd = lwip_accept(m_listen, (struct sockaddr*)&sa, &sl);
+  if (fd < 0) return;
+
+  lwip_fcntl(fd, F_SETFL, lwip_fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+  int one = 1;
+  lwip_setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+  WebConn& c = *slot;
+  c.fd = fd;
+  c.state = WC_HEAD;
+  c.stream = false;
+  c.reqs = 0;
+  c.lastMs = millis();
+  httpReqInit(c.req, m_keep, m_keepCount);
+  st.accepted++;
+  uint8_t act = activeConns();
+  if (act > st.peak) st.peak = act;
+}
+
+void WebSrv::closeConn(WebConn& c) {
+  if (c.fd < 0) return;
+  if (m_upConn == &c) {
+    if (m_upActive) uploadEvent(c, WU_ABORTED, nullptr, 0);
+    m_upConn = nullptr;
+    m_upActive = false;
+  }
+  lwip_close(c.fd);
+  c.fd = -1;
+  c.state = WC_FREE;
+  c.stream = false;
+  c.body = String();
+  c.hdrs = String();
+  c.out = String();
+  c.outP = nullptr;
+}
+
+void WebSrv::readConn(WebConn& c) {
+  if (c.state == WC_STREAM) {
+    // Akışta istemciden veri beklenmez: gelen atılır, yalnızca kapanış önemli
+    int n = lwip_recv(c.fd, m_rx, sizeof(m_rx), MSG_DONTWAIT);
+    if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) closeConn(c);
+    return;
+  }
+  for (int rounds = 0; rounds < WEB_RX_PER_POLL && c.fd >= 0 && c.state != WC_SEND; rounds++) {
+    int n = lwip_recv(c.fd, m_rx, sizeof(m_rx), MSG_DONTWAIT);
+    if (n == 0) { closeConn(c); return; }          // karşı taraf kapattı
+    if (n < 0) {
+      if (errno != EAGAIN && errno != EWOULDBLOCK) closeConn(c);
+      return;
+    }
+    st.bytesIn += (uint32_t)n;
+    c.lastMs = millis();
+
+    size_t off = 0;
+    while (off < (size_t)n && c.fd >= 0 && c.state != WC_SEND) {
+      size_t left = (size_t)n - off;
+      if (c.state == WC_HEAD) {
+        off += httpReqFeed(c.req, m_rx + off, left);
+        if (c.req.error) {
+          static const int codes[] = { 400, 400, 414, 431, 501 };
+          respondError(c, codes[c.req.error]);
+          return;
+        }
+        if (c.req.done) startRequest(c);
+        continue;
+      }
+
+      size_t take = ((int32_t)left < c.bodyLeft) ? left : (size_t)c.bodyLeft;
+      if (c.state == WC_BODY) {
+        c.body.concat(m_rx + off, (unsigned)take);
+      } else if (!httpMpFeed(m_mp, (const uint8_t*)m_rx + off, take, mpEvent, this)) {
+        respondError(c, 400);   // bozuk multipart: yükleme iptal
+        return;
+      }
+      off += take;
+      c.bodyLeft -= (int32_t)take;
+      if (c.bodyLeft == 0) dispatch(c);
+    }
+
+    // Yanıt beklemeden gelen ikinci istek (pipelining): desteklenmiyor, yanıttan sonra kapat
+    if (off < (size_t)n && c.state == WC_SEND) c.keepAlive = false;
+    if ((size_t)n < sizeof(m_rx)) return;          // soket boşaldı
+  }
+}
+
+void WebSrv::startRequest(WebConn& c) {
+  c.reqs++;
+  st.requests++;
+  if (c.reqs > 1) st.reused++;
 
-static bool g_relayState = false;
-static bool g_manualOnLatched = false;
+  uint8_t m = c.req.method;
+  c.headOnly = (m == HTTPM_HEAD);
+  if (m == HTTPM_HEAD) m = HTTPM_GET;
+  c.route = -1;
+  for (int i = 0; i < m_routeCount; i++) {
+    if (m_routes[i].method == m && strcmp(m_routes[i].path, c.req.path) == 0) { c.route = (int16_t)i; break; }
+  }
+
+  c.bodyLeft = c.req.contentLength > 0 ? c.req.contentLength : 0;
+  c.body = String();
+
+  if (c.route >= 0 && m_routes[c.route].upload && httpMpInit(m_mp, c.req.contentType)) {
+    if (m_upConn && m_upConn != &c) { respondError(c, 409); return; }
+    m_upConn = &c;
+    m_upActive = false;
+    c.state = WC_UPLOAD;
+  } else if (c.bodyLeft > WEB_BODY_MAX) {
+    respondError(c, 413);
+    return;
+  } else if (c.bodyLeft > 0) {
+    c.body.reserve((unsigned)c.bodyLeft);
+    c.state = WC_BODY;
+  }
+  if (c.bodyLeft == 0) { dispatch(c); return; }
+  // curl vb. gövdeyi göndermeden önce ara yanıt bekler (yoksa ~1 sn gecikir)
+  if (c.req.expect100) lwip_send(c.fd, "HTTP/1.1 100 Continue\r\n\r\n", 25, MSG_DONTWAIT);
+}
+
+void WebSrv::uploadEvent(WebConn& c, uint8_t status, const uint8_t* data, size_t len) {
+  Handler fn = (c.route >= 0) ? m_routes[c.route].upload : nullptr;
+  if (!fn) return;
+  m_upload.status = status;
+  m_upload.buf = (uint8_t*)data;   // m_rx ya da m_mp.delim (ikisi de yazılabilir)
+  m_upload.currentSize = len;
+  WebConn* prev = m_cur;
+  m_cur = &c;
+  fn();
+  m_cur = prev;
+}
+
+bool WebSrv::mpEvent(HttpMultipart& m, HttpMpEvent ev, const uint8_t* data, size_t len, void* ctx) {
+  WebSrv* s = (WebSrv*)ctx;
+  WebConn& c = *s->m_upConn;
+  if (ev == HMP_PART_BEGIN) {
+    if (!m.filename[0]) return true;   // form alanı: WebServer gibi yalnızca dosyalar
+    s->m_upload.filename = m.filename;
+    s->m_upload.name = m.name;
+    s->m_upload.totalSize = 0;
+    s->m_upActive = true;
+    s->uploadEvent(c, WU_START, nullptr, 0);
+  } else if (ev == HMP_DATA && s->m_upActive) {
+    s->m_upload.totalSize += len;
+    s->uploadEvent(c, WU_WRITE, data, len);
+  } else if (ev == HMP_PART_END && s->m_upActive) {
+    s->m_upActive = false;
+    s->uploadEvent(c, WU_END, nullptr, 0);
+  }
+  return true;
+}
+
+void WebSrv::dispatch(WebConn& c) {
+  if (m_upConn == &c) {
+    if (m_upActive) uploadEvent(c, WU_ABORTED, nullptr, 0);   // kapanış sınırı gelmedi
+    m_upConn = nullptr;
+    m_upActive = false;
+  }
+
+  c.responded = false;
+  c.chunked = false;
+  c.sendErr = false;
+  c.keepAlive = c.req.keepAlive && c.reqs < WEB_KEEPALIVE_MAX;
+  c.hdrs = String();
+  m_cur = &c;
+  uint32_t t0 = micros();
+  if (c.route >= 0) m_routes[c.route].fn();
+  else if (m_notFound) m_notFound();
+  uint32_t dt = micros() - t0;
+  m_cur = nullptr;
+
+  st.handlerUsSum += dt;
+  if (dt > st.handlerUsMax) st.handlerUsMax = dt;
+  c.body = String();
+
+  if (!c.responded) {
+    m_cur = &c;
+    send(500, "text/plain", "no response");
+    m_cur = nullptr;
+  }
+  if (c.chunked && !c.headOnly) writeNow(c, "0\r\n\r\n", 5);   // son parça
+  c.chunked = false;
+  if (c.sendErr) { closeConn(c); return; }
+  flush(c);
+}
+
+void WebSrv::respondError(WebConn& c, int code) {
+  st.rejected++;
+  if (m_upConn == &c) {
+    if (m_upActive) uploadEvent(c, WU_ABORTED, nullptr, 0);
+    m_upConn = nullptr;
+    m_upActive = false;
+  }
+  c.keepAlive = false;   // okunmamış gövde/başlık kalmış olabilir
+  c.headOnly = false;
+  c.responded = false;
+  c.hdrs = String();
+  m_cur = &c;
+  send(code, "text/plain", httpStatusText(code));
+  m_cur = nullptr;
+  flush(c);
+}
+
+// Durum satırı + başlıklar. Dönüş: gövde gönderilecek mi (HEAD / 304 / 204 hayır)
+bool WebSrv::beginResponse(int code, const char* type, size_t len) {
+  WebConn& c = *m_cur;
+  const char* conn = c.keepAlive ? "Connection: keep-alive\r\nKeep-Alive: timeout=15" : "Connection: close";
+  bool noBody = (code == 304 || code == 204);
+  char h[192];
+  if (noBody) {
+    snprintf(h, sizeof(h), "HTTP/1.1 %d %s\r\n%s\r\n", code, httpStatusText(code), conn);
+  } else {
+    snprintf(h, sizeof(h), "HTTP/1.1 %d %s\r\nContent-Type: %s\r\nContent-Length: %u\r\n%s\r\n",
+             code, httpStatusText(code), type ? type : "text/plain", (unsigned)len, conn);
+  }
+  c.out = h;
+  c.out += c.hdrs;
+  c.out += "\r\n";
+  c.hdrs = String();
+  c.outP = nullptr;
+  c.outPLen = 0;
+  c.outOff = 0;
+  c.responded = true;
+  c.state = WC_SEND;
+  if (code == 304) st.notModified++;
+  return !noBody && !c.headOnly;
+}
+
+void WebSrv::sendHeader(const char* name, const char* value) {
+  if (!m_cur || m_cur->responded) return;
+  m_cur->hdrs += name;
+  m_cur->hdrs += ": ";
+  m_cur->hdrs += value;
+  m_cur->hdrs += "\r\n";
+}
+
+void WebSrv::send(int code, const char* type, const String& body) {
+  if (!m_cur || m_cur->responded) return;
+  if (beginResponse(code, type, body.length())) m_cur->out += body;
+}
+
+void WebSrv::send(int code, const char* type, const char* body) {
+  if (!m_cur || m_cur->responded) return;
+  if (!body) body = "";
+  if (beginResponse(code, type, strlen(body))) m_cur->out += body;
+}
+
+void WebSrv::send_P(int code, const char* type, const char* pgm) {
+  send_P(code, type, pgm, strlen_P(pgm));
+}
+
+void WebSrv::send_P(int code, const char* type, const char* pgm, size_t len) {
+  if (!m_cur || m_cur->responded) return;
+  if (beginResponse(code, type, len)) {
+    m_cur->outP = pgm;
+    m_cur->outPLen = len;
+  }
+}
+
+bool WebSrv::beginStream(const char* type) {
+  if (!m_cur || m_cur->responded || m_cur->headOnly) return false;
+  if (streamCount() >= WEB_STREAM_MAX) return false;
+  WebConn& c = *m_cur;
+  // Uzunluk yok: gövde bağlantı kapanınca biter
+  char h[160];
+  snprintf(h, sizeof(h), "HTTP/1.1 200 OK\r\nContent-Type: %s\r\nCache-Control: no-cache\r\nConnection: close\r\n", type);
+  c.out = h;
+  c.out += c.hdrs;
+  c.out += "\r\n";
+  c.hdrs = String();
+  c.outP = nullptr;
+  c.outPLen = 0;
+  c.outOff = 0;
+  c.keepAlive = false;
+  c.responded = true;
+  c.stream = true;
+  c.state = WC_SEND;
+  st.streams++;
+  return true;
+}
+
+bool WebSrv::beginChunked(int code, const char* type) {
+  if (!m_cur || m_cur->responded) return false;
+  WebConn& c = *m_cur;
+  // HTTP/1.0 chunked bilmez: gövde bağlantı kapanınca biter
+  bool framed = (c.req.minor >= 1);
+  if (!framed) c.keepAlive = false;
+  const char* conn = c.keepAlive ? "Connection: keep-alive\r\nKeep-Alive: timeout=15" : "Connection: close";
+  char h[192];
+  snprintf(h, sizeof(h), "HTTP/1.1 %d %s\r\nContent-Type: %s\r\n%s%s\r\n",
+           code, httpStatusText(code), type ? type : "text/plain",
+           framed ? "Transfer-Encoding: chunked\r\n" : "", conn);
+  c.out = String();
+  c.outP = nullptr;
+  c.outPLen = 0;
+  c.outOff = 0;
+  c.responded = true;
+  c.chunked = framed;
+  c.state = WC_SEND;
+  writeNow(c, h, strlen(h));
+  if (c.hdrs.length() > 0) writeNow(c, c.hdrs.c_str(), c.hdrs.length());
+  c.hdrs = String();
+  writeNow(c, "\r\n", 2);
+  return !c.headOnly;
+}
+
+bool WebSrv::sendChunk(const char* data, size_t len) {
+  if (!m_cur || !m_cur->responded || m_cur->headOnly) return false;
+  WebConn& c = *m_cur;
+  while (len > 0 && !c.sendErr) {
+    size_t n = (len < WEB_CHUNK_MAX) ? len : WEB_CHUNK_MAX;
+    if (!c.chunked) {
+      writeNow(c, data, n);
+    } else {
+      // Tek send: boyut satırı + veri + CRLF aynı segmentte (TCP_NODELAY)
+      int h = snprintf(m_tx, sizeof(m_tx), "%x\r\n", (unsigned)n);
+      memcpy(m_tx + h, data, n);
+      memcpy(m_tx + h + n, "\r\n", 2);
+      writeNow(c, m_tx, (size_t)h + n + 2);
+    }
+    data += n;
+    len -= n;
+  }
+  return !c.sendErr;
+}
+
+// Sırada need bayta yer açılana kadar soketi boşalt. Ilerlemesiz WEB_CHUNK_STALL_MS
+// geçerse false (sendErr: yanıt sonunda bağlantı kapatılır).
+bool WebSrv::drainOut(WebConn& c, size_t need) {
+  uint32_t t0 = millis();
+  for (;;) {
+    if (c.outOff > 0) {   // gönderilmiş kısmı at (tampon büyümesin)
+      c.out.remove(0, c.outOff);
+      c.outOff = 0;
+    }
+    size_t pend = c.out.length();
+    if (pend == 0 || pend + need <= WEB_CHUNK_BACKLOG) return true;
+    int w = lwip_send(c.fd, c.out.c_str(), pend, MSG_DONTWAIT);
+    if (w < 0) {
+      if (errno != EAGAIN && errno != EWOULDBLOCK) break;
+      w = 0;
+    }
+    if (w > 0) {
+      c.outOff = (size_t)w;
+      st.bytesOut += (uint32_t)w;
+      c.lastMs = t0 = millis();
+      continue;
+    }
+    uint32_t el = millis() - t0;
+    if (el >= WEB_CHUNK_STALL_MS) break;
+    fd_set wr;
+    FD_ZERO(&wr);
+    FD_SET(c.fd, &wr);
+    uint32_t ms = WEB_CHUNK_STALL_MS - el;
+    struct timeval tv = { (long)(ms / 1000), (long)((ms % 1000) * 1000) };
+    lwip_select(c.fd + 1, nullptr, &wr, nullptr, &tv);
+  }
+  st.timeouts++;
+  c.sendErr = true;
+  return false;
+}
+
+// Handler içinden: sıra yoksa doğrudan sokete, sığmayan kısım out'a (poll'da gider).
+// Sıra WEB_CHUNK_BACKLOG'u aşacaksa önce drainOut ile boşalmasını bekler.
+void WebSrv::writeNow(WebConn& c, const char* p, size_t n) {
+  if (c.sendErr || n == 0) return;
+  if (c.outOff > 0 && c.outOff == c.out.length()) {
+    c.out = String();
+    c.outOff = 0;
+  }
+  if (c.out.length() > 0 && !drainOut(c, n)) return;
+  if (c.out.length() == 0) {
+    int w = lwip_send(c.fd, p, n, MSG_DONTWAIT);
+    if (w < 0) {
+      if (errno != EAGAIN && errno != EWOULDBLOCK) { c.sendErr = true; return; }
+      w = 0;
+    }
+    st.bytesOut += (uint32_t)w;
+    c.lastMs = millis();
+    p += w;
+    n -= (size_t)w;
+    if (n == 0) return;
+  }
+  c.out.concat(p, (unsigned)n);
+}
+
+void WebSrv::streamPrint(const String& s) {
+  if (m_cur && m_cur->stream) m_cur->out += s;
+}
+
+void WebSrv::streamBroadcast(const char* s, size_t len) {
+  for (int i = 0; i < WEB_CONN_MAX; i++) {
+    WebConn& c = m_conns[i];
+    if (c.fd < 0 || !c.stream || &c == m_cur) continue;
+    if (c.out.length() - c.outOff + len > WEB_STREAM_BACKLOG) {
+      st.streamDrops++;
+      closeConn(c);
+      continue;
+    }
+    if (c.outOff > 0) {   // gönderilmiş kısmı at (tampon büyümesin)
+      c.out.remove(0, c.outOff);
+      c.outOff = 0;
+    }
+    c.out.concat(s, (unsigned)len);
+    c.state = WC_SEND;
+    flush(c);             // soket tamponu yetiyorsa hemen gider (loop bloklansa da)
+  }
+}
+
+void WebSrv::flush(WebConn& c) {
+  size_t headLen = c.out.length();
+  size_t total = headLen + c.outPLen;
+  while (c.outOff < total) {
+    const char* p;
+    size_t n;
+    if (c.outOff < headLen) { p = c.out.c_str() + c.outOff; n = headLen - c.outOff; }
+    else                    { p = c.outP + (c.outOff - headLen); n = total - c.outOff; }
+    int w = lwip_send(c.fd, p, n, MSG_DONTWAIT);
+    if (w < 0) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK) return;   // soket tamponu dolu: sonra
+      closeConn(c);
+      return;
+    }
+    c.outOff += (size_t)w;
+    st.bytesOut += (uint32_t)w;
+    c.lastMs = millis();
+  }
+  finish(c);
+}
+
+// Yanıt bitti: keep-alive ise aynı sokette sıradaki istek
+void WebSrv::finish(WebConn& c) {
+  if (c.stream) {
+    c.out = String();
+    c.outOff = 0;
+    c.state = WC_STREAM;
+    return;
+  }
+  if (!c.keepAlive) { closeConn(c); return; }
+  c.out = String();
+  c.outP = nullptr;
+  c.outPLen = 0;
+  c.outOff = 0;
+  c.state = WC_HEAD;
+  c.lastMs = millis();
+  httpReqInit(c.req, m_keep, m_keepCount);
+}
+
+String WebSrv::arg(const char* name) {
+  if (!m_cur) return String();
+  if (strcmp(name, "plain") == 0) return m_cur->body;
+  char v[HTTP_QUERY_MAX];
+  httpQueryArg(m_cur->req.query, name, v, sizeof(v));
+  return String(v);
+}
+
+bool WebSrv::hasArg(const char* name) {
+  if (!m_cur) return false;
+  if (strcmp(name, "plain") == 0) return m_cur->body.length() > 0;
+  char v[2];
+  return httpQueryArg(m_cur->req.query, name, v, sizeof(v));
+}
+
+String WebSrv::header(const char* name) {
+  const char* v = m_cur ? httpReqHeader(m_cur->req, name) : nullptr;
+  return String(v ? v : "");
+}
+
+bool WebSrv::hasHeader(const char* name) {
+  return m_cur && httpReqHeader(m_cur->req, name) != nullptr;
+}
+
+static WebSrv*  g_web = nullptr;
+static void webEventsTick();   // Canlı durum akışı (SSE)
+
+// Ezan API TLS client: g_ezClient (fetchAndStoreMonthly)
+
+// Röle durumu: setup'tan sonra sadece röle görevi yazar (bkz. "Röle görevi"), loop okur.
+// time_t alanları 64 bit: loop tarafı relayLoadTs() ile okur.
+static volatile bool g_relayState = false;
+static volatile bool g_manualOnLatched = false;
 
 // scheduled pencere aktifken /off verilirse, pencere bitene kadar OFF override
 static time_t g_manualOffUntilTs = 0;
@@ -622,15 +1902,14 @@ static uint32_t g_spYmd = 0;
 // özel gün yaklaşan bildirim (her pencere 1 kez)
 static time_t g_lastSpNotifyOnTs = 0;
 
-// ZORUNLU OFF: bir sonraki İmsak - SabahTolerans
+// ZORUNLU OFF: bir sonraki İmsak - SabahTolerans (loop kopyası, gösterim için;
+// tetikleme röle görevinde kendi planından yapılır)
 static time_t g_nextImsakOffTs = 0;
-static time_t g_lastImsakOffEventTs = 0;
 
 // (opsiyonel) zorunlu OFF sonrası kısa ON engeli
 static time_t g_blockOnUntilTs = 0;
 
-// Telegram polling + dedup
-static uint32_t g_lastTgPollMs = 0;
+// Telegram dedup
 static String   g_lastTgMsg = "";
 static uint32_t g_lastTgMsgMs = 0;
 
@@ -646,24 +1925,30 @@ static uint32_t g_lastUserActivityMs = 0;
 
 // ===== /guncelle güvenli worker =====
 static bool     g_updatePending = false;
-static bool     g_updateInProgress = false;
+static volatile bool g_updateInProgress = false;  // Telegram alım görevi de okur
 static uint32_t g_updateCooldownUntilMs = 0;
 static String   g_updateRequesterWho = "";
 
 // ===== Web OTA (dosya yukleme) =====
 // Upload esnasinda ag islerini hafifletmek (TG/HTTP) icin kullanilir.
-static bool     g_webOtaInProgress = false;
+static volatile bool g_webOtaInProgress = false;
 
 // NVS: Telegram last update_id
 static const char* NVS_KEY_TG_LAST = "tgLast"; // int64
 
 // ===== Telegram panel/menu state =====
 static int    g_panelMsgId = 0;  // panel mesaj id (edit için)
+static bool   g_panelForceNew = false;  // /start /menu /panel: diff yok, yeni panel mesajı
 static String g_mainBottom = ""; // ana menü alt bilgi alanı
 
 // UI işlemlerini (panel edit/gönder) Telegram callback içinde değil,
 // döngüde ayrı bir "worker" ile yapmak daha stabil (kitlenme riskini azaltır).
+// İstekler UI_REFRESH_COALESCE_MS içinde birleşir, iki çizim arası en az UI_REFRESH_MIN_GAP_MS.
 static bool   g_uiRefreshPending = false;
+static uint32_t g_uiRefreshReqMs = 0;
+static uint32_t g_uiLastRenderMs = 0;
+static const uint32_t UI_REFRESH_COALESCE_MS = 400;
+static const uint32_t UI_REFRESH_MIN_GAP_MS  = 1500;
 
 // Otomatik menü: her reboot / yeniden bağlantıda panel göster
 static bool     g_autoMenuPending = true;
@@ -783,15 +2068,34 @@ static bool saveNetToNvs(String* errOut = nullptr) {
   return true;
 }
 
+// İlçenin varsayılan koordinatı: yalnızca ILCE_ID_DEFAULT bilinir, diğerleri 0,0 (kapalı)
+static void ilceDefaultGeo(uint32_t id, int32_t& latE6, int32_t& lonE6) {
+  bool known = (id == ILCE_ID_DEFAULT);
+  latE6 = known ? ILCE_LAT_E6_DEFAULT : 0;
+  lonE6 = known ? ILCE_LON_E6_DEFAULT : 0;
+}
+
 static void loadIlceFromNvs() {
   uint32_t id = prefs.getUInt(NVS_KEY_ILCE, 9206);
   if (id < 1 || id > 999999) id = 9206;
   g_ilceId = id;
+
+  int32_t defLat, defLon;
+  ilceDefaultGeo(id, defLat, defLon);
+  g_latE6 = prefs.getInt(NVS_KEY_LAT, defLat);
+  g_lonE6 = prefs.getInt(NVS_KEY_LON, defLon);
+  // Önceki sürüm ilçe değişince Çankaya koordinatını da yazıyordu: başka ilçede geçersiz
+  if (id != ILCE_ID_DEFAULT && g_latE6 == ILCE_LAT_E6_DEFAULT && g_lonE6 == ILCE_LON_E6_DEFAULT) {
+    g_latE6 = 0; g_lonE6 = 0;
+  }
+  if (!prayerCoordValid(g_latE6, g_lonE6)) { g_latE6 = 0; g_lonE6 = 0; }  // hesap kapalı
 }
 static bool saveIlceToNvs(String* errOut = nullptr) {
   if (g_ilceId < 1 || g_ilceId > 999999) g_ilceId = 9206;
   size_t a = prefs.putUInt(NVS_KEY_ILCE, g_ilceId);
-  if (a == 0) {
+  size_t b = prefs.putInt(NVS_KEY_LAT, g_latE6);
+  size_t c = prefs.putInt(NVS_KEY_LON, g_lonE6);
+  if (a == 0 || b == 0 || c == 0) {
     if (errOut) *errOut = "nvs_write_fail";
     return false;
   }
@@ -812,6 +2116,7 @@ static bool saveHttpPortToNvs(uint16_t port, String* errOut = nullptr) {
     return false;
   }
   g_httpPort = (uint16_t)port;
+  stateBump();
   return true;
 }
 
@@ -929,34 +2234,378 @@ static void tgPrepare(uint16_t timeoutMs = 12000) {
     g_tgInsecureSet = true;
   }
   tgClient.setTimeout(timeoutMs);
-}
+  g_bot.setTimeout(timeoutMs);
+}
+
+// =====================
+// Telegram giden kutusu (outbox)
+// - tgSend / tgSendTo / logSerialAndTg sadece kuyruğa ekler; gönderim "tgTx" görevinde.
+// - Öncelik: komut cevapları OB_HIGH, bildirimler OB_NORMAL, WiFi deneme logları OB_LOW.
+//   Kuyruk doluysa en düşük öncelikli en eski mesaj düşer.
+// - Birleştirme: aynı sohbete OUTBOX_MERGE_MS içinde gelen bildirimler tek mesaj olur.
+// - Hız sınırı: mesajlar arası OUTBOX_MIN_GAP_MS, dakikada en fazla OUTBOX_WINDOW_MAX.
+// - Hata: üstel geri çekilme (2 sn .. 5 dk), OUTBOX_MAX_TRIES sonra düşer.
+// - Kalıcılık: SPIFFS /outbox.bin, boot'ta yüklenir. Yalnızca OUTBOX_PERSIST_PRIO ve üstü
+//   mesajlar yazılır (WiFi deneme logları RAM'de kalır). Flash aşınmasın diye dosya en sık
+//   OUTBOX_SAVE_MS'de bir yazılır; planlı restart'lar (outboxFlush) hemen yazar. Kalıcı
+//   mesaj kalmadıysa dosya beklemeden silinir (çökme sonrası aynı mesaj tekrar gitmesin).
+// - 'bot' + tgClient g_tgLock ile paylaşılır (loop: panel edit / callback ACK, görev: gönderim).
+// =====================
+enum TgOutPrio : uint8_t { OB_LOW = 0, OB_NORMAL = 1, OB_HIGH = 2 };
+
+static const int      OUTBOX_MAX           = 24;
+static const uint32_t OUTBOX_MERGE_MS      = 2000;
+static const unsigned OUTBOX_MERGE_MAX_LEN = 3500;    // Telegram sınırı 4096
+static const uint32_t OUTBOX_MIN_GAP_MS    = 1100;    // sohbet başına ~1 mesaj/sn
+static const uint32_t OUTBOX_WINDOW_MS     = 60000;
+static const int      OUTBOX_WINDOW_MAX    = 20;      // grup sohbeti: dakikada 20
+static const uint32_t OUTBOX_BACKOFF_MIN_MS = 2000;
+static const uint32_t OUTBOX_BACKOFF_MAX_MS = 300000;
+static const uint8_t  OUTBOX_MAX_TRIES     = 10;
+static const uint32_t OUTBOX_SAVE_MS       = 600000;  // 10 dk
+static const uint8_t  OUTBOX_PERSIST_PRIO  = OB_NORMAL;
+static const uint32_t TG_LOCK_WAIT_MS      = 15000;
+static const char*    OUTBOX_FILE          = "/outbox.bin";
+static const BaseType_t  TG_TX_TASK_CORE   = 0;
+static const UBaseType_t TG_TX_TASK_PRIO   = 1;
+static const uint32_t    TG_TX_TASK_STACK  = 8192;   // TLS el sıkışma
+static const uint32_t OUTBOX_MAGIC         = 0x3158424F;  // "OBX1"
+
+struct TgOutMsg {
+  uint32_t id;
+  uint32_t firstMs;   // kuyruğa giriş (birleştirme penceresi)
+  uint32_t readyMs;   // bu andan önce gönderilmez (birleştirme / geri çekilme)
+  uint8_t  prio;
+  uint8_t  tries;
+  bool     merge;
+  bool     inFlight;
+  String   chat;
+  String   text;
+};
 
-// =====================
-// Telegram send (dedup)
-// =====================
-static void tgSend(const String& msg, bool force = false) {
-  if (WiFi.status() != WL_CONNECTED) return;
+struct TgOutStats {
+  uint32_t queued;
+  uint32_t sent;
+  uint32_t merged;
+  uint32_t retries;
+  uint32_t dropped;   // kuyruk dolu / deneme sınırı
+  uint32_t saves;
+  uint32_t loaded;    // boot'ta dosyadan
+  uint32_t lastSendMs;
+};
 
-  uint32_t nowMs = millis();
-  if (!force) {
-    if (msg == g_lastTgMsg && (nowMs - g_lastTgMsgMs) < TG_DEDUP_MS) return;
+static TgOutMsg   g_ob[OUTBOX_MAX];
+static int        g_obCount = 0;
+static uint32_t   g_obSeq = 0;
+static bool       g_obDirty = false;
+static bool       g_obFsOk = false;
+static bool       g_obFileHas = false;   // /outbox.bin kayıt içeriyor
+static TgOutStats g_obStats = {};
+static uint32_t   g_obSendTimes[OUTBOX_WINDOW_MAX];  // son gönderimler (halka)
+static uint32_t   g_obSendIdx = 0;
+
+static SemaphoreHandle_t g_obLock = nullptr;   // g_ob + sayaçlar
+static SemaphoreHandle_t g_obWake = nullptr;   // yeni mesaj: görevi uyandır
+static TaskHandle_t      g_tgTxTask = nullptr;
+
+static void obRemoveAt(int i) {
+  for (int k = i; k < g_obCount - 1; k++) g_ob[k] = g_ob[k + 1];
+  g_obCount--;
+  g_ob[g_obCount].chat = String();
+  g_ob[g_obCount].text = String();
+}
+
+static int obFindId(uint32_t id) {
+  for (int i = 0; i < g_obCount; i++) if (g_ob[i].id == id) return i;
+  return -1;
+}
+
+static bool obEnqueue(const String& chat, const String& text, uint8_t prio, bool merge) {
+  if (chat.length() == 0 || text.length() == 0 || !g_obLock) return false;
+  xSemaphoreTake(g_obLock, portMAX_DELAY);
+  uint32_t now = millis();
+
+  if (merge) {
+    for (int i = g_obCount - 1; i >= 0; i--) {
+      TgOutMsg& m = g_ob[i];
+      if (!m.merge || m.inFlight || m.tries != 0 || m.prio != prio || m.chat != chat) continue;
+      if (now - m.firstMs >= OUTBOX_MERGE_MS) break;
+      if (m.text.length() + 1 + text.length() > OUTBOX_MERGE_MAX_LEN) break;
+      m.text += '\n';
+      m.text += text;
+      g_obStats.merged++;
+      if (prio >= OUTBOX_PERSIST_PRIO) g_obDirty = true;
+      xSemaphoreGive(g_obLock);
+      return true;
+    }
   }
 
-  tgPrepare();
-  bool ok = bot.sendMessage(g_activeChatId, msg, "");
-  if (ok) {
+  if (g_obCount >= OUTBOX_MAX) {
+    int victim = -1;
+    for (int i = 0; i < g_obCount; i++) {
+      if (g_ob[i].inFlight || g_ob[i].prio > prio) continue;
+      if (victim < 0 || g_ob[i].prio < g_ob[victim].prio) victim = i;
+    }
+    g_obStats.dropped++;
+    if (victim < 0) { xSemaphoreGive(g_obLock); return false; }
+    if (g_ob[victim].prio >= OUTBOX_PERSIST_PRIO) g_obDirty = true;
+    obRemoveAt(victim);
+  }
+
+  TgOutMsg& m = g_ob[g_obCount++];
+  m.id       = ++g_obSeq;
+  m.firstMs  = now;
+  m.readyMs  = merge ? now + OUTBOX_MERGE_MS : now;
+  m.prio     = prio;
+  m.tries    = 0;
+  m.merge    = merge;
+  m.inFlight = false;
+  m.chat     = chat;
+  m.text     = text;
+  g_obStats.queued++;
+  if (prio >= OUTBOX_PERSIST_PRIO) g_obDirty = true;
+  xSemaphoreGive(g_obLock);
+
+  if (g_obWake) xSemaphoreGive(g_obWake);
+  return true;
+}
+
+// ---- SPIFFS kalıcılık ----
+static void obPut8(uint8_t*& p, uint8_t v) { *p++ = v; }
+static void obPut16(uint8_t*& p, uint16_t v) { *p++ = (uint8_t)v; *p++ = (uint8_t)(v >> 8); }
+
+// Kilit altında çağrılır
+static int obPersistCount() {
+  int n = 0;
+  for (int i = 0; i < g_obCount; i++) if (g_ob[i].prio >= OUTBOX_PERSIST_PRIO) n++;
+  return n;
+}
+
+static void obSave() {
+  if (!g_obFsOk) return;
+  xSemaphoreTake(g_obLock, portMAX_DELAY);
+  g_obDirty = false;
+  int cnt = obPersistCount();
+  size_t need = 5;
+  for (int i = 0; i < g_obCount; i++) {
+    if (g_ob[i].prio >= OUTBOX_PERSIST_PRIO) need += 6 + g_ob[i].chat.length() + g_ob[i].text.length();
+  }
+  uint8_t* buf = (cnt > 0) ? (uint8_t*)malloc(need) : nullptr;
+  uint8_t* p = buf;
+  if (buf) {
+    obPut16(p, (uint16_t)OUTBOX_MAGIC); obPut16(p, (uint16_t)(OUTBOX_MAGIC >> 16));
+    obPut8(p, (uint8_t)cnt);
+    for (int i = 0; i < g_obCount; i++) {
+      const TgOutMsg& m = g_ob[i];
+      if (m.prio < OUTBOX_PERSIST_PRIO) continue;
+      uint8_t cl = (uint8_t)(m.chat.length() > 255 ? 255 : m.chat.length());
+      uint16_t tl = (uint16_t)m.text.length();
+      obPut8(p, m.prio); obPut8(p, m.tries); obPut8(p, m.merge ? 1 : 0);
+      obPut8(p, cl);  memcpy(p, m.chat.c_str(), cl); p += cl;
+      obPut16(p, tl); memcpy(p, m.text.c_str(), tl); p += tl;
+    }
+  }
+
+  // Dosya da kilit altında: loop (outboxFlush) ve görev aynı anda yazmasın
+  if (cnt == 0) {
+    if (SPIFFS.exists(OUTBOX_FILE)) SPIFFS.remove(OUTBOX_FILE);
+    g_obFileHas = false;
+  } else if (buf) {
+    File f = SPIFFS.open(OUTBOX_FILE, "w");
+    if (f) { f.write(buf, (size_t)(p - buf)); f.close(); g_obFileHas = true; }
+  }
+  if (buf) free(buf);
+  g_obStats.saves++;
+  xSemaphoreGive(g_obLock);
+}
+
+static void obLoad() {
+  if (!g_obFsOk || !SPIFFS.exists(OUTBOX_FILE)) return;
+  File f = SPIFFS.open(OUTBOX_FILE, "r");
+  if (!f) return;
+  size_t sz = f.size();
+  uint8_t* buf = (sz >= 5 && sz < 128 * 1024) ? (uint8_t*)malloc(sz) : nullptr;
+  if (!buf) { f.close(); return; }
+  size_t got = f.read(buf, sz);
+  f.close();
+
+  const uint8_t* p = buf;
+  const uint8_t* end = buf + got;
+  uint32_t magic = (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+  int n = (got >= 5 && magic == OUTBOX_MAGIC) ? p[4] : 0;
+  p += 5;
+  g_obFileHas = true;   // gönderilip boşalınca silinsin
+  uint32_t now = millis();
+  char tmp[256];
+  // Yarım yazılmış kayıt (güç kesintisi) -> o kayıttan sonrası atılır
+  for (int i = 0; i < n && g_obCount < OUTBOX_MAX; i++) {
+    if (end - p < 4) break;
+    uint8_t prio = p[0], tries = p[1], merge = p[2], cl = p[3];
+    p += 4;
+    if (end - p < cl + 2) break;
+    memcpy(tmp, p, cl); tmp[cl] = '\0'; p += cl;
+    uint16_t tl = (uint16_t)(p[0] | (p[1] << 8)); p += 2;
+    if (end - p < tl) break;
+
+    TgOutMsg& m = g_ob[g_obCount++];
+    m.id       = ++g_obSeq;
+    m.firstMs  = now;
+    m.readyMs  = now;
+    m.prio     = prio > OB_HIGH ? OB_NORMAL : prio;
+    m.tries    = tries;
+    m.merge    = merge != 0;
+    m.inFlight = false;
+    m.chat     = String(tmp);
+    m.text     = String();
+    m.text.reserve(tl);
+    for (uint16_t k = 0; k < tl; k++) m.text += (char)p[k];
+    p += tl;
+    g_obStats.loaded++;
+  }
+  free(buf);
+}
+
+// ---- Gönderim görevi ----
+// Bir mesaj gönderir ya da bir sonraki denemeye kadar bekleme süresini (ms) döndürür
+static uint32_t obStep() {
+  if (WiFi.status() != WL_CONNECTED || g_updateInProgress || g_webOtaInProgress) return 1000;
+
+  uint32_t now = millis();
+  // Hız sınırı: son gönderimden beri boşluk + son dakikadaki gönderim sayısı
+  if (g_obStats.lastSendMs != 0 && now - g_obStats.lastSendMs < OUTBOX_MIN_GAP_MS) {
+    return OUTBOX_MIN_GAP_MS - (now - g_obStats.lastSendMs);
+  }
+  uint32_t oldest = g_obSendTimes[g_obSendIdx % OUTBOX_WINDOW_MAX];
+  if (g_obSendIdx >= (uint32_t)OUTBOX_WINDOW_MAX && now - oldest < OUTBOX_WINDOW_MS) {
+    return OUTBOX_WINDOW_MS - (now - oldest);
+  }
+
+  xSemaphoreTake(g_obLock, portMAX_DELAY);
+  int best = -1;
+  uint32_t wait = 5000;
+  for (int i = 0; i < g_obCount; i++) {
+    const TgOutMsg& m = g_ob[i];
+    if (m.inFlight) continue;
+    int32_t d = (int32_t)(m.readyMs - now);
+    if (d > 0) { if ((uint32_t)d < wait) wait = (uint32_t)d; continue; }
+    if (best < 0 || m.prio > g_ob[best].prio) best = i;  // eşit öncelikte en eski (sıra)
+  }
+  if (best < 0) { xSemaphoreGive(g_obLock); return wait; }
+
+  TgOutMsg& m = g_ob[best];
+  m.inFlight = true;
+  uint32_t id = m.id;
+  bool persist = m.prio >= OUTBOX_PERSIST_PRIO;
+  String chat = m.chat;
+  String text = m.text;
+  xSemaphoreGive(g_obLock);
+
+  bool ok = false;
+  if (tgLockTake(TG_LOCK_WAIT_MS)) {
+    tgPrepare();
+    ok = g_bot.sendMessage(chat, text);
+    tgLockGive();
+  }
+
+  now = millis();
+  g_obStats.lastSendMs = now;
+  g_obSendTimes[g_obSendIdx++ % OUTBOX_WINDOW_MAX] = now;
+
+  xSemaphoreTake(g_obLock, portMAX_DELAY);
+  int i = obFindId(id);
+  if (i >= 0) {
+    TgOutMsg& r = g_ob[i];
+    r.inFlight = false;
+    if (ok) {
+      obRemoveAt(i);
+      g_obStats.sent++;
+    } else if (++r.tries >= OUTBOX_MAX_TRIES) {
+      obRemoveAt(i);
+      g_obStats.dropped++;
+    } else {
+      uint32_t back = OUTBOX_BACKOFF_MIN_MS << (r.tries - 1);
+      if (back > OUTBOX_BACKOFF_MAX_MS) back = OUTBOX_BACKOFF_MAX_MS;
+      r.readyMs = now + back;
+      g_obStats.retries++;
+    }
+    if (persist) g_obDirty = true;
+  }
+  xSemaphoreGive(g_obLock);
+  return 0;
+}
+
+static void tgTxTaskFn(void*) {
+  uint32_t lastSaveMs = millis();
+  for (;;) {
+    uint32_t waitMs = obStep();
+    if (g_obDirty) {
+      bool stale = false;   // dosyada artık gönderilmiş mesajlar var
+      if (g_obFileHas) {
+        xSemaphoreTake(g_obLock, portMAX_DELAY);
+        stale = obPersistCount() == 0;
+        xSemaphoreGive(g_obLock);
+      }
+      uint32_t since = millis() - lastSaveMs;
+      if (stale || since >= OUTBOX_SAVE_MS) {
+        obSave();
+        lastSaveMs = millis();
+      } else if (waitMs > OUTBOX_SAVE_MS - since) {
+        waitMs = OUTBOX_SAVE_MS - since;
+      }
+    }
+    if (waitMs > 0) xSemaphoreTake(g_obWake, pdMS_TO_TICKS(waitMs));
+  }
+}
+
+// Restart öncesi: kuyruk boşalana kadar (en fazla maxMs) bekle, kalanı dosyaya yaz
+static void outboxFlush(uint32_t maxMs) {
+  uint32_t t0 = millis();
+  while (g_obCount > 0 && g_tgTxTask && WiFi.status() == WL_CONNECTED && millis() - t0 < maxMs) delay(50);
+  if (g_obLock && g_obDirty) obSave();
+}
+
+// setup: kilitler + SPIFFS + bekleyen mesajlar (reinitBot'tan önce)
+static void outboxInit() {
+  g_obLock = xSemaphoreCreateMutex();
+  g_obWake = xSemaphoreCreateBinary();
+  g_tgLock = xSemaphoreCreateMutex();
+  g_obFsOk = SPIFFS.begin(true);
+  if (!g_obFsOk) Serial.println("[BOOT] SPIFFS acilamadi: outbox sadece RAM'de");
+  obLoad();
+  if (g_obCount > 0) {
+    Serial.print("[BOOT] Outbox: bekleyen mesaj "); Serial.println(g_obCount);
+  }
+}
+
+static void tgTxTaskStart() {
+  if (!g_obLock || !g_obWake || !g_tgLock) return;
+  if (xTaskCreatePinnedToCore(tgTxTaskFn, "tgTx", TG_TX_TASK_STACK, nullptr,
+                              TG_TX_TASK_PRIO, &g_tgTxTask, TG_TX_TASK_CORE) != pdPASS) {
+    g_tgTxTask = nullptr;
+    Serial.println("[BOOT] TG gonderim gorevi baslatilamadi!");
+  }
+}
+
+// =====================
+// Telegram send (dedup) -> outbox
+// =====================
+static void tgSend(const String& msg, bool force = false, uint8_t prio = OB_NORMAL) {
+  uint32_t nowMs = millis();
+  if (!force) {
+    if (msg == g_lastTgMsg && (nowMs - g_lastTgMsgMs) < TG_DEDUP_MS) return;
+  }
+  if (obEnqueue(g_activeChatId, msg, prio, true)) {
     g_lastTgMsg = msg;
     g_lastTgMsgMs = nowMs;
   }
 }
 
+// Komut cevabı: birleştirilmez, önce gider
 static bool tgSendTo(const String& cid, const String& msg) {
-  if (WiFi.status() != WL_CONNECTED) return false;
-  tgPrepare();
-  return bot.sendMessage(cid, msg, "");
+  return obEnqueue(cid, msg, OB_HIGH, false);
 }
 
-static void logSerialAndTg(const String& msg, bool notifyTg = true, bool forceTg = false) {
+static void logSerialAndTg(const String& msg, bool notifyTg = true, bool forceTg = false, uint8_t prio = OB_NORMAL) {
   String ts = nowStamp();
   // Tek allocasyon + reserve ile heap fragmantasyonu azalt
   String logLine;
@@ -967,17 +2616,20 @@ static void logSerialAndTg(const String& msg, bool notifyTg = true, bool forceTg
   logLine += msg;
 
   Serial.println(logLine);
-  if (notifyTg) tgSend(logLine, forceTg);
+  if (notifyTg) tgSend(logLine, forceTg, prio);
 }
 
 // =====================
 // Dış IP sorgu
 // =====================
+static NetTcpClient g_ipClient(NH_IPIFY, "ipify");
+
 static String fetchExternalIp() {
   if (WiFi.status() != WL_CONNECTED) return "";
   HTTPClient http;
   http.setTimeout(3000); // 3sn timeout (boot gecikmesini azalt)
-  http.begin("http://api.ipify.org");
+  g_ipClient.beginRequest();
+  http.begin(g_ipClient, "http://api.ipify.org/");
   int code = http.GET();
   String ip = "";
   if (code == 200) ip = http.getString();
@@ -991,6 +2643,7 @@ static String fetchExternalIp() {
 // =====================
 static void relayWrite(bool on) {
   g_relayState = on;
+  stateBump();
   if (RELAY_ACTIVE_LOW) digitalWrite(RELAY_PIN, on ? LOW : HIGH);
   else                  digitalWrite(RELAY_PIN, on ? HIGH : LOW);
 }
@@ -998,23 +2651,8 @@ static void relayWrite(bool on) {
 // =====================
 // Tarih/saat yardımcı
 // =====================
-static uint32_t ymdFromTm(const tm& t) {
-  return (uint32_t)(t.tm_year + 1900) * 10000u + (uint32_t)(t.tm_mon + 1) * 100u + (uint32_t)t.tm_mday;
-}
-
 static uint32_t ymdToday() {
-  time_t now = time(nullptr);
-  tm t{}; localtime_r(&now, &t);
-  return ymdFromTm(t);
-}
-
-static uint16_t hhmmToMin(const String& hhmm) {
-  if (hhmm.length() < 4) return 0;
-  int hh = hhmm.substring(0, 2).toInt();
-  int mm = hhmm.substring(3, 5).toInt();
-  if (hh < 0) hh = 0; if (hh > 23) hh = 23;
-  if (mm < 0) mm = 0; if (mm > 59) mm = 59;
-  return (uint16_t)(hh * 60 + mm);
+  return ymdFromEpoch(time(nullptr));
 }
 
 // Dakika -> "HH:MM" string
@@ -1024,111 +2662,95 @@ static String minToHhmm(uint16_t m) {
   return String(buf);
 }
 
-static uint32_t parseDateToYmd(const String& s) {
-  if (s.length() >= 10 && s.charAt(4) == '-' && s.charAt(7) == '-') {
-    int y = s.substring(0, 4).toInt();
-    int m = s.substring(5, 7).toInt();
-    int d = s.substring(8, 10).toInt();
-    return (uint32_t)y * 10000u + (uint32_t)m * 100u + (uint32_t)d;
-  }
-  if (s.length() >= 10 && s.charAt(2) == '.' && s.charAt(5) == '.') {
-    int d = s.substring(0, 2).toInt();
-    int m = s.substring(3, 5).toInt();
-    int y = s.substring(6, 10).toInt();
-    return (uint32_t)y * 10000u + (uint32_t)m * 100u + (uint32_t)d;
+// =====================
+// Cache yardımcı
+// =====================
+static void hijriCalFromCache() {
+  int8_t off = 0; uint16_t agree = 0, samples = 0;
+  if (!hijriCalibrate(g_days, g_dayApiCount, off, agree, samples)) return;
+  g_hijriCalAgree   = agree;
+  g_hijriCalSamples = samples;
+  if (off != g_hijriCalOff) {
+    g_hijriCalOff = off;
+    prefs.putChar(NVS_KEY_HCAL_OFF, off);
+    Serial.printf("[HICRI] kalibrasyon ofseti=%d (%u/%u gun uyumlu)\n", (int)off, (unsigned)agree, (unsigned)samples);
   }
-  return 0;
 }
 
-static time_t epochFromYmdAndMin(uint32_t ymd, uint16_t minutesFromMidnight) {
-  int year  = (int)(ymd / 10000u);
-  int month = (int)((ymd / 100u) % 100u);
-  int day   = (int)(ymd % 100u);
-
-  tm t{};
-  t.tm_year = year - 1900;
-  t.tm_mon  = month - 1;
-  t.tm_mday = day;
-  t.tm_hour = minutesFromMidnight / 60;
-  t.tm_min  = minutesFromMidnight % 60;
-  t.tm_sec  = 0;
-  return mktime(&t);
+static void dayIdxEnsure() {
+  if (!g_dayIdxDirty) return;
+  g_dayIdxDirty = false;
+  schedDayIndexBuild(g_days, g_dayCount, g_dayIdx);
+  if (g_dayCount > 0 && !g_dayIdx.contiguous) {
+    Serial.println("[DAYS] cache ardışık değil, binary search kullanılacak");
+  }
+  hijriCalFromCache();
 }
 
-static uint32_t addDaysYmd(uint32_t ymd, int deltaDays) {
-  int year  = (int)(ymd / 10000u);
-  int month = (int)((ymd / 100u) % 100u);
-  int day   = (int)(ymd % 100u);
+static int findIdx(uint32_t ymd) {
+  dayIdxEnsure();
+  return schedDayIndexFind(g_dayIdx, g_days, g_dayCount, ymd);
+}
+static bool apiHasYmd(uint32_t ymd) { int i = findIdx(ymd); return i >= 0 && i < (int)g_dayApiCount; }
 
-  tm t{};
-  t.tm_year = year - 1900;
-  t.tm_mon  = month - 1;
-  t.tm_mday = day;
-  t.tm_hour = 12; t.tm_min = 0; t.tm_sec = 0;
-  time_t e = mktime(&t) + (time_t)deltaDays * 86400;
-  tm out{}; localtime_r(&e, &out);
-  return ymdFromTm(out);
+// Hicri tarih: cache'te varsa API değeri, yoksa kalibre edilmiş çevrimdışı takvim
+static bool hijriForYmd(uint32_t ymd, int& dayOut, int& monIdxOut, int& yearOut) {
+  int i = findIdx(ymd);
+  if (i >= 0 && g_days[i].hDay > 0 && g_days[i].hMon >= 0) {
+    dayOut = g_days[i].hDay; monIdxOut = g_days[i].hMon; yearOut = g_days[i].hYear;
+    return true;
+  }
+  hijriFromDays(daysFromYmd(ymd) - g_hijriCalOff, yearOut, monIdxOut, dayOut);
+  return true;
 }
 
-// =====================
-// Cache yardımcı
-// =====================
-static int findIdx(uint32_t ymd) {
-  for (uint16_t i = 0; i < g_dayCount; i++) if (g_days[i].ymd == ymd) return (int)i;
-  return -1;
+static String hijriTextForYmd(uint32_t ymd) {
+  int d = 0, m = 0, y = 0;
+  hijriForYmd(ymd, d, m, y);
+  return String(d) + " " + hijriMonthName(m) + " " + String(y);
 }
-static bool hasYmd(uint32_t ymd) { return findIdx(ymd) >= 0; }
 
 static void sortDaysByYmd() {
-  if (g_dayCount < 2) return;
-  for (uint16_t i = 0; i < g_dayCount - 1; i++) {
-    for (uint16_t j = i + 1; j < g_dayCount; j++) {
-      if (g_days[j].ymd < g_days[i].ymd) {
-        DayTimes tmp = g_days[i];
-        g_days[i] = g_days[j];
-        g_days[j] = tmp;
-      }
-    }
-  }
+  schedSortDays(g_days, g_dayCount);
 }
 
 // =====================
-// Hicri parse + normalize month
+// Çevrimdışı vakit: API cache'i ASTRO_AHEAD_DAYS'ten kısa kaldıysa (API'ye ulaşılamıyor)
+// dünden itibaren eksik günler koordinattan hesaplanıp g_days sonuna eklenir.
+// Hesaplanan günler NVS'e yazılmaz; API'den yeni veri gelince atılır.
 // =====================
-static String normMonthKey(const String& in) {
-  String s = in;
-  s.trim();
-
-  s.replace("Ç", "C"); s.replace("ç", "c");
-  s.replace("Ğ", "G"); s.replace("ğ", "g");
-  s.replace("İ", "I"); s.replace("ı", "i");
-  s.replace("Ö", "O"); s.replace("ö", "o");
-  s.replace("Ş", "S"); s.replace("ş", "s");
-  s.replace("Ü", "U"); s.replace("ü", "u");
-
-  s.toLowerCase();
-  if (s == "recep") s = "receb";
-  if (s == "rebiyulevvel") s = "rebiulevvel";
-  return s;
-}
+static void daysFillAstro(time_t now) {
+  int32_t from = localDaysFromEpoch(now) - 1;  // dünkü akşam: bugünün penceresi için gerekli
+  uint16_t oldCount = g_dayCount;
+  g_dayCount = g_dayApiCount;                   // önceki hesaplananları at
 
-static bool parseHicri(const char* s, int& dayOut, String& monthOut, int& yearOut) {
-  if (!s || !*s) return false;
-  String h(s); h.trim();
+  int32_t apiEnd = (g_dayApiCount > 0) ? daysFromYmd(g_days[g_dayApiCount - 1].ymd) : (from - 1);
+  if (apiEnd >= from + 1 + ASTRO_AHEAD_DAYS || !prayerCoordValid(g_latE6, g_lonE6)) {
+    if (g_dayCount != oldCount) daysMarkDirty();
+    return;
+  }
 
-  int firstSp = h.indexOf(' ');
-  int lastSp  = h.lastIndexOf(' ');
-  if (firstSp < 0 || lastSp <= firstSp) return false;
+  // Yer aç: dünden eski API günleri artık gerekmiyor
+  uint16_t drop = 0;
+  while (drop < g_dayApiCount && daysFromYmd(g_days[drop].ymd) < from) drop++;
+  if (drop > 0) {
+    memmove(g_days, g_days + drop, (size_t)(g_dayApiCount - drop) * sizeof(DayTimes));
+    g_dayApiCount -= drop;
+    g_dayCount = g_dayApiCount;
+  }
 
-  dayOut = h.substring(0, firstSp).toInt();
-  monthOut = h.substring(firstSp + 1, lastSp);
-  monthOut.trim();
-  yearOut = h.substring(lastSp + 1).toInt();
+  int32_t day = (apiEnd >= from) ? apiEnd + 1 : from;
+  while (g_dayCount < MAX_DAYS) {
+    if (!prayerFillDay(g_days[g_dayCount], day, g_latE6, g_lonE6, g_hijriCalOff)) break;
+    g_dayCount++;
+    day++;
+  }
 
-  if (dayOut <= 0 || dayOut > 30) return false;
-  if (monthOut.length() == 0) return false;
-  if (yearOut <= 0) yearOut = 0;
-  return true;
+  if (g_dayCount != oldCount || drop > 0) {
+    Serial.printf("[ASTRO] %u gun hesaplandi (API: %u gun)\n",
+                  (unsigned)(g_dayCount - g_dayApiCount), (unsigned)g_dayApiCount);
+  }
+  daysMarkDirty();
 }
 
 // =====================
@@ -1204,8 +2826,49 @@ static bool delAdmin(int64_t id) {
 // =====================
 // NVS vakit verisi
 // =====================
+// v3 -> v4: eski kayıtlar g_days üzerine okunur, sondan başa genişletilip Hicri alanlar parse edilir
+static bool migrateTimesV3() {
+  uint16_t cnt = prefs.getUShort("dayCount", 0);
+  if (cnt == 0 || cnt > MAX_DAYS) return false;
+
+  size_t need = (size_t)cnt * sizeof(DayTimesV3);
+  static_assert(sizeof(DayTimesV3) <= sizeof(DayTimes), "v4 kaydı v3'ten küçük olamaz");
+  if (prefs.getBytes("daysBlob", g_days, need) != need) return false;
+
+  const uint8_t* raw = (const uint8_t*)g_days;
+  for (int i = (int)cnt - 1; i >= 0; i--) {
+    DayTimesV3 old;
+    memcpy(&old, raw + (size_t)i * sizeof(DayTimesV3), sizeof(old));
+    DayTimes& d = g_days[i];
+    d.ymd      = old.ymd;
+    d.imsakMin = old.imsakMin;
+    d.aksamMin = old.aksamMin;
+    old.hicriUzun[sizeof(old.hicriUzun) - 1] = '\0';
+    dayTimesSetHicri(d, old.hicriUzun);
+  }
+  g_dayCount = cnt;
+  g_dayApiCount = cnt;
+  return true;
+}
+
+static void saveTimesToNvs();
+
 static void loadTimesFromNvs() {
+  daysMarkDirty();
+  g_dayApiCount = 0;
+  g_lastUpdYmd = prefs.getUInt("lastUpdYmd", 0);
   uint8_t ver = prefs.getUChar("timesVer", 0);
+  if (ver == 3) {
+    if (migrateTimesV3()) {
+      uint32_t lastUpd = g_lastUpdYmd;
+      saveTimesToNvs();
+      prefs.putUInt("lastUpdYmd", lastUpd);  // migration güncelleme sayılmaz
+      g_lastUpdYmd = lastUpd;
+      Serial.println("[NVS] vakitler v3 -> v4 migrate edildi");
+      return;
+    }
+    g_dayCount = 0;
+  }
   if (ver != TIMES_VER) {
     prefs.remove("dayCount");
     prefs.remove("daysBlob");
@@ -1221,33 +2884,157 @@ static void loadTimesFromNvs() {
   size_t need = (size_t)g_dayCount * sizeof(DayTimes);
   size_t got  = prefs.getBytes("daysBlob", g_days, need);
   if (got != need) g_dayCount = 0;
+  g_dayApiCount = g_dayCount;
 }
 
 static void saveTimesToNvs() {
   prefs.putUChar("timesVer", TIMES_VER);
-  prefs.putUShort("dayCount", g_dayCount);
-  prefs.putBytes("daysBlob", g_days, (size_t)g_dayCount * sizeof(DayTimes));
-  if (isTimeValid()) prefs.putUInt("lastUpdYmd", ymdToday());
+  prefs.putUShort("dayCount", g_dayApiCount);
+  prefs.putBytes("daysBlob", g_days, (size_t)g_dayApiCount * sizeof(DayTimes));
+  if (isTimeValid()) {
+    g_lastUpdYmd = ymdToday();
+    prefs.putUInt("lastUpdYmd", g_lastUpdYmd);
+  }
 }
 
 // =====================
 // Telegram last_id (NVS)
 // =====================
+// g_tgDoneUpdateId (loop işledikçe ilerler) kalıcı kopyası
 static void tgLoadLastIdFromNvs() {
   int64_t last = prefs.getLong64(NVS_KEY_TG_LAST, 0);
   if (last > 0) {
-    bot.last_message_received = (long)last;
+    g_tgDoneUpdateId = (long)last;
     Serial.print("[BOOT] TG last_id loaded: ");
     Serial.println((long long)last);
   }
 }
 static void tgSaveLastIdToNvsIfNew() {
-  int64_t last = (int64_t)bot.last_message_received;
+  int64_t last = (int64_t)g_tgDoneUpdateId;
   if (last <= 0) return;
   int64_t cur = prefs.getLong64(NVS_KEY_TG_LAST, 0);
   if (last > cur) prefs.putLong64(NVS_KEY_TG_LAST, last);
 }
 
+// =====================
+// Telegram alım görevi (long polling)
+// - Kalıcı TLS bağlantısı üzerinde getUpdates(timeout=TG_LONGPOLL_SEC): sunucu yeni update
+//   gelene kadar bekletir, gelince hemen döner. Komut gecikmesi ~ ağ RTT; boşta 25 sn'de 1 istek.
+// - Gelen update'ler TgUpdate (sabit tampon) olarak değerle g_tgRxQ'ya; loop handleTelegram ile işler.
+//   Kuyruk TG_RX_QWAIT_MS içinde boşalmazsa ayrıştırma kesilir (soket okuması loop'u beklemez);
+//   offset kuyruğa giren son update'ten ilerler, kalanlar bir sonraki istekte yeniden gelir.
+// - İstek hata ile bitse de kuyruğa girenler için offset ilerletilir; loop ayrıca
+//   g_tgDoneUpdateId ile işlenmişleri atlar (aynı komut iki kez çalışmaz).
+// - Vakit güncellemesi / web OTA sırasında durur (aynı anda üç TLS oturumu olmasın).
+// =====================
+static const BaseType_t  TG_RX_TASK_CORE   = 0;     // ağ çekirdeği; loop/röle çekirdeği boş kalır
+static const UBaseType_t TG_RX_TASK_PRIO   = 1;
+static const uint32_t    TG_RX_TASK_STACK  = 8192;  // TLS el sıkışma
+static const int         TG_RX_QLEN        = TG_RX_LIMIT;
+static const int         TG_RX_PER_LOOP    = 4;     // loop turunda en fazla işlenen update
+static const uint32_t    TG_RX_RETRY_MS    = 3000;  // bağlantı/istek hatasında bekleme
+static const uint32_t    TG_RX_QWAIT_MS    = 200;   // kuyruk doluyken ayrıştırıcının beklemesi
+
+struct TgRxStats {
+  uint32_t polls;       // getUpdates istek sayısı
+  uint32_t updates;     // kuyruğa giren update
+  uint32_t errors;      // bağlantı / istek hatası
+  uint32_t reconnects;  // token değişimi ile yeniden kurulum
+  uint32_t qFull;       // kuyruk dolu: ayrıştırma kesildi
+  uint32_t lastPollMs;  // son isteğin süresi
+  uint32_t lastOkMs;    // son başarılı isteğin millis'i
+};
+
+static TaskHandle_t  g_tgRxTask = nullptr;
+static QueueHandle_t g_tgRxQ    = nullptr;
+static TgRxStats     g_tgRxStats = {};
+
+static NetTlsClient g_tgRxClient(NH_TELEGRAM, "tgRx");
+
+static TgBot g_tgRxBot(g_tgRxClient, "tgRx");
+
+// ctx: bool* (kuyruk doldu)
+static bool tgRxOnUpdate(const TgUpdate& u, void* ctx) {
+  if (xQueueSend(g_tgRxQ, &u, pdMS_TO_TICKS(TG_RX_QWAIT_MS)) != pdTRUE) {
+    *(bool*)ctx = true;
+    return false;
+  }
+  g_tgRxStats.updates++;
+  return true;
+}
+
+static void tgRxTaskFn(void*) {
+  NetTlsClient& client = g_tgRxClient;
+  TgBot& rx = g_tgRxBot;
+  uint32_t gen = 0;
+  bool first = true;
+  bool hasToken = false;
+  long lastId = 0;
+
+  client.setInsecure();
+  client.setHandshakeTimeout(10);
+  client.setTimeout((TG_LONGPOLL_SEC + 10) * 1000);
+
+  for (;;) {
+    if (WiFi.status() != WL_CONNECTED || g_updateInProgress || g_webOtaInProgress) {
+      vTaskDelay(pdMS_TO_TICKS(1000));
+      continue;
+    }
+
+    if (first || gen != g_tgRxGen) {
+      char tok[TG_TOKEN_MAX];
+      portENTER_CRITICAL(&g_tgRxMux);
+      memcpy(tok, g_tgRxToken, sizeof(tok));
+      gen = g_tgRxGen;
+      portEXIT_CRITICAL(&g_tgRxMux);
+
+      if (!first) { client.stop(); g_tgRxStats.reconnects++; }
+      rx.setToken(tok);
+      hasToken = tok[0] != '\0';
+      // İlk kurulumda NVS'teki id'den devam; yeni token = yeni bot, sıfırdan
+      lastId = first ? g_tgDoneUpdateId : 0;
+      first = false;
+    }
+    if (!hasToken) {
+      vTaskDelay(pdMS_TO_TICKS(TG_RX_RETRY_MS));
+      continue;
+    }
+
+    uint32_t t0 = millis();
+    bool qFull = false;
+    int n = rx.getUpdates(lastId + 1, TG_LONGPOLL_SEC, tgRxOnUpdate, &qFull);
+    g_tgRxStats.polls++;
+    g_tgRxStats.lastPollMs = millis() - t0;
+    // Kuyruğa girenler teslim edildi: istek hata ile bitse de tekrar istenmesin
+    if (rx.lastUpdateId() > lastId) lastId = rx.lastUpdateId();
+
+    if (qFull) {
+      // loop meşgul: yer açılınca kalanlar yeniden istenir (hata sayılmaz)
+      g_tgRxStats.qFull++;
+      while (uxQueueSpacesAvailable(g_tgRxQ) == 0) vTaskDelay(pdMS_TO_TICKS(TG_RX_QWAIT_MS));
+    } else if (n >= 0) {
+      g_tgRxStats.lastOkMs = millis();
+    } else {
+      // Bağlantı/istek hatası: sıcak döngüye girme
+      g_tgRxStats.errors++;
+      vTaskDelay(pdMS_TO_TICKS(TG_RX_RETRY_MS));
+    }
+  }
+}
+
+static void tgRxTaskStart() {
+  g_tgRxQ = xQueueCreate(TG_RX_QLEN, sizeof(TgUpdate));
+  if (!g_tgRxQ) {
+    Serial.println("[BOOT] TG kuyrugu olusturulamadi!");
+    return;
+  }
+  if (xTaskCreatePinnedToCore(tgRxTaskFn, "tgRx", TG_RX_TASK_STACK, nullptr,
+                              TG_RX_TASK_PRIO, &g_tgRxTask, TG_RX_TASK_CORE) != pdPASS) {
+    g_tgRxTask = nullptr;
+    Serial.println("[BOOT] TG alim gorevi baslatilamadi!");
+  }
+}
+
 // =====================
 // Aktif chat (panel hedefi) NVS
 // =====================
@@ -1268,223 +3055,760 @@ static bool isActiveChatId(const String& cid) {
 }
 
 // =====================
-// HTTP: tüm payload al (global TLS client)
-// =====================
-static bool httpGetPayload(const String& url, String& payloadOut, int& httpCodeOut) {
-  if (WiFi.status() != WL_CONNECTED) return false;
-
-  // Lokal TLS client kullanarak global Telegram client ile çakışma riskini engelle
-  WiFiClientSecure localClient;
-  localClient.setInsecure();
-
-  HTTPClient http;
-  http.setTimeout(25000);
-  http.setReuse(false);
-  http.useHTTP10(true);
-
-  if (!http.begin(localClient, url)) return false;
+// 30 günlük vakit indir + NVS'e kaydet
+// - Yanıt String'e alınmaz: soketten 512 baytlık parçalarla akış ayrıştırıcısına
+//   (include/ezan_stream.h) beslenir, her kayıt ara tabloya DayTimes olarak yazılır.
+// - Ara tablo (MAX_DAYS kayıt) sadece yanıt eksiksiz gelirse g_days'e kopyalanır;
+//   kesik bağlantıda eski cache bozulmaz.
+// =====================
+static const size_t   EZAN_RD_CHUNK      = 512;
+static const uint32_t EZAN_RD_TIMEOUT_MS = 25000;
+
+struct EzanFetchStats {
+  uint32_t fetches;
+  uint32_t fails;
+  int      lastCode;
+  uint32_t lastBytes;
+  uint16_t lastRecords;
+  uint16_t lastDays;
+  uint32_t lastMs;
+  uint32_t lastHeapMin;  // indirme sırasında görülen en düşük boş heap
+};
+static EzanFetchStats g_ezStats = {};
 
-  httpCodeOut = http.GET();
-  if (httpCodeOut != 200) { http.end(); return false; }
+struct EzanFetchCtx {
+  DayTimes* days;
+  uint16_t  n;
+};
 
-  payloadOut = http.getString();
-  http.end();
+static NetTlsClient g_ezClient(NH_EZAN, "ezan");
 
-  yield();
-  return payloadOut.length() > 0;
+static bool ezanOnRecord(const EzanRecord& rec, void* ctx) {
+  EzanFetchCtx* c = (EzanFetchCtx*)ctx;
+  if (c->n >= MAX_DAYS) return true;  // fazlası atlanır (eskisi gibi)
+  if (ezanRecordToDay(rec, c->days[c->n])) c->n++;
+  return true;
 }
 
-// =====================
-// 30 günlük vakit indir + NVS'e kaydet
-// =====================
 static bool fetchAndStoreMonthly(bool notifyTg = true) {
   if (WiFi.status() != WL_CONNECTED) return false;
 
   String url = String(EZAN_API) + "/vakitler/" + String(g_ilceId);
+  uint32_t t0 = millis();
+  g_ezStats.fetches++;
+  g_ezStats.lastHeapMin = ESP.getFreeHeap();
 
-  int code = 0;
-  String payload;
-  if (!httpGetPayload(url, payload, code)) {
-    logSerialAndTg("❌ Vakit cekme FAIL (HTTP) code=" + String(code), notifyTg, true);
-    return false;
+  // Ayrı TLS client: Telegram soketleriyle çakışmaz. HTTP/1.0 -> sunucu yanıttan sonra
+  // kapatır; kalıcı nesne yine de DNS önbelleği ve sayaçlar için havuzda.
+  static bool tlsSet = false;
+  if (!tlsSet) {
+    g_ezClient.setInsecure();
+    g_ezClient.setHandshakeTimeout(10);
+    tlsSet = true;
   }
 
-  StaticJsonDocument<384> filter;
-  filter[0]["MiladiTarihUzunIso8601"] = true;
-  filter[0]["MiladiTarihKisa"]        = true;
-  filter[0]["MiladiTarihKisaIso8601"] = true;
-  filter[0]["Imsak"]                  = true;
-  filter[0]["Aksam"]                  = true;
-  filter[0]["HicriTarihUzun"]         = true;
+  HTTPClient http;
+  http.setTimeout(25000);
+  http.setReuse(false);
+  http.useHTTP10(true);  // chunked değil: gövde doğrudan soketten okunur
 
-  PsramJsonDocument doc(64 * 1024); // PSRAM'da allocate (ana heap'i korur)
-  if (doc.capacity() == 0) {
-    logSerialAndTg("❌ JSON buffer alloc FAIL (heap yetersiz). Free=" + String((int)ESP.getFreeHeap()), notifyTg, true);
+  int code = 0;
+  g_ezClient.beginRequest();
+  if (http.begin(g_ezClient, url)) code = http.GET();
+  g_ezStats.lastCode = code;
+  if (code != 200) {
+    http.end();
+    g_ezStats.fails++;
+    logSerialAndTg("❌ Vakit cekme FAIL (HTTP) code=" + String(code), notifyTg, true);
     return false;
   }
-  DeserializationError err = deserializeJson(doc, payload, DeserializationOption::Filter(filter));
-  if (err) {
-    logSerialAndTg(String("❌ JSON parse error: ") + err.c_str(), notifyTg, true);
+
+  DayTimes* stage = (DayTimes*)malloc((size_t)MAX_DAYS * sizeof(DayTimes));
+  if (!stage) {
+    http.end();
+    g_ezStats.fails++;
+    logSerialAndTg("❌ Vakit tablosu alloc FAIL. Free=" + String((int)ESP.getFreeHeap()), notifyTg, true);
     return false;
   }
 
-  JsonArray arr = doc.as<JsonArray>();
-  uint16_t n = 0;
-
-  for (JsonObject o : arr) {
-    if (n >= MAX_DAYS) break;
+  EzanStreamParser parser;
+  ezanStreamInit(parser);
+  EzanFetchCtx ctx = { stage, 0 };
 
-    String s = String((const char*)(o["MiladiTarihUzunIso8601"] | ""));
-    if (s.length() == 0) s = String((const char*)(o["MiladiTarihKisa"] | ""));
-    if (s.length() == 0) s = String((const char*)(o["MiladiTarihKisaIso8601"] | ""));
+  WiFiClient* stream = http.getStreamPtr();
+  int left = http.getSize();  // -1: Content-Length yok, bağlantı kapanana kadar
+  uint8_t buf[EZAN_RD_CHUNK];
+  uint32_t lastData = millis();
+  bool feedOk = true;
 
-    uint32_t ymd = parseDateToYmd(s);
-    if (ymd == 0) continue;
-
-    String imsak = String((const char*)(o["Imsak"] | ""));
-    String aksam = String((const char*)(o["Aksam"] | ""));
-    if (imsak.length() < 4 || aksam.length() < 4) continue;
-
-    String hicri = String((const char*)(o["HicriTarihUzun"] | ""));
-    hicri.trim();
+  while (stream && http.connected() && (left > 0 || left == -1) && !parser.done) {
+    size_t avail = stream->available();
+    if (avail == 0) {
+      if (millis() - lastData > EZAN_RD_TIMEOUT_MS) break;
+      delay(2);
+      continue;
+    }
+    if (avail > sizeof(buf)) avail = sizeof(buf);
+    int r = stream->readBytes(buf, avail);
+    if (r <= 0) continue;
+    lastData = millis();
+    if (left > 0) left -= r;
+    feedOk = ezanStreamFeed(parser, (const char*)buf, (size_t)r, ezanOnRecord, &ctx);
+    if (!feedOk) break;
+
+    uint32_t fh = ESP.getFreeHeap();
+    if (fh < g_ezStats.lastHeapMin) g_ezStats.lastHeapMin = fh;
+    yield();
+  }
+  http.end();
 
-    g_days[n].ymd      = ymd;
-    g_days[n].imsakMin = hhmmToMin(imsak);
-    g_days[n].aksamMin = hhmmToMin(aksam);
-    memset(g_days[n].hicriUzun, 0, sizeof(g_days[n].hicriUzun));
-    if (hicri.length() > 0) strncpy(g_days[n].hicriUzun, hicri.c_str(), sizeof(g_days[n].hicriUzun) - 1);
+  g_ezStats.lastBytes   = parser.bytes;
+  g_ezStats.lastRecords = parser.records;
+  g_ezStats.lastDays    = ctx.n;
+  g_ezStats.lastMs      = millis() - t0;
 
-    n++;
-    if ((n & 0x03) == 0) yield();
+  if (!ezanStreamComplete(parser)) {
+    free(stage);
+    g_ezStats.fails++;
+    logSerialAndTg(String("❌ Vakit JSON ") + (feedOk ? "eksik geldi" : "parse error") +
+                   " (bayt=" + String(parser.bytes) + ", kayit=" + String(parser.records) + ")", notifyTg, true);
+    return false;
   }
 
+  uint16_t n = ctx.n;
   if (n < 10) {
+    free(stage);
+    g_ezStats.fails++;
     logSerialAndTg("❌ Vakitler az geldi! n=" + String(n), notifyTg, true);
     return false;
   }
 
+  memcpy(g_days, stage, (size_t)n * sizeof(DayTimes));
+  free(stage);
+
   g_dayCount = n;
+  g_dayApiCount = n;
   sortDaysByYmd();
+  daysMarkDirty();
   saveTimesToNvs();
 
   logSerialAndTg("✅ Vakitler guncellendi. gunSayisi=" + String(g_dayCount), notifyTg, true);
   return true;
 }
 
+// =====================
+// Çizelge zaman çizelgesi (timeline)
+// - Cache yenilenince / ayar değişince bir kez kurulur (g_tlDirty).
+// - Tüm g_days ufku için sıralı ON/OFF geçiş dizisi (neden kodu ile).
+// - Loop ve durum çıktıları pencereleri yeniden türetmek yerine
+//   binary search ile bu diziden okur.
+// - Pencere hesapları: include/schedule_engine.h (host'ta da derlenir)
+// =====================
+static const int TL_MAX = SCHED_TL_MAX;
+static SchedTransition g_tl[TL_MAX];
+static uint16_t g_tlCount = 0;
+
+// Kural tablosu (schedule_engine.h SchedRule): ayarlardan varsayılan set
+// (zorunlu OFF, Perşembe->Cuma, aktif özel günler, Ramazan). Timeline ile birlikte derlenir:
+// - g_dayMask[i]: g_days[i] olay günü olan kuralların bitleri
+// - g_iv: birleşik ON aralıkları; röle görevine plan olarak gönderilir (relayPlanPublish)
+static SchedRule g_rules[SCHED_RULE_MAX];
+static int       g_ruleCount = 0;
+static uint32_t  g_dayMask[MAX_DAYS];
+static SchedInterval g_iv[SCHED_IV_MAX];
+static uint16_t  g_ivCount = 0;
+
+static SchedInput schedInputFromGlobals() {
+  SchedInput in{};
+  dayIdxEnsure();
+  in.days         = g_days;
+  in.dayCount     = g_dayCount;
+  in.dayIdx       = &g_dayIdx;
+  in.spOv         = g_spOv;
+  in.spEnableMask = g_spEnableMask;
+  in.ramazanAll   = g_enableRamazanAll;
+  in.onOffsetSec  = g_onOffsetSec;
+  in.offOffsetSec = g_offOffsetSec;
+  return in;
+}
+
+static void relayPlanPublish();
+
+static void tlRebuild() {
+  g_tlDirty = false;
+  g_sched.tlBuildCnt++;
+  SchedInput in = schedInputFromGlobals();
+  g_ruleCount = schedDefaultRules(in, g_rules, SCHED_RULE_MAX);
+  schedRuleDayMasks(in, g_rules, g_ruleCount, g_dayMask);
+  bool tlFull = false, ivFull = false;
+  g_tlCount = schedBuildTimeline(in, g_rules, g_ruleCount, g_dayMask, g_tl, (uint16_t)TL_MAX, &tlFull);
+  g_ivCount = schedBuildIntervals(g_tl, g_tlCount, g_iv, (uint16_t)SCHED_IV_MAX, &ivFull);
+  if (tlFull || ivFull) {
+    // Eksik plan röleye gitmez: görev önceki planla devam eder (ufkun sonu eksik kalsa da
+    // yarım pencere/kayıp OFF çalıştırılmaz)
+    g_sched.tlOverflow++;
+    logSys(String("Cizelge tablosu dolu (") + (tlFull ? "kenar" : "aralik") + "), plan yayinlanmadi");
+    return;
+  }
+  relayPlanPublish();
+}
+
+static void tlEnsure() {
+  if (g_tlDirty && isTimeValid()) tlRebuild();
+}
+
+// Kurallara göre now'da ON olunması gereken birleşik aralık (yoksa -1)
+static int ivFindActive(time_t now) {
+  tlEnsure();
+  return schedIntervalAt(g_iv, g_ivCount, now);
+}
+
+// ts > now olan ilk geçişin indeksi (yoksa g_tlCount)
+static int tlUpperBound(time_t now) {
+  return schedUpperBound(g_tl, g_tlCount, now);
+}
+
+// reasonMask'a uyan, now'dan sonra biten ilk pencerenin OFF kenarı (aktif ya da sıradaki)
+static int tlFindWindowEnd(time_t now, uint8_t reasonMask) {
+  tlEnsure();
+  return schedFindWindowEnd(g_tl, g_tlCount, now, reasonMask);
+}
+
 // =====================
 // Otomatik Perşembe->Cuma penceresi
 // =====================
 static bool computeThuFriWindowForNow(time_t now, time_t& onTs, time_t& offTs) {
   if (!isTimeValid() || g_dayCount == 0) return false;
+  int i = tlFindWindowEnd(now, SRM_THU_FRI);
+  if (i < 0) return false;
+  onTs  = g_tl[i].peer;
+  offTs = g_tl[i].ts;
+  return true;
+}
 
-  tm nt{}; localtime_r(&now, &nt);
-  const int THU = 4;
-  int deltaToLastThu = (nt.tm_wday - THU + 7) % 7;
+// =====================
+// ZORUNLU OFF: bir sonraki imsak - SabahTolerans
+// =====================
+static bool computeNextImsakOff(time_t now, time_t& nextOffTs) {
+  if (!isTimeValid() || g_dayCount == 0) return false;
+  int i = tlFindWindowEnd(now, SRM_IMSAK_OFF);
+  if (i < 0) return false;
+  nextOffTs = g_tl[i].ts;
+  return true;
+}
 
-  tm base = nt;
-  base.tm_hour = 12; base.tm_min = 0; base.tm_sec = 0;
-  time_t baseNoon = mktime(&base);
-  time_t thuNoon  = baseNoon - (time_t)deltaToLastThu * 86400;
+static void getScheduleState(time_t now, bool& thuOn, bool& spOn, time_t& schedOffMax) {
+  thuOn = false; spOn = false;
+  schedOffMax = 0;
 
-  tm thuTm{}; localtime_r(&thuNoon, &thuTm);
+  int k = ivFindActive(now);
+  if (k < 0) return;
+  schedOffMax = g_iv[k].off;  // birleşik pencerenin sonu (manuel OFF bu ana kadar sürer)
+
+  int it = tlFindWindowEnd(now, SRM_THU_FRI);
+  thuOn = (it >= 0 && g_tl[it].peer <= now);
+  int is = tlFindWindowEnd(now, SRM_DINI);
+  spOn = (is >= 0 && g_tl[is].peer <= now);
+}
+
+// due = en yakın ts (0 = yok)
+static void schedDueMin(time_t& due, time_t ts) {
+  if (ts != 0 && (due == 0 || ts < due)) due = ts;
+}
+
+// =====================
+// Röle görevi (FreeRTOS)
+// - Röle kararı + zorunlu OFF, loop'tan yüksek öncelikli ayrı task'ta (loop ile aynı çekirdek:
+//   task uyanınca loop'u hemen keser). HTTP indirme (25 sn timeout), Telegram TLS, WiFi scan
+//   loop'u ne kadar bekletirse bekletsin geçiş gecikmesi en fazla RELAY_TASK_TICK_MS.
+// - Bir sonraki kenar (aralık ON/OFF, zorunlu OFF, manuel OFF / blok bitişi) tek atımlık
+//   esp_timer ile kurulur; callback röleyi doğrudan yazar ve task'ı uyandırır. Her geçişte
+//   planlanan an, gerçek an ve gecikme kaydedilir (/api/system "relayTask.latency").
+// - Röle durumu g_relayLock altında değişir (task adımı, komutlar, timer callback). esp_timer
+//   görevi ortak: callback kilidi RELAY_CB_LOCK_MS içinde alamazsa yalnızca task'ı uyandırır,
+//   geçişi task yapar (diğer timer'lar röle kilidini beklemez).
+// - Kuyruk/kilit/görev kurulamazsa (bellek) karar eski yoldan loop'ta sürer (g_relayInline):
+//   röle çizelgeyi ve manuel komutları izlemeye devam eder, gecikme loop turuna bağlı.
+// - loop -> task: g_relayPlanQ (derlenmiş aralıklar + zorunlu OFF anları, tek elemanlı posta kutusu)
+//                 g_relayCmdQ  (manuel ON/OFF, plan bildirimi); cevap g_relayReplyQ
+// - task -> loop: g_relayEvtQ  (log / Telegram bildirimi; loop boşaltır)
+// - Task kendi TWDT aboneliğiyle beslenir; takılırsa loop'tan bağımsız reset.
+// =====================
+#ifndef ARDUINO_RUNNING_CORE
+#define ARDUINO_RUNNING_CORE 1
+#endif
+static const BaseType_t RELAY_TASK_CORE     = ARDUINO_RUNNING_CORE;
+static const UBaseType_t RELAY_TASK_PRIO    = 3;     // loopTask=1
+static const uint32_t   RELAY_TASK_STACK    = 4096;
+static const uint32_t   RELAY_TASK_TICK_MS  = 250;   // komut yoksa karar periyodu
+static const uint32_t   RELAY_CMD_WAIT_MS   = 2000;  // loop'un cevap bekleme sınırı
+static const int        RELAY_EVT_QLEN      = 16;
+static const int64_t    RELAY_EDGE_EARLY_US = 20000; // callback bu kadar erken gelirse kenar sayılır
+static const int        RELAY_LAT_N         = 64;    // gecikme halka tamponu (persentil)
+static const int        RELAY_LAT_RECENT    = 8;     // /api/system'de listelenen son geçişler
+static const uint32_t   RELAY_CB_LOCK_MS    = 2;     // timer callback'in kilit bekleme sınırı
+
+// Plan: loop'ta tlRebuild sonrası kopyalanır, task kendi kopyası üzerinden karar verir
+struct RelayPlan {
+  uint32_t      version;
+  uint16_t      ivCount;
+  uint16_t      offCount;
+  SchedInterval iv[SCHED_IV_MAX];
+  time_t        offTs[MAX_DAYS];  // zorunlu OFF anları (artan)
+};
 
-  uint32_t ymdThu = ymdFromTm(thuTm);
-  uint32_t ymdFri = addDaysYmd(ymdThu, +1);
+enum RelayCmdType : uint8_t { RC_PLAN = 1, RC_MANUAL_ON = 2, RC_MANUAL_OFF = 3, RC_TIMER = 4 };
+struct RelayCmd   { uint32_t seq; uint8_t type; time_t untilTs; };
+struct RelayReply { uint32_t seq; int8_t rc; };
+
+enum RelayEvtType : uint8_t { RE_SWITCH = 1, RE_FORCED_OFF = 2 };
+struct RelayEvt { uint8_t type; uint8_t on; uint8_t wasOn; time_t ts; };
+
+// Kurulu kenar: ts anında röle 'on' olmalı (forced: zorunlu OFF). Callback doldurur: fired/wasOn/firedUs
+struct RelayEdge {
+  time_t  ts;
+  int64_t firedUs;
+  uint8_t on;
+  uint8_t forced;
+  uint8_t armed;
+  uint8_t fired;
+  uint8_t wasOn;
+};
 
-  auto build = [&](uint32_t yThu, uint32_t yFri, time_t& a, time_t& b)->bool {
-    int iThu = findIdx(yThu);
-    int iFri = findIdx(yFri);
-    if (iThu < 0 || iFri < 0) return false;
+struct RelayLatSample {
+  time_t  schedTs;  // planlanan an
+  int64_t actualUs; // röle yazıldığı an (epoch µs)
+  int32_t latMs;    // gecikme (negatif: RELAY_EDGE_EARLY_US içinde erken)
+  uint8_t on;
+};
 
-    a = epochFromYmdAndMin(yThu, g_days[iThu].aksamMin) + (time_t)g_onOffsetSec;
-    b = epochFromYmdAndMin(yFri, g_days[iFri].imsakMin) - (time_t)g_offOffsetSec;
-    return (b > a);
-  };
+struct RelayTaskStats {
+  uint32_t cycles;
+  uint32_t cmds;
+  uint32_t switches;
+  uint32_t forced;
+  uint32_t evtDrop;
+  uint32_t planVer;
+  uint32_t maxStepUs;
+  uint32_t armed;        // kurulan timer sayısı
+  uint32_t timerFired;   // timer ile yapılan geçişler
+  uint32_t cmdTimeouts;  // loop tarafı
+  uint32_t cbBusy;       // callback kilidi alamadı (geçiş task'ta)
+};
 
-  if (!build(ymdThu, ymdFri, onTs, offTs)) return false;
+static TaskHandle_t  g_relayTask    = nullptr;
+static QueueHandle_t g_relayPlanQ   = nullptr;
+static QueueHandle_t g_relayCmdQ    = nullptr;
+static QueueHandle_t g_relayReplyQ  = nullptr;
+static QueueHandle_t g_relayEvtQ    = nullptr;
+static portMUX_TYPE  g_relayMux     = portMUX_INITIALIZER_UNLOCKED;
+static RelayTaskStats g_relayStats  = {};
+static SemaphoreHandle_t  g_relayLock  = nullptr;
+static esp_timer_handle_t g_relayTimer = nullptr;
+static RelayEdge g_relayEdge = {};
+
+static RelayLatSample g_relayLat[RELAY_LAT_N];
+static uint32_t       g_relayLatCnt = 0;  // toplam örnek (halka indeksi = cnt % N)
+
+static RelayPlan g_relayPlanOut;  // loop tarafı hazırlık tamponu
+static RelayPlan g_relayPlan;     // task kopyası
+static uint32_t  g_relayCmdSeq = 0;
+static time_t    g_relayNextOff = 0;          // task: sıradaki zorunlu OFF
+static bool      g_relayInline = false;       // görev yok: karar loop'ta (relayInlineTick)
+static volatile bool g_relayRearm = false;    // callback kilidi alamadı: timer'ı yeniden kur
+
+static time_t relayLoadTs(const time_t& v) {
+  portENTER_CRITICAL(&g_relayMux);
+  time_t r = v;
+  portEXIT_CRITICAL(&g_relayMux);
+  return r;
+}
+
+static void relayStoreTs(time_t& v, time_t x) {
+  portENTER_CRITICAL(&g_relayMux);
+  v = x;
+  portEXIT_CRITICAL(&g_relayMux);
+}
+
+// loop: g_iv + g_tl zorunlu OFF kenarlarını plana kopyala ve task'a bildir
+static void relayPlanPublish() {
+  RelayPlan& p = g_relayPlanOut;
+  p.version++;
+  p.ivCount = g_ivCount;
+  memcpy(p.iv, g_iv, sizeof(SchedInterval) * g_ivCount);
+  p.offCount = 0;
+  for (uint16_t i = 0; i < g_tlCount && p.offCount < MAX_DAYS; i++) {
+    const SchedTransition& t = g_tl[i];
+    if (t.on == 0 && t.reason == SR_IMSAK_OFF) p.offTs[p.offCount++] = t.ts;
+  }
+  if (g_relayInline) {
+    g_relayPlan = p;
+    g_relayStats.planVer = p.version;
+    g_relayNextOff = 0;
+    return;
+  }
+  if (!g_relayPlanQ) return;
+  xQueueOverwrite(g_relayPlanQ, &p);
+  RelayCmd c = { 0, RC_PLAN, 0 };
+  xQueueSend(g_relayCmdQ, &c, 0);  // dolu ise task zaten periyodik okur
+}
 
-  if (now >= offTs) {
-    uint32_t nextThu = addDaysYmd(ymdThu, +7);
-    uint32_t nextFri = addDaysYmd(nextThu, +1);
-    if (!build(nextThu, nextFri, onTs, offTs)) return false;
+// task: ts > now olan ilk zorunlu OFF (yoksa 0)
+static time_t relayPlanNextOff(time_t now) {
+  const RelayPlan& p = g_relayPlan;
+  for (uint16_t i = 0; i < p.offCount; i++) {
+    if (p.offTs[i] > now) return p.offTs[i];
   }
-  return true;
+  return 0;
 }
 
-// =====================
-// ZORUNLU OFF: bir sonraki imsak - SabahTolerans
-// =====================
-static bool computeNextImsakOff(time_t now, time_t& nextOffTs) {
-  if (!isTimeValid() || g_dayCount == 0) return false;
+static void relayEvtHandle(const RelayEvt& e);
 
-  tm t{}; localtime_r(&now, &t);
-  uint32_t today = ymdFromTm(t);
+static void relayEvtPost(uint8_t type, bool on, bool wasOn, time_t ts) {
+  RelayEvt e = { type, (uint8_t)(on ? 1 : 0), (uint8_t)(wasOn ? 1 : 0), ts };
+  if (g_relayInline) { relayEvtHandle(e); return; }  // zaten loop'tayız
+  if (xQueueSend(g_relayEvtQ, &e, 0) != pdTRUE) g_relayStats.evtDrop++;
+}
 
-  int iToday = findIdx(today);
-  if (iToday < 0) return false;
+// task: manuel komut (manualRelayOn/Off'un röle kısmı). Dönüş: 0=açıldı, 1=engelli, 2=zaten açık
+static int8_t relayTaskCmd(const RelayCmd& c, time_t now, bool hasTime) {
+  if (c.type == RC_MANUAL_ON) {
+    relayStoreTs(g_manualOffUntilTs, 0);
+    if (hasTime && g_blockOnUntilTs != 0 && now < g_blockOnUntilTs) return 1;
+    bool wasOff = !g_relayState;
+    g_manualOnLatched = true;
+    relayWrite(true);
+    return wasOff ? 0 : 2;
+  }
+  if (c.type == RC_MANUAL_OFF) {
+    relayStoreTs(g_manualOffUntilTs, c.untilTs);
+    g_manualOnLatched = false;
+    relayWrite(false);
+    return 0;
+  }
+  return 0;
+}
 
-  time_t offToday = epochFromYmdAndMin(today, g_days[iToday].imsakMin) - (time_t)g_offOffsetSec;
-  if (now < offToday) { nextOffTs = offToday; return true; }
+static int64_t relayEpochUs() {
+  struct timeval tv;
+  gettimeofday(&tv, nullptr);
+  return (int64_t)tv.tv_sec * 1000000LL + (int64_t)tv.tv_usec;
+}
 
-  uint32_t tomorrow = addDaysYmd(today, +1);
-  int iTom = findIdx(tomorrow);
-  if (iTom < 0) return false;
+// task (g_relayLock altında): gerçekleşen kenarın gecikme örneği
+static void relayLatRecord(time_t schedTs, int64_t actualUs, bool on) {
+  RelayLatSample& s = g_relayLat[g_relayLatCnt % RELAY_LAT_N];
+  s.schedTs  = schedTs;
+  s.actualUs = actualUs;
+  s.latMs    = (int32_t)((actualUs - (int64_t)schedTs * 1000000LL) / 1000);
+  s.on       = on ? 1 : 0;
+  g_relayLatCnt++;
+}
 
-  nextOffTs = epochFromYmdAndMin(tomorrow, g_days[iTom].imsakMin) - (time_t)g_offOffsetSec;
-  return true;
+// esp_timer görevi: kurulu kenarı uygula (röleyi doğrudan yazar), task'ı uyandır.
+// Kilit meşgulse beklemez: kenar vadesi gelmişse task uygular, erken geldiyse task yeniden kurar.
+static void relayTimerCb(void*) {
+  if (xSemaphoreTake(g_relayLock, pdMS_TO_TICKS(RELAY_CB_LOCK_MS)) != pdTRUE) {
+    g_relayStats.cbBusy++;
+    g_relayRearm = true;
+    RelayCmd c = { 0, RC_TIMER, 0 };
+    xQueueSend(g_relayCmdQ, &c, 0);
+    return;
+  }
+  RelayEdge& e = g_relayEdge;
+  int64_t nowUs = relayEpochUs();
+  int64_t dueUs = (int64_t)e.ts * 1000000LL;
+  if (e.armed && nowUs + RELAY_EDGE_EARLY_US < dueUs) {
+    // Monotonik timer ile duvar saati (NTP düzeltmesi) ayrıştı: kalan süreye yeniden kur
+    esp_timer_start_once(g_relayTimer, (uint64_t)(dueUs - nowUs));
+  } else if (e.armed) {
+    e.armed   = 0;
+    e.fired   = 1;
+    e.wasOn   = g_relayState ? 1 : 0;
+    e.firedUs = nowUs;
+    if (e.forced) g_manualOnLatched = false;
+    if ((bool)e.on != g_relayState) relayWrite(e.on);
+  }
+  xSemaphoreGive(g_relayLock);
+
+  RelayCmd c = { 0, RC_TIMER, 0 };
+  xQueueSend(g_relayCmdQ, &c, 0);
 }
 
-static void getScheduleState(time_t now, bool& thuOn, bool& spOn, time_t& schedOffMax) {
-  thuOn = (g_thuOnTs && g_thuOffTs && now >= g_thuOnTs && now < g_thuOffTs);
-  spOn  = (g_spOnTs  && g_spOffTs  && now >= g_spOnTs  && now < g_spOffTs);
-  schedOffMax = 0;
-  if (thuOn) schedOffMax = g_thuOffTs;
-  if (spOn && g_spOffTs > schedOffMax) schedOffMax = g_spOffTs;
+// task: zorunlu OFF + çizelge kararı
+static time_t g_relayLastOffEvt = 0;
+
+static void relayTaskStep(time_t now, bool hasTime) {
+  if (g_relayPlanQ && xQueueReceive(g_relayPlanQ, &g_relayPlan, 0) == pdTRUE) {
+    g_relayStats.planVer = g_relayPlan.version;
+    g_relayNextOff = 0;
+  }
+
+  // Timer kenarı uygulandıysa: saniye yuvarlaması kenarın gerisinde kalmasın, olay/örnek task'tan
+  RelayEdge fe = g_relayEdge;
+  g_relayEdge.fired = 0;
+  if (fe.fired && hasTime && now < fe.ts) now = fe.ts;
+  // Kurulu kenar vadesi geldi ama callback henüz çalışmadı: geçişi task yapar, örnek yine kaydedilir
+  time_t dueTs = 0;
+  if (g_relayEdge.armed && hasTime && g_relayEdge.ts <= now) { dueTs = g_relayEdge.ts; g_relayEdge.armed = 0; }
+
+  if (hasTime) {
+    // Karar: schedule_engine schedImsakOffStep (replay simülatörü ile aynı)
+    // Bayat/kaçırılmış OFF anını schedImsakOffStep REFRESH ile yakalar (sabit +5 sn yenileme yok)
+    if (g_relayNextOff == 0) g_relayNextOff = relayPlanNextOff(now);
+    uint8_t step = schedImsakOffStep(g_relayNextOff, g_relayLastOffEvt, now);
+    if (step == SIS_REFRESH) {
+      g_relayNextOff = relayPlanNextOff(now);
+    } else if (step == SIS_FIRE) {
+      g_relayLastOffEvt = g_relayNextOff;
+      bool byTimer = fe.fired && fe.forced && fe.ts == g_relayNextOff;
+      bool wasOn = byTimer ? (bool)fe.wasOn : g_relayState;
+      if (wasOn) {
+        if (byTimer) g_relayStats.timerFired++;
+        relayLatRecord(g_relayNextOff, byTimer ? fe.firedUs : relayEpochUs(), false);
+      }
+      if (byTimer) fe.fired = 0;
+      relayWrite(false);
+      g_manualOnLatched = false;
+      relayStoreTs(g_blockOnUntilTs, now + SCHED_FORCE_BLOCK_SEC);
+      g_relayStats.forced++;
+      relayEvtPost(RE_FORCED_OFF, false, wasOn, g_relayLastOffEvt);
+      g_relayNextOff = relayPlanNextOff(now + 2);
+    }
+
+    if (g_manualOffUntilTs != 0 && now >= g_manualOffUntilTs) relayStoreTs(g_manualOffUntilTs, 0);
+  }
+
+  // Timer ile yapılmış geçiş: röle zaten yazıldı, burada olay + gecikme örneği
+  if (fe.fired && fe.on != fe.wasOn) {
+    g_relayStats.timerFired++;
+    relayLatRecord(fe.ts, fe.firedUs, fe.on);
+    relayEvtPost(RE_SWITCH, fe.on, fe.wasOn, fe.ts);
+  }
+
+  // Derlenmiş kural tablosu: now'ı içeren birleşik ON aralığı var mı (binary search)
+  bool scheduledOn = hasTime && schedIntervalAt(g_relayPlan.iv, g_relayPlan.ivCount, now) >= 0;
+  bool shouldOn = schedRelayShouldOn(scheduledOn, g_manualOnLatched, g_manualOffUntilTs,
+                                     g_blockOnUntilTs, hasTime, now);
+  if (shouldOn != g_relayState) {
+    relayWrite(shouldOn);
+    g_relayStats.switches++;
+    if (dueTs) relayLatRecord(dueTs, relayEpochUs(), shouldOn);
+    relayEvtPost(RE_SWITCH, shouldOn, !shouldOn, now);
+  }
 }
 
-static void enforceImsakOffIfDue() {
-  if (!isTimeValid() || g_nextImsakOffTs == 0) return;
+// task: now'dan sonraki ilk karar anı ve o andaki hedef durum; timer'ı kur
+static void relayArmNext(time_t now, bool hasTime) {
+  if (!g_relayTimer) return;
+  if (!hasTime) {
+    g_relayEdge.armed = 0;
+    esp_timer_stop(g_relayTimer);
+    return;
+  }
 
-  time_t now = time(nullptr);
+  const RelayPlan& p = g_relayPlan;
+  time_t t = 0;
+  if (g_relayNextOff > now) schedDueMin(t, g_relayNextOff);
+  for (uint16_t i = 0; i < p.ivCount; i++) {
+    if (p.iv[i].on > now)  { schedDueMin(t, p.iv[i].on); break; }
+    if (p.iv[i].off > now) { schedDueMin(t, p.iv[i].off); break; }
+  }
+  if (g_manualOffUntilTs > now) schedDueMin(t, g_manualOffUntilTs);
+  if (g_blockOnUntilTs > now)   schedDueMin(t, g_blockOnUntilTs);
 
-  const time_t STALE_SEC = 600;
-  const time_t FIRE_WIN  = 300;
+  uint8_t forced = (t != 0 && t == g_relayNextOff) ? 1 : 0;
+  uint8_t on = 0;
+  if (t != 0 && !forced) {
+    bool schedOn = schedIntervalAt(p.iv, p.ivCount, t) >= 0;
+    time_t offUntil = (g_manualOffUntilTs > t) ? g_manualOffUntilTs : 0;
+    on = schedRelayShouldOn(schedOn, g_manualOnLatched, offUntil, g_blockOnUntilTs, true, t) ? 1 : 0;
+  }
 
-  if (g_nextImsakOffTs < (now - STALE_SEC)) {
-    time_t noff = 0;
-    if (computeNextImsakOff(now, noff)) g_nextImsakOffTs = noff;
+  RelayEdge& e = g_relayEdge;
+  bool rearm = g_relayRearm;
+  g_relayRearm = false;
+  if (!rearm && e.armed && e.ts == t && e.on == on && e.forced == forced) return;  // zaten kurulu
+  e.armed = 0;
+  esp_timer_stop(g_relayTimer);
+  if (t == 0) return;
+
+  e.ts     = t;
+  e.on     = on;
+  e.forced = forced;
+  e.fired  = 0;
+  e.armed  = 1;
+
+  int64_t dUs = (int64_t)t * 1000000LL - relayEpochUs();
+  if (dUs < 1000) dUs = 1000;
+  esp_timer_start_once(g_relayTimer, (uint64_t)dUs);
+  g_relayStats.armed++;
+}
+
+static void relayTaskFn(void*) {
+  esp_task_wdt_add(NULL);
+  for (;;) {
+    RelayCmd c;
+    bool got = (xQueueReceive(g_relayCmdQ, &c, pdMS_TO_TICKS(RELAY_TASK_TICK_MS)) == pdTRUE);
+    uint32_t t0 = micros();
+
+    xSemaphoreTake(g_relayLock, portMAX_DELAY);
+    bool hasTime = isTimeValid();
+    time_t now = hasTime ? time(nullptr) : 0;
+
+    // Komuttan önce adım: manuel ON, bu anda düşen zorunlu OFF'u ezmesin
+    relayTaskStep(now, hasTime);
+    if (got && (c.type == RC_MANUAL_ON || c.type == RC_MANUAL_OFF)) {
+      g_relayStats.cmds++;
+      RelayReply r = { c.seq, relayTaskCmd(c, now, hasTime) };
+      xQueueOverwrite(g_relayReplyQ, &r);
+    }
+    relayArmNext(now, hasTime);
+    xSemaphoreGive(g_relayLock);
+
+    uint32_t dt = micros() - t0;
+    if (dt > g_relayStats.maxStepUs) g_relayStats.maxStepUs = dt;
+    g_relayStats.cycles++;
+    esp_task_wdt_reset();
+  }
+}
+
+// Görev kurulamadı: karar loop'a (relayInlineTick), plan doğrudan kopyalanır
+static void relayTaskFallback(const char* why) {
+  Serial.print("[BOOT] ");
+  Serial.print(why);
+  Serial.println(" -> role karari loop'ta");
+  g_relayInline = true;
+  g_relayPlan = g_relayPlanOut;
+  g_relayStats.planVer = g_relayPlan.version;
+  g_relayNextOff = 0;
+}
+
+static void relayTaskStart() {
+  g_relayPlanQ  = xQueueCreate(1, sizeof(RelayPlan));
+  g_relayCmdQ   = xQueueCreate(4, sizeof(RelayCmd));
+  g_relayReplyQ = xQueueCreate(1, sizeof(RelayReply));
+  g_relayEvtQ   = xQueueCreate(RELAY_EVT_QLEN, sizeof(RelayEvt));
+  g_relayLock   = xSemaphoreCreateMutex();
+  if (!g_relayPlanQ || !g_relayCmdQ || !g_relayReplyQ || !g_relayEvtQ || !g_relayLock) {
+    relayTaskFallback("Role kuyruklari olusturulamadi!");
+    return;
   }
 
-  if (g_nextImsakOffTs == 0) return;
-  if (g_nextImsakOffTs < (now - STALE_SEC)) return;
+  // Kenar timer'ı: yoksa task RELAY_TASK_TICK_MS periyoduyla devam eder
+  esp_timer_create_args_t ta = {};
+  ta.callback        = relayTimerCb;
+  ta.dispatch_method = ESP_TIMER_TASK;
+  ta.name            = "relayEdge";
+  if (esp_timer_create(&ta, &g_relayTimer) != ESP_OK) {
+    g_relayTimer = nullptr;
+    Serial.println("[BOOT] Role timer olusturulamadi (periyodik kontrol)");
+  }
+  // Plan boot'tan önce derlendiyse (tlRebuild) kuyruk henüz yoktu
+  if (g_relayPlanOut.version != 0) xQueueOverwrite(g_relayPlanQ, &g_relayPlanOut);
 
-  if (now > (g_nextImsakOffTs + FIRE_WIN)) {
-    time_t noff = 0;
-    if (computeNextImsakOff(now, noff)) g_nextImsakOffTs = noff;
+  if (xTaskCreatePinnedToCore(relayTaskFn, "relay", RELAY_TASK_STACK, nullptr,
+                              RELAY_TASK_PRIO, &g_relayTask, RELAY_TASK_CORE) != pdPASS) {
+    g_relayTask = nullptr;
+    if (g_relayTimer) { esp_timer_delete(g_relayTimer); g_relayTimer = nullptr; }
+    relayTaskFallback("Role gorevi baslatilamadi!");
     return;
   }
+  Serial.print("[BOOT] Role gorevi core="); Serial.print((int)RELAY_TASK_CORE);
+  Serial.print(" prio="); Serial.println((int)RELAY_TASK_PRIO);
+}
+
+// loop: komutu gönder, cevabı bekle (task daha öncelikli: pratikte anında döner). -1 = zaman aşımı
+static int relayCall(uint8_t type, time_t untilTs) {
+  RelayCmd c = { ++g_relayCmdSeq, type, untilTs };
+  if (g_relayInline) {
+    // Görev yok: aynı sıra (adım, sonra komut) burada
+    bool hasTime = isTimeValid();
+    time_t now = hasTime ? time(nullptr) : 0;
+    relayTaskStep(now, hasTime);
+    g_relayStats.cmds++;
+    return relayTaskCmd(c, now, hasTime);
+  }
+  if (!g_relayTask) return -1;
+  uint32_t t0 = millis();
+  if (xQueueSend(g_relayCmdQ, &c, pdMS_TO_TICKS(RELAY_CMD_WAIT_MS)) != pdTRUE) {
+    g_relayStats.cmdTimeouts++;
+    return -1;
+  }
+  while (millis() - t0 < RELAY_CMD_WAIT_MS) {
+    RelayReply r;
+    if (xQueueReceive(g_relayReplyQ, &r, pdMS_TO_TICKS(RELAY_CMD_WAIT_MS)) != pdTRUE) break;
+    if (r.seq == c.seq) return r.rc;  // önceki zaman aşımından kalan cevaplar atlanır
+  }
+  g_relayStats.cmdTimeouts++;
+  return -1;
+}
 
-  if (now >= g_nextImsakOffTs && g_lastImsakOffEventTs != g_nextImsakOffTs) {
-    g_lastImsakOffEventTs = g_nextImsakOffTs;
+// loop: gecikme örneklerinin kopyası (sıralı latMs + en yeni ilk son geçişler). Dönüş: örnek sayısı
+static int relayLatSnapshot(int32_t* sortedMs, RelayLatSample* recent, int& nRecent) {
+  nRecent = 0;
+  if (!g_relayLock || xSemaphoreTake(g_relayLock, pdMS_TO_TICKS(100)) != pdTRUE) return 0;
+  uint32_t cnt = g_relayLatCnt;
+  int n = (cnt < (uint32_t)RELAY_LAT_N) ? (int)cnt : RELAY_LAT_N;
+  for (int i = 0; i < n; i++) {
+    const RelayLatSample& s = g_relayLat[(cnt - 1 - i) % RELAY_LAT_N];
+    sortedMs[i] = s.latMs;
+    if (i < RELAY_LAT_RECENT) recent[nRecent++] = s;
+  }
+  xSemaphoreGive(g_relayLock);
 
-    bool wasOn = g_relayState;
-    relayWrite(false);
-    g_manualOnLatched = false;
+  // n <= 64: ekleme sıralaması
+  for (int i = 1; i < n; i++) {
+    int32_t v = sortedMs[i];
+    int j = i - 1;
+    while (j >= 0 && sortedMs[j] > v) { sortedMs[j + 1] = sortedMs[j]; j--; }
+    sortedMs[j + 1] = v;
+  }
+  return n;
+}
 
-    g_blockOnUntilTs = now + 120;
+// Yakın-sıra persentil (p: 0..100)
+static int32_t relayLatPct(const int32_t* sortedMs, int n, int p) {
+  if (n <= 0) return 0;
+  int k = (p * n + 99) / 100;
+  if (k < 1) k = 1;
+  return sortedMs[k - 1];
+}
 
+// loop: task olaylarını log / Telegram'a aktar
+static void relayEvtHandle(const RelayEvt& e) {
+  if (e.type == RE_SWITCH) {
+    logSerialAndTg(e.on ? "🔔 ROLE: ON" : "🔕 ROLE: OFF", true, false, OB_HIGH);
+    logSys(e.on ? "Cizelge: Role ACILDI" : "Cizelge: Role KAPANDI");
+  } else if (e.type == RE_FORCED_OFF) {
     char ts[32];
-    formatDateTime(g_nextImsakOffTs, ts, sizeof(ts));
-    logSerialAndTg(String("⛔ ZORUNLU OFF (İmsak - Sabah tolerans): ") + ts + "  (manuel iptal)", true, true);
-    if (wasOn) logSerialAndTg("🔕 ROLE: OFF (Zorunlu)", true, true);
-    if (wasOn) logSys("Imsak zorunlu OFF");
-
-    time_t newOff = 0;
-    if (computeNextImsakOff(now + 2, newOff)) g_nextImsakOffTs = newOff;
-    else g_nextImsakOffTs = 0;
+    formatDateTime(e.ts, ts, sizeof(ts));
+    logSerialAndTg(String("⛔ ZORUNLU OFF (İmsak - Sabah tolerans): ") + ts + "  (manuel iptal)", true, true, OB_HIGH);
+    if (e.wasOn) logSerialAndTg("🔕 ROLE: OFF (Zorunlu)", true, true, OB_HIGH);
+    if (e.wasOn) logSys("Imsak zorunlu OFF");
+    // Gösterim kopyasını ilerlet
+    time_t noff = 0;
+    if (computeNextImsakOff(e.ts + 2, noff)) g_nextImsakOffTs = noff;
   }
 }
 
+static void relayEventsTick() {
+  if (!g_relayEvtQ || g_relayInline) return;
+  RelayEvt e;
+  while (xQueueReceive(g_relayEvtQ, &e, 0) == pdTRUE) relayEvtHandle(e);
+}
+
+// Görev yoksa (kurulamadı) karar loop'ta: eski yol, gecikme loop turuna bağlı
+static void relayInlineTick() {
+  if (!g_relayInline) return;
+  uint32_t t0 = micros();
+  bool hasTime = isTimeValid();
+  relayTaskStep(hasTime ? time(nullptr) : 0, hasTime);
+  uint32_t dt = micros() - t0;
+  if (dt > g_relayStats.maxStepUs) g_relayStats.maxStepUs = dt;
+  g_relayStats.cycles++;
+}
+
 // =====================
 // WiFi keep-alive + watchdog
 // =====================
@@ -1496,6 +3820,7 @@ static void wifiKeepAlive() {
 
   if (st != g_lastWiFi) {
     g_lastWiFi = st;
+    stateBump();
     if (st == WL_CONNECTED) {
       logSerialAndTg("📶 WiFi BAGLANDI. IP=" + WiFi.localIP().toString(), false, false);
       g_autoMenuPending = true;
@@ -1534,6 +3859,7 @@ static void wifiKeepAlive() {
   if (g_wifiDisconnectedSinceMs != 0 && (millis() - g_wifiDisconnectedSinceMs) > WIFI_WATCHDOG_MS) {
     Serial.println("[WIFI] Watchdog: 10dk boyunca baglanilamadi, ESP restart...");
     logSys("WiFi watchdog: 10dk baglanti yok, reboot");
+    outboxFlush(0);  // bekleyen bildirimler sonraki açılışta gönderilsin
     delay(200);
     ESP.restart();
   }
@@ -1551,7 +3877,7 @@ static void wifiKeepAlive() {
   WiFi.disconnect();
   applyWiFiNetCfgIfNeeded();
   wifiBeginNow();
-  logSerialAndTg("🔁 WiFi yeniden baglanma denemesi... (sonraki: " + String(g_wifiRetryIntervalMs/1000) + "sn)", true);
+  logSerialAndTg("🔁 WiFi yeniden baglanma denemesi... (sonraki: " + String(g_wifiRetryIntervalMs/1000) + "sn)", true, false, OB_LOW);
 }
 
 // =====================
@@ -1600,7 +3926,7 @@ static void ensureTodayInCache() {
   if (g_lastUserActivityMs != 0 && (nowMs - g_lastUserActivityMs) < 15000) return; // son 15sn'de kullanıcı varsa dokunma
   if (g_updateInProgress || g_updatePending) return;
 
-  if (g_dayCount == 0 || !hasYmd(ymdToday())) {
+  if (g_dayApiCount == 0 || !apiHasYmd(ymdToday())) {
     logSerialAndTg("📥 Cache bugunu icermiyor -> vakit indiriliyor...", false, false);
     logSys("Otomatik vakit indirme basladi");
     // Arka planda çekimde Telegram'a ekstra mesaj atma; sadece serial/log.
@@ -1609,146 +3935,55 @@ static void ensureTodayInCache() {
 }
 
 // =====================
-// Özel gün penceresi
+// En yakın / aktif dini pencereyi seç
 // =====================
-static bool computeWindowForSpecial(uint8_t spIdx, time_t& onTs, time_t& offTs, uint32_t& ymdEvent, String& hicriText) {
-  if (g_dayCount == 0) return false;
-  if (spIdx >= SPECIAL_COUNT) return false;
-
-  const SpecialDef& sp = g_specials[spIdx];
-  bool useDef = (g_spOv[spIdx].useDefault != 0);
-
-  int    ruleDay  = useDef ? (int)sp.day : (int)g_spOv[spIdx].day;
-  String ruleMon  = useDef ? String(sp.monthKey) : String(monthKeyFromIndex(g_spOv[spIdx].month));
-  ruleMon = normMonthKey(ruleMon);
-  int    ruleYear = useDef ? 0 : (int)g_spOv[spIdx].year;
-
-  int foundIdx = -1;
+// =====================
+// Cache ufku ötesi dini günler (çevrimdışı Hicri takvim tahmini, saat yok)
+// =====================
+static const int SP_PRED_MAX = 2 * ((int)SPECIAL_COUNT + 1);
+static HijriPrediction g_spPred[SP_PRED_MAX];
 
-  for (uint16_t i = 0; i < g_dayCount; i++) {
-    int hd=0, hy=0; String hm;
-    if (!parseHicri(g_days[i].hicriUzun, hd, hm, hy)) continue;
-
-    String key = normMonthKey(hm);
-    if (hd == ruleDay && key == ruleMon) {
-      // Custom seçildiyse yıl da eşleşsin (API yıl vermezse ay+gün ile kabul)
-      if (ruleYear != 0) {
-        if (hy != 0 && hy != ruleYear) continue;
-      }
-      foundIdx = (int)i;
-      break;
-    }
+// Cache'in son gününden sonraki (yoksa bugünden itibaren) SP_PREDICT_DAYS gün
+static int predictSpecialsBeyondCache(time_t now) {
+  int32_t today = localDaysFromEpoch(now);
+  int32_t from  = today;
+  if (g_dayCount > 0) {
+    int32_t afterCache = daysFromYmd(g_days[g_dayCount - 1].ymd) + 1;
+    if (afterCache > from) from = afterCache;
   }
-
-  if (foundIdx < 0) return false;
-
-  ymdEvent  = g_days[foundIdx].ymd;
-  hicriText = String(g_days[foundIdx].hicriUzun);
-
-  uint32_t ymdPrev = addDaysYmd(ymdEvent, -1);
-  int ip = findIdx(ymdPrev);
-  if (ip < 0) return false;
-
-  onTs  = epochFromYmdAndMin(ymdPrev,  g_days[ip].aksamMin) + (time_t)g_onOffsetSec;
-  offTs = epochFromYmdAndMin(ymdEvent, g_days[foundIdx].imsakMin) - (time_t)g_offOffsetSec;
-
-  return (offTs > onTs);
+  return hijriPredictSpecials(schedInputFromGlobals(), g_hijriCalOff, from, today + SP_PREDICT_DAYS,
+                              g_spPred, SP_PRED_MAX);
 }
 
-static bool buildWindowForEventIdx(int idxEvent, time_t& onTs, time_t& offTs) {
-  if (idxEvent < 0 || idxEvent >= (int)g_dayCount) return false;
-  uint32_t ymdEvent = g_days[idxEvent].ymd;
-  uint32_t ymdPrev  = addDaysYmd(ymdEvent, -1);
-
-  int ip = findIdx(ymdPrev);
-  if (ip < 0) return false;
-
-  onTs  = epochFromYmdAndMin(ymdPrev,  g_days[ip].aksamMin) + (time_t)g_onOffsetSec;
-  offTs = epochFromYmdAndMin(ymdEvent, g_days[idxEvent].imsakMin) - (time_t)g_offOffsetSec;
-
-  return (offTs > onTs);
+static String predictionName(const HijriPrediction& p) {
+  if (p.reason == SR_SPECIAL) return String(g_specials[p.arg].name);
+  return String("Ramazan Başlangıcı");
 }
 
-static bool isRamazanIdx(int idx, int& dayNoOut) {
-  dayNoOut = 0;
-  if (idx < 0 || idx >= (int)g_dayCount) return false;
-
-  int hd=0, hy=0; String hm;
-  if (!parseHicri(g_days[idx].hicriUzun, hd, hm, hy)) return false;
-
-  if (normMonthKey(hm) == "ramazan") {
-    dayNoOut = hd;
-    return (hd >= 1 && hd <= 30);
-  }
-  return false;
-}
-
-// =====================
-// En yakın / aktif dini pencereyi seç
-// =====================
 static void computeNextSpecial(time_t now) {
   g_spOnTs = 0; g_spOffTs = 0; g_spName = ""; g_spHicri = ""; g_spYmd = 0;
 
-  bool foundActive = false;
-  time_t bestOn = 0, bestOff = 0;
-  String bestName = "", bestHicri = "";
-  uint32_t bestYmd = 0;
-
-  // 1) Klasik özel günler
-  for (uint8_t i = 0; i < SPECIAL_COUNT; i++) {
-    if (!isSpecialEnabled(i)) continue;
-
-    time_t on=0, off=0; uint32_t ymdEv=0; String hicri;
-    if (!computeWindowForSpecial(i, on, off, ymdEv, hicri)) continue;
-
-    bool active = (now >= on && now < off);
-    if (active) {
-      if (!foundActive || on < bestOn) {
-        foundActive = true;
-        bestOn = on; bestOff = off; bestName = g_specials[i].name; bestHicri = hicri; bestYmd = ymdEv;
-      }
-    } else if (!foundActive) {
-      if (on > now && (bestOn == 0 || on < bestOn)) {
-        bestOn = on; bestOff = off; bestName = g_specials[i].name; bestHicri = hicri; bestYmd = ymdEv;
-      }
+  // Timeline sıralı: now'dan sonra biten ilk dini pencere ya aktif olandır ya da en yakın yaklaşan.
+  int i = tlFindWindowEnd(now, SRM_DINI);
+  if (i < 0) {
+    // Cache'te yok: çevrimdışı takvimden tarih (ON/OFF saati cache gelince hesaplanır)
+    if (predictSpecialsBeyondCache(now) > 0) {
+      g_spYmd   = g_spPred[0].ymd;
+      g_spName  = predictionName(g_spPred[0]) + " (tahmini)";
+      g_spHicri = hijriTextForYmd(g_spPred[0].ymd);
     }
+    return;
   }
 
-  if (g_enableRamazanAll) {
-  // 2) Ramazan tüm günler
-    for (int idx = 0; idx < (int)g_dayCount; idx++) {
-      int dayNo = 0;
-      if (!isRamazanIdx(idx, dayNo)) continue;
-
-      time_t on=0, off=0;
-      if (!buildWindowForEventIdx(idx, on, off)) continue;
-
-      bool active = (now >= on && now < off);
-
-      String name  = String("Ramazan Günü ") + String(dayNo);
-      String hicri = String(g_days[idx].hicriUzun);
-      uint32_t ymdEv = g_days[idx].ymd;
-
-      if (active) {
-        if (!foundActive || on < bestOn) {
-          foundActive = true;
-          bestOn = on; bestOff = off; bestName = name; bestHicri = hicri; bestYmd = ymdEv;
-        }
-      } else if (!foundActive) {
-        if (on > now && (bestOn == 0 || on < bestOn)) {
-          bestOn = on; bestOff = off; bestName = name; bestHicri = hicri; bestYmd = ymdEv;
-        }
-      }
-    }
-  }
+  const SchedTransition& t = g_tl[i];
+  g_spOnTs  = t.peer;
+  g_spOffTs = t.ts;
+  g_spYmd   = t.ymd;
+  if (t.reason == SR_SPECIAL) g_spName = g_specials[t.arg].name;
+  else                        g_spName = String("Ramazan Günü ") + String(t.arg);
 
-  if (bestOn != 0 && bestOff != 0) {
-    g_spOnTs = bestOn;
-    g_spOffTs = bestOff;
-    g_spName = bestName;
-    g_spHicri = bestHicri;
-    g_spYmd = bestYmd;
-  }
+  int di = findIdx(t.ymd);
+  if (di >= 0) g_spHicri = String(g_days[di].hicriUzun);
 }
 
 // =====================
@@ -1791,35 +4026,30 @@ static void weeklyUpdateTick() {
   if (!isTimeValid()) return;
 
   time_t now = time(nullptr);
-  tm t{}; localtime_r(&now, &t);
+  int32_t days = localDaysFromEpoch(now);
+  int minOfDay = (int)(localSecOfDay(now) / 60);
+  int hh = minOfDay / 60, mm = minOfDay % 60;
 
-  uint32_t today = ymdFromTm(t);
-  uint32_t lastUpd = prefs.getUInt("lastUpdYmd", 0);
+  uint32_t today = ymdFromDays(days);
+  uint32_t lastUpd = g_lastUpdYmd;
 
   static uint32_t lastMinuteKey = 0;
-  uint32_t minuteKey = today * 1440u + (uint32_t)(t.tm_hour * 60 + t.tm_min);
+  uint32_t minuteKey = today * 1440u + (uint32_t)minOfDay;
   if (minuteKey == lastMinuteKey) return;
   lastMinuteKey = minuteKey;
 
-  if (t.tm_wday != UPDATE_DOW) return;
+  if (weekdayFromDays(days) != UPDATE_DOW) return;
   if (today == lastUpd) return;
 
-  bool isMainTime = (t.tm_hour == UPDATE_HOUR && t.tm_min == UPDATE_MIN);
-  bool isRetry    = (t.tm_min == 5);
+  bool isMainTime = (hh == UPDATE_HOUR && mm == UPDATE_MIN);
+  bool isRetry    = (mm == 5);
 
   if ((isMainTime || isRetry) && WiFi.status() == WL_CONNECTED) {
     logSerialAndTg("📥 Pazartesi update: 30 gunluk vakit cekiliyor...", true, true);
     logSys("Haftalik vakit guncelleme basladi");
     if (fetchAndStoreMonthly(true)) {
       loadTimesFromNvs();
-
-      time_t on2=0, off2=0;
-      if (computeThuFriWindowForNow(time(nullptr), on2, off2)) { g_thuOnTs = on2; g_thuOffTs = off2; }
-
-      computeNextSpecial(time(nullptr));
-
-      time_t nextOff=0;
-      if (computeNextImsakOff(time(nullptr), nextOff)) g_nextImsakOffTs = nextOff;
+      schedTick(time(nullptr));
 
       char a[32], b[32], c[32], s1[32], s2[32];
       formatDateTime(g_thuOnTs, a, sizeof(a));
@@ -1863,7 +4093,7 @@ static void weeklyRestartTick() {
     Serial.println("[MAINT] Haftalik otomatik restart...");
     logSys("Haftalik otomatik restart");
     tgSend("🔄 Haftalık bakım: otomatik yeniden başlatma", true);
-    delay(500);
+    outboxFlush(5000);
     ESP.restart();
   }
 }
@@ -1875,20 +4105,19 @@ static void weeklyRestartTick() {
 // Dönüş: 0=OK, 1=blocked (imsak), 2=zaten açık (buton için)
 // =====================
 static int manualRelayOn(const char* source, const String& who = "") {
-  g_manualOffUntilTs = 0;
-
-  // İmsak OFF sonrası engel kontrolü
   if (isTimeValid()) {
     time_t noff = 0;
     if (computeNextImsakOff(time(nullptr), noff)) g_nextImsakOffTs = noff;
-    if (g_blockOnUntilTs != 0 && time(nullptr) < g_blockOnUntilTs) {
-      return 1; // blocked
-    }
   }
 
-  bool wasOff = !g_relayState;
-  g_manualOnLatched = true;
-  relayWrite(true);
+  // Röle görevi: İmsak OFF sonrası engel kontrolü + latch + röle
+  int rc = relayCall(RC_MANUAL_ON, 0);
+  if (rc < 0) {
+    logSys("Role gorevi cevap vermedi (manuel ON)");
+    return 1;
+  }
+  if (rc == 1) return 1; // blocked
+  bool wasOff = (rc == 0);
 
   // Log
   String src(source);
@@ -1908,9 +4137,7 @@ static time_t manualRelayOff(const char* source, const String& who = "") {
     getScheduleState(time(nullptr), thuOn, spOn, schedOff);
     if (schedOff) untilTs = schedOff;
   }
-  g_manualOffUntilTs = untilTs;
-  g_manualOnLatched = false;
-  relayWrite(false);
+  if (relayCall(RC_MANUAL_OFF, untilTs) < 0) logSys("Role gorevi cevap vermedi (manuel OFF)");
 
   String src(source);
   String whoStr = who.length() > 0 ? (" (" + who + ")") : "";
@@ -1950,10 +4177,10 @@ static bool cmdIs(const String& text, const char* cmd) {
   return text.startsWith(p);
 }
 
-static String whoStr(const telegramMessage& m) {
+static String whoStr(const TgUpdate& m) {
   String who;
-  if (m.from_name.length() > 0) who += "(" + m.from_name + ") ";
-  if (m.from_id.length() > 0)   who += "id=" + m.from_id;
+  if (m.fromName[0]) { who += "("; who += m.fromName; who += ") "; }
+  if (m.fromId[0])   { who += "id="; who += m.fromId; }
   return who;
 }
 
@@ -1979,25 +4206,12 @@ struct SpItemLite {
   uint8_t kind;          // ItemKind
   uint8_t specialIndex;  // KIND_SPECIAL
   uint8_t ramazanDay;    // KIND_RAMAZAN
+  uint8_t predicted;     // 1 = cache ötesi, çevrimdışı takvim tahmini (on/off yok)
 };
 
-static const int MAX_SP_LIST = (int)SPECIAL_COUNT + 40;
+static const int MAX_SP_LIST = (int)SPECIAL_COUNT + 40 + SP_PRED_MAX;
 static SpItemLite g_spList[MAX_SP_LIST];
 
-static void sortSpLite(SpItemLite* arr, int n) {
-  for (int i=0;i<n-1;i++){
-    for (int j=i+1;j<n;j++){
-      bool swap = false;
-      if (arr[j].stateGroup < arr[i].stateGroup) swap = true;
-      else if (arr[j].stateGroup == arr[i].stateGroup) {
-        if (arr[j].ymd < arr[i].ymd) swap = true;                // en yakın tarih en üstte
-        else if (arr[j].ymd == arr[i].ymd && arr[j].on < arr[i].on) swap = true;
-      }
-      if (swap) { SpItemLite tmp=arr[i]; arr[i]=arr[j]; arr[j]=tmp; }
-    }
-  }
-}
-
 // =====================
 // /guncelle worker
 // =====================
@@ -2009,21 +4223,16 @@ static void updateWorkerTick() {
 
   g_updateInProgress = true;
   g_updatePending = false;
+  stateBump();
   g_updateCooldownUntilMs = millis() + 60000; // 60sn
+  webEventsTick();   // "çalışıyor" bloklayan indirmeden önce panele gitsin
 
   tgSend("[" + nowStamp() + "] 📥 Manuel guncelleme basladi...\n👤 " + g_updateRequesterWho, true);
 
   bool ok = fetchAndStoreMonthly(true);
   if (ok) {
     loadTimesFromNvs();
-
-    time_t on2=0, off2=0;
-    if (isTimeValid() && computeThuFriWindowForNow(time(nullptr), on2, off2)) { g_thuOnTs = on2; g_thuOffTs = off2; }
-
-    if (isTimeValid()) computeNextSpecial(time(nullptr));
-
-    time_t nextOff=0;
-    if (isTimeValid() && computeNextImsakOff(time(nullptr), nextOff)) g_nextImsakOffTs = nextOff;
+    if (isTimeValid()) schedTick(time(nullptr));
 
     tgSend("[" + nowStamp() + "] ✅ Manuel guncelleme OK\n👤 " + g_updateRequesterWho, true);
     logSys("Vakit guncelleme OK");
@@ -2033,65 +4242,71 @@ static void updateWorkerTick() {
   }
 
   g_updateInProgress = false;
+  stateBump();
 }
 
 // =====================
-// Röle karar + override + bloklar
+// Çizelge: dirty girdilere göre artımlı yeniden hesap
 // =====================
-static void applyRelayLogic() {
-  bool scheduledOn = false;
+static void schedTick(time_t now) {
+  uint32_t today = ymdFromEpoch(now);
+  if (today != g_sched.ymd) { g_sched.ymd = today; g_sched.dirty |= SD_DATE; stateBump(); }
+  if (g_sched.dirty & (SD_DAYS | SD_DATE)) daysFillAstro(now);
 
-  time_t now = 0;
-  bool hasTime = isTimeValid();
-  if (hasTime) now = time(nullptr);
+  uint8_t d = g_sched.dirty;
+  if (d == 0 && now < g_sched.nextDueTs) return;
+  g_sched.dirty = 0;
+  g_sched.recomputeCnt++;
+
+  bool retry = false;
 
-  if (hasTime && g_manualOffUntilTs != 0 && now >= g_manualOffUntilTs) {
-    g_manualOffUntilTs = 0;
+  if ((d & (SD_DAYS | SD_TOL | SD_DATE)) || g_thuOffTs == 0 || now >= g_thuOffTs) {
+    g_sched.thuCnt++;
+    time_t on2=0, off2=0;
+    if (!computeThuFriWindowForNow(now, on2, off2)) {
+      ensureTodayInCache();
+      if (!computeThuFriWindowForNow(now, on2, off2)) retry = true;
+    }
+    if (on2 && off2) { g_thuOnTs = on2; g_thuOffTs = off2; }
   }
 
-  if (hasTime) {
-    bool thuOn=false, spOn=false; time_t schedOff=0;
-    getScheduleState(now, thuOn, spOn, schedOff);
-    scheduledOn = thuOn || spOn;
+  if ((d & SD_ALL) || g_spOffTs == 0 || now >= g_spOffTs) {
+    g_sched.spCnt++;
+    ensureTodayInCache();
+    computeNextSpecial(now);
   }
 
-  bool shouldOn = scheduledOn || g_manualOnLatched;
+  if ((d & (SD_DAYS | SD_TOL | SD_DATE)) || g_nextImsakOffTs == 0 || now >= (g_nextImsakOffTs + 5)) {
+    g_sched.imsakCnt++;
+    time_t noff=0;
+    if (!computeNextImsakOff(now, noff)) {
+      ensureTodayInCache();
+      if (!computeNextImsakOff(now, noff)) retry = true;
+    }
+    if (noff) g_nextImsakOffTs = noff;
+  }
 
-  if (hasTime && g_manualOffUntilTs != 0 && now < g_manualOffUntilTs) shouldOn = false;
-  if (hasTime && g_blockOnUntilTs != 0 && now < g_blockOnUntilTs)     shouldOn = false;
+  // Sonraki iş: en yakın pencere sonu. Dini gün yoksa sadece gün değişimi / yeni veri tetikler.
+  time_t due = 0;
+  if (g_thuOffTs > now)       schedDueMin(due, g_thuOffTs);
+  if (g_spOffTs > now)        schedDueMin(due, g_spOffTs);
+  if (g_nextImsakOffTs > now) schedDueMin(due, g_nextImsakOffTs + 5);
+  if (retry) schedDueMin(due, now + 30);  // cache bugünü içermiyor: indirme denemesi sürsün
+  g_sched.nextDueTs = due ? due : (now + 3600);
+}
 
-  if (shouldOn != g_relayState) {
-    relayWrite(shouldOn);
-    logSerialAndTg(shouldOn ? "🔔 ROLE: ON" : "🔕 ROLE: OFF", true);
-    logSys(shouldOn ? "Cizelge: Role ACILDI" : "Cizelge: Role KAPANDI");
-  }
+// Girdi değişikliğini işaretle ve hemen uygula (web/TG handler'ları)
+static void schedRecompute(uint8_t dirtyBits) {
+  schedMarkDirty(dirtyBits);
+  if (!isTimeValid()) return;
+  schedTick(time(nullptr));  // timeline yeniden derlenirse plan röle görevine gider
 }
 
 // =====================
-// Yardımcı: schedule hesaplarını yenile
+// Yardımcı: schedule hesaplarını yenile (tüm girdiler)
 // =====================
 static void recomputeAllSchedules() {
-  if (!isTimeValid()) return;
-
-  time_t now = time(nullptr);
-
-  time_t on2=0, off2=0;
-  if (!computeThuFriWindowForNow(now, on2, off2)) {
-    ensureTodayInCache();
-    (void)computeThuFriWindowForNow(now, on2, off2);
-  }
-  if (on2 && off2) { g_thuOnTs = on2; g_thuOffTs = off2; }
-
-  computeNextSpecial(now);
-
-  time_t noff=0;
-  if (!computeNextImsakOff(now, noff)) {
-    ensureTodayInCache();
-    (void)computeNextImsakOff(now, noff);
-  }
-  if (noff) g_nextImsakOffTs = noff;
-
-  applyRelayLogic();
+  schedRecompute(SD_ALL);
 }
 
 // =====================
@@ -2108,7 +4323,8 @@ static String buildPanelTextMain() {
   s += "🕌 Cami Panel\n";
   s += "📌 Şerefeler: " + String(g_relayState ? "AÇIK ✅" : "KAPALI ❌") + "\n";
   s += "⏱️ Akşam tolerans: " + fmtMin(g_onOffsetSec) + " | Sabah tolerans: " + fmtMin(g_offOffsetSec) + "\n";
-  if (isTimeValid()) s += "🕰️ " + nowStamp() + "\n";
+  // Dakika çözünürlüğü: aynı dakikadaki yenilemeler aynı metni üretir (edit atlanır)
+  if (isTimeValid()) s += "🕰️ " + nowStamp().substring(0, 16) + "\n";
   else s += "🕰️ NO_TIME\n";
   s += "\nSeçim yap:";
 
@@ -2136,9 +4352,47 @@ static String kbMain() {
   return kb;
 }
 
+// Son çizilen panel: sohbet + mesaj id + metin/klavye özeti. Aynıysa edit gönderilmez
+// (REFRESH/TOGGLE/otomatik yenileme). Açık panel komutu (g_panelForceNew) karşılaştırmaz:
+// panel sohbette yukarıda kalmış olabilir, kullanıcı her zaman yeni panel görür.
+struct PanelCache {
+  String   chat;
+  int      msgId;
+  uint32_t hash;
+};
+static PanelCache g_panelCache = { "", 0, 0 };
+
+struct PanelStats {
+  uint32_t requests;     // requestUiRefresh
+  uint32_t renders;      // panelShowOrEdit çağrısı
+  uint32_t skipped;      // içerik aynı: istek atılmadı
+  uint32_t edits;
+  uint32_t notModified;  // Telegram "message is not modified" (başarı sayılır)
+  uint32_t sends;        // yeni panel mesajı
+};
+static PanelStats g_panelStats = {};
+
+static uint32_t panelHash(const String& text, const String& kbJson) {
+  uint32_t h = 2166136261u;  // FNV-1a
+  for (size_t i = 0; i < text.length(); i++)   { h ^= (uint8_t)text[i];   h *= 16777619u; }
+  h ^= 0xFFu; h *= 16777619u;
+  for (size_t i = 0; i < kbJson.length(); i++) { h ^= (uint8_t)kbJson[i]; h *= 16777619u; }
+  return h;
+}
+
 static void panelShowOrEdit(const String& text, const String& kbJson, int messageId) {
+  g_panelStats.renders++;
+  uint32_t h = panelHash(text, kbJson);
+  if (messageId != 0 && messageId == g_panelCache.msgId && h == g_panelCache.hash &&
+      g_panelCache.chat == g_activeChatId) {
+    g_panelStats.skipped++;
+    return;
+  }
+
   // Telegram HTTPS istekleri bazen uzun sürebiliyor.
   // WDT'yi tetiklememek için küçük yield'ler ve daha makul timeout kullanıyoruz.
+  // Outbox görevi o an gönderiyorsa bitmesini bekle; alınamazsa bir sonraki turda tekrar dene.
+  if (!tgLockTake(TG_LOCK_WAIT_MS)) { g_uiRefreshPending = true; return; }
   tgPrepare(8000);
 
   yield();
@@ -2147,7 +4401,12 @@ static void panelShowOrEdit(const String& text, const String& kbJson, int messag
 
   // 1) Önce mevcut paneli edit etmeyi dene
   if (messageId != 0) {
-    ok = bot.sendMessageWithInlineKeyboard(g_activeChatId, text, "", kbJson, messageId); // edit
+    ok = g_bot.editMessage(g_activeChatId, messageId, text, kbJson);
+    g_panelStats.edits++;
+    if (!ok && g_bot.lastNotModified()) {
+      ok = true;  // içerik zaten bu: panel güncel
+      g_panelStats.notModified++;
+    }
     yield();
     if (!ok) {
       // Panel mesajı silinmiş/geçersiz olabilir -> yeni mesaj göndereceğiz
@@ -2157,26 +4416,35 @@ static void panelShowOrEdit(const String& text, const String& kbJson, int messag
 
   // 2) Edit olmadıysa (veya messageId=0 ise) yeni panel gönder
   if (messageId == 0 || !ok) {
-    ok = bot.sendMessageWithInlineKeyboard(g_activeChatId, text, "", kbJson);
+    int32_t newId = 0;
+    ok = g_bot.sendMessage(g_activeChatId, text, kbJson, &newId);
+    g_panelStats.sends++;
     yield();
-    if (ok) {
-      // Kütüphane son gönderilen mesajın id'sini buraya yazar
-      g_panelMsgId = bot.last_sent_message_id;
-    }
+    if (ok) g_panelMsgId = newId;
   }
 
-  if (!ok) {
+  if (ok) {
+    if (messageId == 0) g_panelForceNew = false;
+    g_panelCache.chat  = g_activeChatId;
+    g_panelCache.msgId = g_panelMsgId;
+    g_panelCache.hash  = h;
+  } else {
+    g_panelCache.hash = 0;
     // Son çare: kullanıcıya hata bilgisi bırak.
-    bot.sendMessage(g_activeChatId, "❌ Menü açılamadı (Telegram API). /menu yazıp tekrar dene.", "");
+    g_bot.sendMessage(g_activeChatId, "❌ Menü açılamadı (Telegram API). /menu yazıp tekrar dene.");
   }
+  tgLockGive();
 }
 
 static void openMainPanel() {
-  panelShowOrEdit(buildPanelTextMain(), kbMain(), g_panelMsgId);
+  panelShowOrEdit(buildPanelTextMain(), kbMain(), g_panelForceNew ? 0 : g_panelMsgId);
 }
 
 static void requestUiRefresh() {
+  g_panelStats.requests++;
+  if (g_uiRefreshPending) return;  // bekleyen isteğe katılır
   g_uiRefreshPending = true;
+  g_uiRefreshReqMs = millis();
 }
 
 static void uiRefreshTick() {
@@ -2184,8 +4452,13 @@ static void uiRefreshTick() {
   if (g_updateInProgress)  return;
   if (WiFi.status() != WL_CONNECTED) return;
 
+  uint32_t nowMs = millis();
+  if (nowMs - g_uiRefreshReqMs < UI_REFRESH_COALESCE_MS) return;
+  if (g_uiLastRenderMs != 0 && nowMs - g_uiLastRenderMs < UI_REFRESH_MIN_GAP_MS) return;
+
   // tek sefer çalıştır
   g_uiRefreshPending = false;
+  g_uiLastRenderMs = nowMs;
   openMainPanel();
 }
 
@@ -2194,9 +4467,11 @@ static void uiRefreshTick() {
 // =====================
 static void cbAnswer(const String& qid, const String& msg, bool alert) {
   if (qid.length() == 0) return;
+  if (!tgLockTake(TG_LOCK_WAIT_MS)) return;
   tgPrepare(3000);
   yield();
-  /*ACK*/ bot.answerCallbackQuery(qid, msg, alert);
+  /*ACK*/ g_bot.answerCallback(qid, msg, alert);
+  tgLockGive();
 }
 
 // =====================
@@ -2225,7 +4500,7 @@ static String buildStatusText(const String& who) {
   formatDateTime(g_nextImsakOffTs, c, sizeof(c));
   formatDateTime(g_spOnTs, s1, sizeof(s1));
   formatDateTime(g_spOffTs, s2, sizeof(s2));
-  formatDateTime(g_manualOffUntilTs, mo, sizeof(mo));
+  formatDateTime(relayLoadTs(g_manualOffUntilTs), mo, sizeof(mo));
 
   bool thuOn=false, spOn=false; time_t schedOff=0;
   if (isTimeValid()) getScheduleState(time(nullptr), thuOn, spOn, schedOff);
@@ -2248,7 +4523,11 @@ static String buildStatusText(const String& who) {
   msg += "Sabah tolerans: "; msg += fmtMin(g_offOffsetSec); msg += "\n";
   msg += "Persembe->Cuma ON: "; msg += a; msg += "\n";
   msg += "Persembe->Cuma OFF: "; msg += b; msg += "\n";
-  if (g_spName.length() > 0) {
+  if (g_spName.length() > 0 && g_spOnTs == 0 && g_spYmd != 0) {
+    char dmy[16]; ymdToDdMmYyyy(g_spYmd, dmy, sizeof(dmy));
+    msg += "Dini Gun: "; msg += g_spName; msg += " Miladi: "; msg += dmy; msg += "\n";
+    if (g_spHicri.length() > 0) { msg += "Hicri: "; msg += g_spHicri; msg += "\n"; }
+  } else if (g_spName.length() > 0) {
     msg += "Dini Gun ("; msg += g_spName; msg += ") ON: "; msg += s1; msg += "\n";
     msg += "Dini Gun ("; msg += g_spName; msg += ") OFF: "; msg += s2; msg += "\n";
     if (g_spHicri.length() > 0) { msg += "Hicri: "; msg += g_spHicri; msg += "\n"; }
@@ -2273,48 +4552,36 @@ static String buildStatusText(const String& who) {
 // =====================
 static int buildSpListSorted() {
   if (g_dayCount == 0) return 0;
+  if (!isTimeValid()) return 0;
 
-  time_t now = isTimeValid() ? time(nullptr) : 0;
-  bool tValid = isTimeValid();
-  int cnt = 0;
-
-  for (uint8_t k = 0; k < SPECIAL_COUNT && cnt < MAX_SP_LIST; k++) {
-    if (!isSpecialEnabled(k)) continue;
-    time_t on=0, off=0; uint32_t ymdEv=0; String hicri;
-    if (!computeWindowForSpecial(k, on, off, ymdEv, hicri)) continue;
+  time_t now = time(nullptr);
+  tlEnsure();
 
-    uint8_t group = 2;
-    if (tValid && now >= on && now < off) group = 0;
-    else if (tValid && on > now)          group = 1;
-    if (group == 2) continue;
+  // Timeline OFF sırasına göre: önce aktif pencere(ler), sonra yaklaşanlar (en yakın tarih üstte)
+  int cnt = 0;
+  for (int i = tlUpperBound(now); i < (int)g_tlCount && cnt < MAX_SP_LIST; i++) {
+    const SchedTransition& t = g_tl[i];
+    if (t.on != 0 || ((1u << t.reason) & SRM_DINI) == 0) continue;
 
     SpItemLite it{};
-    it.ymd = ymdEv; it.on = on; it.off = off;
-    it.kind = KIND_SPECIAL; it.specialIndex = k; it.stateGroup = group;
+    it.ymd = t.ymd; it.on = t.peer; it.off = t.ts;
+    it.stateGroup = (t.peer <= now) ? 0 : 1;
+    if (t.reason == SR_SPECIAL) { it.kind = KIND_SPECIAL; it.specialIndex = t.arg; }
+    else                        { it.kind = KIND_RAMAZAN; it.ramazanDay = t.arg; }
     g_spList[cnt++] = it;
   }
 
-  if (g_enableRamazanAll) {
-    for (int idx=0; idx<(int)g_dayCount && cnt < MAX_SP_LIST; idx++) {
-      int dayNo=0;
-      if (!isRamazanIdx(idx, dayNo)) continue;
-
-      time_t on=0, off=0;
-      if (!buildWindowForEventIdx(idx, on, off)) continue;
-
-      uint8_t group = 2;
-      if (tValid && now >= on && now < off) group = 0;
-      else if (tValid && on > now)          group = 1;
-      if (group == 2) continue;
-
-      SpItemLite it{};
-      it.ymd = g_days[idx].ymd; it.on = on; it.off = off;
-      it.kind = KIND_RAMAZAN; it.ramazanDay = (uint8_t)dayNo; it.stateGroup = group;
-      g_spList[cnt++] = it;
-    }
+  // Cache ufku ötesi: 12 aylık tahmin
+  int np = predictSpecialsBeyondCache(now);
+  for (int p = 0; p < np && cnt < MAX_SP_LIST; p++) {
+    SpItemLite it{};
+    it.ymd = g_spPred[p].ymd;
+    it.stateGroup = 1;
+    it.predicted = 1;
+    if (g_spPred[p].reason == SR_SPECIAL) { it.kind = KIND_SPECIAL; it.specialIndex = g_spPred[p].arg; }
+    else                                  { it.kind = KIND_RAMAZAN; it.ramazanDay = g_spPred[p].arg; }
+    g_spList[cnt++] = it;
   }
-
-  if (cnt > 0) sortSpLite(g_spList, cnt);
   return cnt;
 }
 
@@ -2324,7 +4591,11 @@ static String formatSpItem(const SpItemLite& item) {
   String st = (item.stateGroup==0) ? "🟢 AKTIF" : "🟡 YAKLASAN";
   String name;
   if (item.kind == KIND_SPECIAL) name = String(g_specials[item.specialIndex].name);
+  else if (item.predicted)       name = String("Ramazan Başlangıcı");
   else name = String("Ramazan Günü ") + String(item.ramazanDay);
+  if (item.predicted) {
+    return String("📅 TAHMINI - ") + name + " Miladi: " + String(ddmmyyyy) + " (" + hijriTextForYmd(item.ymd) + ")\n";
+  }
   return String("✅ ") + st + " - " + name + " Miladi: " + String(ddmmyyyy) + "\n";
 }
 
@@ -2357,257 +4628,252 @@ static String buildDiniGunlerWebText() {
 // =====================
 // Telegram handler
 // =====================
-static void handleTelegram() {
-  if (g_updateInProgress) return;
-  if (WiFi.status() != WL_CONNECTED) return;
-
-  uint32_t nowMs = millis();
-  if (nowMs - g_lastTgPollMs < TG_POLL_MS) return;
-  g_lastTgPollMs = nowMs;
-
-  int cycles = 0;
-  int n = bot.getUpdates(bot.last_message_received + 1);
-  while (n && cycles++ < 3) {
-    for (int i = 0; i < n; i++) {
-      String chat_id = bot.messages[i].chat_id;
-      String text    = bot.messages[i].text;
-      String who = whoStr(bot.messages[i]);
-      int64_t uid = atoll(bot.messages[i].from_id.c_str());
-      bool isAdminUser = isAdmin(uid);
-      bool isOwnerUser = (uid == OWNER_ADMIN_ID);
-
-      // Panel açma komutları (OWNER farklı sohbette kullanırsa aktif chat otomatik taşınır)
-      bool cmdPanel = (cmdIs(text, "/start") || cmdIs(text, "/menu") || cmdIs(text, "/panel"));
-      bool cmdPair  = (cmdIs(text, "/admin_menu")  || cmdIs(text, "/pair")  || cmdIs(text, "/eslestir") || cmdIs(text, "/eşleştir"));
-      bool cmdMyId  = (cmdIs(text, "/myid"));
-
-      // Aktif chat dışından sadece OWNER için: /myid ve (otomatik taşıma) /menu-/panel-/start veya /admin_menu izinli
-      if (!isActiveChatId(chat_id)) {
-        if (isOwnerUser && (cmdPanel || cmdPair)) {
-          g_activeChatId = chat_id;
-          saveActiveChatToNvs();
-          g_panelMsgId = 0; // yeni chat'te yeni panel gönderilsin
-          g_lastTgMsg = ""; g_lastTgMsgMs = 0;
-          logSerialAndTg("📌 Aktif chat değişti -> " + g_activeChatId, false, false);
-        } else if (isOwnerUser && cmdMyId) {
-          // /myid her yerden çalışsın
-        } else {
-          continue;
-        }
-      }
+static void tgHandleMessage(const TgUpdate& m) {
+  String chat_id = m.chatId;
+  String text    = m.text;
+  String who = whoStr(m);
+  int64_t uid = atoll(m.fromId);
+  bool isAdminUser = isAdmin(uid);
+  bool isOwnerUser = (uid == OWNER_ADMIN_ID);
+
+  // Panel açma komutları (OWNER farklı sohbette kullanırsa aktif chat otomatik taşınır)
+  bool cmdPanel = (cmdIs(text, "/start") || cmdIs(text, "/menu") || cmdIs(text, "/panel"));
+  bool cmdPair  = (cmdIs(text, "/admin_menu")  || cmdIs(text, "/pair")  || cmdIs(text, "/eslestir") || cmdIs(text, "/eşleştir"));
+  bool cmdMyId  = (cmdIs(text, "/myid"));
+
+  // Aktif chat dışından sadece OWNER için: /myid ve (otomatik taşıma) /menu-/panel-/start veya /admin_menu izinli
+  if (!isActiveChatId(chat_id)) {
+    if (isOwnerUser && (cmdPanel || cmdPair)) {
+      g_activeChatId = chat_id;
+      saveActiveChatToNvs();
+      g_panelMsgId = 0; // yeni chat'te yeni panel gönderilsin
+      g_lastTgMsg = ""; g_lastTgMsgMs = 0;
+      logSerialAndTg("📌 Aktif chat değişti -> " + g_activeChatId, false, false);
+    } else if (isOwnerUser && cmdMyId) {
+      // /myid her yerden çalışsın
+    } else {
+      return;
+    }
+  }
 
-      // Kullanıcı aktivitesi: arka plandaki ağır işlemleri (vakit indirme gibi) geciktirmek için
-      g_lastUserActivityMs = millis();
+  // Kullanıcı aktivitesi: arka plandaki ağır işlemleri (vakit indirme gibi) geciktirmek için
+  g_lastUserActivityMs = millis();
 
-      // Panel mesaj id'yi callback ile güncelle (edit stabil olsun)
-      if (bot.messages[i].type == "callback_query") {
-        g_panelMsgId = bot.messages[i].message_id; // int
-        String qid = bot.messages[i].query_id;
+  // Panel mesaj id'yi callback ile güncelle (edit stabil olsun)
+  if (strcmp(m.type, "callback_query") == 0) {
+    g_panelMsgId = m.messageId;
+    String qid = m.queryId;
 
-        // ---- CALLBACK ACTIONS ----
-        const String data = text; // callback_data
+    // ---- CALLBACK ACTIONS ----
+    const String data = text; // callback_data
 
-        if (data == "REFRESH") {
-          cbAnswer(qid, "Yenileniyor…", false);
-          requestUiRefresh();
-        }
-        else if (data == "BACK_MAIN") {
-          cbAnswer(qid, "Ana menü", false);
-          requestUiRefresh();
-        }
-        else if (data == "TOGGLE") {
-          if (!isAdminUser) {
-            cbAnswer(qid, "Yetkisiz", true);
-          } else {
-            cbAnswer(qid, g_relayState ? "Kapatılıyor…" : "Açılıyor…", false);
-
-            if (g_relayState) {
-              manualRelayOff("TG Panel", who);
-            } else {
-              int rc = manualRelayOn("TG Panel", who);
-              if (rc == 1) {
-                g_mainBottom = "⛔ Şu an ON engelli (Zorunlu OFF sonrası)";
-              }
-            }
+    if (data == "REFRESH") {
+      cbAnswer(qid, "Yenileniyor…", false);
+      requestUiRefresh();
+    }
+    else if (data == "BACK_MAIN") {
+      cbAnswer(qid, "Ana menü", false);
+      requestUiRefresh();
+    }
+    else if (data == "TOGGLE") {
+      if (!isAdminUser) {
+        cbAnswer(qid, "Yetkisiz", true);
+      } else {
+        cbAnswer(qid, g_relayState ? "Kapatılıyor…" : "Açılıyor…", false);
 
-            requestUiRefresh();
+        if (g_relayState) {
+          manualRelayOff("TG Panel", who);
+        } else {
+          int rc = manualRelayOn("TG Panel", who);
+          if (rc == 1) {
+            g_mainBottom = "⛔ Şu an ON engelli (Zorunlu OFF sonrası)";
           }
         }
-        else {
-          cbAnswer(qid, "Bu menü kaldırıldı", false);
-          requestUiRefresh();
-        }
-        continue; // callback işlendi
-      }
 
-      // ---- NORMAL MESSAGE COMMANDS ----
-
-      if (cmdMyId) {
-        String msg;
-        msg += "👤 " + who + "\n";
-        msg += "chat_id=" + chat_id + "\n";
-        msg += "active_chat=" + g_activeChatId + "\n";
-        msg += "admin=" + String(isAdminUser ? "1" : "0") + " owner=" + String(isOwnerUser ? "1" : "0");
-        tgSendTo(chat_id, msg);
-      }
-      else if (cmdPair) {
-        // Geri uyumluluk: /pair komutu artik /admin_menu olarak degisti
-        bool usedLegacyPair = cmdIs(text, "/pair");
-        if (usedLegacyPair && isOwnerUser) {
-          tgSendTo(chat_id, "ℹ️ Komut degisti: /pair yerine /admin_menu kullan.\nYine de eslestirme yapildi.");
-        }
-        if (!isOwnerUser) {
-          tgSendTo(chat_id, "⛔ Yetkisiz: /admin_menu (sadece OWNER)");
-        } else {
-          g_activeChatId = chat_id;
-          saveActiveChatToNvs();
-          g_panelMsgId = 0;
-          g_lastTgMsg = ""; g_lastTgMsgMs = 0;
-          tgSendTo(chat_id, "✅ Eşleştirildi. Artık komutlar bu sohbetten çalışır.");
-          g_mainBottom = "";
-          requestUiRefresh();
-        }
-      }
-      else if (cmdPanel) {
-        // Panel aç / edit et
-        g_mainBottom = "";
         requestUiRefresh();
       }
-      else if (cmdIs(text, "/help") || cmdIs(text, "/yardim") || cmdIs(text, "/yardım")) {
-        String msg;
-        msg += "Komutlar:\n";
-        msg += "/panel (/start /menu)\n";
-        msg += "/durum\n/myid\n/dinigunler\n";
-        msg += "/admin_menu (OWNER)\n";
-        msg += "\nAdmin:\n";
-        msg += "/on /off /guncelle\n/admin_list\n/admin_add <id>\n/admin_del <id>\n";
-        tgSendTo(chat_id, msg);
-      }
-      else if (cmdIs(text, "/durum") || cmdIs(text, "/status")) {
-        tgSendTo(chat_id, buildStatusText(who));
-        logUser("TG: /durum (" + who + ")");
-      }
-      else if (cmdIs(text, "/dinigunler") || cmdIs(text, "/dinigünler")) {
-        sendDiniGunlerList();
-      }
+    }
+    else {
+      cbAnswer(qid, "Bu menü kaldırıldı", false);
+      requestUiRefresh();
+    }
+    return; // callback işlendi
+  }
 
-      // Admin komutları
-      else if (cmdIs(text, "/admin_list") || cmdIs(text, "/admins")) {
-        if (!isAdminUser) {
-          tgSendTo(chat_id, "⛔ Yetkisiz: /admin_list\n👤 " + who);
-          logSerialAndTg("⛔ YETKISIZ /admin_list  " + who, true, true);
-        } else {
-          String msg = "👮 Admin listesi:\n";
-          for (uint8_t k = 0; k < g_adminCount; k++) {
-            msg += String((long long)g_adminIds[k]);
-            if (g_adminIds[k] == OWNER_ADMIN_ID) msg += " (OWNER)";
-            msg += "\n";
-          }
-          tgSendTo(chat_id, msg);
-        }
+  // ---- NORMAL MESSAGE COMMANDS ----
+
+  if (cmdMyId) {
+    String msg;
+    msg += "👤 " + who + "\n";
+    msg += "chat_id=" + chat_id + "\n";
+    msg += "active_chat=" + g_activeChatId + "\n";
+    msg += "admin=" + String(isAdminUser ? "1" : "0") + " owner=" + String(isOwnerUser ? "1" : "0");
+    tgSendTo(chat_id, msg);
+  }
+  else if (cmdPair) {
+    // Geri uyumluluk: /pair komutu artik /admin_menu olarak degisti
+    bool usedLegacyPair = cmdIs(text, "/pair");
+    if (usedLegacyPair && isOwnerUser) {
+      tgSendTo(chat_id, "ℹ️ Komut degisti: /pair yerine /admin_menu kullan.\nYine de eslestirme yapildi.");
+    }
+    if (!isOwnerUser) {
+      tgSendTo(chat_id, "⛔ Yetkisiz: /admin_menu (sadece OWNER)");
+    } else {
+      g_activeChatId = chat_id;
+      saveActiveChatToNvs();
+      g_panelMsgId = 0;
+      g_lastTgMsg = ""; g_lastTgMsgMs = 0;
+      tgSendTo(chat_id, "✅ Eşleştirildi. Artık komutlar bu sohbetten çalışır.");
+      g_mainBottom = "";
+      requestUiRefresh();
+    }
+  }
+  else if (cmdPanel) {
+    // Panel aç: içerik aynı olsa da yeni mesaj (eski panel yukarıda kalmış olabilir)
+    g_mainBottom = "";
+    g_panelForceNew = true;
+    requestUiRefresh();
+  }
+  else if (cmdIs(text, "/help") || cmdIs(text, "/yardim") || cmdIs(text, "/yardım")) {
+    String msg;
+    msg += "Komutlar:\n";
+    msg += "/panel (/start /menu)\n";
+    msg += "/durum\n/myid\n/dinigunler\n";
+    msg += "/admin_menu (OWNER)\n";
+    msg += "\nAdmin:\n";
+    msg += "/on /off /guncelle\n/admin_list\n/admin_add <id>\n/admin_del <id>\n";
+    tgSendTo(chat_id, msg);
+  }
+  else if (cmdIs(text, "/durum") || cmdIs(text, "/status")) {
+    tgSendTo(chat_id, buildStatusText(who));
+    logUser("TG: /durum (" + who + ")");
+  }
+  else if (cmdIs(text, "/dinigunler") || cmdIs(text, "/dinigünler")) {
+    sendDiniGunlerList();
+  }
+
+  // Admin komutları
+  else if (cmdIs(text, "/admin_list") || cmdIs(text, "/admins")) {
+    if (!isAdminUser) {
+      tgSendTo(chat_id, "⛔ Yetkisiz: /admin_list\n👤 " + who);
+      logSerialAndTg("⛔ YETKISIZ /admin_list  " + who, true, true);
+    } else {
+      String msg = "👮 Admin listesi:\n";
+      for (uint8_t k = 0; k < g_adminCount; k++) {
+        msg += String((long long)g_adminIds[k]);
+        if (g_adminIds[k] == OWNER_ADMIN_ID) msg += " (OWNER)";
+        msg += "\n";
       }
-      else if (text.startsWith("/admin_add")) {
-        if (!isAdminUser) {
-          tgSendTo(chat_id, "⛔ Yetkisiz: /admin_add\n👤 " + who);
-          logSerialAndTg("⛔ YETKISIZ /admin_add  " + who, true, true);
-        } else {
-          int64_t newId = parseIdArg(text);
-          if (newId == 0) tgSendTo(chat_id, "Kullanim: /admin_add 123456789\nİpucu: kisi /myid yazsin.");
-          else {
-            bool ok = addAdmin(newId);
-            if (ok) {
-              tgSendTo(chat_id, "✅ Admin eklendi: " + String((long long)newId) + "\n👤 Ekleyen: " + who);
-              logSerialAndTg("✅ Admin eklendi: " + String((long long)newId) + "  Ekleyen: " + who, true, true);
-              logUser("TG: Admin eklendi (" + who + ")");
-            } else tgSendTo(chat_id, "❌ Admin eklenemedi (liste dolu olabilir).");
-          }
-        }
+      tgSendTo(chat_id, msg);
+    }
+  }
+  else if (text.startsWith("/admin_add")) {
+    if (!isAdminUser) {
+      tgSendTo(chat_id, "⛔ Yetkisiz: /admin_add\n👤 " + who);
+      logSerialAndTg("⛔ YETKISIZ /admin_add  " + who, true, true);
+    } else {
+      int64_t newId = parseIdArg(text);
+      if (newId == 0) tgSendTo(chat_id, "Kullanim: /admin_add 123456789\nİpucu: kisi /myid yazsin.");
+      else {
+        bool ok = addAdmin(newId);
+        if (ok) {
+          tgSendTo(chat_id, "✅ Admin eklendi: " + String((long long)newId) + "\n👤 Ekleyen: " + who);
+          logSerialAndTg("✅ Admin eklendi: " + String((long long)newId) + "  Ekleyen: " + who, true, true);
+          logUser("TG: Admin eklendi (" + who + ")");
+        } else tgSendTo(chat_id, "❌ Admin eklenemedi (liste dolu olabilir).");
       }
-      else if (text.startsWith("/admin_del")) {
-        if (!isAdminUser) {
-          tgSendTo(chat_id, "⛔ Yetkisiz: /admin_del\n👤 " + who);
-          logSerialAndTg("⛔ YETKISIZ /admin_del  " + who, true, true);
-        } else {
-          int64_t delId = parseIdArg(text);
-          if (delId == 0) tgSendTo(chat_id, "Kullanim: /admin_del 123456789");
-          else {
-            bool ok = delAdmin(delId);
-            if (ok) {
-              tgSendTo(chat_id, "✅ Admin silindi: " + String((long long)delId) + "\n👤 Silen: " + who);
-              logSerialAndTg("✅ Admin silindi: " + String((long long)delId) + "  Silen: " + who, true, true);
-              logUser("TG: Admin silindi (" + who + ")");
-            } else tgSendTo(chat_id, "❌ Admin silinemedi (OWNER/son admin olabilir veya yok).");
-          }
-        }
+    }
+  }
+  else if (text.startsWith("/admin_del")) {
+    if (!isAdminUser) {
+      tgSendTo(chat_id, "⛔ Yetkisiz: /admin_del\n👤 " + who);
+      logSerialAndTg("⛔ YETKISIZ /admin_del  " + who, true, true);
+    } else {
+      int64_t delId = parseIdArg(text);
+      if (delId == 0) tgSendTo(chat_id, "Kullanim: /admin_del 123456789");
+      else {
+        bool ok = delAdmin(delId);
+        if (ok) {
+          tgSendTo(chat_id, "✅ Admin silindi: " + String((long long)delId) + "\n👤 Silen: " + who);
+          logSerialAndTg("✅ Admin silindi: " + String((long long)delId) + "  Silen: " + who, true, true);
+          logUser("TG: Admin silindi (" + who + ")");
+        } else tgSendTo(chat_id, "❌ Admin silinemedi (OWNER/son admin olabilir veya yok).");
       }
-      else if (cmdIs(text, "/on")) {
-        if (!isAdminUser) {
-          tgSendTo(chat_id, "⛔ Yetkisiz: /on\n👤 " + who);
-          logSerialAndTg("⛔ YETKISIZ /on  " + who, true, true);
-        } else {
-          int rc = manualRelayOn("TG", who);
-          if (rc == 1) {
-            tgSendTo(chat_id, "⛔ Su an ON engelli (Zorunlu OFF sonrasi).\n👤 " + who);
-          } else {
-            char offb[32];
-            formatDateTime(g_nextImsakOffTs, offb, sizeof(offb));
-            int tolMin = (g_offOffsetSec >= 0) ? (g_offOffsetSec / 60) : 0;
-            String offInfo = String(offb);
-            if (g_nextImsakOffTs == 0) offInfo = "-";
-            tgSendTo(chat_id, "✅ Manual ON.\n⛔ Zorunlu OFF: " + offInfo + " (İmsak - Sabah tolerans: " + String(tolMin) + " dk)\n👤 " + who);
-          }
-        }
+    }
+  }
+  else if (cmdIs(text, "/on")) {
+    if (!isAdminUser) {
+      tgSendTo(chat_id, "⛔ Yetkisiz: /on\n👤 " + who);
+      logSerialAndTg("⛔ YETKISIZ /on  " + who, true, true);
+    } else {
+      int rc = manualRelayOn("TG", who);
+      if (rc == 1) {
+        tgSendTo(chat_id, "⛔ Su an ON engelli (Zorunlu OFF sonrasi).\n👤 " + who);
+      } else {
+        char offb[32];
+        formatDateTime(g_nextImsakOffTs, offb, sizeof(offb));
+        int tolMin = (g_offOffsetSec >= 0) ? (g_offOffsetSec / 60) : 0;
+        String offInfo = String(offb);
+        if (g_nextImsakOffTs == 0) offInfo = "-";
+        tgSendTo(chat_id, "✅ Manual ON.\n⛔ Zorunlu OFF: " + offInfo + " (İmsak - Sabah tolerans: " + String(tolMin) + " dk)\n👤 " + who);
       }
-      else if (cmdIs(text, "/off")) {
-        if (!isAdminUser) {
-          tgSendTo(chat_id, "⛔ Yetkisiz: /off\n👤 " + who);
-          logSerialAndTg("⛔ YETKISIZ /off  " + who, true, true);
-        } else {
-          time_t untilTs = manualRelayOff("TG", who);
+    }
+  }
+  else if (cmdIs(text, "/off")) {
+    if (!isAdminUser) {
+      tgSendTo(chat_id, "⛔ Yetkisiz: /off\n👤 " + who);
+      logSerialAndTg("⛔ YETKISIZ /off  " + who, true, true);
+    } else {
+      time_t untilTs = manualRelayOff("TG", who);
 
-          if (untilTs != 0) {
-            char ub[32]; formatDateTime(untilTs, ub, sizeof(ub));
-            tgSendTo(chat_id, "✅ Manual OFF (Scheduled override)\n⛔ Tekrar ON olmayacak (pencere bitişi): " + String(ub) + "\n👤 " + who);
-          } else {
-            tgSendTo(chat_id, "✅ Manual OFF\n👤 " + who);
-          }
-        }
-      }
-      else if (cmdIs(text, "/guncelle") || cmdIs(text, "/güncelle") || cmdIs(text, "/update")) {
-        if (!isAdminUser) {
-          tgSendTo(chat_id, "⛔ Yetkisiz: /guncelle\n👤 " + who);
-          logSerialAndTg("⛔ YETKISIZ /guncelle  " + who, true, true);
-        } else {
-          tgSaveLastIdToNvsIfNew();
-
-          if (g_updateInProgress) {
-            tgSendTo(chat_id, "⏳ Zaten guncelleme calisiyor.\n👤 " + who);
-          } else if (g_updatePending) {
-            tgSendTo(chat_id, "⏳ Guncelleme kuyrukta.\n👤 " + who);
-          } else if (g_updateCooldownUntilMs != 0 && !millisPassed(g_updateCooldownUntilMs)) {
-            tgSendTo(chat_id, "⏳ Bekle: guncelleme koruma (cooldown) aktif.\n👤 " + who);
-          } else {
-            g_updatePending = true;
-            g_updateRequesterWho = who;
-
-            tgSendTo(chat_id, "✅ /guncelle alindi. Cache guncellemesi baslatilacak...\n👤 " + who);
-            logSerialAndTg("📌 /guncelle kuyruğa alindi  " + who, true, true);
-            logUser("TG: Vakit guncelleme (" + who + ")");
-          }
-        }
+      if (untilTs != 0) {
+        char ub[32]; formatDateTime(untilTs, ub, sizeof(ub));
+        tgSendTo(chat_id, "✅ Manual OFF (Scheduled override)\n⛔ Tekrar ON olmayacak (pencere bitişi): " + String(ub) + "\n👤 " + who);
+      } else {
+        tgSendTo(chat_id, "✅ Manual OFF\n👤 " + who);
       }
     }
-
-    yield();
-    n = bot.getUpdates(bot.last_message_received + 1);
   }
+  else if (cmdIs(text, "/guncelle") || cmdIs(text, "/güncelle") || cmdIs(text, "/update")) {
+    if (!isAdminUser) {
+      tgSendTo(chat_id, "⛔ Yetkisiz: /guncelle\n👤 " + who);
+      logSerialAndTg("⛔ YETKISIZ /guncelle  " + who, true, true);
+    } else {
+      tgSaveLastIdToNvsIfNew();
+
+      if (g_updateInProgress) {
+        tgSendTo(chat_id, "⏳ Zaten guncelleme calisiyor.\n👤 " + who);
+      } else if (g_updatePending) {
+        tgSendTo(chat_id, "⏳ Guncelleme kuyrukta.\n👤 " + who);
+      } else if (g_updateCooldownUntilMs != 0 && !millisPassed(g_updateCooldownUntilMs)) {
+        tgSendTo(chat_id, "⏳ Bekle: guncelleme koruma (cooldown) aktif.\n👤 " + who);
+      } else {
+        g_updatePending = true;
+        g_updateRequesterWho = who;
+        stateBump();
 
-  // Güvenlik: beklenmeyen bir durumda aynı update'ler tekrar gelirse sonsuz döngüye girme
-  if (n && cycles >= 3) {
-    Serial.println("[TG] Uyari: getUpdates dongusu limite takildi (muhtemel tekrarlayan update). Bir sonraki poll'da devam.");
+        tgSendTo(chat_id, "✅ /guncelle alindi. Cache guncellemesi baslatilacak...\n👤 " + who);
+        logSerialAndTg("📌 /guncelle kuyruğa alindi  " + who, true, true);
+        logUser("TG: Vakit guncelleme (" + who + ")");
+      }
+    }
   }
+}
+
+// loop: alım görevinin kuyruğundaki update'leri işle
+static void handleTelegram() {
+  if (!g_tgRxQ) return;
+  if (WiFi.status() != WL_CONNECTED) return;  // cevaplar gidemez: kuyrukta beklesin
 
-  tgSaveLastIdToNvsIfNew();
+  static TgUpdate m;  // ~400 bayt: loop yığını yerine
+  int cnt = 0;
+  while (cnt++ < TG_RX_PER_LOOP && xQueueReceive(g_tgRxQ, &m, 0) == pdTRUE) {
+    if (m.updateId <= g_tgDoneUpdateId) continue;  // yeniden teslim: zaten işlendi
+    tgHandleMessage(m);
+    if (m.updateId > g_tgDoneUpdateId) g_tgDoneUpdateId = m.updateId;
+    yield();
+  }
+  if (cnt > 1) tgSaveLastIdToNvsIfNew();
 }
 
 
@@ -2667,6 +4933,64 @@ static void webSendJsonError(int code, const char* err, const char* msg = nullpt
   g_web->send(code, "application/json", r);
 }
 
+// Accept: application/cbor -> aynı içerik CBOR olarak (panel, filo toplayıcı). Yoksa JSON.
+static bool webWantsCbor() {
+  return strstr(g_web->header("Accept").c_str(), "application/cbor") != nullptr;
+}
+
+// Parçalı JSON/CBOR yanıtı (include/json_out.h): belge/String yok, JSON_OUT_BUF'lık parçalar
+// halinde sokete gider. Handler'lar sırayla çalışır: yazıcı tek.
+static JsonOut g_jsonOut;
+static bool webJsonSink(const char* data, size_t len, void*) {
+  if (!g_web->sendChunk(data, len)) return false;   // istemci almıyor: JsonOut durur
+  return true;
+}
+static JsonOut& webJsonBegin() {
+  uint8_t fmt = webWantsCbor() ? JO_CBOR : JO_JSON;
+  g_web->sendHeader("Vary", "Accept");
+  g_web->beginChunked(200, fmt == JO_CBOR ? "application/cbor" : "application/json");
+  jsonOutInit(g_jsonOut, webJsonSink, nullptr, fmt);
+  jsonObjBegin(g_jsonOut);
+  return g_jsonOut;
+}
+
+// ArduinoJson belgesini JsonOut'a yürüt (önbellekli yanıtların CBOR hali)
+static void webDocToOut(JsonOut& j, const char* key, JsonVariantConst v) {
+  if (v.is<JsonObjectConst>()) {
+    jsonObjBegin(j, key);
+    for (JsonPairConst kv : v.as<JsonObjectConst>()) webDocToOut(j, kv.key().c_str(), kv.value());
+    jsonEnd(j);
+  } else if (v.is<JsonArrayConst>()) {
+    jsonArrBegin(j, key);
+    for (JsonVariantConst e : v.as<JsonArrayConst>()) webDocToOut(j, nullptr, e);
+    jsonEnd(j);
+  } else if (v.is<bool>()) {
+    jsonBool(j, key, v.as<bool>());
+  } else if (v.is<long>()) {
+    jsonInt(j, key, v.as<long>());
+  } else if (v.is<unsigned long>()) {
+    jsonUint(j, key, v.as<unsigned long>());
+  } else if (v.is<double>()) {
+    jsonNum(j, key, v.as<double>(), 9);
+  } else if (v.is<const char*>()) {
+    jsonStr(j, key, v.as<const char*>());
+  } else {
+    jsonNull(j, key);
+  }
+}
+
+static bool webStrSink(const char* data, size_t len, void* ctx) {
+  return ((String*)ctx)->concat(data, len);
+}
+
+// Belge -> out (JSON ya da CBOR). g_jsonOut burada boşta: parçalı yanıt aynı anda üretilmez.
+static void webSerializeDoc(const JsonDocument& doc, String& out, bool cbor) {
+  if (!cbor) { serializeJson(doc, out); return; }
+  jsonOutInit(g_jsonOut, webStrSink, &out, JO_CBOR);
+  webDocToOut(g_jsonOut, nullptr, doc);
+  jsonOutFinish(g_jsonOut);
+}
+
 // Basit yetki kontrolü endpoint'i (Public sayfadan "anahtar doğru mu" kontrolü için)
 static void webHandleAuthCheck() {
   if (!webRequireAuth()) return;
@@ -2674,458 +4998,109 @@ static void webHandleAuthCheck() {
 }
 
 // =====================
-// Web HTML (Public + Admin Tabs)
-// =====================
-static const char WEB_PUBLIC_HTML[] PROGMEM = R"HTML(
-<!doctype html><html lang="tr"><head>
-<meta charset="utf-8"/>
-<meta name="viewport" content="width=device-width,initial-scale=1,maximum-scale=1"/>
-<meta name="theme-color" content="#0b6"/>
-<meta name="apple-mobile-web-app-capable" content="yes"/>
-<title>Cami Otomasyon</title>
-<style>
-:root{--ac:#0b6;--bg:#f0f4f3;--card:#fff;--cb:rgba(0,0,0,.06);--tx:#1a2332;--ts:#6b7c8d;--ib:#f6f8fa;--ibr:#d0d7de;--hd:linear-gradient(135deg,#0b6 0%,#087f5b 50%,#0a5e42 100%)}
-.dk{--bg:#0d1117;--card:#161b22;--cb:rgba(255,255,255,.06);--tx:#e6edf3;--ts:#8b949e;--ib:#21262d;--ibr:#30363d;--hd:linear-gradient(135deg,#0d2818 0%,#0a1628 50%,#1a0a28 100%)}
-*{box-sizing:border-box;margin:0;padding:0}
-body{font-family:'Segoe UI',-apple-system,BlinkMacSystemFont,sans-serif;background:var(--bg);color:var(--tx);transition:background .3s,color .3s}
-.hdr{background:var(--hd);padding:20px 16px 16px;border-radius:0 0 24px 24px;box-shadow:0 4px 20px rgba(0,0,0,.15);position:relative;z-index:2}
-.hdr-in{max-width:720px;margin:0 auto}
-.hdr h1{font-size:22px;font-weight:800;color:#fff;letter-spacing:-.02em}
-.hdr .sub{font-size:12px;color:rgba(255,255,255,.7);margin-top:3px}
-.hdr-btns{display:flex;gap:6px}
-.hdr-btn{width:36px;height:36px;border-radius:10px;border:1px solid rgba(255,255,255,.2);background:rgba(255,255,255,.1);color:#fff;cursor:pointer;display:flex;align-items:center;justify-content:center;font-size:16px}
-.tabs{display:flex;gap:5px;margin-top:14px;overflow-x:auto;padding-bottom:2px;-webkit-overflow-scrolling:touch}
-.tabs::-webkit-scrollbar{display:none}
-.tab{padding:7px 13px;border-radius:18px;border:none;font-size:12px;font-weight:600;cursor:pointer;white-space:nowrap;transition:all .2s}
-.tab.on{background:rgba(255,255,255,.93);color:#0a5e42}
-.tab.off{background:rgba(255,255,255,.12);color:rgba(255,255,255,.85)}
-.tab.lock{border:1px solid rgba(255,255,255,.25);background:transparent;color:rgba(255,255,255,.85)}
-.main{max-width:720px;margin:0 auto;padding:16px 14px 40px;position:relative;z-index:1}
-.cd{background:var(--card);border:1px solid var(--cb);border-radius:18px;padding:18px;margin-bottom:14px;box-shadow:0 2px 10px rgba(0,0,0,.04);transition:all .3s}
-.dk .cd{box-shadow:0 2px 10px rgba(0,0,0,.25)}
-.cd h3{font-size:17px;font-weight:700;margin-bottom:14px}
-.row{display:flex;gap:10px;flex-wrap:wrap;align-items:center}
-.grid2{display:grid;grid-template-columns:1fr 1fr;gap:10px}
-.grid3{display:grid;grid-template-columns:repeat(3,1fr);gap:9px}
-.grid4{display:grid;grid-template-columns:repeat(4,1fr);gap:12px}
-.btn{padding:9px 18px;border-radius:11px;border:none;font-size:13px;font-weight:600;cursor:pointer;transition:all .2s;display:inline-flex;align-items:center;gap:5px}
-.btn-p{background:var(--ac);color:#fff}
-.btn-s{background:var(--ib);color:var(--tx);border:1px solid var(--cb)}
-.btn-d{background:transparent;color:#e74c3c;border:1px solid rgba(231,76,60,.3)}
-.btn-relay{padding:14px 28px;border-radius:14px;border:none;font-size:16px;font-weight:700;cursor:pointer;transition:all .3s;display:inline-flex;align-items:center;gap:8px;min-width:200px;justify-content:center}
-.btn-relay.on{background:linear-gradient(135deg,#0b6,#087f5b);color:#fff;box-shadow:0 4px 16px rgba(0,180,130,.3)}
-.btn-relay.off{background:linear-gradient(135deg,#e74c3c,#c0392b);color:#fff;box-shadow:0 4px 16px rgba(231,76,60,.3)}
-input[type=text],input[type=password],input[type=number],select{padding:9px 12px;border-radius:11px;border:1.5px solid var(--ibr);background:var(--ib);color:var(--tx);font-size:13px;outline:none;width:100%;box-sizing:border-box;transition:border .2s}
-input:focus,select:focus{border-color:var(--ac)!important;box-shadow:0 0 0 3px rgba(0,180,130,.12)}
-input:disabled,select:disabled{opacity:.5;cursor:not-allowed;background:rgba(128,128,128,.08)}
-label.lbl{font-size:12px;font-weight:600;color:var(--ts);margin-bottom:5px;display:block;letter-spacing:.02em}
-.badge{display:inline-block;padding:4px 10px;border-radius:99px;font-size:12px;font-weight:600}
-.bg-ok{background:rgba(0,180,130,.1);color:var(--ac)}
-.bg-err{background:rgba(231,76,60,.08);color:#e74c3c}
-.bg-warn{background:rgba(255,180,0,.1);color:#b08000}
-.stat{display:flex;align-items:center;gap:7px;padding:7px 11px;border-radius:9px;background:rgba(128,128,128,.06);font-size:12px}
-.stat .k{color:var(--ts)}.stat .v{margin-left:auto;font-weight:600;font-variant-numeric:tabular-nums}
-.bar-wrap{margin-bottom:12px}
-.bar-hdr{display:flex;justify-content:space-between;font-size:12px;margin-bottom:4px}
-.bar-hdr .k{font-weight:600}.bar-hdr .v{color:var(--ts);font-variant-numeric:tabular-nums}
-.bar{height:7px;border-radius:4px;background:rgba(128,128,128,.1);overflow:hidden}
-.bar-fill{height:100%;border-radius:4px;transition:width 1s ease}
-.prayer{border-radius:14px;padding:12px 8px;text-align:center;border:1.5px solid var(--cb);background:rgba(128,128,128,.04);transition:all .3s;position:relative}
-.prayer.next{background:rgba(0,180,130,.1);border-color:var(--ac);box-shadow:0 3px 14px rgba(0,180,130,.15)}
-.prayer .nm{font-size:11px;opacity:.6;margin-bottom:2px}
-.prayer .tm{font-size:20px;font-weight:700;font-variant-numeric:tabular-nums}
-.prayer.next .tm{color:var(--ac);font-size:23px}
-.sbox{border-radius:13px;padding:12px 14px;border:1px solid var(--cb);background:rgba(128,128,128,.03)}
-.live{display:flex;align-items:center;gap:5px;padding:4px 10px;border-radius:18px;font-size:11px;font-weight:600;cursor:pointer}
-.live.on{background:rgba(0,180,130,.1);color:var(--ac)}
-.live .dot{width:7px;height:7px;border-radius:50%}
-.live.on .dot{background:var(--ac);animation:pulse 2s infinite}
-.sig-bars{display:flex;align-items:flex-end;gap:2px;height:16px}
-.gauge-svg{transform:rotate(-90deg)}
-table.sp{width:100%;border-collapse:collapse;font-size:13px}
-table.sp th{padding:8px 5px;text-align:left;color:var(--ts);font-weight:600;font-size:11px;border-bottom:2px solid var(--cb)}
-table.sp td{padding:8px 5px;border-bottom:1px solid var(--cb)}
-table.sp select{width:auto;padding:5px 7px;font-size:12px}
-.warn{padding:9px 12px;border-radius:11px;background:rgba(255,200,0,.07);border:1px solid rgba(255,200,0,.15);font-size:12px;color:var(--ts)}
-.ilce-grid{display:grid;grid-template-columns:repeat(3,1fr);gap:10px}
-#toast{position:fixed;bottom:20px;left:50%;transform:translateX(-50%) translateY(20px);background:#1a1a2e;color:#fff;padding:10px 22px;border-radius:13px;font-size:13px;font-weight:500;opacity:0;transition:all .3s;z-index:999;pointer-events:none;box-shadow:0 6px 24px rgba(0,0,0,.3);max-width:90vw}
-#toast.show{opacity:1;transform:translateX(-50%) translateY(0)}
-.hidden{display:none!important}
-@keyframes pulse{0%,100%{opacity:1}50%{opacity:.4}}
-@media(max-width:520px){.grid4{grid-template-columns:repeat(2,1fr)}.ilce-grid{grid-template-columns:1fr}}
-</style>
-</head><body>
-<div class="hdr"><div class="hdr-in">
-<div style="display:flex;justify-content:space-between;align-items:flex-start">
-<div><h1>🕌 Cami Otomasyon</h1><div class="sub" id="hdrSub">-</div></div>
-<div class="hdr-btns">
-<button class="hdr-btn" onclick="toggleDark()" id="darkBtn">🌙</button>
-<button class="hdr-btn hidden" id="rebootBtn" onclick="doReboot()" title="Yeniden Başlat">🔄</button>
-<button class="hdr-btn hidden" id="logoutBtn" onclick="doLogout()">🚪</button>
-</div></div>
-<div class="tabs" id="tabBar"></div>
-</div></div>
-<div class="main" id="content"></div>
-<div id="toast"></div>
-<script>
-var S={dark:false,authed:false,key:'',tab:'home',autoRef:true,pub:{},sys:{},sets:{},acfg:{}};
-var refreshTimer=null;
-function $(id){return document.getElementById(id)}
-function toast(m){var t=$('toast');t.textContent=m;t.className='show';clearTimeout(t._t);t._t=setTimeout(function(){t.className=''},2800)}
-function fmtB(b){return b>=1048576?(b/1048576).toFixed(1)+' MB':b>=1024?(b/1024|0)+' KB':b+' B'}
-function fmtUp(s){var d=s/86400|0,h=(s%86400)/3600|0,m=(s%3600)/60|0;return d>0?d+'g '+h+'s':h>0?h+'s '+m+'dk':m+'dk'}
-function getKey(){return localStorage.getItem('WEB_KEY')||''}
-function saveKey(k){localStorage.setItem('WEB_KEY',k);S.key=k}
-function api(path,opts){opts=opts||{};opts.headers=opts.headers||{};var k=getKey();if(k)opts.headers['X-API-KEY']=k;return fetch(path,opts)}
-function barColor(pct){return pct>80?'#e74c3c':pct>60?'#f39c12':'#0b6'}
-function rssiQ(r){return r>-50?'Mükemmel':r>-60?'Çok İyi':r>-70?'İyi':r>-80?'Zayıf':'Çok Zayıf'}
-function rssiBars(r){return r>-50?4:r>-60?3:r>-70?2:r>-80?1:0}
-function toggleDark(){S.dark=!S.dark;document.body.classList.toggle('dk',S.dark);$('darkBtn').textContent=S.dark?'☀️':'🌙';localStorage.setItem('DARK',S.dark?'1':'0')}
-
-// ── Auth ──
-function doLogin(){
-  var inp=$('loginKey');if(inp)saveKey(inp.value.trim());
-  api('/api/authcheck').then(function(r){
-    if(r.ok){S.authed=true;S.tab='system';toast('✅ Giriş başarılı');loadSystem();loadSettings();loadAdminCfg();renderAll();}
-    else toast('❌ Şifre hatalı');
-  }).catch(function(){toast('Bağlantı hatası')});
-}
-function doLogout(){localStorage.removeItem('WEB_KEY');S.key='';S.authed=false;S.tab='home';toast('Çıkış yapıldı');renderAll()}
-function doReboot(){if(!confirm('Sistem yeniden başlatılsın mı?'))return;toast('🔄 Yeniden başlatılıyor...');api('/api/action',{method:'POST',headers:{'Content-Type':'application/json'},body:JSON.stringify({cmd:'reboot'})}).then(function(){setTimeout(function(){location.reload()},5000)}).catch(function(){setTimeout(function(){location.reload()},5000)})}
-
-// ── Tabs ──
-var TABS=[
-  {id:'home',label:'🏠 Durum',pub:true},
-  {id:'system',label:'📊 Sistem'},
-  {id:'tolerans',label:'⚙️ Toleranslar'},
-  {id:'dinigun',label:'🕌 Dini Günler'},
-  {id:'komut',label:'🧰 Komutlar'},
-  {id:'log',label:'📋 Log'},
-  {id:'ayarlar',label:'🛠️ Ayarlar'}
-];
-function setTab(id){S.tab=id;renderAll()}
-function renderTabs(){
-  var h='';TABS.forEach(function(t){if(!t.pub&&!S.authed)return;h+='<button class="tab '+(S.tab===t.id?'on':'off')+'" onclick="setTab(\''+t.id+'\')">'+t.label+'</button>';});
-  if(!S.authed)h+='<button class="tab '+(S.tab==='login'?'on':'lock')+'" onclick="setTab(\'login\')">🔒 Giriş</button>';
-  $('tabBar').innerHTML=h;$('logoutBtn').className=S.authed?'hdr-btn':'hdr-btn hidden';$('rebootBtn').className=S.authed?'hdr-btn':'hdr-btn hidden';
-}
-
-// ── Data ──
-function loadPublic(){fetch('/api/public').then(function(r){return r.json()}).then(function(d){S.pub=d;$('hdrSub').textContent=(d.version||'')+' • '+(d.now||'-');if(S.tab==='home')renderHome();if(S.tab==='komut')renderKomut()}).catch(function(){})}
-function loadSystem(){api('/api/system').then(function(r){if(r.status===401)return null;return r.json()}).then(function(d){if(d){S.sys=d;if(S.tab==='system')renderSystem()}}).catch(function(){})}
-function loadSettings(){api('/api/settings').then(function(r){if(r.status===401)return null;return r.json()}).then(function(d){if(d)S.sets=d}).catch(function(){})}
-function loadAdminCfg(){api('/api/admincfg').then(function(r){if(r.status===401)return null;return r.json()}).then(function(d){if(d&&d.ok){S.acfg=d;if(S.tab==='ayarlar')renderAyarlar()}}).catch(function(){})}
-function refreshData(){loadPublic();if(S.authed&&S.tab==='system')loadSystem();if(S.authed&&S.tab==='log')loadLogs()}
-function startAutoRef(){clearInterval(refreshTimer);if(S.autoRef)refreshTimer=setInterval(refreshData,15000)}
-
-// ── UI Helpers ──
-function gauge(pct,size,label,detail){var r=(size-10)/2,c=2*Math.PI*r,off=c-(Math.min(100,Math.max(0,pct))/100)*c,col=barColor(pct);return'<div style="text-align:center"><div style="position:relative;display:inline-block;width:'+size+'px;height:'+size+'px"><svg width="'+size+'" height="'+size+'" class="gauge-svg"><circle cx="'+(size/2)+'" cy="'+(size/2)+'" r="'+r+'" fill="none" stroke="rgba(128,128,128,.1)" stroke-width="7"/><circle cx="'+(size/2)+'" cy="'+(size/2)+'" r="'+r+'" fill="none" stroke="'+col+'" stroke-width="7" stroke-dasharray="'+c+'" stroke-dashoffset="'+off+'" stroke-linecap="round" style="transition:stroke-dashoffset 1s"/></svg><div style="position:absolute;top:50%;left:50%;transform:translate(-50%,-50%);font-size:'+(size*.22)+'px;font-weight:700;font-variant-numeric:tabular-nums">'+Math.round(pct)+'%</div></div><div style="font-size:10px;font-weight:600;color:var(--ts);margin-top:3px">'+label+'</div>'+(detail?'<div style="font-size:9px;color:var(--ts);opacity:.7">'+detail+'</div>':'')+'</div>'}
-function sigBars(rssi){var n=rssiBars(rssi),col=n>=3?'#0b6':n===2?'#f39c12':'#e74c3c',h='<div class="sig-bars">';for(var i=1;i<=4;i++)h+='<div style="width:4px;height:'+(3+i*3)+'px;border-radius:1px;background:'+(i<=n?col:'rgba(128,128,128,.15)')+'"></div>';return h+'</div>'}
-function barH(pct,label,detail,color){var c=color||barColor(pct);return'<div class="bar-wrap"><div class="bar-hdr"><span class="k">'+label+'</span><span class="v">'+detail+'</span></div><div class="bar"><div class="bar-fill" style="width:'+Math.min(100,pct)+'%;background:'+c+'"></div></div></div>'}
-function statH(icon,label,val){return'<div class="stat"><span>'+icon+'</span><span class="k">'+label+'</span><span class="v">'+val+'</span></div>'}
-function prayerH(name,time,isNext){return'<div class="prayer'+(isNext?' next':'')+'">'+(isNext?'<div style="position:absolute;top:4px;right:6px;color:var(--ac);font-size:11px">★</div>':'')+'<div class="nm">'+name+'</div><div class="tm">'+time+'</div></div>'}
-
-function nextPrayer(d){if(!d||!d.now)return'';var hm=(d.now.split(' ')[1]||'').substring(0,5);if(d.imsak&&d.imsak>hm)return'imsak';if(d.aksam&&d.aksam>hm)return'aksam';return'imsak'}
-function cmdAction(cmd){api('/api/action',{method:'POST',headers:{'Content-Type':'application/json'},body:JSON.stringify({cmd:cmd})}).then(function(r){if(r.status===401){toast('Yetkisiz');return}return r.json()}).then(function(d){if(d){toast(d.ok?(d.msg||'✅ Tamam'):('❌ '+(d.msg||d.err||'Hata')));loadPublic()}}).catch(function(){toast('Bağlantı hatası')})}
-
-// ══════════ HOME ══════════
-function renderHome(){
-  var d=S.pub;if(!d.ok){$('content').innerHTML='<div class="cd"><p>Yükleniyor...</p></div>';return}
-  var np=nextPrayer(d),pN={imsak:'🌙 İmsak',gunes:'🌅 Güneş',ogle:'☀️ Öğle',ikindi:'🌤 İkindi',aksam:'🌇 Akşam',yatsi:'🌃 Yatsı'},h='';
-  h+='<div class="cd"><div style="display:flex;justify-content:space-between;align-items:center;margin-bottom:14px"><div><h3 style="margin:0">Namaz Vakitleri</h3><div style="font-size:12px;color:var(--ts);margin-top:3px">'+(d.hicri||'')+'</div></div>';
-  h+='<div class="live'+(S.autoRef?' on':'')+'" onclick="S.autoRef=!S.autoRef;startAutoRef();renderAll()"><div class="dot" style="background:'+(S.autoRef?'var(--ac)':'var(--ts)')+'"></div>'+(S.autoRef?'Canlı':'Durdu')+'</div></div>';
-  h+='<div class="grid3">';['imsak','gunes','ogle','ikindi','aksam','yatsi'].forEach(function(k){var t=d[k]||'—';h+=prayerH(pN[k],t,np===k&&t!=='—')});h+='</div></div>';
-  h+='<div class="cd"><h3 style="margin-bottom:12px">Sistem Durumu</h3><div class="grid2">';
-  var ron=d.relay;h+='<div class="sbox" style="border-color:'+(ron?'rgba(0,180,130,.2)':'rgba(231,76,60,.15)')+'"><div style="font-size:11px;color:var(--ts);margin-bottom:3px">⚡ Şerefeler</div><div style="font-size:18px;font-weight:700;color:'+(ron?'var(--ac)':'#e74c3c')+'">'+(ron?'AÇIK ✅':'KAPALI ❌')+'</div></div>';
-  h+='<div class="sbox"><div style="font-size:11px;color:var(--ts);margin-bottom:3px">🕰️ Saat</div><div style="font-size:18px;font-weight:700;font-variant-numeric:tabular-nums">'+((d.now||'').split(' ')[1]||'-')+'</div></div>';
-  h+='<div class="sbox"><div style="font-size:11px;color:var(--ts);margin-bottom:3px">📶 WiFi</div><div style="display:flex;align-items:center;gap:6px">'+sigBars(d.rssi||0)+'<div><div style="font-size:13px;font-weight:600">'+(d.ssid||'-')+'</div><div style="font-size:10px;color:var(--ts)">'+(d.rssi||0)+' dBm</div></div></div></div>';
-  h+='<div class="sbox"><div style="font-size:11px;color:var(--ts);margin-bottom:3px">📊 Performans</div><div style="font-size:13px;font-weight:600">İş Yükü: '+(d.cpuUsage||0)+'%</div><div style="font-size:10px;color:var(--ts)">RAM: '+fmtB(d.freeHeap||0)+' boş</div></div>';
-  h+='</div><div style="margin-top:10px;padding:9px 12px;border-radius:10px;background:rgba(128,128,128,.03);display:flex;flex-wrap:wrap;gap:5px 16px;font-size:12px;color:var(--ts)">';
-  h+='<span>Tolerans: <b style="color:var(--tx)">'+(d.onTolMin||0)+'dk / '+(d.offTolMin||0)+'dk</b></span>';
-  h+='<span>Cache: <b style="color:var(--tx)">'+(d.dayCount||0)+' gün</b></span>';
-  h+='<span>İlçe: <b style="color:var(--tx)">'+(d.ilceId||0)+'</b></span>';
-  h+='<span>Uptime: <b style="color:var(--tx)">'+fmtUp(d.uptimeSec||0)+'</b></span></div></div>';
-  $('content').innerHTML=h;
-}
-
-// ══════════ SYSTEM ══════════
-function renderSystem(){
-  var d=S.sys;if(!d||!d.ok){$('content').innerHTML='<div class="cd"><p>Yükleniyor...</p></div>';loadSystem();return}
-  var ram=d.ram||{},fl=d.flash||{},cpu=d.cpu||{},wifi=d.wifi||{},nvs=d.nvs||{},h='';
-  h+='<div class="cd"><div style="display:flex;justify-content:space-between;align-items:center;margin-bottom:18px"><h3 style="margin:0">📊 Sistem İzleme</h3>';
-  h+='<div class="live'+(S.autoRef?' on':'')+'" onclick="S.autoRef=!S.autoRef;startAutoRef();renderAll()"><div class="dot" style="background:'+(S.autoRef?'var(--ac)':'var(--ts)')+'"></div>'+(S.autoRef?'Canlı':'Durdu')+'</div></div>';
-  h+='<div class="grid4" style="text-align:center">';
-  h+=gauge(ram.usedPct||0,85,'RAM',fmtB(ram.free||0)+' boş');
-  var lps=cpu.loopsPerSec||0;var lpsStr=lps>=10?Math.round(lps)+'/s':lps>0?lps+'/s':'<1/s';
-  var ioP=cpu.ioPct||0;
-  h+='<div>'+gauge(cpu.usageTotal||0,85,'İş Yükü',lpsStr)+'<div style="font-size:10px;color:var(--ts);margin-top:2px">I/O: '+ioP+'%</div></div>';
-  h+=gauge(fl.sketchPct||0,85,'Flash',fmtB(fl.sketchFree||0)+' boş');
-  h+='<div style="display:flex;flex-direction:column;align-items:center;justify-content:center">'+sigBars(wifi.rssi||0)+'<div style="font-size:18px;font-weight:700;margin-top:5px;font-variant-numeric:tabular-nums">'+(wifi.rssi||0)+'</div><div style="font-size:10px;font-weight:600;color:var(--ts)">WiFi dBm</div><div style="font-size:9px;color:var(--ts)">'+rssiQ(wifi.rssi||0)+'</div></div>';
-  h+='</div></div>';
-  h+='<div class="cd"><h3>🧠 RAM (Heap)</h3>'+barH(ram.usedPct||0,'Kullanılan',fmtB(ram.used||0)+' / '+fmtB(ram.total||0))+'<div class="grid2">'+statH('📦','Boş',fmtB(ram.free||0))+statH('📉','Min Boş',fmtB(ram.minFree||0))+statH('🧩','Max Blok',fmtB(ram.maxAlloc||0))+statH('💾','Toplam',fmtB(ram.total||0))+'</div></div>';
-  h+='<div class="cd"><h3>⚡ İşlemci</h3><div class="grid2" style="margin-bottom:12px">'+statH('🏷️','Model',cpu.model||'-')+statH('🧮','Çekirdek',cpu.cores||0)+statH('⏱️','Frekans',(cpu.freqMHz||0)+' MHz')+statH('🔄','Döngü',lpsStr)+statH('📊','İş Yükü',(cpu.usageTotal||0)+'%')+statH('📡','I/O Bekleme',ioP+'%');
-  if(cpu.tempC)h+=statH('🌡️','Sıcaklık',cpu.tempC+'°C');
-  h+=statH('⏰','Uptime',fmtUp(d.uptimeSec||0))+'</div></div>';
-  h+='<div class="cd"><h3>💿 Flash</h3>'+barH(fl.sketchPct||0,'Firmware',fmtB(fl.sketch||0)+' / '+fmtB((fl.sketch||0)+(fl.sketchFree||0)))+'<div class="grid2">'+statH('📀','Toplam',fmtB(fl.total||0))+statH('📦','OTA Boş',fmtB(fl.sketchFree||0))+'</div></div>';
-  h+='<div class="cd"><h3>📡 WiFi</h3><div class="grid2">'+statH('📶','SSID',wifi.ssid||'-')+statH('📊','Sinyal',(wifi.rssi||0)+' dBm')+statH('🌐','IP',wifi.ip||'-')+statH('🔗','MAC',wifi.mac||'-')+statH('📻','Kanal',wifi.channel||0)+statH('📡','TX',wifi.txPower||0)+'</div></div>';
-  if(nvs.totalEntries){h+='<div class="cd"><h3>🗄️ NVS</h3>'+barH(((nvs.usedEntries||0)/(nvs.totalEntries||1)*100),'Entries',(nvs.usedEntries||0)+' / '+(nvs.totalEntries||0))+statH('📂','Namespace',nvs.nsCount||0)+'</div>'}
-  $('content').innerHTML=h;
-}
-
-// ══════════ TOLERANS ══════════
-function renderTolerans(){
-  var d=S.sets,h='<div class="cd"><h3>⚙️ Toleranslar</h3><div class="grid2">';
-  h+='<div><label class="lbl">Akşam tolerans (dk)</label><input type="number" id="onMin" min="0" max="30" value="'+(d.onTolMin||0)+'"/><div style="font-size:11px;color:var(--ts);margin-top:3px">Akşam + X dakika</div></div>';
-  h+='<div><label class="lbl">Sabah tolerans (dk)</label><input type="number" id="offMin" min="0" max="30" value="'+(d.offTolMin||0)+'"/><div style="font-size:11px;color:var(--ts);margin-top:3px">İmsak - X dakika</div></div>';
-  h+='</div><div class="row" style="margin-top:16px"><button class="btn btn-p" onclick="saveTolerans()">💾 Kaydet</button><button class="btn btn-s" onclick="loadSettings();loadPublic();toast(\'Yenileniyor...\')">🔄 Yenile</button></div></div>';
-  $('content').innerHTML=h;
-}
-function saveTolerans(){
-  var body=JSON.stringify({onTolMin:parseInt($('onMin').value||'0',10),offTolMin:parseInt($('offMin').value||'0',10)});
-  api('/api/settings',{method:'POST',headers:{'Content-Type':'application/json'},body:body}).then(function(r){if(r.status===401){toast('Yetkisiz');return}return r.json()}).then(function(d){if(d)toast(d.ok?'✅ Kaydedildi':'❌ '+(d.detail||d.err||'Hata'));loadSettings();loadPublic()}).catch(function(){toast('Bağlantı hatası')});
-}
-
-// ══════════ DİNİ GÜNLER ══════════
-var HMONTHS=['Muharrem','Safer','Rebiülevvel','Rebiülahir','Cemaziyelevvel','Cemaziyelahir','Receb','Şaban','Ramazan','Şevval','Zilkade','Zilhicce'];
-function renderDiniGunler(){
-  var d=S.sets;if(!d.specials){$('content').innerHTML='<div class="cd"><p>Yükleniyor...</p></div>';return}
-  var h='<div class="cd"><h3>🕌 Dini Günler</h3><div style="overflow-x:auto"><table class="sp"><thead><tr><th></th><th>Dini Gün</th><th>Gün</th><th>Ay</th><th>Yıl</th><th>Vars.</th></tr></thead><tbody>';
-  d.specials.forEach(function(sp){
-    var dis=sp.useDefault?' disabled':'';
-    h+='<tr style="opacity:'+(sp.en?1:.5)+'"><td><input type="checkbox" id="sp_en_'+sp.id+'" '+(sp.en?'checked':'')+'/></td>';
-    h+='<td style="font-weight:500;white-space:nowrap">'+sp.name+'</td>';
-    h+='<td><select id="sp_day_'+sp.id+'"'+dis+'>';for(var i=1;i<=30;i++)h+='<option value="'+i+'"'+(sp.hDay===i?' selected':'')+'>'+i+'</option>';h+='</select></td>';
-    h+='<td><select id="sp_mon_'+sp.id+'"'+dis+'>';HMONTHS.forEach(function(m,j){h+='<option value="'+j+'"'+(sp.hMonth===j?' selected':'')+'>'+m+'</option>'});h+='</select></td>';
-    h+='<td><select id="sp_yr_'+sp.id+'"'+dis+'>';for(var y=1447;y<=1461;y++)h+='<option value="'+y+'"'+(sp.hYear===y?' selected':'')+'>'+y+'</option>';h+='</select></td>';
-    h+='<td style="text-align:center"><input type="checkbox" id="sp_def_'+sp.id+'" '+(sp.useDefault?'checked':'')+' onchange="toggleSpDef('+sp.id+')"/></td></tr>';
-  });
-  h+='<tr style="background:rgba(0,180,130,.03)"><td><input type="checkbox" id="ram_all" '+(d.ramazanAll?'checked':'')+'></td><td colspan="5" style="font-weight:600;color:var(--ac)">☪️ Ramazan (Tüm Günler)</td></tr>';
-  h+='</tbody></table></div><div class="row" style="margin-top:16px"><button class="btn btn-p" onclick="saveDiniGunler()">💾 Kaydet</button><button class="btn btn-s" onclick="loadSettings();setTimeout(renderDiniGunler,500)">🔄 Yenile</button></div></div>';
-  h+='<div class="cd"><h3>🗓️ Aktif/Yaklaşan Günler</h3><button class="btn btn-s" onclick="loadDGText()">🔄 Yenile</button><pre id="dgText" style="white-space:pre-wrap;margin-top:10px;background:var(--ib);border:1px solid var(--cb);border-radius:10px;padding:10px;font-size:12px">-</pre></div>';
-  $('content').innerHTML=h;loadDGText();
-}
-function toggleSpDef(id){var ch=$('sp_def_'+id),dis=ch&&ch.checked;['sp_day_'+id,'sp_mon_'+id,'sp_yr_'+id].forEach(function(eid){var el=$(eid);if(el)el.disabled=dis});if(dis&&S.sets&&S.sets.specials){var sp=S.sets.specials.find(function(s){return s.id===id});if(sp){var d=$('sp_day_'+id),m=$('sp_mon_'+id),y=$('sp_yr_'+id);if(d)d.value=sp.defDay;if(m)m.value=sp.defMonth;if(y)y.value=sp.defYear}}}
-function loadDGText(){api('/api/dinigunler').then(function(r){return r.text()}).then(function(t){var el=$('dgText');if(el)el.textContent=t&&t.trim().length?t:'-'}).catch(function(){})}
-function saveDiniGunler(){
-  var d=S.sets,specials=[];
-  if(d.specials){d.specials.forEach(function(sp){var en=$('sp_en_'+sp.id),def=$('sp_def_'+sp.id),day=$('sp_day_'+sp.id),mon=$('sp_mon_'+sp.id),yr=$('sp_yr_'+sp.id);specials.push({id:sp.id,en:en?en.checked:false,useDefault:def?def.checked:true,hDay:day?parseInt(day.value,10):1,hMonth:mon?parseInt(mon.value,10):0,hYear:yr?parseInt(yr.value,10):1447})})}
-  var ramAll=$('ram_all')?$('ram_all').checked:false;
-  api('/api/settings',{method:'POST',headers:{'Content-Type':'application/json'},body:JSON.stringify({ramazanAll:ramAll,specials:specials})}).then(function(r){if(r.status===401){toast('Yetkisiz');return}return r.json()}).then(function(d){if(d)toast(d.ok?'✅ Kaydedildi':'❌ '+(d.detail||d.err||'Hata'));loadSettings()}).catch(function(){toast('Bağlantı hatası')});
-}
-
-// ══════════ KOMUTLAR ══════════
-function renderKomut(){
-  var d=S.pub,ron=d.relay,h='';
-  var upP=d.updatePending,upR=d.updateInProgress;
-  var upSt=upR?'🔄 Aktif':upP?'⏳ Kuyrukta':'✅ Boşta';
-  var upCol=upR?'bg-warn':upP?'bg-warn':'bg-ok';
-  h+='<div class="cd"><h3>🧰 Komutlar</h3>';
-  h+='<div style="display:flex;align-items:center;gap:10px;margin-bottom:14px;padding:10px 14px;border-radius:11px;background:rgba(128,128,128,.04);border:1px solid var(--cb)"><span style="font-size:12px;color:var(--ts)">Güncelleme:</span><span class="badge '+upCol+'">'+upSt+'</span>';
-  if(upP)h+='<button class="btn btn-d" style="padding:5px 12px;font-size:12px" onclick="cmdAction(\'cancelUpdate\')">❌ İptal</button>';
-  h+='</div>';
-  h+='<div class="row"><button class="btn btn-p" onclick="cmdAction(\'updateTimes\')">📥 Vakitleri Güncelle</button><button class="btn btn-s" onclick="cmdAction(\'recompute\')">🧮 Çizelge Yenile</button></div></div>';
-  h+='<div class="cd"><h3>⚡ Şerefeler Kontrolü</h3><div style="text-align:center;padding:10px 0">';
-  h+='<button class="btn-relay '+(ron?'on':'off')+'" onclick="cmdAction(\''+(ron?'relayOff':'relayOn')+'\')">'+(ron?'🟢 AÇIK — Kapat':'🔴 KAPALI — Aç')+'</button>';
-  h+='<div style="font-size:12px;color:var(--ts);margin-top:10px">Durum: <b style="color:'+(ron?'var(--ac)':'#e74c3c')+'">'+(ron?'AÇIK':'KAPALI')+'</b></div>';
-  h+='</div></div>';
-  $('content').innerHTML=h;
-}
-
-// ══════════ LOG ══════════
-function loadLogs(){api('/api/logs').then(function(r){if(r.status===401)return null;return r.json()}).then(function(d){if(d&&d.ok){S.logs=d;if(S.tab==='log')renderLog()}}).catch(function(){})}
-function logTable(arr){if(!arr||arr.length===0)return'<div style="padding:12px;color:var(--ts);font-size:12px;text-align:center">Henuz kayit yok</div>';var h='<table style="width:100%;border-collapse:collapse;font-size:12px"><thead><tr style="border-bottom:2px solid var(--cb)"><th style="text-align:left;padding:8px 6px;color:var(--ts);font-weight:600;width:140px">Tarih / Saat</th><th style="text-align:left;padding:8px 6px;color:var(--ts);font-weight:600">İşlem</th></tr></thead><tbody>';for(var i=arr.length-1;i>=0;i--){var e=arr[i];h+='<tr style="border-bottom:1px solid var(--cb)"><td style="padding:6px;white-space:nowrap;color:var(--ts);font-variant-numeric:tabular-nums">'+e.ts+'</td><td style="padding:6px">'+e.msg+'</td></tr>'}h+='</tbody></table>';return h}
-function renderLog(){
-  var d=S.logs;if(!d){$('content').innerHTML='<div class="cd"><p>Yükleniyor...</p></div>';loadLogs();return}
-  var h='';
-  h+='<div class="cd"><div style="display:flex;justify-content:space-between;align-items:center;margin-bottom:14px"><h3 style="margin:0">👤 Kullanıcı İşlemleri</h3><span style="font-size:11px;color:var(--ts)">'+(d.user?d.user.length:0)+' kayıt</span></div>';
-  h+=logTable(d.user);
-  h+='</div>';
-  h+='<div class="cd"><div style="display:flex;justify-content:space-between;align-items:center;margin-bottom:14px"><h3 style="margin:0">⚙️ Sistem İşlemleri</h3><span style="font-size:11px;color:var(--ts)">'+(d.sys?d.sys.length:0)+' kayıt</span></div>';
-  h+=logTable(d.sys);
-  h+='</div>';
-  h+='<div style="text-align:center;padding:10px"><button class="btn btn-s" onclick="loadLogs();toast(\'Yenileniyor...\')">🔄 Yenile</button></div>';
-  $('content').innerHTML=h;
-}
-
-// ══════════ AYARLAR ══════════
-function renderAyarlar(){
-  var ac=S.acfg||{},net=ac.net||{},creds=ac.creds||{},h='';
-  // 1. Ağ Ayarları
-  var isStatic=net.useStatic;
-  var ip=isStatic&&net.ip?net.ip:(net.liveIp||''),gw=isStatic&&net.gw?net.gw:(net.liveGw||''),mask=isStatic&&net.mask?net.mask:(net.liveMask||'');
-  var dns1=net.dns1||(net.liveDns1||''),dns2=net.dns2||(net.liveDns2||''),port=net.httpPort||80;
-  var dis=isStatic?'':' disabled';
-  h+='<div class="cd"><h3>📡 Ağ Ayarları</h3>';
-  h+='<div class="row" style="margin-bottom:12px"><label style="display:flex;align-items:center;gap:6px;cursor:pointer"><input type="checkbox" id="useStatic" '+(isStatic?'checked':'')+' onchange="toggleStatic()"/> Statik IP</label>';
-  h+='<span class="badge '+(isStatic?'bg-ok':'bg-warn')+'">'+(isStatic?'Statik':'DHCP')+'</span></div>';
-  h+='<div class="grid2" style="grid-template-columns:repeat(auto-fit,minmax(160px,1fr))">';
-  h+='<div><label class="lbl">IP</label><input type="text" id="ipS" value="'+ip+'"'+dis+'/></div>';
-  h+='<div><label class="lbl">Gateway</label><input type="text" id="gwS" value="'+gw+'"'+dis+'/></div>';
-  h+='<div><label class="lbl">Mask</label><input type="text" id="maskS" value="'+mask+'"'+dis+'/></div>';
-  h+='<div><label class="lbl">DNS1</label><input type="text" id="dns1S" value="'+dns1+'"'+dis+'/></div>';
-  h+='<div><label class="lbl">DNS2</label><input type="text" id="dns2S" value="'+dns2+'"'+dis+'/></div>';
-  h+='<div><label class="lbl">Port</label><input type="number" id="portS" value="'+port+'"/></div>';
-  h+='</div><div class="row" style="margin-top:14px"><button class="btn btn-p" onclick="saveNet()">💾 Ağ Kaydet</button></div>';
-  h+='<div style="font-size:11px;color:var(--ts);margin-top:6px">Ağ ayarı kaydedilince cihaz yeniden başlatılır.</div></div>';
-
-  // 2. WiFi Bilgileri (ayrı kart, ağ altında)
-  h+='<div class="cd"><h3>🔐 WiFi Bilgileri</h3>';
-  h+='<div class="grid2" style="grid-template-columns:repeat(auto-fit,minmax(180px,1fr))">';
-  h+='<div><label class="lbl">WiFi SSID</label><div style="display:flex;gap:6px"><input type="text" id="wfSsid" value="'+(creds.nvsWifiSsid||'')+'" style="flex:1"/><button class="btn btn-s" style="padding:6px 10px;font-size:12px;white-space:nowrap" onclick="wifiScan()">📶 Tara</button></div><select id="wfScanList" class="hidden" style="margin-top:6px" onchange="wfPickSsid()"><option>-</option></select></div>';
-  h+='<div><label class="lbl">WiFi Şifre</label><input type="password" id="wfPass" placeholder="değiştirmek için yaz"/></div></div>';
-  h+='<div class="row" style="margin-top:12px"><button class="btn btn-p" onclick="saveWifi()">💾 Kaydet</button>';
-  h+='<button class="btn btn-d" onclick="clearWifi()">🧹 WiFi Sil</button></div>';
-  h+='<div style="font-size:11px;color:var(--ts);margin-top:6px">WiFi: '+(creds.wifiSrc||'-')+'</div></div>';
-
-  // 2.5 Hicri Yil
-  var hny=ac.hicriYear||{};
-  h+='<div class="cd"><h3>📅 Hicri Yıl Ayarları</h3>';
-  h+='<div class="grid2" style="margin-bottom:12px">';
-  h+='<div><label class="lbl">Yılbaşı Günü</label><select id="hnyDay">';for(var dd=1;dd<=30;dd++)h+='<option value="'+dd+'"'+((hny.day||1)===dd?' selected':'')+'>'+dd+'</option>';h+='</select></div>';
-  h+='<div><label class="lbl">Yılbaşı Ayı</label><select id="hnyMon">';var _hm=['Muharrem','Safer','Rebiülevvel','Rebiülahir','Cemaziyelevvel','Cemaziyelahir','Receb','Şaban','Ramazan','Şevval','Zilkade','Zilhicce'];_hm.forEach(function(m,j){h+='<option value="'+j+'"'+((hny.mon||0)===j?' selected':'')+'>'+m+'</option>'});h+='</select></div>';
-  h+='</div>';
-  h+='<label style="display:flex;align-items:center;gap:8px;cursor:pointer;margin-bottom:10px"><input type="checkbox" id="hnyAuto" '+(hny.auto?'checked':'')+'/>  Yılları Otomatik Güncelle</label>';
-  if(hny.lastYear)h+='<div style="font-size:11px;color:var(--ts)">Son güncellenen yıl: '+hny.lastYear+'</div>';
-  h+='<div class="row" style="margin-top:12px"><button class="btn btn-p" onclick="saveHicriYear()">💾 Kaydet</button></div>';
-  h+='<div style="font-size:11px;color:var(--ts);margin-top:6px">Yılbaşı geçtiğinde dini günlerin yılı otomatik +1 olur.</div></div>';
-
-  // 3. İlçe ID Bulucu (üstte) + İlçe Kodu (altta)
-  h+='<div class="cd"><h3>🔍 Ezan Vakti İlçe ID Bulucu</h3>';
-  h+='<div class="ilce-grid"><div><label class="lbl">Ülke</label><select id="ilceUlke" onchange="ilceLoadCities()"><option>Yükleniyor...</option></select></div>';
-  h+='<div><label class="lbl">Şehir</label><select id="ilceSehir" disabled onchange="ilceLoadDistricts()"><option>Önce ülke seçin</option></select></div>';
-  h+='<div><label class="lbl">İlçe</label><select id="ilceIlce" disabled onchange="ilceSelect()"><option>Önce şehir seçin</option></select></div></div>';
-  h+='<div id="ilceResult" class="hidden" style="margin-top:10px;padding:10px;border-radius:10px;background:rgba(0,180,130,.06);border:1px solid rgba(0,180,130,.15);font-size:14px;font-weight:600">İlçe ID: <span id="ilceFoundId">-</span> <button class="btn btn-p" style="margin-left:10px;padding:5px 12px;font-size:12px" onclick="ilceApply()">Uygula</button></div>';
-  h+='<div style="font-size:11px;color:var(--ts);margin-top:6px" id="ilceStat">-</div>';
-  h+='<div style="margin-top:16px;padding-top:16px;border-top:1px solid var(--cb)"><h3 style="font-size:15px;margin-bottom:12px">📍 İlçe Kodu</h3>';
-  h+='<div class="row"><div style="flex:1;min-width:100px"><label class="lbl">İlçe ID</label><input type="number" id="ilceId" value="'+(ac.ilceId||'')+'"/></div>';
-  h+='<button class="btn btn-p" onclick="saveIlce()">💾</button><button class="btn btn-s" onclick="cmdAction(\'updateTimes\')">📥 Güncelle</button></div></div></div>';
-
-  // 4. Kimlik Bilgileri
-  h+='<div class="cd"><h3>🔑 Kimlik Bilgileri</h3>';
-  h+='<div style="overflow-x:auto"><table class="sp"><thead><tr><th>Alan</th><th>Kaynak</th><th>Durum</th><th>Değiştir</th></tr></thead><tbody>';
-  h+='<tr><td style="font-weight:600">Web Şifre</td><td><span class="badge '+(creds.webKeySrc==='nvs'?'bg-ok':'bg-warn')+'">'+(creds.webKeySrc||'-')+'</span></td>';
-  h+='<td>'+(creds.activeWebKeySet?'✅ Ayarlı':'❌ Yok')+'</td>';
-  h+='<td><input type="password" id="newWebKey" placeholder="Yeni şifre" style="width:140px;font-size:12px"/></td></tr>';
-  h+='<tr><td style="font-weight:600">Bot Token</td><td><span class="badge '+(creds.botTokenSrc==='nvs'?'bg-ok':'bg-warn')+'">'+(creds.botTokenSrc||'-')+'</span></td>';
-  h+='<td>'+(creds.botTokenSet?'✅ Ayarlı':'❌ Yok')+'</td>';
-  h+='<td><input type="password" id="newBotToken" placeholder="Yeni token" style="width:140px;font-size:12px"/></td></tr>';
-  h+='<tr><td style="font-weight:600">Chat ID</td><td><span class="badge '+(creds.chatIdSrc==='nvs'?'bg-ok':'bg-warn')+'">'+(creds.chatIdSrc||'-')+'</span></td>';
-  h+='<td style="font-variant-numeric:tabular-nums">'+(creds.chatId||'-')+'</td>';
-  h+='<td><input type="text" id="newChatId" placeholder="Yeni chat ID" style="width:140px;font-size:12px"/></td></tr>';
-  h+='</tbody></table></div>';
-  h+='<div class="row" style="margin-top:12px"><button class="btn btn-p" onclick="saveKimlik()">💾 Kaydet</button>';
-  h+='<button class="btn btn-d" onclick="clearWebKey()">🧹 Web Şifre Sil</button>';
-  h+='<button class="btn btn-d" onclick="clearBotToken()">🧹 Bot Token Sil</button>';
-  h+='<button class="btn btn-d" onclick="clearChatId()">🧹 Chat ID Sil</button></div>';
-  h+='<div style="font-size:11px;color:var(--ts);margin-top:6px">NVS\'e kaydedilen bilgiler secrets.h\'yi geçersiz kılar. Sil butonu NVS\'i temizler ve secrets.h aktif olur.</div></div>';
-
-  // 5. Telegram Admin
-  h+='<div class="cd"><h3>👮 Telegram Admin</h3><div class="row" style="margin-bottom:10px">';
-  h+='<div style="flex:1;min-width:140px"><label class="lbl">Admin ID</label><input type="text" id="adminId"/></div>';
-  h+='<button class="btn btn-p" onclick="adminAdd()">➕</button><button class="btn btn-d" onclick="adminDel()">➖</button></div>';
-  h+='<div id="adminsList" style="display:flex;gap:6px;flex-wrap:wrap"></div></div>';
-
-  // 6. OTA
-  h+='<div class="cd"><h3>⬆️ Firmware Güncelle</h3><div class="row"><input type="file" id="fwFile" accept=".bin"/> <button class="btn btn-p" onclick="uploadFw()">⬆️ Yükle</button></div>';
-  h+='<div style="margin-top:10px"><div class="bar" style="height:6px"><div class="bar-fill" id="fwBar" style="width:0%;background:var(--ac)"></div></div><div style="font-size:11px;color:var(--ts);margin-top:4px" id="fwStat">-</div></div></div>';
-
-  // 7. Factory Reset
-  h+='<div class="cd" style="border-color:rgba(231,76,60,.2)"><h3 style="color:#e74c3c">🧨 Fabrika Ayarları</h3>';
-  h+='<div class="row"><div style="flex:1;min-width:180px"><label class="lbl">Owner Key</label><input type="password" id="rstKey"/></div>';
-  h+='<button class="btn btn-s" onclick="rstCheck()">Doğrula</button></div>';
-  h+='<div id="rstWrap" class="hidden" style="margin-top:10px"><label><input type="checkbox" id="rstConfirm"/> Evet, sıfırla</label> <button class="btn btn-d" onclick="rstDo()" style="margin-top:8px">⚠️ Sıfırla</button></div></div>';
-
-  $('content').innerHTML=h;
-  if(ac.admins)renderAdmins(ac.admins);
-  ilceLoadCountries();
-}
-
-function toggleStatic(){var ch=$('useStatic').checked;['ipS','gwS','maskS','dns1S','dns2S'].forEach(function(id){var el=$(id);if(el)el.disabled=!ch})}
-function renderAdmins(list){var el=$('adminsList');if(!el)return;el.innerHTML='';if(!list||!list.length){el.innerHTML='<span style="font-size:12px;color:var(--ts)">-</span>';return}list.forEach(function(a){el.innerHTML+='<span class="badge bg-ok">'+a.id+(a.owner?' (OWNER)':'')+'</span>'})}
-
-// İlçe ID Bulucu API
-var _ilkeUlk=[],_ilkeSeh=[],_ilkeIlc=[];
-function ilceLoadCountries(){fetch('https://ezanvakti.emushaf.net/ulkeler').then(function(r){return r.json()}).then(function(d){_ilkeUlk=d;_ilkeUlk.sort(function(a,b){return a.UlkeAdi.localeCompare(b.UlkeAdi,'tr')});var s=$('ilceUlke');s.innerHTML='<option value="">Ülke seçin</option>';_ilkeUlk.forEach(function(u){s.innerHTML+='<option value="'+u.UlkeID+'">'+u.UlkeAdi+'</option>'});var st=$('ilceStat');if(st)st.textContent='Ülkeler yüklendi.'}).catch(function(){var st=$('ilceStat');if(st)st.textContent='Ülkeler yüklenemedi (CORS?)'})}
-function ilceLoadCities(){var uid=$('ilceUlke').value;var s2=$('ilceSehir'),s3=$('ilceIlce');s2.innerHTML='<option>Yükleniyor...</option>';s2.disabled=true;s3.innerHTML='<option>Önce şehir seçin</option>';s3.disabled=true;$('ilceResult').className='hidden';if(!uid){s2.innerHTML='<option>Önce ülke seçin</option>';return}fetch('https://ezanvakti.emushaf.net/sehirler/'+uid).then(function(r){return r.json()}).then(function(d){_ilkeSeh=d;_ilkeSeh.sort(function(a,b){return a.SehirAdi.localeCompare(b.SehirAdi,'tr')});s2.innerHTML='<option value="">Şehir seçin</option>';_ilkeSeh.forEach(function(c){s2.innerHTML+='<option value="'+c.SehirID+'">'+c.SehirAdi+'</option>'});s2.disabled=false;var st=$('ilceStat');if(st)st.textContent='Şehirler yüklendi.'}).catch(function(){s2.innerHTML='<option>Yüklenemedi</option>';var st=$('ilceStat');if(st)st.textContent='Şehirler yüklenemedi.'})}
-function ilceLoadDistricts(){var cid=$('ilceSehir').value;var s3=$('ilceIlce');s3.innerHTML='<option>Yükleniyor...</option>';s3.disabled=true;$('ilceResult').className='hidden';if(!cid){s3.innerHTML='<option>Önce şehir seçin</option>';return}fetch('https://ezanvakti.emushaf.net/ilceler/'+cid).then(function(r){return r.json()}).then(function(d){_ilkeIlc=d;_ilkeIlc.sort(function(a,b){return a.IlceAdi.localeCompare(b.IlceAdi,'tr')});s3.innerHTML='<option value="">İlçe seçin</option>';_ilkeIlc.forEach(function(i){s3.innerHTML+='<option value="'+i.IlceID+'">'+i.IlceAdi+'</option>'});s3.disabled=false;var st=$('ilceStat');if(st)st.textContent='İlçeler yüklendi.'}).catch(function(){s3.innerHTML='<option>Yüklenemedi</option>'})}
-function ilceSelect(){var v=$('ilceIlce').value;if(!v){$('ilceResult').className='hidden';return}$('ilceFoundId').textContent=v;$('ilceResult').className='';var st=$('ilceStat');if(st)st.textContent='İlçe ID bulundu: '+v}
-function ilceApply(){var v=$('ilceFoundId').textContent;if(v&&v!=='-'){var el=$('ilceId');if(el)el.value=v;toast('İlçe ID: '+v+' uygulandı')}}
-
-// Admin API calls
-function saveHicriYear(){var d=parseInt($('hnyDay').value||'1',10),m=parseInt($('hnyMon').value||'0',10),au=$('hnyAuto')?$('hnyAuto').checked:false;postAcfg({hicriYear:{day:d,mon:m,auto:au}},function(){loadAdminCfg()})}
-function postAcfg(payload,cb){api('/api/admincfg',{method:'POST',headers:{'Content-Type':'application/json'},body:JSON.stringify(payload)}).then(function(r){if(r.status===401){toast('Yetkisiz');return}return r.json()}).then(function(d){if(!d)return;toast(d.ok?(d.msg||'✅ OK'):('❌ '+(d.err||'Hata')));if(cb)cb(d)}).catch(function(){toast('Bağlantı hatası')})}
-function saveNet(){postAcfg({net:{useStatic:$('useStatic').checked,ip:$('ipS').value.trim(),gw:$('gwS').value.trim(),mask:$('maskS').value.trim(),dns1:$('dns1S').value.trim(),dns2:$('dns2S').value.trim(),httpPort:parseInt($('portS').value||'80',10)}},function(d){if(d.nextUrl){toast('🔁 Yeni: '+d.nextUrl);setTimeout(function(){location.href=d.nextUrl},2500)}else if(d.reboot)toast('🔁 Yeniden başlıyor...')})}
-function saveIlce(){postAcfg({ilceId:parseInt($('ilceId').value||'0',10)})}
-function adminAdd(){var id=($('adminId').value||'').trim();if(!id){toast('ID gir');return}postAcfg({adminAdd:id},function(){loadAdminCfg()})}
-function adminDel(){var id=($('adminId').value||'').trim();if(!id){toast('ID gir');return}postAcfg({adminDel:id},function(){loadAdminCfg()})}
-function saveKimlik(){
-  var payload={};
-  var wk=$('newWebKey'),bt=$('newBotToken'),ci=$('newChatId');
-  if(wk&&wk.value.trim())payload.creds={webKey:wk.value.trim()};
-  if(bt&&bt.value.trim())payload.botToken=bt.value.trim();
-  if(ci&&ci.value.trim())payload.chatId=ci.value.trim();
-  if(!Object.keys(payload).length){toast('Değişiklik yok');return}
-  postAcfg(payload,function(d){if(wk)wk.value='';if(bt)bt.value='';if(ci)ci.value='';loadAdminCfg()});
-}
-function clearBotToken(){if(!confirm('Bot Token NVS silinsin mi? secrets.h aktif olur.'))return;postAcfg({clearBotToken:true},function(){loadAdminCfg()})}
-function clearChatId(){if(!confirm('Chat ID NVS silinsin mi? secrets.h aktif olur.'))return;postAcfg({clearChatId:true},function(){loadAdminCfg()})}
-function clearWebKey(){if(!confirm('Web Şifre NVS silinsin mi? secrets.h aktif olur.'))return;postAcfg({creds:{clearWebKey:true}},function(){localStorage.removeItem('WEB_KEY');loadAdminCfg()})}
-function wifiScan(){toast('📶 Taranıyor...');api('/api/wifiscan').then(function(r){if(r.status===401){toast('Yetkisiz');return}return r.json()}).then(function(d){if(!d)return;var sel=$('wfScanList');if(!sel)return;sel.innerHTML='<option value="">-- Ağ Seçin ('+d.count+') --</option>';if(d.networks){d.networks.sort(function(a,b){return b.rssi-a.rssi});d.networks.forEach(function(n){sel.innerHTML+='<option value="'+n.ssid+'">'+n.ssid+' ('+n.rssi+' dBm'+(n.enc?' 🔒':'')+')  </option>'})}sel.className='';toast(d.count+' ağ bulundu')}).catch(function(){toast('Tarama hatası')})}
-function wfPickSsid(){var sel=$('wfScanList'),inp=$('wfSsid');if(sel&&inp&&sel.value){inp.value=sel.value;toast('SSID: '+sel.value)}}
-function saveWifi(){
-  var ss=($('wfSsid').value||'').trim();if(!ss){toast('SSID boş olamaz');return}
-  var pw=$('wfPass');var ps=pw?pw.value:'';
-  if(!confirm('WiFi test edilecek: '+ss))return;
-  toast('📶 Bağlantı test ediliyor...');
-  api('/api/wifitest',{method:'POST',headers:{'Content-Type':'application/json'},body:JSON.stringify({ssid:ss,pass:ps})}).then(function(r){return r.json()}).then(function(d){if(d.testing){var pollCnt=0;var pollId=setInterval(function(){pollCnt++;api('/api/wifistatus').then(function(r){return r.json()}).then(function(s){if(s.state===3){clearInterval(pollId);toast('✅ '+s.msg);if(pw)pw.value='';if(s.ip)setTimeout(function(){location.href='http://'+s.ip},3000)}else if(s.state===5){clearInterval(pollId);toast('⛔ '+s.msg)}}).catch(function(){if(pollCnt>30)clearInterval(pollId)})},1000)}else{toast('⛔ '+(d.msg||'Hata'))}}).catch(function(){toast('❌ Ağ hatası')})
-}
-function clearWifi(){if(!confirm('WiFi NVS silinsin mi?'))return;postAcfg({creds:{clearWifi:true}},function(d){loadAdminCfg();if(d.reboot)setTimeout(function(){location.href='/'},2500)})}
-var _rstOk=false,_rstKey='';
-function rstCheck(){var k=($('rstKey').value||'').trim();if(!k){toast('Şifre gir');return}fetch('/api/authcheck',{headers:{'X-API-KEY':k}}).then(function(r){if(r.ok){_rstOk=true;_rstKey=k;$('rstWrap').className='';toast('✅ Doğrulandı')}else{_rstOk=false;toast('❌ Yanlış')}}).catch(function(){toast('Hata')})}
-function rstDo(){if(!_rstOk){toast('Önce doğrula');return}if(!$('rstConfirm').checked){toast('Onay kutusunu işaretle');return}fetch('/api/factory_reset',{method:'POST',headers:{'Content-Type':'application/json','X-API-KEY':_rstKey},body:JSON.stringify({ownerKey:_rstKey,confirm:true})}).then(function(r){if(r.ok){toast('🧨 Sıfırlanıyor...');setTimeout(function(){location.href='/'},2500)}else toast('❌ Reddedildi')}).catch(function(){toast('Hata')})}
-function uploadFw(){var inp=$('fwFile');if(!inp||!inp.files||!inp.files.length){toast('Dosya seç');return}if(!confirm('Firmware yüklensin mi?'))return;var f=inp.files[0];var reader=new FileReader();reader.onload=function(ev){var buf=new Uint8Array(ev.target.result);var btTag=[0x7F,67,65,77,73,95,66,84,58];var fwBt=-1;for(var i=0;i<buf.length-btTag.length-1;i++){var ok=true;for(var j=0;j<btTag.length;j++){if(buf[i+j]!==btTag[j]){ok=false;break}}if(ok){fwBt=buf[i+btTag.length]-48;break}}var devBt=(S.pub&&S.pub.boardType!==undefined)?S.pub.boardType:-1;if(fwBt>=0&&devBt>=0&&fwBt!==devBt){toast('⛔ Yanlis firmware! Dosya board='+fwBt+', Cihaz board='+devBt);return}if(fwBt<0){if(!confirm('Board bilgisi bulunamadi. Devam?'))return}var vnTag=[0x7E,67,65,77,73,95,86,78,58];var fwVer=-1;for(var i=0;i<buf.length-vnTag.length-2;i++){var ok=true;for(var j=0;j<vnTag.length;j++){if(buf[i+j]!==vnTag[j]){ok=false;break}}if(ok){var ns='';for(var k=i+vnTag.length;k<buf.length&&buf[k]>=48&&buf[k]<=57;k++)ns+=String.fromCharCode(buf[k]);fwVer=parseInt(ns)||0;break}}var devVer=(S.pub&&S.pub.fwVerNum)?S.pub.fwVerNum:0;if(fwVer>0&&devVer>0&&fwVer<=devVer){toast('⛔ Firmware zaten güncel veya eski (cihaz: '+devVer+', dosya: '+fwVer+')');return}var xhr=new XMLHttpRequest();xhr.open('POST','/update',true);var k=getKey();if(k)xhr.setRequestHeader('X-API-KEY',k);if(fwBt>=0)xhr.setRequestHeader('X-Board-Type',String(fwBt));if(fwVer>0)xhr.setRequestHeader('X-Firmware-Ver',String(fwVer));xhr.upload.onprogress=function(e){if(e.lengthComputable){var p=Math.round(e.loaded*100/e.total);var b=$('fwBar');if(b)b.style.width=p+'%';var s=$('fwStat');if(s)s.textContent=p+'%'}};xhr.onload=function(){if(xhr.status===200){toast('✅ Yüklendi');setTimeout(function(){location.href='/'},5000)}else if(xhr.status===401)toast('⛔ Yetkisiz');else{try{var r=JSON.parse(xhr.responseText);toast('⛔ '+(r.msg||r.err||'Hata'))}catch(e){toast('❌ Hata: '+xhr.status)}}};xhr.onerror=function(){toast('❌ Ağ hatası')};var fd=new FormData();fd.append('firmware',f,f.name);xhr.send(fd)};reader.readAsArrayBuffer(f)}
-
-// ── Login ──
-function renderLogin(){var h='<div class="cd" style="text-align:center;padding:36px 18px"><div style="font-size:44px;margin-bottom:14px">🔐</div><h3 style="margin-bottom:6px">Yönetim Paneli</h3><p style="color:var(--ts);font-size:13px;margin-bottom:18px">Ayarları değiştirmek için giriş yapın</p><div style="max-width:280px;margin:0 auto"><input type="password" id="loginKey" placeholder="Şifre" style="text-align:center;font-size:15px;margin-bottom:10px" onkeydown="if(event.key===\'Enter\')doLogin()"/><button class="btn btn-p" style="width:100%;justify-content:center;padding:11px" onclick="doLogin()">🔓 Giriş Yap</button></div></div>';$('content').innerHTML=h;var el=$('loginKey');if(el){el.value=getKey();el.focus()}}
-
-// ── Render ──
-function renderContent(){var t=S.tab;if(t==='home'){renderHome();return}if(t==='login'&&!S.authed){renderLogin();return}if(!S.authed){renderLogin();return}if(t==='system')renderSystem();else if(t==='tolerans')renderTolerans();else if(t==='dinigun')renderDiniGunler();else if(t==='komut')renderKomut();else if(t==='log')renderLog();else if(t==='ayarlar')renderAyarlar()}
-function renderAll(){renderTabs();renderContent()}
-
-// ── Init ──
-(function(){
-  S.key=getKey();S.dark=localStorage.getItem('DARK')==='1';if(S.dark)document.body.classList.add('dk');$('darkBtn').textContent=S.dark?'☀️':'🌙';
-  if(S.key){api('/api/authcheck').then(function(r){if(r.ok){S.authed=true;if(location.pathname==='/admin')S.tab='system';renderAll();loadSettings();loadAdminCfg()}else renderAll()}).catch(function(){renderAll()})}else renderAll();
-  loadPublic();startAutoRef();
-})();
-</script></body></html>
-
-)HTML";
-
-static const char WEB_ADMIN_HTML[] PROGMEM = R"HTML(
-<!doctype html><html><head><meta charset="utf-8"><script>location.href="/";</script></head><body></body></html>
-)HTML";
+// Web panel dosyaları
+// - Kaynak web/ (index.html, app.css, app.js, admin.html). Derleme öncesi
+//   tools/build_web_assets.py küçültüp gzip'ler -> web_assets.h (build klasöründe).
+// - Gzip'li hali olduğu gibi gönderilir (cihazda sıkıştırma/açma yok). Hedef tarayıcıların
+//   hepsi gzip kabul ediyor; ham kopya flash'ta tutulmuyor.
+// - app.css/app.js içerik hash'li adla: süresiz (immutable) önbellek, yeni firmware'de ad
+//   değişir. Sayfalar no-cache + ETag: yenilemede sadece 304 gider.
+// =====================
+static void webHandleAsset() {
+  const WebAsset* a = nullptr;
+  for (int i = 0; i < WEB_ASSET_COUNT; i++) {
+    if (strcmp(g_web->uri(), WEB_ASSETS[i].path) == 0) { a = &WEB_ASSETS[i]; break; }
+  }
+  if (!a) { g_web->send(404, "text/plain", "Not found"); return; }
+
+  g_web->sendHeader("ETag", a->etag);
+  g_web->sendHeader("Cache-Control", a->immutable ? "public, max-age=31536000, immutable" : "no-cache");
+  String inm = g_web->header("If-None-Match");
+  if (inm.length() > 0 && (inm == "*" || strstr(inm.c_str(), a->etag))) {
+    g_web->send(304, nullptr, "");
+    return;
+  }
+  g_web->sendHeader("Content-Encoding", "gzip");
+  g_web->sendHeader("Vary", "Accept-Encoding");
+  g_web->send_P(200, a->type, (const char*)a->gz, a->gzLen);
+}
 
 // =====================
 // Web handlers
 // =====================
-static void webHandleRoot() {
-  g_web->send_P(200, "text/html; charset=utf-8", WEB_PUBLIC_HTML);
-}
+// =====================
+// Önbellekli JSON yanıtı (/api/public, /api/system)
+// - Gövde bir kez üretilip saklanır; anahtar aynıyken sonraki istekler yalnızca kopyalar
+//   (birden çok panel / yoklayıcı için).
+// - /api/public: anahtar durum sürümü (g_stateVer) + WEB_PUB_SNAP_SEC'lik dilim. Anlık
+//   alanlar (now, uptime, heap, RSSI, iş yükü) mevcut yoklayıcılar için gövdede kalır,
+//   en fazla bu kadar eski olur; tam değerler /api/live'da (önbelleksiz, küçük).
+// - /api/system: sayaç/teşhis içeriği; anahtar sürüm + WEB_SYS_SNAP_SEC'lik dilim
+//   (panelin sistem sekmesi yenileme aralığı). Değerler en fazla bu kadar eski olur.
+// - ETag = "<sürüm>[.<dilim>]", Cache-Control: no-cache: tarayıcı fetch'i If-None-Match
+//   ile yeniden doğrular, değişmediyse 304 (gövde yok).
+// - JSON ve CBOR (Accept) gövdeleri ayrı tutulur; CBOR ETag'i "c" önekli, Vary: Accept.
+// =====================
+static const uint32_t WEB_PUB_SNAP_SEC = 60;
+static const uint32_t WEB_SYS_SNAP_SEC = 15;
+
+struct JsonSnapBody {
+  uint32_t ver;
+  uint32_t slot;
+  char     etag[24];
+  String   body;
+};
 
-static void webHandleAdmin() {
-  g_web->send_P(200, "text/html; charset=utf-8", WEB_ADMIN_HTML);
+struct JsonSnap {
+  uint32_t     slotSec;  // 0: yalnızca sürüm
+  uint32_t     builds;
+  uint32_t     hits;     // gövde kopyadan verildi
+  uint32_t     notMod;   // 304
+  JsonSnapBody fmt[2];   // [JO_JSON], [JO_CBOR]
+};
+
+static JsonSnap g_snapPublic = { WEB_PUB_SNAP_SEC };
+static JsonSnap g_snapSystem = { WEB_SYS_SNAP_SEC };
+
+static void webSendSnap(JsonSnap& s, void (*build)(String&, bool)) {
+  bool cbor = webWantsCbor();
+  JsonSnapBody& b = s.fmt[cbor ? JO_CBOR : JO_JSON];
+  uint32_t ver = g_stateVer;   // üretimden önce: üretim sırasındaki değişiklik bir sonrakini tazeler
+  uint32_t slot = 0;
+  if (s.slotSec) slot = (isTimeValid() ? (uint32_t)time(nullptr) : millis() / 1000) / s.slotSec;
+  bool fresh = b.body.length() == 0 || b.ver != ver || b.slot != slot;
+  if (fresh) {
+    b.body = String();
+    build(b.body, cbor);
+    b.ver = ver;
+    b.slot = slot;
+    s.builds++;
+    if (s.slotSec) snprintf(b.etag, sizeof(b.etag), "\"%s%lx.%lx\"", cbor ? "c" : "", (unsigned long)ver, (unsigned long)slot);
+    else           snprintf(b.etag, sizeof(b.etag), "\"%s%lx\"", cbor ? "c" : "", (unsigned long)ver);
+  }
+
+  g_web->sendHeader("ETag", b.etag);
+  g_web->sendHeader("Cache-Control", "no-cache");
+  g_web->sendHeader("Vary", "Accept");
+  String inm = g_web->header("If-None-Match");
+  if (inm.length() > 0 && strstr(inm.c_str(), b.etag)) {
+    s.notMod++;
+    g_web->send(304, nullptr, "");
+    return;
+  }
+  if (!fresh) s.hits++;
+  g_web->send(200, cbor ? "application/cbor" : "application/json", b.body);
 }
 
 // Public API (auth yok) - sadece durum
-static void webHandlePublic() {
+static void webBuildPublic(String& out, bool cbor) {
   DynamicJsonDocument doc(2048);
   doc["ok"]   = true;
   doc["version"] = String(APP_VERSION) + " (" + BOARD_NAME + ")";
   doc["boardType"] = BOARD_TYPE;
   doc["fwVerNum"] = FW_VER_NUM;
   doc["author"]  = APP_AUTHOR;
-  doc["relay"]= g_relayState;
+  doc["relay"]= (bool)g_relayState;
   doc["ip"]   = WiFi.localIP().toString();
   doc["ssid"] = getWiFiSsidForUi();
   doc["httpPort"] = (int)g_httpPort;
@@ -3135,14 +5110,15 @@ static void webHandlePublic() {
   // Debug/teşhis: web panelden ayarların etkisini görebilmek için
   doc["timeValid"] = isTimeValid();
   doc["dayCount"]  = (int)g_dayCount;
+  doc["astroDays"] = (int)(g_dayCount - g_dayApiCount);
   doc["onTolMin"]  = (int)(g_onOffsetSec / 60);
   doc["offTolMin"] = (int)(g_offOffsetSec / 60);
   doc["ramazanAll"] = g_enableRamazanAll;
   doc["spMask"]    = (uint32_t)(g_spEnableMask & spValidMask());
   doc["ilceId"]    = (uint32_t)g_ilceId;
-  doc["lastUpdYmd"] = (uint32_t)prefs.getUInt("lastUpdYmd", 0);
+  doc["lastUpdYmd"] = g_lastUpdYmd;
 
-  // Sistem sağlığı
+  // Sistem sağlığı (dilim başındaki değer; saniyelik hali /api/live)
   doc["freeHeap"]    = (uint32_t)ESP.getFreeHeap();
   doc["minFreeHeap"] = (uint32_t)ESP.getMinFreeHeap();
   doc["uptimeSec"]   = (uint32_t)(millis() / 1000);
@@ -3150,10 +5126,11 @@ static void webHandlePublic() {
   doc["cpuUsage"]    = (int)(g_cpuUsageTotal + 0.5f);
   doc["heapTotal"]   = (uint32_t)ESP.getHeapSize();
   doc["updatePending"]    = g_updatePending;
-  doc["updateInProgress"] = g_updateInProgress;
+  doc["updateInProgress"] = (bool)g_updateInProgress;
 
   // Bugünün namaz vakitleri (mevcut: imsak + akşam)
   int todayIdx = findIdx(ymdToday());
+  if (todayIdx < 0 && isTimeValid()) doc["hicri"] = hijriTextForYmd(ymdToday());  // çevrimdışı takvim
   if (todayIdx >= 0) {
     doc["imsak"] = minToHhmm(g_days[todayIdx].imsakMin);
     doc["aksam"] = minToHhmm(g_days[todayIdx].aksamMin);
@@ -3162,49 +5139,74 @@ static void webHandlePublic() {
     }
   }
 
-  String out;
-  serializeJson(doc, out);
-  g_web->send(200, "application/json", out);
+  webSerializeDoc(doc, out, cbor);
+}
+
+static void webHandlePublic() {
+  webSendSnap(g_snapPublic, webBuildPublic);
+}
+
+// Live API (auth yok) - saniyede değişen alanlar; önbelleğe alınmaz, küçük tutulur.
+// stateVer /api/public ETag'inden farklıysa panel /api/public'i yeniden ister.
+static void webHandleLive() {
+  g_web->sendHeader("Cache-Control", "no-store");
+  JsonOut& j = webJsonBegin();
+  jsonBool(j, "ok", true);
+  jsonUint(j, "stateVer", g_stateVer);
+  jsonStr(j, "now", isTimeValid() ? nowStamp().c_str() : "NO_TIME");
+  jsonUint(j, "uptimeSec", millis() / 1000);
+  jsonUint(j, "freeHeap", ESP.getFreeHeap());
+  jsonUint(j, "minFreeHeap", ESP.getMinFreeHeap());
+  jsonInt(j, "rssi", WiFi.RSSI());
+  jsonInt(j, "cpuUsage", (int)(g_cpuUsageTotal + 0.5f));
+  jsonOutFinish(j);
 }
 
 
 static int defaultHicriYearForSpecial(uint8_t spIdx) {
   if (spIdx >= SPECIAL_COUNT) return HICRI_YEAR_MIN;
   int d = (int)g_specials[spIdx].day;
-  String m = normMonthKey(String(g_specials[spIdx].monthKey));
+  int m = monthIndexFromKey(g_specials[spIdx].monthKey);
   for (uint16_t i = 0; i < g_dayCount; i++) {
-    int hd=0, hy=0; String hm;
-    if (!parseHicri(g_days[i].hicriUzun, hd, hm, hy)) continue;
-    if (hd == d && normMonthKey(hm) == m) {
-      if (hy >= HICRI_YEAR_MIN && hy <= HICRI_YEAR_MAX) return hy;
+    const DayTimes& t = g_days[i];
+    if (t.hDay == d && t.hMon == m) {
+      if (t.hYear >= HICRI_YEAR_MIN && t.hYear <= HICRI_YEAR_MAX) return (int)t.hYear;
     }
   }
+
+  // Cache'te yok: çevrimdışı takvimle bir sonraki yıl dönümü
+  if (isTimeValid() && m >= 0) {
+    int hd = 0, hm = 0, hy = 0;
+    hijriForYmd(ymdToday(), hd, hm, hy);
+    int y = (m > hm || (m == hm && d >= hd)) ? hy : hy + 1;
+    if (y >= HICRI_YEAR_MIN && y <= HICRI_YEAR_MAX) return y;
+  }
   return HICRI_YEAR_MIN;
 }
 
 static void webHandleGetSettings() {
   if (!webRequireAuth()) return;
 
-  DynamicJsonDocument doc(8192);
-  doc["ok"] = true;
-  doc["onTolMin"]  = (int)(g_onOffsetSec / 60);
-  doc["offTolMin"] = (int)(g_offOffsetSec / 60);
-  doc["ramazanAll"] = g_enableRamazanAll;
-  doc["ip"] = WiFi.localIP().toString();
-  doc["ssid"] = getWiFiSsidForUi();
-  doc["httpPort"] = (int)g_httpPort;
-  doc["baseUrl"] = makeBaseUrlForCurrent();
-
-    JsonArray arr = doc.createNestedArray("specials");
+  JsonOut& j = webJsonBegin();
+  jsonBool(j, "ok", true);
+  jsonInt(j, "onTolMin",  g_onOffsetSec / 60);
+  jsonInt(j, "offTolMin", g_offOffsetSec / 60);
+  jsonBool(j, "ramazanAll", g_enableRamazanAll);
+  jsonStr(j, "ip", WiFi.localIP().toString().c_str());
+  jsonStr(j, "ssid", getWiFiSsidForUi().c_str());
+  jsonInt(j, "httpPort", g_httpPort);
+  jsonStr(j, "baseUrl", makeBaseUrlForCurrent().c_str());
+
+  jsonArrBegin(j, "specials");
   for (uint8_t i = 0; i < SPECIAL_COUNT; i++) {
-    JsonObject o = arr.createNestedObject();
-    o["id"]   = (int)i;
-    o["name"] = g_specials[i].name;
-    o["en"]   = isSpecialEnabled(i);
+    jsonObjBegin(j);
+    jsonInt(j, "id", i);
+    jsonStr(j, "name", g_specials[i].name);
+    jsonBool(j, "en", isSpecialEnabled(i));
 
     // Hicri tarih override UI (Dini Günler sayfası)
     const int defDay   = (int)g_specials[i].day;
-    int defMonIdx      = monthIndexFromKey(String(g_specials[i].monthKey));
+    int defMonIdx      = monthIndexFromKey(g_specials[i].monthKey);
     if (defMonIdx < 0) defMonIdx = 0;
     const int defYear  = defaultHicriYearForSpecial(i);
 
@@ -3218,17 +5220,17 @@ static void webHandleGetSettings() {
     if (hMonth < 0) hMonth = 0; if (hMonth > 11) hMonth = 11;
     if (hYear < HICRI_YEAR_MIN || hYear > HICRI_YEAR_MAX) hYear = defYear;
 
-    o["useDefault"] = useDef;
-    o["hDay"]   = hDay;
-    o["hMonth"] = hMonth;
-    o["hYear"]  = hYear;
-    o["defDay"]   = defDay;
-    o["defMonth"] = defMonIdx;
-    o["defYear"]  = defYear;
+    jsonBool(j, "useDefault", useDef);
+    jsonInt(j, "hDay",     hDay);
+    jsonInt(j, "hMonth",   hMonth);
+    jsonInt(j, "hYear",    hYear);
+    jsonInt(j, "defDay",   defDay);
+    jsonInt(j, "defMonth", defMonIdx);
+    jsonInt(j, "defYear",  defYear);
+    jsonEnd(j);
   }
-String out;
-  serializeJson(doc, out);
-  g_web->send(200, "application/json", out);
+  jsonEnd(j);
+  jsonOutFinish(j);
 }
 
 static void webHandlePostSettings() {
@@ -3244,6 +5246,14 @@ static void webHandlePostSettings() {
     return;
   }
 
+  // Neyin değiştiğini bilmek için eski değerler (sadece etkilenen pencereler yeniden hesaplanır)
+  const int      oldOn   = g_onOffsetSec;
+  const int      oldOff  = g_offOffsetSec;
+  const uint32_t oldMask = g_spEnableMask;
+  const bool     oldRam  = g_enableRamazanAll;
+  SpOverride oldOv[SPECIAL_COUNT];
+  memcpy(oldOv, g_spOv, sizeof(oldOv));
+
   int onTolMin  = doc["onTolMin"]  | (g_onOffsetSec/60);
   int offTolMin = doc["offTolMin"] | (g_offOffsetSec/60);
   bool ramAll   = doc["ramazanAll"] | g_enableRamazanAll;
@@ -3329,7 +5339,11 @@ static void webHandlePostSettings() {
 #endif
 
   // Çizelgeleri tekrar hesapla (zaman geçerliyse hemen etkiler)
-  recomputeAllSchedules();
+  uint8_t dirty = 0;
+  if (oldOn != g_onOffsetSec || oldOff != g_offOffsetSec) dirty |= SD_TOL;
+  if (oldMask != g_spEnableMask || memcmp(oldOv, g_spOv, sizeof(oldOv)) != 0) dirty |= SD_SPECIAL;
+  if (oldRam != g_enableRamazanAll) dirty |= SD_RAMAZAN;
+  schedRecompute(dirty);
 
   DynamicJsonDocument out(768);
   out["ok"] = (ok1 && ok2 && ok3 && match);
@@ -3388,66 +5402,72 @@ static void webHandleGetDiniGunler() {
 static void webHandleGetAdminCfg() {
   if (!webRequireAuth()) return;
 
-  DynamicJsonDocument doc(4096);
-  doc["ok"] = true;
-  doc["ilceId"] = (uint32_t)g_ilceId;
-
-  JsonObject net = doc.createNestedObject("net");
-  net["useStatic"] = g_netCfg.useStatic;
-  net["ip"]   = (g_netCfg.useStatic && g_netCfg.ip)   ? u32ToIp(g_netCfg.ip).toString()   : String("");
-  net["gw"]   = (g_netCfg.useStatic && g_netCfg.gw)   ? u32ToIp(g_netCfg.gw).toString()   : String("");
-  net["mask"] = (g_netCfg.useStatic && g_netCfg.mask) ? u32ToIp(g_netCfg.mask).toString() : String("");
-  net["dns1"] = (g_netCfg.dns1) ? u32ToIp(g_netCfg.dns1).toString() : String("");
-  net["dns2"] = (g_netCfg.dns2) ? u32ToIp(g_netCfg.dns2).toString() : String("");
-  net["httpPort"] = (uint16_t)g_httpPort;
-
-  JsonArray admins = doc.createNestedArray("admins");
-  for (uint8_t i = 0; i < g_adminCount; i++) {
-    JsonObject a = admins.createNestedObject();
-    a["id"] = String((long long)g_adminIds[i]);   // string -> JS güvenli
-    a["owner"] = (g_adminIds[i] == OWNER_ADMIN_ID);
-  }
-
-  // Canlı WiFi bilgileri (DHCP/statik farketmez)
-  net["liveIp"]   = WiFi.localIP().toString();
-  net["liveGw"]   = WiFi.gatewayIP().toString();
-  net["liveMask"] = WiFi.subnetMask().toString();
-  net["liveDns1"] = WiFi.dnsIP(0).toString();
-  net["liveDns2"] = WiFi.dnsIP(1).toString();
-
-  // creds (WiFi/Web) - şifreleri döndürmeyiz, sadece durum bilgisi
-  JsonObject creds = doc.createNestedObject("creds");
-  creds["wifiSrc"] = g_wifiSrc;
-  creds["webKeySrc"] = g_webKeySrc;
-  creds["activeWifiSsid"] = g_wifiSsid;
-  creds["activeWebKeySet"] = (g_webKey.length() > 0);
-  creds["botTokenSrc"] = g_botTokenSrc;
-  creds["chatIdSrc"] = g_chatIdSrc;
-  creds["chatId"] = g_activeChatId;
-  creds["botTokenSet"] = (g_botToken.length() > 0);
-
+  // NVS okumaları yanıt başlamadan (yazım sırasında bloklamasın)
   String nvsSsid = prefs.getString(NVS_KEY_WIFI_SSID, "");
   nvsSsid.trim();
-  creds["nvsWifiSsid"] = nvsSsid;
-
-  String nvsPass = prefs.getString(NVS_KEY_WIFI_PASS, "");
-  creds["nvsHasWifiPass"] = (nvsPass.length() > 0);
-
+  bool nvsHasPass = prefs.getString(NVS_KEY_WIFI_PASS, "").length() > 0;
   String nvsWk = prefs.getString(NVS_KEY_WEB_KEY, "");
   nvsWk.trim();
-  creds["nvsHasWebKey"] = (nvsWk.length() > 0);
 
-  creds["secretsWifiSet"]   = !isEmptyCstr(SECRET_WIFI_SSID);
-  creds["secretsWebKeySet"] = !isEmptyCstr(SECRET_WEB_KEY);
-  JsonObject hny = doc.createNestedObject("hicriYear");
-  hny["day"]  = (int)g_hnyDay;
-  hny["mon"]  = (int)g_hnyMon;
-  hny["auto"] = g_autoHicriYear;
-  hny["lastYear"] = (int)g_hnyLastYear;
+  JsonOut& j = webJsonBegin();
+  jsonBool(j, "ok", true);
+  jsonUint(j, "ilceId", g_ilceId);
+  jsonObjBegin(j, "geo");
+  jsonNum(j, "lat", (double)g_latE6 / 1e6, 6);
+  jsonNum(j, "lon", (double)g_lonE6 / 1e6, 6);
+  jsonEnd(j);
+
+  jsonObjBegin(j, "net");
+  jsonBool(j, "useStatic", g_netCfg.useStatic);
+  jsonStr(j, "ip",   (g_netCfg.useStatic && g_netCfg.ip)   ? u32ToIp(g_netCfg.ip).toString().c_str()   : "");
+  jsonStr(j, "gw",   (g_netCfg.useStatic && g_netCfg.gw)   ? u32ToIp(g_netCfg.gw).toString().c_str()   : "");
+  jsonStr(j, "mask", (g_netCfg.useStatic && g_netCfg.mask) ? u32ToIp(g_netCfg.mask).toString().c_str() : "");
+  jsonStr(j, "dns1", (g_netCfg.dns1) ? u32ToIp(g_netCfg.dns1).toString().c_str() : "");
+  jsonStr(j, "dns2", (g_netCfg.dns2) ? u32ToIp(g_netCfg.dns2).toString().c_str() : "");
+  jsonUint(j, "httpPort", g_httpPort);
+  // Canlı WiFi bilgileri (DHCP/statik farketmez)
+  jsonStr(j, "liveIp",   WiFi.localIP().toString().c_str());
+  jsonStr(j, "liveGw",   WiFi.gatewayIP().toString().c_str());
+  jsonStr(j, "liveMask", WiFi.subnetMask().toString().c_str());
+  jsonStr(j, "liveDns1", WiFi.dnsIP(0).toString().c_str());
+  jsonStr(j, "liveDns2", WiFi.dnsIP(1).toString().c_str());
+  jsonEnd(j);
+
+  jsonArrBegin(j, "admins");
+  for (uint8_t i = 0; i < g_adminCount; i++) {
+    char id[24];
+    snprintf(id, sizeof(id), "%lld", (long long)g_adminIds[i]);   // string -> JS güvenli
+    jsonObjBegin(j);
+    jsonStr(j, "id", id);
+    jsonBool(j, "owner", g_adminIds[i] == OWNER_ADMIN_ID);
+    jsonEnd(j);
+  }
+  jsonEnd(j);
 
-  String out;
-  serializeJson(doc, out);
-  g_web->send(200, "application/json", out);
+  // creds (WiFi/Web) - şifreleri döndürmeyiz, sadece durum bilgisi
+  jsonObjBegin(j, "creds");
+  jsonStr(j, "wifiSrc", g_wifiSrc.c_str());
+  jsonStr(j, "webKeySrc", g_webKeySrc.c_str());
+  jsonStr(j, "activeWifiSsid", g_wifiSsid.c_str());
+  jsonBool(j, "activeWebKeySet", g_webKey.length() > 0);
+  jsonStr(j, "botTokenSrc", g_botTokenSrc.c_str());
+  jsonStr(j, "chatIdSrc", g_chatIdSrc.c_str());
+  jsonStr(j, "chatId", g_activeChatId.c_str());
+  jsonBool(j, "botTokenSet", g_botToken.length() > 0);
+  jsonStr(j, "nvsWifiSsid", nvsSsid.c_str());
+  jsonBool(j, "nvsHasWifiPass", nvsHasPass);
+  jsonBool(j, "nvsHasWebKey", nvsWk.length() > 0);
+  jsonBool(j, "secretsWifiSet",   !isEmptyCstr(SECRET_WIFI_SSID));
+  jsonBool(j, "secretsWebKeySet", !isEmptyCstr(SECRET_WEB_KEY));
+  jsonEnd(j);
+
+  jsonObjBegin(j, "hicriYear");
+  jsonInt(j, "day", g_hnyDay);
+  jsonInt(j, "mon", g_hnyMon);
+  jsonBool(j, "auto", g_autoHicriYear);
+  jsonInt(j, "lastYear", g_hnyLastYear);
+  jsonEnd(j);
+  jsonOutFinish(j);
 }
 
 static bool parseIpString(const String& s, uint32_t& outPacked) {
@@ -3472,6 +5492,24 @@ static void webHandlePostAdminCfg() {
   bool needReboot = false;
   String msg = "";
 
+  // ---- İlçe koordinatı (çevrimdışı vakit hesabı; 0,0 = kapalı) ----
+  bool geoChanged = false;
+  if (doc.containsKey("geo")) {
+    JsonObject g = doc["geo"].as<JsonObject>();
+    double lat = g["lat"] | ((double)g_latE6 / 1e6);
+    double lon = g["lon"] | ((double)g_lonE6 / 1e6);
+    int32_t latE6 = (int32_t)lround(lat * 1e6);
+    int32_t lonE6 = (int32_t)lround(lon * 1e6);
+    if (!(latE6 == 0 && lonE6 == 0) && !prayerCoordValid(latE6, lonE6)) {
+      g_web->send(400, "application/json", "{\"ok\":false,\"err\":\"geo\"}");
+      return;
+    }
+    if (latE6 != g_latE6 || lonE6 != g_lonE6) {
+      g_latE6 = latE6; g_lonE6 = lonE6;
+      geoChanged = true;
+    }
+  }
+
   // ---- İlçe ID ----
   if (doc.containsKey("ilceId")) {
     uint32_t id = (uint32_t)(doc["ilceId"] | (int)g_ilceId);
@@ -3481,6 +5519,15 @@ static void webHandlePostAdminCfg() {
     }
     if (id != g_ilceId) {
       g_ilceId = id;
+      // Aynı istekte yeni koordinat gelmediyse eskisi yeni ilçeye ait değil
+      bool geoReset = false;
+      if (!geoChanged) {
+        int32_t latE6, lonE6;
+        ilceDefaultGeo(id, latE6, lonE6);
+        geoReset = (latE6 != g_latE6 || lonE6 != g_lonE6);
+        g_latE6 = latE6; g_lonE6 = lonE6;
+      }
+      stateBump();
       String nvsErr;
       if (!saveIlceToNvs(&nvsErr)) { g_web->send(500, "application/json", "{\"ok\":false,\"err\":\"nvs\"}"); return; }
 
@@ -3488,7 +5535,10 @@ static void webHandlePostAdminCfg() {
       prefs.remove("dayCount");
       prefs.remove("daysBlob");
       prefs.remove("lastUpdYmd");
+      g_lastUpdYmd = 0;
       g_dayCount = 0;
+      g_dayApiCount = 0;
+      daysMarkDirty();
 
       // schedule reset
       g_thuOnTs = g_thuOffTs = 0;
@@ -3497,9 +5547,18 @@ static void webHandlePostAdminCfg() {
       g_nextImsakOffTs = 0;
 
       msg += "İlçe ID güncellendi. ";
+      if (geoReset && !prayerCoordValid(g_latE6, g_lonE6)) msg += "Çevrimdışı vakit hesabı kapatıldı (yeni ilçe için enlem/boylam girin). ";
       logUser("WEB: Ilce ID degistirildi (" + String(g_ilceId) + ")");
+      geoChanged = false;  // koordinat saveIlceToNvs ile yazıldı
     }
   }
+  if (geoChanged) {
+    String nvsErr;
+    if (!saveIlceToNvs(&nvsErr)) { g_web->send(500, "application/json", "{\"ok\":false,\"err\":\"nvs\"}"); return; }
+    schedRecompute(SD_DAYS);  // hesaplanan günler yeni koordinatla yeniden üretilir
+    msg += "Koordinat güncellendi. ";
+    logUser("WEB: Ilce koordinati degistirildi");
+  }
 
   // ---- Ağ (Statik IP) ----
   if (doc.containsKey("net")) {
@@ -3736,27 +5795,25 @@ if (doc.containsKey("creds")) {
   // Eğer reboot planlandıysa loop'ta yapılacak (burada bloklama yok)
 }
 
+static void webJsonLogArr(JsonOut& j, const char* key, const LogEntry* log, uint8_t idx, uint8_t cnt) {
+  jsonArrBegin(j, key);
+  for (int i = 0; i < cnt; i++) {
+    int ri = (idx - cnt + i + LOG_MAX) % LOG_MAX;
+    jsonObjBegin(j);
+    jsonStr(j, "ts", log[ri].ts);
+    jsonStr(j, "msg", log[ri].msg);
+    jsonEnd(j);
+  }
+  jsonEnd(j);
+}
+
 static void webHandleLogs() {
   if (!webRequireAuth()) return;
-  DynamicJsonDocument doc(4096);
-  doc["ok"] = true;
-  JsonArray ua = doc.createNestedArray("user");
-  for (int i = 0; i < g_userLogCnt; i++) {
-    int ri = (g_userLogIdx - g_userLogCnt + i + LOG_MAX) % LOG_MAX;
-    JsonObject o = ua.createNestedObject();
-    o["ts"] = String(g_userLog[ri].ts);
-    o["msg"] = String(g_userLog[ri].msg);
-  }
-  JsonArray sa = doc.createNestedArray("sys");
-  for (int i = 0; i < g_sysLogCnt; i++) {
-    int ri = (g_sysLogIdx - g_sysLogCnt + i + LOG_MAX) % LOG_MAX;
-    JsonObject o = sa.createNestedObject();
-    o["ts"] = String(g_sysLog[ri].ts);
-    o["msg"] = String(g_sysLog[ri].msg);
-  }
-  String out;
-  serializeJson(doc, out);
-  g_web->send(200, "application/json", out);
+  JsonOut& j = webJsonBegin();
+  jsonBool(j, "ok", true);
+  webJsonLogArr(j, "user", g_userLog, g_userLogIdx, g_userLogCnt);
+  webJsonLogArr(j, "sys", g_sysLog, g_sysLogIdx, g_sysLogCnt);
+  jsonOutFinish(j);
 }
 
 // WiFi test state machine (non-blocking)
@@ -3873,21 +5930,151 @@ static void webHandleWifiScan() {
   esp_task_wdt_reset(); // Scan uzun sürebilir, WDT besle
   int n = WiFi.scanNetworks(false, false, false, 200); // 200ms/kanal
   esp_task_wdt_reset();
-  DynamicJsonDocument doc(2048);
-  JsonArray arr = doc.createNestedArray("networks");
-  if (n > 0) {
-    for (int i = 0; i < n && i < 20; i++) {
-      JsonObject o = arr.createNestedObject();
-      o["ssid"] = WiFi.SSID(i);
-      o["rssi"] = WiFi.RSSI(i);
-      o["enc"]  = (WiFi.encryptionType(i) != WIFI_AUTH_OPEN);
+  JsonOut& j = webJsonBegin();
+  jsonArrBegin(j, "networks");
+  for (int i = 0; i < n && i < 20; i++) {
+    jsonObjBegin(j);
+    jsonStr(j, "ssid", WiFi.SSID(i).c_str());
+    jsonInt(j, "rssi", WiFi.RSSI(i));
+    jsonBool(j, "enc", WiFi.encryptionType(i) != WIFI_AUTH_OPEN);
+    jsonEnd(j);
+  }
+  jsonEnd(j);
+  jsonInt(j, "count", n > 0 ? n : 0);
+  jsonOutFinish(j);
+  WiFi.scanDelete();
+}
+
+// =====================
+// Canlı durum akışı (SSE): GET /api/events
+// - Panel 15 sn'de bir /api/public çekmek yerine bu akışı dinler. Bağlanınca tam
+//   durum, sonra yalnızca değişen alanlar: röle, çizelge penceresi, saat (dakika),
+//   güncelleme durumu, WiFi testi. Dakika dönüşünde sağlık alanları (RSSI, heap, CPU,
+//   uptime) da eklenir; gün/cache değişince panel /api/public'i kendisi yeniler.
+// - webEventsTick her loop turunda değerleri karşılaştırır (JSON belgesi/NVS yok);
+//   akış yoksa hiç iş yapmaz. 25 sn sessizlikte nabız yorumu gider (ölü bağlantı
+//   gönderim zaman aşımıyla düşer).
+// =====================
+static const uint32_t WEB_EVENTS_BEAT_MS = 25000;
+
+struct WebLive {
+  int8_t   relay;
+  int8_t   upd;       // 0=boşta, 1=kuyrukta, 2=çalışıyor
+  int8_t   wf;        // g_wfTestState
+  bool     winAct;    // pencere şu an açık
+  int32_t  minute;    // epoch/60, saat yoksa -1
+  uint32_t ymd;
+  uint16_t dayCount;
+  time_t   winOn, winOff;
+};
+
+static WebLive  g_live;
+static uint32_t g_liveTxMs = 0;
+
+// En yakın (açık ya da sıradaki) Perşembe / dini gün penceresi
+static void webLiveWindow(time_t now, time_t& on, time_t& off) {
+  on = 0; off = 0;
+  if (g_thuOffTs > now) { on = g_thuOnTs; off = g_thuOffTs; }
+  if (g_spOffTs > now && (on == 0 || g_spOnTs < on)) { on = g_spOnTs; off = g_spOffTs; }
+}
+
+static void webLiveSample(WebLive& s) {
+  bool tv = isTimeValid();
+  time_t now = tv ? time(nullptr) : 0;
+  s.relay    = g_relayState ? 1 : 0;
+  s.upd      = g_updateInProgress ? 2 : (g_updatePending ? 1 : 0);
+  s.wf       = (int8_t)g_wfTestState;
+  s.minute   = tv ? (int32_t)(now / 60) : -1;
+  s.ymd      = tv ? ymdToday() : 0;
+  s.dayCount = g_dayCount;
+  if (tv) webLiveWindow(now, s.winOn, s.winOff);
+  else { s.winOn = 0; s.winOff = 0; }
+  s.winAct   = tv && s.winOn != 0 && now >= s.winOn;
+}
+
+static void webLiveWinText(time_t ts, char* out, size_t outSz) {
+  tm t{}; localtime_r(&ts, &t);
+  strftime(out, outSz, "%d.%m %H:%M", &t);
+}
+
+// prev == nullptr: tam durum. Dönüş: yazılan alan sayısı
+static int webLiveJson(const WebLive* prev, const WebLive& cur, char* out, size_t outSz) {
+  size_t n = 1;
+  int fields = 0;
+  auto add = [&](const char* fmt, ...) {
+    if (n >= outSz) return;
+    va_list ap;
+    va_start(ap, fmt);
+    int w = vsnprintf(out + n, outSz - n, fmt, ap);
+    va_end(ap);
+    if (w > 0) n += (size_t)w;
+    fields++;
+  };
+
+  out[0] = '{';
+  out[1] = '\0';
+  if (!prev || prev->relay != cur.relay)   add("\"relay\":%s,", cur.relay ? "true" : "false");
+  if (!prev || prev->upd != cur.upd)       add("\"upd\":%d,", cur.upd);
+  if (!prev || prev->wf != cur.wf)         add("\"wf\":%d,", cur.wf);
+  if (!prev || prev->winOn != cur.winOn || prev->winOff != cur.winOff || prev->winAct != cur.winAct) {
+    if (cur.winOn) {
+      char a[16], b[16];
+      webLiveWinText(cur.winOn, a, sizeof(a));
+      webLiveWinText(cur.winOff, b, sizeof(b));
+      add("\"win\":[\"%s\",\"%s\"],\"winAct\":%s,", a, b, cur.winAct ? "true" : "false");
+    } else {
+      add("\"win\":[],\"winAct\":false,");
     }
   }
-  doc["count"] = n > 0 ? n : 0;
-  WiFi.scanDelete();
-  String out;
-  serializeJson(doc, out);
-  g_web->send(200, "application/json", out);
+  if (!prev || prev->ymd != cur.ymd)           add("\"ymd\":%u,", (unsigned)cur.ymd);
+  if (!prev || prev->dayCount != cur.dayCount) add("\"dayCount\":%u,", (unsigned)cur.dayCount);
+  if (!prev || prev->minute != cur.minute) {
+    add("\"now\":\"%s\",\"rssi\":%d,\"freeHeap\":%u,\"cpuUsage\":%d,\"uptimeSec\":%u,",
+        nowStamp().c_str(), (int)WiFi.RSSI(), (unsigned)ESP.getFreeHeap(),
+        (int)(g_cpuUsageTotal + 0.5f), (unsigned)(millis() / 1000));
+  }
+  if (n + 1 >= outSz) n = outSz - 2;   // taşma (olmamalı): kesik ama kapalı
+  if (fields > 0) n--;                 // son virgül
+  out[n++] = '}';
+  out[n] = '\0';
+  return fields;
+}
+
+static void webHandleEvents() {
+  if (!g_web->beginStream("text/event-stream")) {
+    g_web->send(503, "application/json", "{\"ok\":false,\"err\":\"busy\"}");
+    return;
+  }
+  WebLive cur;
+  webLiveSample(cur);
+  if (g_web->streamCount() == 1) { g_live = cur; g_liveTxMs = millis(); }   // ilk dinleyici: temel
+
+  char js[384];
+  webLiveJson(nullptr, cur, js, sizeof(js));
+  String ev = "retry: 3000\ndata: ";
+  ev += js;
+  ev += "\n\n";
+  g_web->streamPrint(ev);
+}
+
+static void webEventsTick() {
+  if (!g_web || g_web->streamCount() == 0) return;
+  WebLive cur;
+  webLiveSample(cur);
+
+  char ev[400];
+  memcpy(ev, "data: ", 6);
+  if (webLiveJson(&g_live, cur, ev + 6, sizeof(ev) - 8) > 0) {
+    size_t n = strlen(ev);
+    ev[n++] = '\n';
+    ev[n++] = '\n';
+    g_web->streamBroadcast(ev, n);
+    g_live = cur;
+    g_liveTxMs = millis();
+  } else if (millis() - g_liveTxMs > WEB_EVENTS_BEAT_MS) {
+    g_web->streamBroadcast(":\n\n", 3);
+    g_liveTxMs = millis();
+  }
 }
 
 static void webHandlePostAction() {
@@ -3924,6 +6111,7 @@ static void webHandlePostAction() {
     } else {
       g_updatePending = true;
       g_updateRequesterWho = "(WEB)";
+      stateBump();
       out["ok"] = true;
       out["msg"] = "✅ Vakit güncelleme kuyruğa alındı";
       logUser("WEB: Vakit guncelleme istendi");
@@ -3947,6 +6135,7 @@ static void webHandlePostAction() {
   else if (cmd == "cancelUpdate") {
     if (g_updatePending) {
       g_updatePending = false;
+      stateBump();
       out["ok"] = true;
       out["msg"] = "Guncelleme iptal edildi";
     } else {
@@ -3958,12 +6147,8 @@ static void webHandlePostAction() {
     out["ok"] = true;
     out["msg"] = "Sistem yeniden baslatiliyor...";
     logUser("WEB: Reboot istendi");
-    String outStr;
-    serializeJson(out, outStr);
-    g_web->send(200, "application/json", outStr);
-    delay(500);
-    ESP.restart();
-    return;
+    // Yanıt dispatch() sonunda yazılır; restart loop'ta (outboxFlush ile) yapılır
+    scheduleRestart(1000, "Reboot (web)");
   }
   else {
     out["err"] = "unknown";
@@ -4014,9 +6199,9 @@ static int  g_otaFileVer = 0;
 static void webHandleOtaUpload() {
   if (!webAuthOk()) return;
 
-  HTTPUpload& up = g_web->upload();
+  WebUpload& up = g_web->upload();
 
-  if (up.status == UPLOAD_FILE_START) {
+  if (up.status == WU_START) {
     g_webOtaInProgress = true;
     g_otaBoardChecked = false;
     g_otaBoardMismatch = false;
@@ -4058,14 +6243,14 @@ static void webHandleOtaUpload() {
       Serial.println(Update.getError());
     }
   }
-  else if (up.status == UPLOAD_FILE_WRITE) {
+  else if (up.status == WU_WRITE) {
     if (g_otaBoardMismatch || g_otaVerOld) return;
     if (Update.write(up.buf, up.currentSize) != up.currentSize) {
       Serial.print("[OTA] Update.write FAILED. err=");
       Serial.println(Update.getError());
     }
   }
-  else if (up.status == UPLOAD_FILE_END) {
+  else if (up.status == WU_END) {
     if (g_otaBoardMismatch || g_otaVerOld) {
       Serial.println(g_otaBoardMismatch ? "[OTA] Board mismatch - iptal" : "[OTA] Version old - iptal");
       g_webOtaInProgress = false;
@@ -4080,7 +6265,7 @@ static void webHandleOtaUpload() {
     }
     g_webOtaInProgress = false;
   }
-  else if (up.status == UPLOAD_FILE_ABORTED) {
+  else if (up.status == WU_ABORTED) {
     Serial.println("[OTA] Upload aborted");
     if (!g_otaBoardMismatch && !g_otaVerOld) Update.abort();
     g_webOtaInProgress = false;
@@ -4155,10 +6340,8 @@ static void webHandleOtaFinish() {
 // =====================
 // /api/system - Detaylı sistem bilgisi
 // =====================
-static void webHandleSystem() {
-  if (!webRequireAuth()) return;
-
-  DynamicJsonDocument doc(2048);
+static void webBuildSystem(String& out, bool cbor) {
+  DynamicJsonDocument doc(6144);
   doc["ok"] = true;
 
   // ── RAM ──
@@ -4240,6 +6423,217 @@ static void webHandleSystem() {
   uint32_t uptimeSec = millis() / 1000;
   doc["uptimeSec"] = uptimeSec;
 
+  // ── Çizelge (artımlı yeniden hesap sayaçları) ──
+  JsonObject sch = doc.createNestedObject("sched");
+  sch["recompute"] = g_sched.recomputeCnt;
+  sch["thu"]       = g_sched.thuCnt;
+  sch["special"]   = g_sched.spCnt;
+  sch["imsak"]     = g_sched.imsakCnt;
+  sch["tlBuild"]   = g_sched.tlBuildCnt;
+  sch["tlOverflow"] = g_sched.tlOverflow;
+  sch["rules"]     = g_ruleCount;
+  sch["intervals"] = g_ivCount;
+  sch["edges"]     = g_tlCount;
+  sch["dirty"]     = g_sched.dirty;
+  if (isTimeValid() && g_sched.nextDueTs != 0) sch["nextDueSec"] = (long)(g_sched.nextDueTs - time(nullptr));
+
+  // ── Röle görevi ──
+  JsonObject rt = doc.createNestedObject("relayTask");
+  rt["running"]   = (g_relayTask != nullptr);
+  rt["inline"]    = g_relayInline;
+  rt["core"]      = (int)RELAY_TASK_CORE;
+  rt["prio"]      = (int)RELAY_TASK_PRIO;
+  rt["cycles"]    = g_relayStats.cycles;
+  rt["cmds"]      = g_relayStats.cmds;
+  rt["switches"]  = g_relayStats.switches;
+  rt["forced"]    = g_relayStats.forced;
+  rt["planVer"]   = g_relayStats.planVer;
+  rt["maxStepUs"] = g_relayStats.maxStepUs;
+  rt["evtDrop"]   = g_relayStats.evtDrop;
+  rt["cmdTimeout"] = g_relayStats.cmdTimeouts;
+  rt["armed"]     = g_relayStats.armed;
+  rt["timerFired"] = g_relayStats.timerFired;
+  rt["cbBusy"]    = g_relayStats.cbBusy;
+  if (g_relayTask) rt["stackFree"] = (uint32_t)uxTaskGetStackHighWaterMark(g_relayTask);
+  {
+    // Geçiş gecikmesi: planlanan an -> rölenin yazıldığı an (ms, son RELAY_LAT_N geçiş)
+    static int32_t latMs[RELAY_LAT_N];
+    static RelayLatSample recent[RELAY_LAT_RECENT];
+    int nRecent = 0;
+    int n = relayLatSnapshot(latMs, recent, nRecent);
+    JsonObject lat = rt.createNestedObject("latency");
+    lat["total"] = g_relayLatCnt;
+    lat["n"]     = n;
+    if (n > 0) {
+      lat["minMs"] = latMs[0];
+      lat["p50Ms"] = relayLatPct(latMs, n, 50);
+      lat["p90Ms"] = relayLatPct(latMs, n, 90);
+      lat["p99Ms"] = relayLatPct(latMs, n, 99);
+      lat["maxMs"] = latMs[n - 1];
+    }
+    JsonArray ra = lat.createNestedArray("recent");
+    for (int i = 0; i < nRecent; i++) {
+      char ts[32];
+      formatDateTime(recent[i].schedTs, ts, sizeof(ts));
+      JsonObject o = ra.createNestedObject();
+      o["at"]    = String(ts);
+      o["on"]    = recent[i].on != 0;
+      o["latMs"] = recent[i].latMs;
+    }
+  }
+
+  // ── Telegram alım (long polling) ──
+  JsonObject tg = doc.createNestedObject("tg");
+  tg["running"]    = (g_tgRxTask != nullptr);
+  tg["longPollSec"] = TG_LONGPOLL_SEC;
+  tg["polls"]      = g_tgRxStats.polls;
+  tg["updates"]    = g_tgRxStats.updates;
+  tg["errors"]     = g_tgRxStats.errors;
+  tg["reconnects"] = g_tgRxStats.reconnects;
+  tg["qFull"]      = g_tgRxStats.qFull;
+  tg["lastPollMs"] = g_tgRxStats.lastPollMs;
+  tg["queued"]     = g_tgRxQ ? (int)uxQueueMessagesWaiting(g_tgRxQ) : 0;
+  if (g_tgRxStats.lastOkMs) tg["lastOkAgoSec"] = (uint32_t)((millis() - g_tgRxStats.lastOkMs) / 1000);
+  if (g_tgRxTask) tg["stackFree"] = (uint32_t)uxTaskGetStackHighWaterMark(g_tgRxTask);
+
+  // ── Telegram paneli (edit diff / birleştirme) ──
+  JsonObject pn = doc.createNestedObject("panel");
+  pn["requests"]    = g_panelStats.requests;
+  pn["renders"]     = g_panelStats.renders;
+  pn["skipped"]     = g_panelStats.skipped;
+  pn["edits"]       = g_panelStats.edits;
+  pn["notModified"] = g_panelStats.notModified;
+  pn["sends"]       = g_panelStats.sends;
+
+  // ── Telegram Bot API çağrıları (süre / heap) ──
+  JsonArray ta = doc.createNestedArray("tgApi");
+  const TgBot* tgBots[] = { &g_bot, &g_tgRxBot };
+  for (const TgBot* b : tgBots) {
+    for (int k = 0; k < TGM_COUNT; k++) {
+      const TgCallStat& cs = b->stats[k];
+      if (cs.calls == 0) continue;
+      JsonObject o = ta.createNestedObject();
+      o["bot"]      = b->label();
+      o["method"]   = TG_METHOD_NAMES[k];
+      o["calls"]    = cs.calls;
+      o["fails"]    = cs.fails;
+      o["lastMs"]   = cs.lastMs;
+      o["avgMs"]    = cs.totalMs / cs.calls;
+      o["maxMs"]    = cs.maxMs;
+      o["heapDrop"] = cs.heapDropMax;
+      o["maxAlloc"] = cs.lastMaxAlloc;
+    }
+  }
+
+  // ── Telegram outbox ──
+  JsonObject ob = doc.createNestedObject("outbox");
+  ob["running"] = (g_tgTxTask != nullptr);
+  ob["pending"] = g_obCount;
+  ob["queued"]  = g_obStats.queued;
+  ob["sent"]    = g_obStats.sent;
+  ob["merged"]  = g_obStats.merged;
+  ob["retries"] = g_obStats.retries;
+  ob["dropped"] = g_obStats.dropped;
+  ob["loaded"]  = g_obStats.loaded;
+  ob["saves"]   = g_obStats.saves;
+  ob["fs"]      = g_obFsOk;
+  if (g_obStats.lastSendMs) ob["lastSendAgoSec"] = (uint32_t)((millis() - g_obStats.lastSendMs) / 1000);
+
+  // ── Web sunucusu ──
+  {
+    const WebStats& ws = g_web->st;
+    JsonObject wo = doc.createNestedObject("web");
+    wo["conns"]        = g_web->activeConns();
+    wo["connsMax"]     = WEB_CONN_MAX;
+    wo["peak"]         = ws.peak;
+    wo["accepted"]     = ws.accepted;
+    wo["requests"]     = ws.requests;
+    wo["reused"]       = ws.reused;
+    wo["evicted"]      = ws.evicted;
+    wo["timeouts"]     = ws.timeouts;
+    wo["rejected"]     = ws.rejected;
+    wo["notModified"]  = ws.notModified;
+    wo["streamsOpen"]  = g_web->streamCount();
+    wo["streams"]      = ws.streams;
+    wo["streamDrops"]  = ws.streamDrops;
+    wo["stateVer"]     = (uint32_t)g_stateVer;
+    wo["pubBuilds"]    = g_snapPublic.builds;
+    wo["pubHits"]      = g_snapPublic.hits;
+    wo["pubNotMod"]    = g_snapPublic.notMod;
+    wo["sysBuilds"]    = g_snapSystem.builds;
+    wo["sysHits"]      = g_snapSystem.hits;
+    wo["sysNotMod"]    = g_snapSystem.notMod;
+    wo["bytesIn"]      = ws.bytesIn;
+    wo["bytesOut"]     = ws.bytesOut;
+    wo["handlerMaxUs"] = ws.handlerUsMax;
+    wo["handlerAvgUs"] = ws.requests ? (uint32_t)(ws.handlerUsSum / ws.requests) : 0;
+  }
+
+  // ── Ağ bağlantıları (DNS önbelleği + keep-alive) ──
+  JsonObject net = doc.createNestedObject("net");
+  JsonArray nh = net.createNestedArray("hosts");
+  for (int h = 0; h < NH_COUNT; h++) {
+    const NetHostInfo& hi = g_netHosts[h];
+    JsonObject o = nh.createNestedObject();
+    o["name"]       = hi.name;
+    if (hi.ip) o["ip"] = IPAddress(hi.ip).toString();
+    o["dnsLookups"] = hi.dnsLookups;
+    o["dnsHits"]    = hi.dnsHits;
+    o["dnsFails"]   = hi.dnsFails;
+    uint32_t hs = 0, req = 0, reuse = 0, rx = 0, tx = 0;
+    for (int i = 0; i < g_netClientCount; i++) {
+      const NetClientBase* c = g_netClients[i];
+      if (c->host != h) continue;
+      hs += c->st.connects; req += c->st.requests; reuse += c->st.reuses;
+      rx += c->st.bytesRx;  tx += c->st.bytesTx;
+    }
+    o["handshakes"] = hs;
+    o["requests"]   = req;
+    o["reuses"]     = reuse;
+    o["bytesRx"]    = rx;
+    o["bytesTx"]    = tx;
+  }
+  JsonArray nc = net.createNestedArray("clients");
+  for (int i = 0; i < g_netClientCount; i++) {
+    const NetClientBase* c = g_netClients[i];
+    JsonObject o = nc.createNestedObject();
+    o["label"]      = c->label;
+    o["host"]       = g_netHosts[c->host].name;
+    o["connects"]   = c->st.connects;
+    o["fails"]      = c->st.connectFails;
+    o["requests"]   = c->st.requests;
+    o["reuses"]     = c->st.reuses;
+    o["idleCloses"] = c->st.idleCloses;
+    o["lastConnMs"] = c->st.lastConnMs;
+    if (c->st.connects) o["avgConnMs"] = c->st.connMsTotal / c->st.connects;
+    o["bytesRx"]    = c->st.bytesRx;
+    o["bytesTx"]    = c->st.bytesTx;
+  }
+
+  // ── Ezan API indirme (akış ayrıştırıcı) ──
+  JsonObject ez = doc.createNestedObject("ezanFetch");
+  ez["fetches"] = g_ezStats.fetches;
+  ez["fails"]   = g_ezStats.fails;
+  ez["code"]    = g_ezStats.lastCode;
+  ez["bytes"]   = g_ezStats.lastBytes;
+  ez["records"] = g_ezStats.lastRecords;
+  ez["days"]    = g_ezStats.lastDays;
+  ez["ms"]      = g_ezStats.lastMs;
+  if (g_ezStats.fetches) ez["heapMin"] = g_ezStats.lastHeapMin;
+
+  // ── Çevrimdışı Hicri takvim ──
+  JsonObject hc = doc.createNestedObject("hijriCal");
+  hc["offset"]  = (int)g_hijriCalOff;
+  hc["agree"]   = g_hijriCalAgree;
+  hc["samples"] = g_hijriCalSamples;
+
+  // ── Çevrimdışı vakit hesabı ──
+  JsonObject ast = doc.createNestedObject("astro");
+  ast["enabled"] = prayerCoordValid(g_latE6, g_lonE6);
+  ast["apiDays"] = (int)g_dayApiCount;
+  ast["days"]    = (int)(g_dayCount - g_dayApiCount);
+  if (g_dayCount > g_dayApiCount) ast["fromYmd"] = (uint32_t)g_days[g_dayApiCount].ymd;
+
   // ── NVS İstatistikleri ──
   nvs_stats_t nvsStats;
   if (nvs_get_stats(NULL, &nvsStats) == ESP_OK) {
@@ -4250,45 +6644,50 @@ static void webHandleSystem() {
     nvs["nsCount"]      = (int)nvsStats.namespace_count;
   }
 
-  String out;
-  serializeJson(doc, out);
-  g_web->send(200, "application/json", out);
+  webSerializeDoc(doc, out, cbor);
+}
+
+static void webHandleSystem() {
+  if (!webRequireAuth()) return;
+  webSendSnap(g_snapSystem, webBuildSystem);
 }
 
 static void webSetup() {
-  // WebServer port'u runtime (NVS) ile değiştirilebilsin diye pointer kullandık.
+  // Port runtime (NVS) ile değiştirilebilsin diye pointer kullandık.
   if (g_web) { delete g_web; g_web = nullptr; }
-  g_web = new WebServer((int)g_httpPort);
+  g_web = new WebSrv(g_httpPort);
 
-  const char* hdrs[] = {"X-API-KEY", "X-Board-Type", "X-Firmware-Ver"};
-  g_web->collectHeaders(hdrs, 3);
+  const char* hdrs[] = {"X-API-KEY", "X-Board-Type", "X-Firmware-Ver", "If-None-Match", "Accept"};
+  g_web->collectHeaders(hdrs, 5);
 
-  g_web->on("/", HTTP_GET, webHandleRoot);
-  g_web->on("/admin", HTTP_GET, webHandleAdmin);
+  // Panel: / , /admin, /s/app.<hash>.css|js
+  for (int i = 0; i < WEB_ASSET_COUNT; i++) g_web->on(WEB_ASSETS[i].path, HTTPM_GET, webHandleAsset);
 
-  g_web->on("/api/public", HTTP_GET, webHandlePublic);
-  g_web->on("/api/authcheck", HTTP_GET, webHandleAuthCheck);
+  g_web->on("/api/public", HTTPM_GET, webHandlePublic);
+  g_web->on("/api/live", HTTPM_GET, webHandleLive);
+  g_web->on("/api/events", HTTPM_GET, webHandleEvents);
+  g_web->on("/api/authcheck", HTTPM_GET, webHandleAuthCheck);
 
-  g_web->on("/api/settings", HTTP_GET, webHandleGetSettings);
-  g_web->on("/api/settings", HTTP_POST, webHandlePostSettings);
+  g_web->on("/api/settings", HTTPM_GET, webHandleGetSettings);
+  g_web->on("/api/settings", HTTPM_POST, webHandlePostSettings);
 
-  g_web->on("/api/dinigunler", HTTP_GET, webHandleGetDiniGunler);
+  g_web->on("/api/dinigunler", HTTPM_GET, webHandleGetDiniGunler);
 
-  g_web->on("/api/admincfg", HTTP_GET, webHandleGetAdminCfg);
-  g_web->on("/api/admincfg", HTTP_POST, webHandlePostAdminCfg);
+  g_web->on("/api/admincfg", HTTPM_GET, webHandleGetAdminCfg);
+  g_web->on("/api/admincfg", HTTPM_POST, webHandlePostAdminCfg);
 
-  g_web->on("/api/action", HTTP_POST, webHandlePostAction);
+  g_web->on("/api/action", HTTPM_POST, webHandlePostAction);
 
-  g_web->on("/api/factory_reset", HTTP_POST, webHandlePostFactoryReset);
+  g_web->on("/api/factory_reset", HTTPM_POST, webHandlePostFactoryReset);
 
-  g_web->on("/api/system", HTTP_GET, webHandleSystem);
-  g_web->on("/api/logs", HTTP_GET, webHandleLogs);
-  g_web->on("/api/wifiscan", HTTP_GET, webHandleWifiScan);
-  g_web->on("/api/wifitest", HTTP_POST, webHandleWifiTest);
-  g_web->on("/api/wifistatus", HTTP_GET, webHandleWifiStatus);
+  g_web->on("/api/system", HTTPM_GET, webHandleSystem);
+  g_web->on("/api/logs", HTTPM_GET, webHandleLogs);
+  g_web->on("/api/wifiscan", HTTPM_GET, webHandleWifiScan);
+  g_web->on("/api/wifitest", HTTPM_POST, webHandleWifiTest);
+  g_web->on("/api/wifistatus", HTTPM_GET, webHandleWifiStatus);
 
   // Web OTA upload
-  g_web->on("/update", HTTP_POST, webHandleOtaFinish, webHandleOtaUpload);
+  g_web->on("/update", HTTPM_POST, webHandleOtaFinish, webHandleOtaUpload);
 
   g_web->onNotFound([]() {
     g_web->send(404, "text/plain", "Not found");
@@ -4351,6 +6750,9 @@ void setup() {
   logLoadFromNvs(NVS_KEY_ULOG_BLOB, NVS_KEY_ULOG_META, g_userLog, g_userLogIdx, g_userLogCnt);
   logLoadFromNvs(NVS_KEY_SLOG_BLOB, NVS_KEY_SLOG_META, g_sysLog, g_sysLogIdx, g_sysLogCnt);
 
+  // Telegram outbox (SPIFFS): önceki açılıştan kalan bildirimler
+  outboxInit();
+
   // Ağ/İlçe ayarları (NVS)
   loadNetFromNvs();
   loadHttpPortFromNvs();
@@ -4371,6 +6773,8 @@ void setup() {
   g_hnyMon = prefs.getUChar(NVS_KEY_HNY_MON, 0);
   g_autoHicriYear = prefs.getBool(NVS_KEY_AUTO_HYR, false);
   g_hnyLastYear = prefs.getUShort(NVS_KEY_HNY_LAST, 0);
+  g_hijriCalOff = prefs.getChar(NVS_KEY_HCAL_OFF, 0);
+  if (g_hijriCalOff < -HIJRI_CAL_OFF_MAX || g_hijriCalOff > HIJRI_CAL_OFF_MAX) g_hijriCalOff = 0;
   if (g_hnyDay < 1 || g_hnyDay > 30) g_hnyDay = 1;
   if (g_hnyMon > 11) g_hnyMon = 0;  // Panelin hedef sohbetini (aktif chat) NVS'ten yükle
   loadActiveChatFromNvs();
@@ -4411,7 +6815,14 @@ void setup() {
   esp_task_wdt_add(NULL);
   Serial.println("[BOOT] Watchdog 30sn aktif");
 
-  configTime(3 * 3600, 0, "pool.ntp.org", "time.google.com");
+  // Röle görevi (kendi TWDT aboneliği ile)
+  relayTaskStart();
+
+  // Telegram alım (long polling) + gönderim (outbox) görevleri, ağ çekirdeği
+  tgRxTaskStart();
+  tgTxTaskStart();
+
+  configTime(LOCAL_UTC_OFFSET_SEC, 0, "pool.ntp.org", "time.google.com");
 
   // Boot log
   {
@@ -4427,8 +6838,6 @@ void setup() {
   // Not: Boot'ta uzun beklemeler (WiFi/NTP bekleme + vakit indirme) Telegram komutlarına geç tepkiye neden oluyordu.
   // Artık setup'ta beklemiyoruz; loop içinde arka planda tamamlanacak.
 
-  applyRelayLogic();
-
   // Her reboot'ta otomatik menü
   g_autoMenuPending = true;
 }
@@ -4440,13 +6849,13 @@ void loop() {
   g_loopCount++;
 
   wifiKeepAlive();
-  if (g_web) g_web->handleClient();
+  if (g_web) g_web->poll();
 
   // Planlı restart (örn. statik IP değişimi)
   if (millisPassed(g_restartAtMs)) {
     Serial.print("[RESTART] ");
     Serial.println(g_restartWhy);
-    delay(150);
+    outboxFlush(3000);
     ESP.restart();
   }
 
@@ -4455,7 +6864,8 @@ void loop() {
 
   // Web OTA upload sırasında diğer işleri durdur (stabilite için)
   if (g_webOtaInProgress) {
-    delay(10);
+    if (g_web) g_web->wait(10);   // sıradaki parça gelince hemen dön
+    else delay(10);
     return;
   }
 
@@ -4472,48 +6882,23 @@ void loop() {
   weeklyRestartTick();
   wifiTestTick();
 
-  if (isTimeValid()) {
-    time_t now = time(nullptr);
-
-    if (g_thuOffTs == 0 || now >= g_thuOffTs) {
-      time_t on2=0, off2=0;
-      if (!computeThuFriWindowForNow(now, on2, off2)) {
-        ensureTodayInCache();
-        (void)computeThuFriWindowForNow(now, on2, off2);
-      }
-      if (on2 && off2) { g_thuOnTs = on2; g_thuOffTs = off2; }
-    }
-
-    if (g_spOffTs == 0 || now >= g_spOffTs) {
-      ensureTodayInCache();
-      computeNextSpecial(now);
-    }
-
-    if (g_nextImsakOffTs == 0 || now >= (g_nextImsakOffTs + 5)) {
-      time_t noff=0;
-      if (!computeNextImsakOff(now, noff)) {
-        ensureTodayInCache();
-        (void)computeNextImsakOff(now, noff);
-      }
-      if (noff) g_nextImsakOffTs = noff;
-    }
-  }
+  if (isTimeValid()) schedTick(time(nullptr));
 
   specialNotifyTick();
-  enforceImsakOffIfDue();
-  applyRelayLogic();
+  relayInlineTick();  // yalnızca röle görevi kurulamadıysa
+  relayEventsTick();  // röle kararı ayrı görevde; burada sadece log/bildirim
+  webEventsTick();    // panel akışına değişen durum
 
   // Heap durumu izleme (5dk arayla serial log)
   // Hicri yıl otomatik güncelleme (saatlik kontrol)
   {
     static uint32_t _hnyMs = 0;
-    if (g_autoHicriYear && isTimeValid() && g_dayCount > 0 && millis() - _hnyMs > 3600000UL) {
+    if (g_autoHicriYear && isTimeValid() && millis() - _hnyMs > 3600000UL) {
       _hnyMs = millis();
-      int ti = findIdx(ymdToday());
-      if (ti >= 0) {
-        int hd=0, hy=0; String hm;
-        if (parseHicri(g_days[ti].hicriUzun, hd, hm, hy)) {
-          int mi = monthIndexFromKey(hm);
+      // Cache bugünü içermese de çevrimdışı takvimle devam eder
+      int hd = 0, mi = 0, hy = 0;
+      if (hijriForYmd(ymdToday(), hd, mi, hy)) {
+        if (hd > 0) {
           bool pastNY = (mi > (int)g_hnyMon) || (mi == (int)g_hnyMon && hd >= (int)g_hnyDay);
           if (pastNY && hy > 0 && (uint16_t)hy != g_hnyLastYear) {
             for (uint8_t si = 0; si < SPECIAL_COUNT; si++) {
@@ -4524,7 +6909,7 @@ void loop() {
             saveSpecialOverrideToNvs();
             g_hnyLastYear = (uint16_t)hy;
             prefs.putUShort(NVS_KEY_HNY_LAST, g_hnyLastYear);
-            recomputeAllSchedules();
+            schedRecompute(SD_SPECIAL);
             logSys("Hicri yil guncellendi: " + String(hy));
           }
         }
@@ -4558,6 +6943,7 @@ void loop() {
   }
 
   uint32_t _delayStart = micros();
-  delay(50);
+  if (g_web) g_web->wait(50);   // web isteği gelirse erken uyan
+  else delay(50);
   g_cpuDelayUs += (micros() - _delayStart);
 }
\ No newline at end of file
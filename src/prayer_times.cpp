@@ -0,0 +1,97 @@
+/*
+  src/prayer_times.cpp - Çevrimdışı imsak / akşam hesabı
+  Bkz. include/prayer_times.h
+*/
+
+#include "prayer_times.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "hijri_calendar.h"
+
+static const double PT_DEG = 3.14159265358979323846 / 180.0;
+
+static double ptFix(double a, double b) {
+  a = a - b * floor(a / b);
+  return (a < 0) ? a + b : a;
+}
+
+// t: gün içi UT saat. declOut derece, eqtOut saat (zaman denklemi)
+static void ptSun(int32_t days, double t, double& declOut, double& eqtOut) {
+  double D = (double)days + 2440587.5 + t / 24.0 - 2451545.0;
+  double g = ptFix(357.529 + 0.98560028 * D, 360.0);
+  double q = ptFix(280.459 + 0.98564736 * D, 360.0);
+  double L = ptFix(q + 1.915 * sin(g * PT_DEG) + 0.020 * sin(2.0 * g * PT_DEG), 360.0);
+  double e = 23.439 - 0.00000036 * D;
+
+  double ra = atan2(cos(e * PT_DEG) * sin(L * PT_DEG), cos(L * PT_DEG)) / PT_DEG / 15.0;
+  double eqt = q / 15.0 - ptFix(ra, 24.0);
+  if (eqt > 12.0)  eqt -= 24.0;
+  if (eqt < -12.0) eqt += 24.0;
+
+  declOut = asin(sin(e * PT_DEG) * sin(L * PT_DEG)) / PT_DEG;
+  eqtOut  = eqt;
+}
+
+// Güneşin ufkun 'angle' derece altına indiği an (UT saat). ccw: öğleden önce (imsak)
+static bool ptAngleTime(int32_t days, double lat, double lon, double angle, bool ccw, double& tOut) {
+  double t = 12.0 - lon / 15.0 + (ccw ? -6.0 : 6.0);
+  for (int it = 0; it < 3; it++) {
+    double decl = 0, eqt = 0;
+    ptSun(days, t, decl, eqt);
+    double noon = 12.0 - eqt - lon / 15.0;
+    double c = (-sin(angle * PT_DEG) - sin(lat * PT_DEG) * sin(decl * PT_DEG)) /
+               (cos(lat * PT_DEG) * cos(decl * PT_DEG));
+    if (c < -1.0 || c > 1.0) return false;
+    double h = acos(c) / PT_DEG / 15.0;
+    t = ccw ? noon - h : noon + h;
+  }
+  tOut = t;
+  return true;
+}
+
+static int ptLocalMin(double tUt, int temkinMin, bool roundUp) {
+  double m = tUt * 60.0 + (double)(LOCAL_UTC_OFFSET_SEC / 60) + (double)temkinMin;
+  int v = roundUp ? (int)ceil(m - 1e-9) : (int)floor(m + 1e-9);
+  return (int)ptFix((double)v, 1440.0);
+}
+
+bool prayerCoordValid(int32_t latE6, int32_t lonE6) {
+  if (latE6 == 0 && lonE6 == 0) return false;  // ayarlanmamış
+  return latE6 >= -PT_COORD_E6_MAX_LAT && latE6 <= PT_COORD_E6_MAX_LAT &&
+         lonE6 >= -PT_COORD_E6_MAX_LON && lonE6 <= PT_COORD_E6_MAX_LON;
+}
+
+bool prayerCalcDay(int32_t days, int32_t latE6, int32_t lonE6, uint16_t& imsakMinOut, uint16_t& aksamMinOut) {
+  if (!prayerCoordValid(latE6, lonE6)) return false;
+  double lat = (double)latE6 / 1e6;
+  double lon = (double)lonE6 / 1e6;
+
+  double tImsak = 0, tAksam = 0;
+  if (!ptAngleTime(days, lat, lon, PT_IMSAK_ANGLE, true, tImsak)) return false;
+  if (!ptAngleTime(days, lat, lon, PT_AKSAM_ANGLE, false, tAksam)) return false;
+
+  imsakMinOut = (uint16_t)ptLocalMin(tImsak, PT_IMSAK_TEMKIN_MIN, false);
+  aksamMinOut = (uint16_t)ptLocalMin(tAksam, PT_AKSAM_TEMKIN_MIN, true);
+  return true;
+}
+
+bool prayerFillDay(DayTimes& d, int32_t days, int32_t latE6, int32_t lonE6, int8_t hijriCalOff) {
+  uint16_t im = 0, ak = 0;
+  if (!prayerCalcDay(days, latE6, lonE6, im, ak)) return false;
+
+  int hy = 0, hm = 0, hd = 0;
+  hijriFromDays(days - hijriCalOff, hy, hm, hd);
+
+  memset(&d, 0, sizeof(d));
+  d.ymd      = ymdFromDays(days);
+  d.imsakMin = im;
+  d.aksamMin = ak;
+  d.hDay     = (uint8_t)hd;
+  d.hMon     = (int8_t)hm;
+  d.hYear    = (uint16_t)hy;
+  snprintf(d.hicriUzun, sizeof(d.hicriUzun), "%d %s %d", hd, hijriMonthName(hm), hy);
+  return true;
+}
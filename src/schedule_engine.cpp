@@ -0,0 +1,579 @@
+/*
+  src/schedule_engine.cpp - Çizelge motoru (Arduino bağımsız)
+  Bkz. include/schedule_engine.h
+*/
+
+#include "schedule_engine.h"
+
+#include <string.h>
+#include <stdlib.h>
+#include <ctype.h>
+
+// =====================
+// Tarih/saat yardımcı
+// =====================
+uint32_t ymdFromTm(const tm& t) {
+  return (uint32_t)(t.tm_year + 1900) * 10000u + (uint32_t)(t.tm_mon + 1) * 100u + (uint32_t)t.tm_mday;
+}
+
+// Sabit UTC+3: mktime/localtime_r yerine tamsayı takvim (include/civil_time.h)
+time_t epochFromYmdAndMin(uint32_t ymd, uint16_t minutesFromMidnight) {
+  return epochFromLocalDays(daysFromYmd(ymd), (int32_t)minutesFromMidnight * 60);
+}
+
+uint32_t addDaysYmd(uint32_t ymd, int deltaDays) {
+  return ymdFromDays(daysFromYmd(ymd) + deltaDays);
+}
+
+int weekdayOfYmd(uint32_t ymd) {
+  return weekdayFromDays(daysFromYmd(ymd));
+}
+
+// =====================
+// Hicri parse + normalize month
+// =====================
+static const char* const HICRI_MONTH_KEYS[12] = {
+  "muharrem", "safer", "rebiulevvel", "rebiulahir", "cemaziyelevvel", "cemaziyelahir",
+  "receb", "saban", "ramazan", "sevval", "zilkade", "zilhicce",
+};
+
+// Türkçe harfleri ASCII'ye indir (UTF-8 iki bayt) - main.cpp normMonthKey ile aynı kurallar
+static char foldTr(uint8_t lead, uint8_t trail) {
+  if (lead == 0xC3) {
+    switch (trail) {
+      case 0x87: case 0xA7: return 'c';  // Ç ç
+      case 0x96: case 0xB6: return 'o';  // Ö ö
+      case 0x9C: case 0xBC: return 'u';  // Ü ü
+    }
+  } else if (lead == 0xC4) {
+    switch (trail) {
+      case 0x9E: case 0x9F: return 'g';  // Ğ ğ
+      case 0xB0: case 0xB1: return 'i';  // İ ı
+    }
+  } else if (lead == 0xC5) {
+    switch (trail) {
+      case 0x9E: case 0x9F: return 's';  // Ş ş
+    }
+  }
+  return 0;
+}
+
+int hicriMonthIndex(const char* name, size_t len) {
+  if (!name) return -1;
+  while (len > 0 && isspace((uint8_t)*name)) { name++; len--; }
+  while (len > 0 && isspace((uint8_t)name[len - 1])) len--;
+
+  char key[24];
+  size_t k = 0;
+  for (size_t i = 0; i < len; i++) {
+    if (k >= sizeof(key) - 1) return -1;
+    uint8_t c = (uint8_t)name[i];
+    if (c >= 0x80 && i + 1 < len) {
+      char f = foldTr(c, (uint8_t)name[i + 1]);
+      if (f) { key[k++] = f; i++; continue; }
+    }
+    key[k++] = (char)tolower(c);
+  }
+  key[k] = '\0';
+
+  if (strcmp(key, "recep") == 0)        return 6;
+  if (strcmp(key, "rebiyulevvel") == 0) return 2;
+  for (int m = 0; m < 12; m++) {
+    if (strcmp(key, HICRI_MONTH_KEYS[m]) == 0) return m;
+  }
+  return -1;
+}
+
+bool parseHicriFields(const char* s, int& dayOut, int& monIdxOut, int& yearOut) {
+  if (!s || !*s) return false;
+
+  const char* b = s;
+  const char* e = s + strlen(s);
+  while (b < e && isspace((uint8_t)*b)) b++;
+  while (e > b && isspace((uint8_t)e[-1])) e--;
+
+  const char* firstSp = nullptr;
+  const char* lastSp  = nullptr;
+  for (const char* p = b; p < e; p++) {
+    if (*p != ' ') continue;
+    if (!firstSp) firstSp = p;
+    lastSp = p;
+  }
+  if (!firstSp || lastSp <= firstSp) return false;
+
+  dayOut  = atoi(b);
+  yearOut = atoi(lastSp + 1);
+
+  const char* mb = firstSp + 1;
+  const char* me = lastSp;
+  while (mb < me && isspace((uint8_t)*mb)) mb++;
+  while (me > mb && isspace((uint8_t)me[-1])) me--;
+
+  if (dayOut <= 0 || dayOut > 30) return false;
+  if (me == mb) return false;
+  if (yearOut <= 0) yearOut = 0;
+
+  monIdxOut = hicriMonthIndex(mb, (size_t)(me - mb));
+  return true;
+}
+
+void dayTimesSetHicri(DayTimes& d, const char* hicriUzun) {
+  memset(d.hicriUzun, 0, sizeof(d.hicriUzun));
+  if (hicriUzun) strncpy(d.hicriUzun, hicriUzun, sizeof(d.hicriUzun) - 1);
+
+  int hd = 0, hm = -1, hy = 0;
+  if (parseHicriFields(d.hicriUzun, hd, hm, hy)) {
+    d.hDay  = (uint8_t)hd;
+    d.hMon  = (int8_t)hm;
+    d.hYear = (uint16_t)hy;
+  } else {
+    d.hDay = 0; d.hMon = -1; d.hYear = 0;
+  }
+}
+
+// =====================
+// Gün indeksi
+// =====================
+void schedDayIndexBuild(const DayTimes* days, uint16_t n, SchedDayIndex& out) {
+  out.firstDay   = (n > 0) ? daysFromYmd(days[0].ymd) : 0;
+  out.count      = n;
+  out.contiguous = 1;
+  for (uint16_t i = 1; i < n; i++) {
+    if (days[i].ymd != ymdFromDays(out.firstDay + (int32_t)i)) { out.contiguous = 0; break; }
+  }
+}
+
+int schedDayIndexFind(const SchedDayIndex& ix, const DayTimes* days, uint16_t n, uint32_t ymd) {
+  if (n == 0) return -1;
+  if (ix.contiguous && ix.count == n) {
+    int32_t off = daysFromYmd(ymd) - ix.firstDay;
+    if (off < 0 || off >= (int32_t)n) return -1;
+    return (days[off].ymd == ymd) ? (int)off : -1;
+  }
+
+  // Boşluklu cache: ilk ymd >= aranan
+  int lo = 0, hi = (int)n;
+  while (lo < hi) {
+    int mid = (lo + hi) / 2;
+    if (days[mid].ymd < ymd) lo = mid + 1;
+    else hi = mid;
+  }
+  return (lo < (int)n && days[lo].ymd == ymd) ? lo : -1;
+}
+
+static int cmpDayYmd(const void* a, const void* b) {
+  uint32_t x = ((const DayTimes*)a)->ymd;
+  uint32_t y = ((const DayTimes*)b)->ymd;
+  return (x < y) ? -1 : (x > y) ? 1 : 0;
+}
+
+void schedSortDays(DayTimes* days, uint16_t n) {
+  if (n < 2) return;
+  qsort(days, n, sizeof(DayTimes), cmpDayYmd);
+}
+
+// =====================
+// Pencere hesapları
+// =====================
+int schedFindIdx(const SchedInput& in, uint32_t ymd) {
+  if (in.dayIdx) return schedDayIndexFind(*in.dayIdx, in.days, in.dayCount, ymd);
+  for (uint16_t i = 0; i < in.dayCount; i++) if (in.days[i].ymd == ymd) return (int)i;
+  return -1;
+}
+
+static inline bool spEnabled(const SchedInput& in, uint8_t idx) {
+  return ((in.spEnableMask >> idx) & 1u) != 0;
+}
+
+bool schedSpecialRule(const SchedInput& in, uint8_t spIdx, int& dayOut, int& monIdxOut, int& yearOut) {
+  if (spIdx >= SPECIAL_COUNT) return false;
+
+  const SpecialDef& sp = g_specials[spIdx];
+  const SpOverride& ov = in.spOv[spIdx];
+  bool useDef = (ov.useDefault != 0);
+
+  dayOut    = useDef ? (int)sp.day : (int)ov.day;
+  monIdxOut = useDef ? hicriMonthIndex(sp.monthKey, strlen(sp.monthKey)) : (ov.month <= 11 ? (int)ov.month : 8);
+  yearOut   = useDef ? 0 : (int)ov.year;
+  return true;
+}
+
+int schedFindSpecialIdx(const SchedInput& in, uint8_t spIdx) {
+  int ruleDay = 0, ruleMon = -1, ruleYear = 0;
+  if (!schedSpecialRule(in, spIdx, ruleDay, ruleMon, ruleYear)) return -1;
+
+  for (uint16_t i = 0; i < in.dayCount; i++) {
+    const DayTimes& d = in.days[i];
+    if (d.hDay == 0) continue;
+
+    if (d.hDay == ruleDay && d.hMon == ruleMon) {
+      // Custom seçildiyse yıl da eşleşsin (API yıl vermezse ay+gün ile kabul)
+      if (ruleYear != 0) {
+        if (d.hYear != 0 && d.hYear != ruleYear) continue;
+      }
+      return (int)i;
+    }
+  }
+  return -1;
+}
+
+bool computeWindowForSpecial(const SchedInput& in, uint8_t spIdx, time_t& onTs, time_t& offTs, uint32_t& ymdEvent) {
+  if (in.dayCount == 0) return false;
+
+  int foundIdx = schedFindSpecialIdx(in, spIdx);
+  if (foundIdx < 0) return false;
+
+  ymdEvent = in.days[foundIdx].ymd;
+  return buildWindowForEventIdx(in, foundIdx, onTs, offTs);
+}
+
+bool buildWindowForEventIdx(const SchedInput& in, int idxEvent, time_t& onTs, time_t& offTs) {
+  if (idxEvent < 0 || idxEvent >= (int)in.dayCount) return false;
+  uint32_t ymdEvent = in.days[idxEvent].ymd;
+  uint32_t ymdPrev  = addDaysYmd(ymdEvent, -1);
+
+  int ip = schedFindIdx(in, ymdPrev);
+  if (ip < 0) return false;
+
+  onTs  = epochFromYmdAndMin(ymdPrev,  in.days[ip].aksamMin) + (time_t)in.onOffsetSec;
+  offTs = epochFromYmdAndMin(ymdEvent, in.days[idxEvent].imsakMin) - (time_t)in.offOffsetSec;
+
+  return (offTs > onTs);
+}
+
+bool isRamazanIdx(const SchedInput& in, int idx, int& dayNoOut) {
+  dayNoOut = 0;
+  if (idx < 0 || idx >= (int)in.dayCount) return false;
+
+  const DayTimes& d = in.days[idx];
+  if (d.hDay == 0) return false;
+
+  if (d.hMon == 8) { // ramazan
+    dayNoOut = d.hDay;
+    return (d.hDay >= 1 && d.hDay <= 30);
+  }
+  return false;
+}
+
+// =====================
+// Timeline
+// =====================
+struct TlBuf {
+  SchedTransition* out;
+  uint16_t cap;
+  uint16_t n;
+  bool     full;  // en az bir kenar sığmadı
+};
+
+static void tlPush(TlBuf& b, time_t ts, time_t peer, uint32_t ymd, uint8_t on, uint8_t reason, uint8_t arg, uint8_t rule) {
+  if (b.n >= b.cap) { b.full = true; return; }
+  SchedTransition& t = b.out[b.n++];
+  t.ts = ts; t.peer = peer; t.ymd = ymd; t.on = on; t.reason = reason; t.arg = arg; t.rule = rule;
+}
+
+// ON/OFF çifti birlikte: yarım pencere (OFF'suz ON) timeline'a girmez
+static void tlPushWindow(TlBuf& b, time_t onTs, time_t offTs, uint32_t ymd, uint8_t reason, uint8_t arg, uint8_t rule) {
+  if (b.n + 2 > b.cap) { b.full = true; return; }
+  tlPush(b, onTs,  offTs, ymd, 1, reason, arg, rule);
+  tlPush(b, offTs, onTs,  ymd, 0, reason, arg, rule);
+}
+
+// Aynı anda düşen kenarlarda özel gün Ramazan gününden önce gelsin (Kadir Gecesi adı korunur)
+static bool tlLess(const SchedTransition& a, const SchedTransition& b) {
+  if (a.ts != b.ts) return a.ts < b.ts;
+  return a.reason < b.reason;
+}
+
+// =====================
+// Kural tablosu
+// =====================
+static SchedRule ruleBase(uint8_t kind, uint8_t reason, uint8_t arg) {
+  SchedRule r{};
+  r.kind = kind; r.reason = reason; r.arg = arg; r.hMon = -1;
+  r.onTolSec = SCHED_TOL_INHERIT; r.offTolSec = SCHED_TOL_INHERIT;
+  return r;
+}
+
+int schedDefaultRules(const SchedInput& in, SchedRule* out, int cap) {
+  int n = 0;
+  if (n < cap) out[n++] = ruleBase(RK_FORCE_OFF, SR_IMSAK_OFF, 0);
+
+  if (n < cap) {
+    SchedRule r = ruleBase(RK_WEEKDAY, SR_THU_FRI, 0);
+    r.wdayMask = (uint8_t)(1u << 5);  // Cuma: Perşembe akşamı -> Cuma imsak
+    out[n++] = r;
+  }
+
+  for (uint8_t k = 0; k < SPECIAL_COUNT && n < cap; k++) {
+    if (!spEnabled(in, k)) continue;
+    int d = 0, m = -1, y = 0;
+    if (!schedSpecialRule(in, k, d, m, y)) continue;
+    SchedRule r = ruleBase(RK_HIJRI_DAY, SR_SPECIAL, k);
+    r.hDay = (uint8_t)d; r.hMon = (int8_t)m; r.hYear = (uint16_t)y;
+    out[n++] = r;
+  }
+
+  if (in.ramazanAll && n < cap) {
+    SchedRule r = ruleBase(RK_HIJRI_MON, SR_RAMAZAN, 0);
+    r.hMon = 8;
+    out[n++] = r;
+  }
+  return n;
+}
+
+bool schedRuleMatchesDay(const SchedRule& r, const DayTimes& d) {
+  switch (r.kind) {
+    case RK_WEEKDAY:
+      return ((r.wdayMask >> weekdayOfYmd(d.ymd)) & 1u) != 0;
+    case RK_HIJRI_DAY:
+      if (d.hDay == 0 || d.hDay != r.hDay || d.hMon != r.hMon) return false;
+      return r.hYear == 0 || d.hYear == 0 || d.hYear == r.hYear;
+    case RK_HIJRI_MON:
+      return d.hDay >= 1 && d.hDay <= 30 && d.hMon == r.hMon;
+    case RK_DATE_RANGE:
+      return d.ymd >= r.fromYmd && d.ymd <= r.toYmd;
+    default:
+      return false;  // RK_FORCE_OFF pencere üretmez
+  }
+}
+
+void schedRuleDayMasks(const SchedInput& in, const SchedRule* rules, int nRules, uint32_t* masks) {
+  if (nRules > SCHED_RULE_MAX) nRules = SCHED_RULE_MAX;
+  for (uint16_t i = 0; i < in.dayCount; i++) {
+    uint32_t m = 0;
+    for (int r = 0; r < nRules; r++) {
+      if (schedRuleMatchesDay(rules[r], in.days[i])) m |= (1u << r);
+    }
+    masks[i] = m;
+  }
+}
+
+static time_t ruleOnTol(const SchedInput& in, const SchedRule& r) {
+  return (time_t)(r.onTolSec == SCHED_TOL_INHERIT ? in.onOffsetSec : r.onTolSec);
+}
+static time_t ruleOffTol(const SchedInput& in, const SchedRule& r) {
+  return (time_t)(r.offTolSec == SCHED_TOL_INHERIT ? in.offOffsetSec : r.offTolSec);
+}
+
+uint16_t schedBuildTimeline(const SchedInput& in, const SchedRule* rules, int nRules, const uint32_t* masks,
+                            SchedTransition* out, uint16_t cap, bool* overflow) {
+  TlBuf b{ out, cap, 0, false };
+  if (overflow) *overflow = false;
+  if (in.dayCount == 0) return 0;
+  if (nRules > SCHED_RULE_MAX) nRules = SCHED_RULE_MAX;
+
+  for (uint16_t i = 0; i < in.dayCount; i++) {
+    const DayTimes& d = in.days[i];
+    time_t imsak = epochFromYmdAndMin(d.ymd, d.imsakMin);
+
+    // Zorunlu OFF kuralları: her gün İmsak - tolerans
+    for (int r = 0; r < nRules; r++) {
+      if (rules[r].kind != RK_FORCE_OFF) continue;
+      tlPush(b, imsak - ruleOffTol(in, rules[r]), 0, d.ymd, 0, rules[r].reason, rules[r].arg, (uint8_t)r);
+    }
+
+    uint32_t m = masks[i];
+    if (m == 0) continue;
+
+    // Önceki gün Akşam + tolerans -> bu gün İmsak - tolerans
+    int ip = schedFindIdx(in, addDaysYmd(d.ymd, -1));
+    if (ip < 0) continue;
+    time_t aksamPrev = epochFromYmdAndMin(in.days[ip].ymd, in.days[ip].aksamMin);
+
+    for (int r = 0; r < nRules; r++) {
+      if ((m & (1u << r)) == 0) continue;
+      const SchedRule& rule = rules[r];
+      time_t on  = aksamPrev + ruleOnTol(in, rule);
+      time_t off = imsak - ruleOffTol(in, rule);
+      if (off <= on) continue;
+      uint8_t arg = (rule.kind == RK_HIJRI_MON) ? d.hDay : rule.arg;
+      tlPushWindow(b, on, off, d.ymd, rule.reason, arg, (uint8_t)r);
+    }
+  }
+
+  // Kararlı insertion sort (kenar sayısı küçük, bir kez çalışır)
+  for (int i = 1; i < (int)b.n; i++) {
+    SchedTransition cur = out[i];
+    int j = i - 1;
+    while (j >= 0 && tlLess(cur, out[j])) { out[j + 1] = out[j]; j--; }
+    out[j + 1] = cur;
+  }
+  if (overflow) *overflow = b.full;
+  return b.n;
+}
+
+// =====================
+// Birleşik ON aralıkları
+// =====================
+uint16_t schedBuildIntervals(const SchedTransition* tl, uint16_t tlN, SchedInterval* out, uint16_t cap,
+                             bool* overflow) {
+  uint16_t n = 0;
+  if (overflow) *overflow = false;
+  // tl ts'e göre sıralı: ON kenarları başlangıca göre sıralı gelir
+  for (uint16_t i = 0; i < tlN; i++) {
+    const SchedTransition& t = tl[i];
+    if (t.reason == SR_IMSAK_OFF) {
+      // Zorunlu OFF açık aralığı keser (pencere imsak - tolerans'tan sonra bitiyorsa)
+      if (n > 0 && out[n - 1].on < t.ts && t.ts < out[n - 1].off) out[n - 1].off = t.ts;
+      continue;
+    }
+    if (t.on == 0) continue;
+
+    uint32_t bit = (t.rule < 32) ? (1u << t.rule) : 0;
+    if (n > 0 && t.ts <= out[n - 1].off) {
+      if (t.peer > out[n - 1].off) out[n - 1].off = t.peer;
+      out[n - 1].rules |= bit;
+      continue;
+    }
+    if (n >= cap) {
+      if (overflow) *overflow = true;
+      break;
+    }
+    out[n].on = t.ts; out[n].off = t.peer; out[n].rules = bit;
+    n++;
+  }
+  return n;
+}
+
+int schedIntervalAt(const SchedInterval* iv, uint16_t n, time_t now) {
+  // on <= now olan son aralık
+  int lo = 0, hi = (int)n;
+  while (lo < hi) {
+    int mid = (lo + hi) / 2;
+    if (iv[mid].on <= now) lo = mid + 1;
+    else hi = mid;
+  }
+  int i = lo - 1;
+  return (i >= 0 && now < iv[i].off) ? i : -1;
+}
+
+int schedUpperBound(const SchedTransition* tl, uint16_t n, time_t now) {
+  int lo = 0, hi = (int)n;
+  while (lo < hi) {
+    int mid = (lo + hi) / 2;
+    if (tl[mid].ts <= now) lo = mid + 1;
+    else hi = mid;
+  }
+  return lo;
+}
+
+int schedFindWindowEnd(const SchedTransition* tl, uint16_t n, time_t now, uint8_t reasonMask) {
+  for (int i = schedUpperBound(tl, n, now); i < (int)n; i++) {
+    const SchedTransition& t = tl[i];
+    if (t.on == 0 && ((1u << t.reason) & reasonMask)) return i;
+  }
+  return -1;
+}
+
+// =====================
+// Röle karar adımları
+// =====================
+uint8_t schedImsakOffStep(time_t nextOffTs, time_t lastEventTs, time_t now) {
+  if (nextOffTs == 0) return SIS_IDLE;
+  if (nextOffTs < now - SCHED_IMSAK_STALE_SEC) return SIS_REFRESH;
+  if (now > nextOffTs + SCHED_IMSAK_FIRE_WIN) return SIS_REFRESH;
+  if (now >= nextOffTs && lastEventTs != nextOffTs) return SIS_FIRE;
+  return SIS_IDLE;
+}
+
+bool schedRelayShouldOn(bool scheduledOn, bool manualOnLatched, time_t manualOffUntilTs,
+                        time_t blockOnUntilTs, bool hasTime, time_t now) {
+  bool on = (hasTime && scheduledOn) || manualOnLatched;
+  if (hasTime && manualOffUntilTs != 0 && now < manualOffUntilTs) on = false;
+  if (hasTime && blockOnUntilTs != 0 && now < blockOnUntilTs)     on = false;
+  return on;
+}
+
+// =====================
+// Timeline'sız doğrudan hesaplar
+// =====================
+bool schedThuFriWindowScan(const SchedInput& in, time_t now, time_t& onTs, time_t& offTs) {
+  if (in.dayCount == 0) return false;
+
+  const int THU = 4;
+  int32_t today = localDaysFromEpoch(now);
+  int deltaToLastThu = (weekdayFromDays(today) - THU + 7) % 7;
+
+  uint32_t ymdThu = ymdFromDays(today - deltaToLastThu);
+  uint32_t ymdFri = addDaysYmd(ymdThu, +1);
+
+  auto build = [&](uint32_t yThu, uint32_t yFri, time_t& a, time_t& b)->bool {
+    int iThu = schedFindIdx(in, yThu);
+    int iFri = schedFindIdx(in, yFri);
+    if (iThu < 0 || iFri < 0) return false;
+
+    a = epochFromYmdAndMin(yThu, in.days[iThu].aksamMin) + (time_t)in.onOffsetSec;
+    b = epochFromYmdAndMin(yFri, in.days[iFri].imsakMin) - (time_t)in.offOffsetSec;
+    return (b > a);
+  };
+
+  if (!build(ymdThu, ymdFri, onTs, offTs)) return false;
+
+  if (now >= offTs) {
+    uint32_t nextThu = addDaysYmd(ymdThu, +7);
+    uint32_t nextFri = addDaysYmd(nextThu, +1);
+    if (!build(nextThu, nextFri, onTs, offTs)) return false;
+  }
+  return true;
+}
+
+bool schedNextImsakOffScan(const SchedInput& in, time_t now, time_t& nextOffTs) {
+  if (in.dayCount == 0) return false;
+
+  uint32_t today = ymdFromEpoch(now);
+
+  int iToday = schedFindIdx(in, today);
+  if (iToday < 0) return false;
+
+  time_t offToday = epochFromYmdAndMin(today, in.days[iToday].imsakMin) - (time_t)in.offOffsetSec;
+  if (now < offToday) { nextOffTs = offToday; return true; }
+
+  uint32_t tomorrow = addDaysYmd(today, +1);
+  int iTom = schedFindIdx(in, tomorrow);
+  if (iTom < 0) return false;
+
+  nextOffTs = epochFromYmdAndMin(tomorrow, in.days[iTom].imsakMin) - (time_t)in.offOffsetSec;
+  return true;
+}
+
+bool schedNextSpecialScan(const SchedInput& in, time_t now, SchedWindow& out) {
+  bool foundActive = false;
+  SchedWindow best{};
+
+  auto consider = [&](time_t on, time_t off, uint32_t ymdEv, uint8_t reason, uint8_t arg) {
+    bool active = (now >= on && now < off);
+    if (active) {
+      if (!foundActive || on < best.on) {
+        foundActive = true;
+        best = SchedWindow{ on, off, ymdEv, reason, arg };
+      }
+    } else if (!foundActive) {
+      if (on > now && (best.on == 0 || on < best.on)) {
+        best = SchedWindow{ on, off, ymdEv, reason, arg };
+      }
+    }
+  };
+
+  // 1) Klasik özel günler
+  for (uint8_t i = 0; i < SPECIAL_COUNT; i++) {
+    if (!spEnabled(in, i)) continue;
+    time_t on=0, off=0; uint32_t ymdEv=0;
+    if (!computeWindowForSpecial(in, i, on, off, ymdEv)) continue;
+    consider(on, off, ymdEv, SR_SPECIAL, i);
+  }
+
+  // 2) Ramazan tüm günler
+  if (in.ramazanAll) {
+    for (int idx = 0; idx < (int)in.dayCount; idx++) {
+      int dayNo = 0;
+      if (!isRamazanIdx(in, idx, dayNo)) continue;
+      time_t on=0, off=0;
+      if (!buildWindowForEventIdx(in, idx, on, off)) continue;
+      consider(on, off, in.days[idx].ymd, SR_RAMAZAN, (uint8_t)dayNo);
+    }
+  }
+
+  if (best.on == 0 || best.off == 0) return false;
+  out = best;
+  return true;
+}
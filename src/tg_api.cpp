@@ -0,0 +1,337 @@
+/*
+  src/tg_api.cpp - Telegram Bot API yanıt ayrıştırıcısı
+  Bkz. include/tg_api.h
+*/
+
+#include "tg_api.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// =====================
+// JsonSax
+// =====================
+static bool jsTopIsObject(const JsonSax& s) {
+  return s.depth > 0 && ((s.ctr >> (s.depth - 1)) & 1u);
+}
+
+static void jsPut(JsonSax& s, char c) {
+  if (s.inKey) {
+    if (s.keyLen < JS_KEY_MAX - 1) s.key[s.depth - 1][s.keyLen++] = c;
+    else s.keyLen = JS_KEY_MAX;
+  } else if (s.valLen < JS_VAL_MAX - 1) {
+    s.val[s.valLen++] = c;
+  } else {
+    s.trunc = 1;
+  }
+}
+
+static void jsPutUtf8(JsonSax& s, uint16_t cp) {
+  if (cp < 0x80) {
+    jsPut(s, (char)cp);
+  } else if (cp < 0x800) {
+    jsPut(s, (char)(0xC0 | (cp >> 6)));
+    jsPut(s, (char)(0x80 | (cp & 0x3F)));
+  } else if (cp >= 0xD800 && cp <= 0xDFFF) {
+    jsPut(s, '?');  // surrogate çifti (emoji vb.): komut/callback alanlarında anlamsız
+  } else {
+    jsPut(s, (char)(0xE0 | (cp >> 12)));
+    jsPut(s, (char)(0x80 | ((cp >> 6) & 0x3F)));
+    jsPut(s, (char)(0x80 | (cp & 0x3F)));
+  }
+}
+
+static int jsHex(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+// Değer olayı; üst seviyede tek değer bittiyse done
+static bool jsEmit(JsonSax& s, JsonSaxEvent ev, JsonSaxFn fn, void* ctx) {
+  s.val[s.valLen] = '\0';
+  if (s.depth == 0) s.done = 1;
+  return !fn || fn(s, ev, ctx);
+}
+
+void jsonSaxInit(JsonSax& s) {
+  memset(&s, 0, sizeof(s));
+}
+
+bool jsonSaxFeed(JsonSax& s, const char* data, size_t len, JsonSaxFn fn, void* ctx) {
+  if (s.error) return false;
+  s.bytes += (uint32_t)len;
+
+  for (size_t i = 0; i < len; i++) {
+    char c = data[i];
+
+    if (s.inStr) {
+      if (s.uLeft) {
+        int h = jsHex(c);
+        if (h < 0) { s.error = 1; return false; }
+        s.uCode = (uint16_t)((s.uCode << 4) | (uint16_t)h);
+        if (--s.uLeft == 0) jsPutUtf8(s, s.uCode);
+      } else if (s.esc) {
+        s.esc = 0;
+        switch (c) {
+          case 'u': s.uLeft = 4; s.uCode = 0; break;
+          case 'n': jsPut(s, '\n'); break;
+          case 't': jsPut(s, '\t'); break;
+          case 'r': jsPut(s, '\r'); break;
+          case 'b': jsPut(s, '\b'); break;
+          case 'f': jsPut(s, '\f'); break;
+          default:  jsPut(s, c); break;
+        }
+      } else if (c == '\\') {
+        s.esc = 1;
+      } else if (c == '"') {
+        s.inStr = 0;
+        if (s.inKey) {
+          char* k = s.key[s.depth - 1];
+          if (s.keyLen >= JS_KEY_MAX) { k[0] = '\x01'; k[1] = '\0'; }  // eşleşmesin
+          else k[s.keyLen] = '\0';
+          s.inKey = 0;
+          s.expectKey = 0;
+        } else if (!jsEmit(s, JS_STRING, fn, ctx)) {
+          s.error = 1;
+          return false;
+        }
+      } else {
+        jsPut(s, c);
+      }
+      continue;
+    }
+
+    if (s.inScalar) {
+      if (c != ',' && c != '}' && c != ']' && c != ' ' && c != '\t' && c != '\r' && c != '\n') {
+        jsPut(s, c);
+        continue;
+      }
+      s.inScalar = 0;
+      JsonSaxEvent ev = (s.val[0] == 't' || s.val[0] == 'f' || s.val[0] == 'n') ? JS_LITERAL : JS_NUMBER;
+      if (!jsEmit(s, ev, fn, ctx)) { s.error = 1; return false; }
+    }
+
+    if (s.done) continue;
+
+    switch (c) {
+      case ' ': case '\t': case '\r': case '\n':
+        break;
+
+      case '"':
+        s.inStr = 1; s.esc = 0; s.uLeft = 0;
+        s.started = 1;
+        if (jsTopIsObject(s) && s.expectKey) {
+          s.inKey = 1;
+          s.keyLen = 0;
+        } else {
+          s.inKey = 0;
+          s.valLen = 0;
+          s.trunc = 0;
+        }
+        break;
+
+      case '{': case '[': {
+        if (s.depth >= JS_DEPTH_MAX) { s.error = 1; return false; }
+        s.started = 1;
+        s.valLen = 0;
+        if (fn && !fn(s, c == '{' ? JS_OBJ_BEGIN : JS_ARR_BEGIN, ctx)) { s.error = 1; return false; }
+        if (c == '{') s.ctr |= (uint16_t)(1u << s.depth);
+        else          s.ctr &= (uint16_t)~(1u << s.depth);
+        s.key[s.depth][0] = '\0';
+        s.depth++;
+        s.expectKey = (c == '{');
+        break;
+      }
+
+      case '}': case ']':
+        if (s.depth == 0 || jsTopIsObject(s) != (c == '}')) { s.error = 1; return false; }
+        s.depth--;
+        s.expectKey = 0;
+        if (s.depth == 0) s.done = 1;
+        if (fn && !fn(s, c == '}' ? JS_OBJ_END : JS_ARR_END, ctx)) { s.error = 1; return false; }
+        break;
+
+      case ',':
+        if (jsTopIsObject(s)) s.expectKey = 1;
+        break;
+
+      case ':':
+        s.expectKey = 0;
+        break;
+
+      default:
+        s.started = 1;
+        s.inScalar = 1;
+        s.valLen = 0;
+        s.trunc = 0;
+        jsPut(s, c);
+        break;
+    }
+  }
+  return true;
+}
+
+bool jsonSaxComplete(const JsonSax& s) {
+  return s.started && s.done && !s.error && !s.inStr;
+}
+
+bool jsonSaxAt(const JsonSax& s, const char* path) {
+  if (s.depth == 0) return path[0] == '\0';
+  const char* p = path;
+  for (int d = 0; d < s.depth; d++) {
+    const char* e = strchr(p, '.');
+    size_t n = e ? (size_t)(e - p) : strlen(p);
+    if (!(n == 1 && p[0] == '*')) {
+      const char* k = s.key[d];
+      if (strlen(k) != n || memcmp(k, p, n) != 0) return false;
+    }
+    if (!e) return d == s.depth - 1;
+    p = e + 1;
+  }
+  return false;  // yol derinlikten uzun
+}
+
+// =====================
+// JSON string kaçışı
+// =====================
+static size_t tgEsc(unsigned char c, char* out) {
+  switch (c) {
+    case '"':  out[0] = '\\'; out[1] = '"';  return 2;
+    case '\\': out[0] = '\\'; out[1] = '\\'; return 2;
+    case '\n': out[0] = '\\'; out[1] = 'n';  return 2;
+    case '\r': out[0] = '\\'; out[1] = 'r';  return 2;
+    case '\t': out[0] = '\\'; out[1] = 't';  return 2;
+    case '\b': out[0] = '\\'; out[1] = 'b';  return 2;
+    case '\f': out[0] = '\\'; out[1] = 'f';  return 2;
+    default: break;
+  }
+  if (c < 0x20) {
+    snprintf(out, 7, "\\u%04x", (unsigned)c);
+    return 6;
+  }
+  out[0] = (char)c;
+  return 1;
+}
+
+size_t tgJsonEscapedLen(const char* in) {
+  size_t n = 0;
+  char tmp[7];
+  for (; *in; in++) n += tgEsc((unsigned char)*in, tmp);
+  return n;
+}
+
+size_t tgJsonEscapeChunk(const char*& in, char* out, size_t cap) {
+  size_t o = 0;
+  char tmp[7];
+  while (*in) {
+    size_t k = tgEsc((unsigned char)*in, tmp);
+    if (o + k > cap) break;
+    memcpy(out + o, tmp, k);
+    o += k;
+    in++;
+  }
+  return o;
+}
+
+// =====================
+// Telegram yanıtı
+// =====================
+static void tgCopy(char* dst, size_t cap, const JsonSax& s) {
+  size_t n = (s.valLen < cap - 1) ? s.valLen : cap - 1;
+  memcpy(dst, s.val, n);
+  dst[n] = '\0';
+}
+
+// getUpdates: "result" bir dizi ve değer bir update nesnesinin içinde
+static bool tgInUpdates(const JsonSax& s) {
+  return s.depth >= 2 && ((s.ctr >> 1) & 1u) == 0 && strcmp(s.key[0], "result") == 0;
+}
+
+static bool tgOnSax(JsonSax& s, JsonSaxEvent ev, void* ctx) {
+  TgResponse& r = *(TgResponse*)ctx;
+  TgUpdate& u = r.upd;
+
+  switch (ev) {
+    case JS_OBJ_BEGIN:
+      if (s.depth == 2 && tgInUpdates(s)) {
+        memset(&u, 0, sizeof(u));
+      } else if (s.depth == 3 && !u.type[0] && tgInUpdates(s)) {
+        // update türü = update nesnesindeki ilk nesne alanının adı
+        size_t n = strlen(s.key[2]);
+        if (n >= sizeof(u.type)) n = sizeof(u.type) - 1;
+        memcpy(u.type, s.key[2], n);
+        u.type[n] = '\0';
+      }
+      return true;
+    case JS_OBJ_END:
+      if (s.depth == 2 && tgInUpdates(s)) {
+        // Callback reddederse (kuyruk dolu) bu update teslim edilmedi: lastUpdateId ilerlemez
+        if (r.fn && !r.fn(u, r.ctx)) return false;
+        r.updates++;
+        if (u.updateId > r.lastUpdateId) r.lastUpdateId = u.updateId;
+      }
+      return true;
+    case JS_ARR_BEGIN:
+    case JS_ARR_END:
+      return true;
+    default:
+      break;
+  }
+
+  if (s.depth >= 3 && !tgInUpdates(s)) return true;
+
+  switch (s.depth) {
+    case 1:
+      if (jsonSaxAt(s, "ok"))               r.res.ok = (ev == JS_LITERAL && s.val[0] == 't');
+      else if (jsonSaxAt(s, "error_code"))  r.res.errorCode = atoi(s.val);
+      else if (jsonSaxAt(s, "description")) tgCopy(r.res.desc, sizeof(r.res.desc), s);
+      break;
+    case 2:
+      if (jsonSaxAt(s, "result.message_id")) r.res.messageId = (int32_t)atol(s.val);
+      break;
+    case 3:
+      if (jsonSaxAt(s, "result.*.update_id")) u.updateId = atol(s.val);
+      break;
+    case 4:
+      if (jsonSaxAt(s, "result.*.callback_query.id"))        tgCopy(u.queryId, sizeof(u.queryId), s);
+      else if (jsonSaxAt(s, "result.*.callback_query.data")) tgCopy(u.text, sizeof(u.text), s);
+      else if (jsonSaxAt(s, "result.*.*.message_id"))       u.messageId = (int32_t)atol(s.val);
+      else if (jsonSaxAt(s, "result.*.*.text"))             tgCopy(u.text, sizeof(u.text), s);
+      break;
+    case 5:
+      if (jsonSaxAt(s, "result.*.callback_query.message.message_id"))
+        u.messageId = (int32_t)atol(s.val);
+      else if (jsonSaxAt(s, "result.*.*.chat.id"))              tgCopy(u.chatId, sizeof(u.chatId), s);
+      else if (jsonSaxAt(s, "result.*.*.from.id"))         tgCopy(u.fromId, sizeof(u.fromId), s);
+      else if (jsonSaxAt(s, "result.*.*.from.first_name")) tgCopy(u.fromName, sizeof(u.fromName), s);
+      break;
+    case 6:
+      if (jsonSaxAt(s, "result.*.callback_query.message.chat.id"))
+        tgCopy(u.chatId, sizeof(u.chatId), s);
+      break;
+    default:
+      break;
+  }
+  return true;
+}
+
+void tgResponseBegin(TgResponse& r, TgUpdateFn fn, void* ctx) {
+  jsonSaxInit(r.sax);
+  memset(&r.res, 0, sizeof(r.res));
+  memset(&r.upd, 0, sizeof(r.upd));
+  r.fn = fn;
+  r.ctx = ctx;
+  r.updates = 0;
+  r.lastUpdateId = 0;
+}
+
+bool tgResponseFeed(TgResponse& r, const char* data, size_t len) {
+  return jsonSaxFeed(r.sax, data, len, tgOnSax, &r);
+}
+
+bool tgResponseComplete(const TgResponse& r) {
+  return jsonSaxComplete(r.sax);
+}
@@ -0,0 +1,160 @@
+#!/usr/bin/env python3
+"""
+tools/build_web_assets.py - web/ panel dosyalarını küçültüp gzip'leyerek C başlığına gömer
+
+PlatformIO'da extra_scripts (pre:) olarak her derlemeden önce çalışır; çıktı
+$BUILD_DIR/web/web_assets.h (include yoluna eklenir, repoya girmez). Elle:
+  python3 tools/build_web_assets.py [--out <klasör>]    (varsayılan: .pio/web)
+
+Adımlar:
+  - Küçültme (güvenli, satır yapısını bozmadan): HTML/JS'te satır başı/sonu boşlukları,
+    boş satırlar ve tam satır // ya da <!-- --> yorumları atılır (JS satır sonları ASI
+    için korunur); CSS'te yorumlar ve { } ; , çevresindeki boşluklar atılır.
+  - gzip -9, mtime=0 (aynı girdi -> aynı bayt, derleme tekrar edilebilir).
+  - ETag = gzip içeriğinin SHA-256'sının ilk 16 hanesi.
+  - app.css / app.js içerik hash'li adla sunulur (/s/app.<hash>.css) ve index.html'deki
+    referanslar bu adla değiştirilir: bu dosyalar "immutable" önbelleklenir, yeni
+    firmware'de adları değişir. HTML sayfalar "no-cache" + ETag (yeniden doğrulama 304).
+
+Girdi değişmediyse başlık yeniden yazılmaz (gereksiz yeniden derleme olmasın).
+"""
+import argparse
+import gzip
+import hashlib
+import os
+import re
+import sys
+
+try:
+    Import("env")  # noqa: F821  (PlatformIO / SCons)
+    _env = env     # noqa: F821
+    ROOT = _env.subst("$PROJECT_DIR")   # SCons altında __file__ yok
+except NameError:
+    _env = None
+    ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+WEB_DIR = os.path.join(ROOT, "web")
+
+# (kaynak, URL yolu, Content-Type, hash'li ad). HTML'ler en sonda: hash'li adlar önce belli olmalı.
+ASSETS = [
+    ("app.css",    "/app.css", "text/css; charset=utf-8",               True),
+    ("app.js",     "/app.js",  "application/javascript; charset=utf-8", True),
+    ("index.html", "/",        "text/html; charset=utf-8",              False),
+    ("admin.html", "/admin",   "text/html; charset=utf-8",              False),
+]
+
+
+def minify_lines(text, comment_prefixes):
+    out = []
+    for line in text.splitlines():
+        s = line.strip()
+        if not s or any(s.startswith(p) for p in comment_prefixes):
+            continue
+        out.append(s)
+    return "\n".join(out) + "\n"
+
+
+def minify_html(text):
+    text = re.sub(r"<!--.*?-->", "", text, flags=re.S)
+    return minify_lines(text, ())
+
+
+def minify_js(text):
+    return minify_lines(text, ("//",))
+
+
+def minify_css(text):
+    text = re.sub(r"/\*.*?\*/", "", text, flags=re.S)
+    text = re.sub(r"\s+", " ", text)
+    text = re.sub(r"\s*([{};,])\s*", r"\1", text)
+    text = text.replace(";}", "}")
+    return text.strip() + "\n"
+
+
+def c_ident(name):
+    return "WEB_ASSET_" + re.sub(r"[^0-9A-Za-z]", "_", name).upper()
+
+
+def build(out_dir):
+    blobs = []          # (ident, path, ctype, immutable, gz, etag, rawLen)
+    renames = {}        # "/app.css" -> "/s/app.<h>.css"
+
+    for src, url, ctype, hashed in ASSETS:
+        with open(os.path.join(WEB_DIR, src), encoding="utf-8") as f:
+            text = f.read()
+        if src.endswith(".css"):
+            text = minify_css(text)
+        elif src.endswith(".js"):
+            text = minify_js(text)
+        else:
+            for old, new in renames.items():
+                text = text.replace('"%s"' % old, '"%s"' % new)
+            text = minify_html(text)
+
+        raw = text.encode("utf-8")
+        gz = gzip.compress(raw, compresslevel=9, mtime=0)
+        digest = hashlib.sha256(gz).hexdigest()
+        if hashed:
+            base, ext = os.path.splitext(src)
+            new_url = "/s/%s.%s%s" % (base, digest[:10], ext)
+            renames[url] = new_url
+            url = new_url
+        blobs.append((c_ident(src), url, ctype, hashed, gz, digest[:16], len(raw)))
+
+    lines = [
+        "#pragma once",
+        "// Otomatik üretildi: tools/build_web_assets.py (kaynak: web/). Elle düzenlemeyin.",
+        "#include <stdint.h>",
+        "#include <stddef.h>",
+        "",
+    ]
+    for ident, url, ctype, immutable, gz, etag, raw_len in blobs:
+        lines.append("// %s: %d -> %d bayt (gzip)" % (url, raw_len, len(gz)))
+        lines.append("static const uint8_t %s[] PROGMEM = {" % ident)
+        for i in range(0, len(gz), 24):
+            lines.append("  " + ",".join("0x%02x" % b for b in gz[i:i + 24]) + ",")
+        lines.append("};")
+        lines.append("")
+
+    lines.append("struct WebAsset {")
+    lines.append("  const char*    path;")
+    lines.append("  const char*    type;")
+    lines.append("  const uint8_t* gz;")
+    lines.append("  size_t         gzLen;")
+    lines.append("  const char*    etag;       // tırnaklı")
+    lines.append("  bool           immutable;  // hash'li ad: süresiz önbellek")
+    lines.append("};")
+    lines.append("")
+    lines.append("static const WebAsset WEB_ASSETS[] = {")
+    for ident, url, ctype, immutable, gz, etag, raw_len in blobs:
+        lines.append('  { "%s", "%s", %s, sizeof(%s), "\\"%s\\"", %s },'
+                     % (url, ctype, ident, ident, etag, "true" if immutable else "false"))
+    lines.append("};")
+    lines.append("static const int WEB_ASSET_COUNT = (int)(sizeof(WEB_ASSETS) / sizeof(WEB_ASSETS[0]));")
+    header = "\n".join(lines) + "\n"
+
+    os.makedirs(out_dir, exist_ok=True)
+    path = os.path.join(out_dir, "web_assets.h")
+    old = None
+    if os.path.exists(path):
+        with open(path, encoding="utf-8") as f:
+            old = f.read()
+    if old != header:
+        with open(path, "w", encoding="utf-8") as f:
+            f.write(header)
+
+    total_raw = sum(b[6] for b in blobs)
+    total_gz = sum(len(b[4]) for b in blobs)
+    print("web assets: %d dosya, %d -> %d bayt gzip (%s)" %
+          (len(blobs), total_raw, total_gz, "güncel" if old == header else "yazıldı"))
+    return out_dir
+
+
+if _env is not None:
+    gen = build(os.path.join(_env.subst("$BUILD_DIR"), "web"))
+    _env.Append(CPPPATH=[gen])
+elif __name__ == "__main__":
+    ap = argparse.ArgumentParser(description="web/ -> web_assets.h (gzip + ETag)")
+    ap.add_argument("--out", default=os.path.join(ROOT, ".pio", "web"))
+    args = ap.parse_args()
+    build(args.out)
+    sys.exit(0)
@@ -0,0 +1,197 @@
+#!/usr/bin/env python3
+"""
+tools/gen_sched_fixtures.py - env:native benchmark için 45 günlük g_days fixture üretici
+
+Kullanım:
+  # Cihazın çektiği /vakitler cevabından (ezanvakti API JSON) fixture:
+  python3 tools/gen_sched_fixtures.py --json vakitler_9206.json --name ankara_2026_03 \
+      --lat 39.9179 --lon 32.8627 >> src/host/sched_fixtures.h
+  # (çıktının son satırındaki g_fixtures satırı elle listeye eklenir)
+
+  # Argümansız: src/host/sched_fixtures.h dosyasını sentetik fixture'larla yeniden yazar.
+
+Sentetik fixture'lar API şeklini taklit eder (İmsak/Akşam dakikası + "26 Ramazan 1447"
+gibi Hicri metin). Vakitler Ankara için yaklaşık bir sinüs eğrisidir, Hicri tarih
+tabular takvim + sabit gün kaydırmasıyla Diyanet 1447 başlangıçlarına oturtulur.
+Gerçek ölçüm için --json ile cihazdan alınmış cevap kullanılmalıdır; benchmark'ın
+çevrimdışı vakit hesabı (prayer_times.h) dakika hatası sadece bu fixture'larda anlamlıdır.
+"""
+import argparse
+import datetime as dt
+import json
+import math
+import os
+import sys
+
+HIJRI_MONTHS = ["Muharrem", "Safer", "Rebiülevvel", "Rebiülahir", "Cemaziyelevvel",
+                "Cemaziyelahir", "Recep", "Şaban", "Ramazan", "Şevval", "Zilkade", "Zilhicce"]
+
+# 1 Ramazan 1447 = 2026-02-19 (Diyanet); tabular takvimi buna kaydır
+HIJRI_SHIFT_DAYS = None
+
+
+def tabular_hijri(d):
+    # Kuveyt algoritması (tabular, 30 yıllık döngü)
+    jd = d.toordinal() + 1721424.5
+    jd = math.floor(jd) + 0.5
+    days = int(jd - 1948439.5)
+    cyc = days // 10631
+    rem = days - cyc * 10631
+    y = cyc * 30
+    for yy in range(30):
+        ylen = 355 if ((11 * (yy + 1) + 14) % 30) < 11 else 354
+        if rem < ylen:
+            break
+        rem -= ylen
+        y += 1
+    y += 1
+    m = 0
+    while True:
+        mlen = 30 if m % 2 == 0 else 29
+        if m == 11 and ((11 * y + 14) % 30) < 11:
+            mlen = 30
+        if rem < mlen:
+            break
+        rem -= mlen
+        m += 1
+    return rem + 1, m, y
+
+
+def hijri_for(d):
+    global HIJRI_SHIFT_DAYS
+    if HIJRI_SHIFT_DAYS is None:
+        anchor = dt.date(2026, 2, 19)
+        for s in range(-3, 4):
+            if tabular_hijri(anchor - dt.timedelta(days=s)) == (1, 8, 1447):
+                HIJRI_SHIFT_DAYS = s
+                break
+        else:
+            HIJRI_SHIFT_DAYS = 0
+    hd, hm, hy = tabular_hijri(d - dt.timedelta(days=HIJRI_SHIFT_DAYS))
+    return "%d %s %d" % (hd, HIJRI_MONTHS[hm], hy)
+
+
+def synth_times(d):
+    # Ankara yaklaşık: imsak 04:00 (yaz) .. 06:25 (kış), akşam 16:45 .. 20:05
+    doy = d.timetuple().tm_yday
+    c = math.cos(2 * math.pi * (doy - 172) / 365.0)  # 1 = yaz gündönümü
+    imsak = int(round(312 - 73 * c))
+    aksam = int(round(1122 + 100 * c))
+    return imsak, aksam
+
+
+def synth_days(start, n=45):
+    out = []
+    for i in range(n):
+        d = start + dt.timedelta(days=i)
+        im, ak = synth_times(d)
+        out.append((int(d.strftime("%Y%m%d")), im, ak, hijri_for(d)))
+    return out
+
+
+def hhmm(s):
+    h, m = s.strip().split(":")[:2]
+    return int(h) * 60 + int(m)
+
+
+def days_from_json(path):
+    with open(path, encoding="utf-8") as f:
+        arr = json.load(f)
+    out = []
+    for o in arr:
+        s = o.get("MiladiTarihUzunIso8601") or o.get("MiladiTarihKisaIso8601") or ""
+        if len(s) < 10:
+            continue
+        ymd = int(s[0:4] + s[5:7] + s[8:10])
+        out.append((ymd, hhmm(o["Imsak"]), hhmm(o["Aksam"]), (o.get("HicriTarihUzun") or "").strip()))
+        if len(out) >= 45:
+            break
+    out.sort()
+    return out
+
+
+MONTH_KEYS = ["muharrem", "safer", "rebiulevvel", "rebiulahir", "cemaziyelevvel", "cemaziyelahir",
+              "receb", "saban", "ramazan", "sevval", "zilkade", "zilhicce"]
+TR_FOLD = str.maketrans("ÇçĞğİıÖöŞşÜü", "ccggiioossuu")
+
+
+def hijri_fields(s):
+    # schedule_engine parseHicriFields ile aynı: (gün, ay index, yıl), parse edilemezse (0, -1, 0)
+    p = s.strip().split(" ")
+    if len(p) < 3 or not p[0].isdigit() or not (1 <= int(p[0]) <= 30):
+        return 0, -1, 0
+    key = " ".join(p[1:-1]).strip().translate(TR_FOLD).lower()
+    key = {"recep": "receb", "rebiyulevvel": "rebiulevvel"}.get(key, key)
+    mon = MONTH_KEYS.index(key) if key in MONTH_KEYS else -1
+    year = int(p[-1]) if p[-1].isdigit() else 0
+    return int(p[0]), mon, year
+
+
+def c_str(s):
+    b = s.encode("utf-8")[:27]
+    return '"' + "".join(chr(c) if 32 <= c < 127 and c not in (34, 92) else "\\%03o" % c for c in b) + '"'
+
+
+def emit(name, days):
+    lines = ["static const DayTimes fx_%s[] = {" % name]
+    for ymd, im, ak, h in days:
+        hd, hm, hy = hijri_fields(h)
+        lines.append("  { %d, %4d, %4d, %2d, %2d, %4d, %s }," % (ymd, im, ak, hd, hm, hy, c_str(h)))
+    lines.append("};")
+    return "\n".join(lines) + "\n"
+
+
+# Sentetik fixture'ların koordinatı (ILCE_ID=9206 Çankaya)
+SYNTH_LAT, SYNTH_LON = 39.9179, 32.8627
+
+
+def fixture_row(name, lat, lon, recorded):
+    return "  { \"%s\", fx_%s, (uint16_t)(sizeof(fx_%s) / sizeof(fx_%s[0])), %d, %d, %d }," % (
+        name, name, name, name, int(round(lat * 1e6)), int(round(lon * 1e6)), 1 if recorded else 0)
+
+
+SYNTH = [
+    ("receb_1447",    dt.date(2025, 12, 12)),  # Üç aylar, Regaib, Mirac
+    ("ramazan_1447",  dt.date(2026, 2, 10)),   # Berat sonrası, Ramazan, Kadir, Bayram
+    ("kurban_1447",   dt.date(2026, 5, 10)),   # Arefe + Kurban Bayramı
+    ("mevlid_1448",   dt.date(2026, 8, 10)),   # Mevlid Kandili
+]
+
+
+def main():
+    ap = argparse.ArgumentParser()
+    ap.add_argument("--json")
+    ap.add_argument("--name", default="recorded")
+    ap.add_argument("--lat", type=float, default=SYNTH_LAT)
+    ap.add_argument("--lon", type=float, default=SYNTH_LON)
+    a = ap.parse_args()
+
+    if a.json:
+        sys.stdout.write(emit(a.name, days_from_json(a.json)))
+        sys.stdout.write("// g_fixtures:\n//%s\n" % fixture_row(a.name, a.lat, a.lon, True))
+        return
+
+    path = os.path.join(os.path.dirname(__file__), "..", "src", "host", "sched_fixtures.h")
+    body = ["#pragma once",
+            "// src/host/sched_fixtures.h - env:native benchmark fixture'ları",
+            "// tools/gen_sched_fixtures.py ile üretildi (sentetik, API şeklinde 45 gün). Elle düzenlemeyin.",
+            "",
+            '#include "schedule_engine.h"',
+            ""]
+    for name, start in SYNTH:
+        body.append(emit(name, synth_days(start)))
+    body.append("// latE6/lonE6: ilçe koordinatı (prayer_times.h karşılaştırması), recorded: gerçek API cevabı")
+    body.append("struct SchedFixture { const char* name; const DayTimes* days; uint16_t count;")
+    body.append("                      int32_t latE6; int32_t lonE6; uint8_t recorded; };")
+    body.append("")
+    body.append("static const SchedFixture g_fixtures[] = {")
+    for name, _ in SYNTH:
+        body.append(fixture_row(name, SYNTH_LAT, SYNTH_LON, False))
+    body.append("};")
+    body.append("static const int FIXTURE_COUNT = sizeof(g_fixtures) / sizeof(g_fixtures[0]);")
+    with open(path, "w", encoding="utf-8") as f:
+        f.write("\n".join(body) + "\n")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,373 @@
+var S={dark:false,authed:false,key:'',tab:'home',autoRef:true,pub:{},sys:{},sets:{},acfg:{},es:null,wfCb:null};
+var refreshTimer=null;
+function $(id){return document.getElementById(id)}
+function toast(m){var t=$('toast');t.textContent=m;t.className='show';clearTimeout(t._t);t._t=setTimeout(function(){t.className=''},2800)}
+function fmtB(b){return b>=1048576?(b/1048576).toFixed(1)+' MB':b>=1024?(b/1024|0)+' KB':b+' B'}
+function fmtUp(s){var d=s/86400|0,h=(s%86400)/3600|0,m=(s%3600)/60|0;return d>0?d+'g '+h+'s':h>0?h+'s '+m+'dk':m+'dk'}
+function getKey(){return localStorage.getItem('WEB_KEY')||''}
+function saveKey(k){localStorage.setItem('WEB_KEY',k);S.key=k}
+function api(path,opts){opts=opts||{};opts.headers=opts.headers||{};var k=getKey();if(k)opts.headers['X-API-KEY']=k;return fetch(path,opts)}
+// ── CBOR (RFC 8949) çözücü: cihaz Accept: application/cbor'a ikili yanıt verir (daha küçük, daha az biçimlendirme) ──
+var CBOR_OK=!!(window.TextDecoder&&window.DataView);
+function cborDec(buf){var dv=new DataView(buf),u8=new Uint8Array(buf),p=0,td=new TextDecoder();
+function arg(ai){if(ai<24)return ai;if(ai===24)return u8[p++];if(ai===25){p+=2;return dv.getUint16(p-2)}if(ai===26){p+=4;return dv.getUint32(p-4)}if(ai===27){p+=8;return dv.getUint32(p-8)*4294967296+dv.getUint32(p-4)}return -1}
+function item(){var b=u8[p++],mt=b>>5,ai=b&31,n,v,i,k;
+if(mt===7){if(ai===20)return false;if(ai===21)return true;if(ai===26){p+=4;return dv.getFloat32(p-4)}if(ai===27){p+=8;return dv.getFloat64(p-8)}return null}
+n=arg(ai);if(mt===0)return n;if(mt===1)return -1-n;
+if(mt===2||mt===3){v=u8.subarray(p,p+n);p+=n;return mt===3?td.decode(v):v}
+if(mt===4){v=[];for(i=0;n<0?u8[p]!==255:i<n;i++)v.push(item());if(n<0)p++;return v}
+if(mt===5){v={};for(i=0;n<0?u8[p]!==255:i<n;i++){k=item();v[k]=item()}if(n<0)p++;return v}
+return item()}
+return item()}
+// GET + CBOR istemi; 401 -> null. Yanıt türüne göre çözer (eski firmware JSON döner)
+function apiGet(path,auth){var o={headers:CBOR_OK?{'Accept':'application/cbor'}:{}};return (auth?api(path,o):fetch(path,o)).then(function(r){if(r.status===401)return null;return (r.headers.get('Content-Type')||'').indexOf('application/cbor')===0?r.arrayBuffer().then(cborDec):r.json()})}
+function barColor(pct){return pct>80?'#e74c3c':pct>60?'#f39c12':'#0b6'}
+function rssiQ(r){return r>-50?'Mükemmel':r>-60?'Çok İyi':r>-70?'İyi':r>-80?'Zayıf':'Çok Zayıf'}
+function rssiBars(r){return r>-50?4:r>-60?3:r>-70?2:r>-80?1:0}
+function toggleDark(){S.dark=!S.dark;document.body.classList.toggle('dk',S.dark);$('darkBtn').textContent=S.dark?'☀️':'🌙';localStorage.setItem('DARK',S.dark?'1':'0')}
+
+// ── Auth ──
+function doLogin(){
+  var inp=$('loginKey');if(inp)saveKey(inp.value.trim());
+  api('/api/authcheck').then(function(r){
+    if(r.ok){S.authed=true;S.tab='system';toast('✅ Giriş başarılı');loadSystem();loadSettings();loadAdminCfg();renderAll();}
+    else toast('❌ Şifre hatalı');
+  }).catch(function(){toast('Bağlantı hatası')});
+}
+function doLogout(){localStorage.removeItem('WEB_KEY');S.key='';S.authed=false;S.tab='home';toast('Çıkış yapıldı');renderAll()}
+function doReboot(){if(!confirm('Sistem yeniden başlatılsın mı?'))return;toast('🔄 Yeniden başlatılıyor...');api('/api/action',{method:'POST',headers:{'Content-Type':'application/json'},body:JSON.stringify({cmd:'reboot'})}).then(function(){setTimeout(function(){location.reload()},5000)}).catch(function(){setTimeout(function(){location.reload()},5000)})}
+
+// ── Tabs ──
+var TABS=[
+  {id:'home',label:'🏠 Durum',pub:true},
+  {id:'system',label:'📊 Sistem'},
+  {id:'tolerans',label:'⚙️ Toleranslar'},
+  {id:'dinigun',label:'🕌 Dini Günler'},
+  {id:'komut',label:'🧰 Komutlar'},
+  {id:'log',label:'📋 Log'},
+  {id:'ayarlar',label:'🛠️ Ayarlar'}
+];
+function setTab(id){S.tab=id;renderAll()}
+function renderTabs(){
+  var h='';TABS.forEach(function(t){if(!t.pub&&!S.authed)return;h+='<button class="tab '+(S.tab===t.id?'on':'off')+'" onclick="setTab(\''+t.id+'\')">'+t.label+'</button>';});
+  if(!S.authed)h+='<button class="tab '+(S.tab==='login'?'on':'lock')+'" onclick="setTab(\'login\')">🔒 Giriş</button>';
+  $('tabBar').innerHTML=h;$('logoutBtn').className=S.authed?'hdr-btn':'hdr-btn hidden';$('rebootBtn').className=S.authed?'hdr-btn':'hdr-btn hidden';
+}
+
+// ── Data ──
+// /api/public durum sürümü ya da dakika değişince yeni gövde döner (aksi halde 304); içindeki anlık alanlar dakika başına aittir, güncelleri /api/live'dan ya da SSE'den gelir
+var LIVE_KEYS=['now','rssi','freeHeap','minFreeHeap','cpuUsage','uptimeSec'];
+function loadPublic(){apiGet('/api/public').then(function(d){['win','winAct','liveYmd'].forEach(function(k){if(d[k]===undefined&&S.pub[k]!==undefined)d[k]=S.pub[k]});if(S.pub.ok)LIVE_KEYS.forEach(function(k){if(S.pub[k]!==undefined)d[k]=S.pub[k]});S.pub=d;$('hdrSub').textContent=(d.version||'')+' • '+(d.now||'-');if(S.tab==='home')renderHome();if(S.tab==='komut')renderKomut();if(!S.es)loadLive()}).catch(function(){})}
+function loadLive(){apiGet('/api/live').then(function(d){var p=S.pub;LIVE_KEYS.forEach(function(k){if(d[k]!==undefined)p[k]=d[k]});if(p.ok){$('hdrSub').textContent=(p.version||'')+' • '+(p.now||'-');if(S.tab==='home')renderHome();if(S.tab==='komut')renderKomut()}}).catch(function(){})}
+function loadSystem(){apiGet('/api/system',true).then(function(d){if(d){S.sys=d;if(S.tab==='system')renderSystem()}}).catch(function(){})}
+function loadSettings(){apiGet('/api/settings',true).then(function(d){if(d)S.sets=d}).catch(function(){})}
+function loadAdminCfg(){api('/api/admincfg').then(function(r){if(r.status===401)return null;return r.json()}).then(function(d){if(d&&d.ok){S.acfg=d;if(S.tab==='ayarlar')renderAyarlar()}}).catch(function(){})}
+function refreshData(){if(!S.es)loadPublic();if(S.authed&&S.tab==='system')loadSystem();if(S.authed&&S.tab==='log')loadLogs()}
+function startAutoRef(){clearInterval(refreshTimer);liveStop();if(!S.autoRef)return;liveStart();refreshTimer=setInterval(refreshData,15000)}
+// ── Canlı akış (/api/events, SSE): durum değişince anında; yoksa /api/public yoklaması ──
+function liveStart(){if(!window.EventSource)return;var es=new EventSource('/api/events');S.es=es;es.onmessage=function(e){try{applyLive(JSON.parse(e.data))}catch(x){}};es.onerror=function(){if(es.readyState===2&&S.es===es){S.es=null;loadPublic()}}}
+function liveStop(){if(S.es){S.es.close();S.es=null}}
+function applyLive(d){
+  var p=S.pub,reload=(d.ymd!==undefined&&p.liveYmd!==undefined&&d.ymd!==p.liveYmd)||(d.dayCount!==undefined&&p.dayCount!==undefined&&d.dayCount!==p.dayCount);
+  if(d.ymd!==undefined)p.liveYmd=d.ymd;
+  ['relay','now','rssi','freeHeap','cpuUsage','uptimeSec','dayCount','win','winAct'].forEach(function(k){if(d[k]!==undefined)p[k]=d[k]});
+  if(d.upd!==undefined){p.updatePending=d.upd===1;p.updateInProgress=d.upd===2}
+  if(d.wf!==undefined&&S.wfCb)S.wfCb(d.wf);
+  if(p.ok){$('hdrSub').textContent=(p.version||'')+' • '+(p.now||'-');if(S.tab==='home')renderHome();if(S.tab==='komut')renderKomut()}
+  if(reload)loadPublic();
+}
+
+// ── UI Helpers ──
+function gauge(pct,size,label,detail){var r=(size-10)/2,c=2*Math.PI*r,off=c-(Math.min(100,Math.max(0,pct))/100)*c,col=barColor(pct);return'<div style="text-align:center"><div style="position:relative;display:inline-block;width:'+size+'px;height:'+size+'px"><svg width="'+size+'" height="'+size+'" class="gauge-svg"><circle cx="'+(size/2)+'" cy="'+(size/2)+'" r="'+r+'" fill="none" stroke="rgba(128,128,128,.1)" stroke-width="7"/><circle cx="'+(size/2)+'" cy="'+(size/2)+'" r="'+r+'" fill="none" stroke="'+col+'" stroke-width="7" stroke-dasharray="'+c+'" stroke-dashoffset="'+off+'" stroke-linecap="round" style="transition:stroke-dashoffset 1s"/></svg><div style="position:absolute;top:50%;left:50%;transform:translate(-50%,-50%);font-size:'+(size*.22)+'px;font-weight:700;font-variant-numeric:tabular-nums">'+Math.round(pct)+'%</div></div><div style="font-size:10px;font-weight:600;color:var(--ts);margin-top:3px">'+label+'</div>'+(detail?'<div style="font-size:9px;color:var(--ts);opacity:.7">'+detail+'</div>':'')+'</div>'}
+function sigBars(rssi){var n=rssiBars(rssi),col=n>=3?'#0b6':n===2?'#f39c12':'#e74c3c',h='<div class="sig-bars">';for(var i=1;i<=4;i++)h+='<div style="width:4px;height:'+(3+i*3)+'px;border-radius:1px;background:'+(i<=n?col:'rgba(128,128,128,.15)')+'"></div>';return h+'</div>'}
+function barH(pct,label,detail,color){var c=color||barColor(pct);return'<div class="bar-wrap"><div class="bar-hdr"><span class="k">'+label+'</span><span class="v">'+detail+'</span></div><div class="bar"><div class="bar-fill" style="width:'+Math.min(100,pct)+'%;background:'+c+'"></div></div></div>'}
+function statH(icon,label,val){return'<div class="stat"><span>'+icon+'</span><span class="k">'+label+'</span><span class="v">'+val+'</span></div>'}
+function prayerH(name,time,isNext){return'<div class="prayer'+(isNext?' next':'')+'">'+(isNext?'<div style="position:absolute;top:4px;right:6px;color:var(--ac);font-size:11px">★</div>':'')+'<div class="nm">'+name+'</div><div class="tm">'+time+'</div></div>'}
+
+function nextPrayer(d){if(!d||!d.now)return'';var hm=(d.now.split(' ')[1]||'').substring(0,5);if(d.imsak&&d.imsak>hm)return'imsak';if(d.aksam&&d.aksam>hm)return'aksam';return'imsak'}
+function cmdAction(cmd){api('/api/action',{method:'POST',headers:{'Content-Type':'application/json'},body:JSON.stringify({cmd:cmd})}).then(function(r){if(r.status===401){toast('Yetkisiz');return}return r.json()}).then(function(d){if(d){toast(d.ok?(d.msg||'✅ Tamam'):('❌ '+(d.msg||d.err||'Hata')));loadPublic()}}).catch(function(){toast('Bağlantı hatası')})}
+
+// ══════════ HOME ══════════
+function renderHome(){
+  var d=S.pub;if(!d.ok){$('content').innerHTML='<div class="cd"><p>Yükleniyor...</p></div>';return}
+  var np=nextPrayer(d),pN={imsak:'🌙 İmsak',gunes:'🌅 Güneş',ogle:'☀️ Öğle',ikindi:'🌤 İkindi',aksam:'🌇 Akşam',yatsi:'🌃 Yatsı'},h='';
+  h+='<div class="cd"><div style="display:flex;justify-content:space-between;align-items:center;margin-bottom:14px"><div><h3 style="margin:0">Namaz Vakitleri</h3><div style="font-size:12px;color:var(--ts);margin-top:3px">'+(d.hicri||'')+'</div></div>';
+  h+='<div class="live'+(S.autoRef?' on':'')+'" onclick="S.autoRef=!S.autoRef;startAutoRef();renderAll()"><div class="dot" style="background:'+(S.autoRef?'var(--ac)':'var(--ts)')+'"></div>'+(S.autoRef?'Canlı':'Durdu')+'</div></div>';
+  h+='<div class="grid3">';['imsak','gunes','ogle','ikindi','aksam','yatsi'].forEach(function(k){var t=d[k]||'—';h+=prayerH(pN[k],t,np===k&&t!=='—')});h+='</div></div>';
+  h+='<div class="cd"><h3 style="margin-bottom:12px">Sistem Durumu</h3><div class="grid2">';
+  var ron=d.relay;h+='<div class="sbox" style="border-color:'+(ron?'rgba(0,180,130,.2)':'rgba(231,76,60,.15)')+'"><div style="font-size:11px;color:var(--ts);margin-bottom:3px">⚡ Şerefeler</div><div style="font-size:18px;font-weight:700;color:'+(ron?'var(--ac)':'#e74c3c')+'">'+(ron?'AÇIK ✅':'KAPALI ❌')+'</div></div>';
+  h+='<div class="sbox"><div style="font-size:11px;color:var(--ts);margin-bottom:3px">🕰️ Saat</div><div style="font-size:18px;font-weight:700;font-variant-numeric:tabular-nums">'+((d.now||'').split(' ')[1]||'-')+'</div></div>';
+  h+='<div class="sbox"><div style="font-size:11px;color:var(--ts);margin-bottom:3px">📶 WiFi</div><div style="display:flex;align-items:center;gap:6px">'+sigBars(d.rssi||0)+'<div><div style="font-size:13px;font-weight:600">'+(d.ssid||'-')+'</div><div style="font-size:10px;color:var(--ts)">'+(d.rssi||0)+' dBm</div></div></div></div>';
+  h+='<div class="sbox"><div style="font-size:11px;color:var(--ts);margin-bottom:3px">📊 Performans</div><div style="font-size:13px;font-weight:600">İş Yükü: '+(d.cpuUsage||0)+'%</div><div style="font-size:10px;color:var(--ts)">RAM: '+fmtB(d.freeHeap||0)+' boş</div></div>';
+  h+='</div><div style="margin-top:10px;padding:9px 12px;border-radius:10px;background:rgba(128,128,128,.03);display:flex;flex-wrap:wrap;gap:5px 16px;font-size:12px;color:var(--ts)">';
+  h+='<span>Tolerans: <b style="color:var(--tx)">'+(d.onTolMin||0)+'dk / '+(d.offTolMin||0)+'dk</b></span>';
+  h+='<span>Cache: <b style="color:var(--tx)">'+(d.dayCount||0)+' gün</b></span>';
+  h+='<span>İlçe: <b style="color:var(--tx)">'+(d.ilceId||0)+'</b></span>';
+  h+='<span>Uptime: <b style="color:var(--tx)">'+fmtUp(d.uptimeSec||0)+'</b></span>';
+  if(d.win&&d.win.length===2)h+='<span>'+(d.winAct?'Pencere açık':'Sonraki pencere')+': <b style="color:var(--tx)">'+d.win[0]+' – '+d.win[1]+'</b></span>';
+  h+='</div></div>';
+  $('content').innerHTML=h;
+}
+
+// ══════════ SYSTEM ══════════
+function renderSystem(){
+  var d=S.sys;if(!d||!d.ok){$('content').innerHTML='<div class="cd"><p>Yükleniyor...</p></div>';loadSystem();return}
+  var ram=d.ram||{},fl=d.flash||{},cpu=d.cpu||{},wifi=d.wifi||{},nvs=d.nvs||{},h='';
+  h+='<div class="cd"><div style="display:flex;justify-content:space-between;align-items:center;margin-bottom:18px"><h3 style="margin:0">📊 Sistem İzleme</h3>';
+  h+='<div class="live'+(S.autoRef?' on':'')+'" onclick="S.autoRef=!S.autoRef;startAutoRef();renderAll()"><div class="dot" style="background:'+(S.autoRef?'var(--ac)':'var(--ts)')+'"></div>'+(S.autoRef?'Canlı':'Durdu')+'</div></div>';
+  h+='<div class="grid4" style="text-align:center">';
+  h+=gauge(ram.usedPct||0,85,'RAM',fmtB(ram.free||0)+' boş');
+  var lps=cpu.loopsPerSec||0;var lpsStr=lps>=10?Math.round(lps)+'/s':lps>0?lps+'/s':'<1/s';
+  var ioP=cpu.ioPct||0;
+  h+='<div>'+gauge(cpu.usageTotal||0,85,'İş Yükü',lpsStr)+'<div style="font-size:10px;color:var(--ts);margin-top:2px">I/O: '+ioP+'%</div></div>';
+  h+=gauge(fl.sketchPct||0,85,'Flash',fmtB(fl.sketchFree||0)+' boş');
+  h+='<div style="display:flex;flex-direction:column;align-items:center;justify-content:center">'+sigBars(wifi.rssi||0)+'<div style="font-size:18px;font-weight:700;margin-top:5px;font-variant-numeric:tabular-nums">'+(wifi.rssi||0)+'</div><div style="font-size:10px;font-weight:600;color:var(--ts)">WiFi dBm</div><div style="font-size:9px;color:var(--ts)">'+rssiQ(wifi.rssi||0)+'</div></div>';
+  h+='</div></div>';
+  h+='<div class="cd"><h3>🧠 RAM (Heap)</h3>'+barH(ram.usedPct||0,'Kullanılan',fmtB(ram.used||0)+' / '+fmtB(ram.total||0))+'<div class="grid2">'+statH('📦','Boş',fmtB(ram.free||0))+statH('📉','Min Boş',fmtB(ram.minFree||0))+statH('🧩','Max Blok',fmtB(ram.maxAlloc||0))+statH('💾','Toplam',fmtB(ram.total||0))+'</div></div>';
+  h+='<div class="cd"><h3>⚡ İşlemci</h3><div class="grid2" style="margin-bottom:12px">'+statH('🏷️','Model',cpu.model||'-')+statH('🧮','Çekirdek',cpu.cores||0)+statH('⏱️','Frekans',(cpu.freqMHz||0)+' MHz')+statH('🔄','Döngü',lpsStr)+statH('📊','İş Yükü',(cpu.usageTotal||0)+'%')+statH('📡','I/O Bekleme',ioP+'%');
+  if(cpu.tempC)h+=statH('🌡️','Sıcaklık',cpu.tempC+'°C');
+  h+=statH('⏰','Uptime',fmtUp(d.uptimeSec||0))+'</div></div>';
+  h+='<div class="cd"><h3>💿 Flash</h3>'+barH(fl.sketchPct||0,'Firmware',fmtB(fl.sketch||0)+' / '+fmtB((fl.sketch||0)+(fl.sketchFree||0)))+'<div class="grid2">'+statH('📀','Toplam',fmtB(fl.total||0))+statH('📦','OTA Boş',fmtB(fl.sketchFree||0))+'</div></div>';
+  h+='<div class="cd"><h3>📡 WiFi</h3><div class="grid2">'+statH('📶','SSID',wifi.ssid||'-')+statH('📊','Sinyal',(wifi.rssi||0)+' dBm')+statH('🌐','IP',wifi.ip||'-')+statH('🔗','MAC',wifi.mac||'-')+statH('📻','Kanal',wifi.channel||0)+statH('📡','TX',wifi.txPower||0)+'</div></div>';
+  var rt=d.relayTask||{},lt=rt.latency||{};
+  if(rt.core!==undefined){h+='<div class="cd"><h3>⏱️ Röle Zamanlaması</h3><div class="grid2">'+statH('🧵','Görev',(rt.running?'Core '+rt.core+' / P'+rt.prio:'Yok'))+statH('🔁','Geçiş (timer)',(rt.timerFired||0)+' / '+((rt.timerFired||0)+(rt.switches||0)))+statH('📈','Gecikme p50',(lt.n?lt.p50Ms+' ms':'-'))+statH('📈','p90 / p99',(lt.n?lt.p90Ms+' / '+lt.p99Ms+' ms':'-'))+statH('⚠️','Maks',(lt.n?lt.maxMs+' ms':'-'))+statH('🧮','Örnek',(lt.n||0)+' / '+(lt.total||0))+'</div>';
+    if(lt.recent&&lt.recent.length){h+='<div style="font-size:12px;margin-top:10px">';lt.recent.forEach(function(x){h+='<div>'+(x.on?'🔔':'🔕')+' '+x.at+' <span style="color:var(--ts)">'+(x.latMs>=0?'+':'')+x.latMs+' ms</span></div>'});h+='</div>'}
+    h+='</div>'}
+  if(nvs.totalEntries){h+='<div class="cd"><h3>🗄️ NVS</h3>'+barH(((nvs.usedEntries||0)/(nvs.totalEntries||1)*100),'Entries',(nvs.usedEntries||0)+' / '+(nvs.totalEntries||0))+statH('📂','Namespace',nvs.nsCount||0)+'</div>'}
+  $('content').innerHTML=h;
+}
+
+// ══════════ TOLERANS ══════════
+function renderTolerans(){
+  var d=S.sets,h='<div class="cd"><h3>⚙️ Toleranslar</h3><div class="grid2">';
+  h+='<div><label class="lbl">Akşam tolerans (dk)</label><input type="number" id="onMin" min="0" max="30" value="'+(d.onTolMin||0)+'"/><div style="font-size:11px;color:var(--ts);margin-top:3px">Akşam + X dakika</div></div>';
+  h+='<div><label class="lbl">Sabah tolerans (dk)</label><input type="number" id="offMin" min="0" max="30" value="'+(d.offTolMin||0)+'"/><div style="font-size:11px;color:var(--ts);margin-top:3px">İmsak - X dakika</div></div>';
+  h+='</div><div class="row" style="margin-top:16px"><button class="btn btn-p" onclick="saveTolerans()">💾 Kaydet</button><button class="btn btn-s" onclick="loadSettings();loadPublic();toast(\'Yenileniyor...\')">🔄 Yenile</button></div></div>';
+  $('content').innerHTML=h;
+}
+function saveTolerans(){
+  var body=JSON.stringify({onTolMin:parseInt($('onMin').value||'0',10),offTolMin:parseInt($('offMin').value||'0',10)});
+  api('/api/settings',{method:'POST',headers:{'Content-Type':'application/json'},body:body}).then(function(r){if(r.status===401){toast('Yetkisiz');return}return r.json()}).then(function(d){if(d)toast(d.ok?'✅ Kaydedildi':'❌ '+(d.detail||d.err||'Hata'));loadSettings();loadPublic()}).catch(function(){toast('Bağlantı hatası')});
+}
+
+// ══════════ DİNİ GÜNLER ══════════
+var HMONTHS=['Muharrem','Safer','Rebiülevvel','Rebiülahir','Cemaziyelevvel','Cemaziyelahir','Receb','Şaban','Ramazan','Şevval','Zilkade','Zilhicce'];
+function renderDiniGunler(){
+  var d=S.sets;if(!d.specials){$('content').innerHTML='<div class="cd"><p>Yükleniyor...</p></div>';return}
+  var h='<div class="cd"><h3>🕌 Dini Günler</h3><div style="overflow-x:auto"><table class="sp"><thead><tr><th></th><th>Dini Gün</th><th>Gün</th><th>Ay</th><th>Yıl</th><th>Vars.</th></tr></thead><tbody>';
+  d.specials.forEach(function(sp){
+    var dis=sp.useDefault?' disabled':'';
+    h+='<tr style="opacity:'+(sp.en?1:.5)+'"><td><input type="checkbox" id="sp_en_'+sp.id+'" '+(sp.en?'checked':'')+'/></td>';
+    h+='<td style="font-weight:500;white-space:nowrap">'+sp.name+'</td>';
+    h+='<td><select id="sp_day_'+sp.id+'"'+dis+'>';for(var i=1;i<=30;i++)h+='<option value="'+i+'"'+(sp.hDay===i?' selected':'')+'>'+i+'</option>';h+='</select></td>';
+    h+='<td><select id="sp_mon_'+sp.id+'"'+dis+'>';HMONTHS.forEach(function(m,j){h+='<option value="'+j+'"'+(sp.hMonth===j?' selected':'')+'>'+m+'</option>'});h+='</select></td>';
+    h+='<td><select id="sp_yr_'+sp.id+'"'+dis+'>';for(var y=1447;y<=1461;y++)h+='<option value="'+y+'"'+(sp.hYear===y?' selected':'')+'>'+y+'</option>';h+='</select></td>';
+    h+='<td style="text-align:center"><input type="checkbox" id="sp_def_'+sp.id+'" '+(sp.useDefault?'checked':'')+' onchange="toggleSpDef('+sp.id+')"/></td></tr>';
+  });
+  h+='<tr style="background:rgba(0,180,130,.03)"><td><input type="checkbox" id="ram_all" '+(d.ramazanAll?'checked':'')+'></td><td colspan="5" style="font-weight:600;color:var(--ac)">☪️ Ramazan (Tüm Günler)</td></tr>';
+  h+='</tbody></table></div><div class="row" style="margin-top:16px"><button class="btn btn-p" onclick="saveDiniGunler()">💾 Kaydet</button><button class="btn btn-s" onclick="loadSettings();setTimeout(renderDiniGunler,500)">🔄 Yenile</button></div></div>';
+  h+='<div class="cd"><h3>🗓️ Aktif/Yaklaşan Günler</h3><button class="btn btn-s" onclick="loadDGText()">🔄 Yenile</button><pre id="dgText" style="white-space:pre-wrap;margin-top:10px;background:var(--ib);border:1px solid var(--cb);border-radius:10px;padding:10px;font-size:12px">-</pre></div>';
+  $('content').innerHTML=h;loadDGText();
+}
+function toggleSpDef(id){var ch=$('sp_def_'+id),dis=ch&&ch.checked;['sp_day_'+id,'sp_mon_'+id,'sp_yr_'+id].forEach(function(eid){var el=$(eid);if(el)el.disabled=dis});if(dis&&S.sets&&S.sets.specials){var sp=S.sets.specials.find(function(s){return s.id===id});if(sp){var d=$('sp_day_'+id),m=$('sp_mon_'+id),y=$('sp_yr_'+id);if(d)d.value=sp.defDay;if(m)m.value=sp.defMonth;if(y)y.value=sp.defYear}}}
+function loadDGText(){api('/api/dinigunler').then(function(r){return r.text()}).then(function(t){var el=$('dgText');if(el)el.textContent=t&&t.trim().length?t:'-'}).catch(function(){})}
+function saveDiniGunler(){
+  var d=S.sets,specials=[];
+  if(d.specials){d.specials.forEach(function(sp){var en=$('sp_en_'+sp.id),def=$('sp_def_'+sp.id),day=$('sp_day_'+sp.id),mon=$('sp_mon_'+sp.id),yr=$('sp_yr_'+sp.id);specials.push({id:sp.id,en:en?en.checked:false,useDefault:def?def.checked:true,hDay:day?parseInt(day.value,10):1,hMonth:mon?parseInt(mon.value,10):0,hYear:yr?parseInt(yr.value,10):1447})})}
+  var ramAll=$('ram_all')?$('ram_all').checked:false;
+  api('/api/settings',{method:'POST',headers:{'Content-Type':'application/json'},body:JSON.stringify({ramazanAll:ramAll,specials:specials})}).then(function(r){if(r.status===401){toast('Yetkisiz');return}return r.json()}).then(function(d){if(d)toast(d.ok?'✅ Kaydedildi':'❌ '+(d.detail||d.err||'Hata'));loadSettings()}).catch(function(){toast('Bağlantı hatası')});
+}
+
+// ══════════ KOMUTLAR ══════════
+function renderKomut(){
+  var d=S.pub,ron=d.relay,h='';
+  var upP=d.updatePending,upR=d.updateInProgress;
+  var upSt=upR?'🔄 Aktif':upP?'⏳ Kuyrukta':'✅ Boşta';
+  var upCol=upR?'bg-warn':upP?'bg-warn':'bg-ok';
+  h+='<div class="cd"><h3>🧰 Komutlar</h3>';
+  h+='<div style="display:flex;align-items:center;gap:10px;margin-bottom:14px;padding:10px 14px;border-radius:11px;background:rgba(128,128,128,.04);border:1px solid var(--cb)"><span style="font-size:12px;color:var(--ts)">Güncelleme:</span><span class="badge '+upCol+'">'+upSt+'</span>';
+  if(upP)h+='<button class="btn btn-d" style="padding:5px 12px;font-size:12px" onclick="cmdAction(\'cancelUpdate\')">❌ İptal</button>';
+  h+='</div>';
+  h+='<div class="row"><button class="btn btn-p" onclick="cmdAction(\'updateTimes\')">📥 Vakitleri Güncelle</button><button class="btn btn-s" onclick="cmdAction(\'recompute\')">🧮 Çizelge Yenile</button></div></div>';
+  h+='<div class="cd"><h3>⚡ Şerefeler Kontrolü</h3><div style="text-align:center;padding:10px 0">';
+  h+='<button class="btn-relay '+(ron?'on':'off')+'" onclick="cmdAction(\''+(ron?'relayOff':'relayOn')+'\')">'+(ron?'🟢 AÇIK — Kapat':'🔴 KAPALI — Aç')+'</button>';
+  h+='<div style="font-size:12px;color:var(--ts);margin-top:10px">Durum: <b style="color:'+(ron?'var(--ac)':'#e74c3c')+'">'+(ron?'AÇIK':'KAPALI')+'</b></div>';
+  h+='</div></div>';
+  $('content').innerHTML=h;
+}
+
+// ══════════ LOG ══════════
+function loadLogs(){apiGet('/api/logs',true).then(function(d){if(d&&d.ok){S.logs=d;if(S.tab==='log')renderLog()}}).catch(function(){})}
+function logTable(arr){if(!arr||arr.length===0)return'<div style="padding:12px;color:var(--ts);font-size:12px;text-align:center">Henuz kayit yok</div>';var h='<table style="width:100%;border-collapse:collapse;font-size:12px"><thead><tr style="border-bottom:2px solid var(--cb)"><th style="text-align:left;padding:8px 6px;color:var(--ts);font-weight:600;width:140px">Tarih / Saat</th><th style="text-align:left;padding:8px 6px;color:var(--ts);font-weight:600">İşlem</th></tr></thead><tbody>';for(var i=arr.length-1;i>=0;i--){var e=arr[i];h+='<tr style="border-bottom:1px solid var(--cb)"><td style="padding:6px;white-space:nowrap;color:var(--ts);font-variant-numeric:tabular-nums">'+e.ts+'</td><td style="padding:6px">'+e.msg+'</td></tr>'}h+='</tbody></table>';return h}
+function renderLog(){
+  var d=S.logs;if(!d){$('content').innerHTML='<div class="cd"><p>Yükleniyor...</p></div>';loadLogs();return}
+  var h='';
+  h+='<div class="cd"><div style="display:flex;justify-content:space-between;align-items:center;margin-bottom:14px"><h3 style="margin:0">👤 Kullanıcı İşlemleri</h3><span style="font-size:11px;color:var(--ts)">'+(d.user?d.user.length:0)+' kayıt</span></div>';
+  h+=logTable(d.user);
+  h+='</div>';
+  h+='<div class="cd"><div style="display:flex;justify-content:space-between;align-items:center;margin-bottom:14px"><h3 style="margin:0">⚙️ Sistem İşlemleri</h3><span style="font-size:11px;color:var(--ts)">'+(d.sys?d.sys.length:0)+' kayıt</span></div>';
+  h+=logTable(d.sys);
+  h+='</div>';
+  h+='<div style="text-align:center;padding:10px"><button class="btn btn-s" onclick="loadLogs();toast(\'Yenileniyor...\')">🔄 Yenile</button></div>';
+  $('content').innerHTML=h;
+}
+
+// ══════════ AYARLAR ══════════
+function renderAyarlar(){
+  var ac=S.acfg||{},net=ac.net||{},creds=ac.creds||{},h='';
+  // 1. Ağ Ayarları
+  var isStatic=net.useStatic;
+  var ip=isStatic&&net.ip?net.ip:(net.liveIp||''),gw=isStatic&&net.gw?net.gw:(net.liveGw||''),mask=isStatic&&net.mask?net.mask:(net.liveMask||'');
+  var dns1=net.dns1||(net.liveDns1||''),dns2=net.dns2||(net.liveDns2||''),port=net.httpPort||80;
+  var dis=isStatic?'':' disabled';
+  h+='<div class="cd"><h3>📡 Ağ Ayarları</h3>';
+  h+='<div class="row" style="margin-bottom:12px"><label style="display:flex;align-items:center;gap:6px;cursor:pointer"><input type="checkbox" id="useStatic" '+(isStatic?'checked':'')+' onchange="toggleStatic()"/> Statik IP</label>';
+  h+='<span class="badge '+(isStatic?'bg-ok':'bg-warn')+'">'+(isStatic?'Statik':'DHCP')+'</span></div>';
+  h+='<div class="grid2" style="grid-template-columns:repeat(auto-fit,minmax(160px,1fr))">';
+  h+='<div><label class="lbl">IP</label><input type="text" id="ipS" value="'+ip+'"'+dis+'/></div>';
+  h+='<div><label class="lbl">Gateway</label><input type="text" id="gwS" value="'+gw+'"'+dis+'/></div>';
+  h+='<div><label class="lbl">Mask</label><input type="text" id="maskS" value="'+mask+'"'+dis+'/></div>';
+  h+='<div><label class="lbl">DNS1</label><input type="text" id="dns1S" value="'+dns1+'"'+dis+'/></div>';
+  h+='<div><label class="lbl">DNS2</label><input type="text" id="dns2S" value="'+dns2+'"'+dis+'/></div>';
+  h+='<div><label class="lbl">Port</label><input type="number" id="portS" value="'+port+'"/></div>';
+  h+='</div><div class="row" style="margin-top:14px"><button class="btn btn-p" onclick="saveNet()">💾 Ağ Kaydet</button></div>';
+  h+='<div style="font-size:11px;color:var(--ts);margin-top:6px">Ağ ayarı kaydedilince cihaz yeniden başlatılır.</div></div>';
+
+  // 2. WiFi Bilgileri (ayrı kart, ağ altında)
+  h+='<div class="cd"><h3>🔐 WiFi Bilgileri</h3>';
+  h+='<div class="grid2" style="grid-template-columns:repeat(auto-fit,minmax(180px,1fr))">';
+  h+='<div><label class="lbl">WiFi SSID</label><div style="display:flex;gap:6px"><input type="text" id="wfSsid" value="'+(creds.nvsWifiSsid||'')+'" style="flex:1"/><button class="btn btn-s" style="padding:6px 10px;font-size:12px;white-space:nowrap" onclick="wifiScan()">📶 Tara</button></div><select id="wfScanList" class="hidden" style="margin-top:6px" onchange="wfPickSsid()"><option>-</option></select></div>';
+  h+='<div><label class="lbl">WiFi Şifre</label><input type="password" id="wfPass" placeholder="değiştirmek için yaz"/></div></div>';
+  h+='<div class="row" style="margin-top:12px"><button class="btn btn-p" onclick="saveWifi()">💾 Kaydet</button>';
+  h+='<button class="btn btn-d" onclick="clearWifi()">🧹 WiFi Sil</button></div>';
+  h+='<div style="font-size:11px;color:var(--ts);margin-top:6px">WiFi: '+(creds.wifiSrc||'-')+'</div></div>';
+
+  // 2.5 Hicri Yil
+  var hny=ac.hicriYear||{};
+  h+='<div class="cd"><h3>📅 Hicri Yıl Ayarları</h3>';
+  h+='<div class="grid2" style="margin-bottom:12px">';
+  h+='<div><label class="lbl">Yılbaşı Günü</label><select id="hnyDay">';for(var dd=1;dd<=30;dd++)h+='<option value="'+dd+'"'+((hny.day||1)===dd?' selected':'')+'>'+dd+'</option>';h+='</select></div>';
+  h+='<div><label class="lbl">Yılbaşı Ayı</label><select id="hnyMon">';var _hm=['Muharrem','Safer','Rebiülevvel','Rebiülahir','Cemaziyelevvel','Cemaziyelahir','Receb','Şaban','Ramazan','Şevval','Zilkade','Zilhicce'];_hm.forEach(function(m,j){h+='<option value="'+j+'"'+((hny.mon||0)===j?' selected':'')+'>'+m+'</option>'});h+='</select></div>';
+  h+='</div>';
+  h+='<label style="display:flex;align-items:center;gap:8px;cursor:pointer;margin-bottom:10px"><input type="checkbox" id="hnyAuto" '+(hny.auto?'checked':'')+'/>  Yılları Otomatik Güncelle</label>';
+  if(hny.lastYear)h+='<div style="font-size:11px;color:var(--ts)">Son güncellenen yıl: '+hny.lastYear+'</div>';
+  h+='<div class="row" style="margin-top:12px"><button class="btn btn-p" onclick="saveHicriYear()">💾 Kaydet</button></div>';
+  h+='<div style="font-size:11px;color:var(--ts);margin-top:6px">Yılbaşı geçtiğinde dini günlerin yılı otomatik +1 olur.</div></div>';
+
+  // 3. İlçe ID Bulucu (üstte) + İlçe Kodu (altta)
+  h+='<div class="cd"><h3>🔍 Ezan Vakti İlçe ID Bulucu</h3>';
+  h+='<div class="ilce-grid"><div><label class="lbl">Ülke</label><select id="ilceUlke" onchange="ilceLoadCities()"><option>Yükleniyor...</option></select></div>';
+  h+='<div><label class="lbl">Şehir</label><select id="ilceSehir" disabled onchange="ilceLoadDistricts()"><option>Önce ülke seçin</option></select></div>';
+  h+='<div><label class="lbl">İlçe</label><select id="ilceIlce" disabled onchange="ilceSelect()"><option>Önce şehir seçin</option></select></div></div>';
+  h+='<div id="ilceResult" class="hidden" style="margin-top:10px;padding:10px;border-radius:10px;background:rgba(0,180,130,.06);border:1px solid rgba(0,180,130,.15);font-size:14px;font-weight:600">İlçe ID: <span id="ilceFoundId">-</span> <button class="btn btn-p" style="margin-left:10px;padding:5px 12px;font-size:12px" onclick="ilceApply()">Uygula</button></div>';
+  h+='<div style="font-size:11px;color:var(--ts);margin-top:6px" id="ilceStat">-</div>';
+  h+='<div style="margin-top:16px;padding-top:16px;border-top:1px solid var(--cb)"><h3 style="font-size:15px;margin-bottom:12px">📍 İlçe Kodu</h3>';
+  h+='<div class="row"><div style="flex:1;min-width:100px"><label class="lbl">İlçe ID</label><input type="number" id="ilceId" value="'+(ac.ilceId||'')+'"/></div>';
+  var geo=ac.geo||{};
+  h+='<div style="flex:1;min-width:90px"><label class="lbl">Enlem</label><input type="number" step="0.0001" id="geoLat" value="'+(geo.lat||'')+'"/></div>';
+  h+='<div style="flex:1;min-width:90px"><label class="lbl">Boylam</label><input type="number" step="0.0001" id="geoLon" value="'+(geo.lon||'')+'"/></div>';
+  h+='<button class="btn btn-p" onclick="saveIlce()">💾</button><button class="btn btn-s" onclick="cmdAction(\'updateTimes\')">📥 Güncelle</button></div>';
+  h+='<div style="font-size:11px;color:var(--ts);margin-top:6px">Koordinat: API\'ye ulaşılamazsa imsak/akşam buradan hesaplanır (0 = kapalı).</div></div></div>';
+
+  // 4. Kimlik Bilgileri
+  h+='<div class="cd"><h3>🔑 Kimlik Bilgileri</h3>';
+  h+='<div style="overflow-x:auto"><table class="sp"><thead><tr><th>Alan</th><th>Kaynak</th><th>Durum</th><th>Değiştir</th></tr></thead><tbody>';
+  h+='<tr><td style="font-weight:600">Web Şifre</td><td><span class="badge '+(creds.webKeySrc==='nvs'?'bg-ok':'bg-warn')+'">'+(creds.webKeySrc||'-')+'</span></td>';
+  h+='<td>'+(creds.activeWebKeySet?'✅ Ayarlı':'❌ Yok')+'</td>';
+  h+='<td><input type="password" id="newWebKey" placeholder="Yeni şifre" style="width:140px;font-size:12px"/></td></tr>';
+  h+='<tr><td style="font-weight:600">Bot Token</td><td><span class="badge '+(creds.botTokenSrc==='nvs'?'bg-ok':'bg-warn')+'">'+(creds.botTokenSrc||'-')+'</span></td>';
+  h+='<td>'+(creds.botTokenSet?'✅ Ayarlı':'❌ Yok')+'</td>';
+  h+='<td><input type="password" id="newBotToken" placeholder="Yeni token" style="width:140px;font-size:12px"/></td></tr>';
+  h+='<tr><td style="font-weight:600">Chat ID</td><td><span class="badge '+(creds.chatIdSrc==='nvs'?'bg-ok':'bg-warn')+'">'+(creds.chatIdSrc||'-')+'</span></td>';
+  h+='<td style="font-variant-numeric:tabular-nums">'+(creds.chatId||'-')+'</td>';
+  h+='<td><input type="text" id="newChatId" placeholder="Yeni chat ID" style="width:140px;font-size:12px"/></td></tr>';
+  h+='</tbody></table></div>';
+  h+='<div class="row" style="margin-top:12px"><button class="btn btn-p" onclick="saveKimlik()">💾 Kaydet</button>';
+  h+='<button class="btn btn-d" onclick="clearWebKey()">🧹 Web Şifre Sil</button>';
+  h+='<button class="btn btn-d" onclick="clearBotToken()">🧹 Bot Token Sil</button>';
+  h+='<button class="btn btn-d" onclick="clearChatId()">🧹 Chat ID Sil</button></div>';
+  h+='<div style="font-size:11px;color:var(--ts);margin-top:6px">NVS\'e kaydedilen bilgiler secrets.h\'yi geçersiz kılar. Sil butonu NVS\'i temizler ve secrets.h aktif olur.</div></div>';
+
+  // 5. Telegram Admin
+  h+='<div class="cd"><h3>👮 Telegram Admin</h3><div class="row" style="margin-bottom:10px">';
+  h+='<div style="flex:1;min-width:140px"><label class="lbl">Admin ID</label><input type="text" id="adminId"/></div>';
+  h+='<button class="btn btn-p" onclick="adminAdd()">➕</button><button class="btn btn-d" onclick="adminDel()">➖</button></div>';
+  h+='<div id="adminsList" style="display:flex;gap:6px;flex-wrap:wrap"></div></div>';
+
+  // 6. OTA
+  h+='<div class="cd"><h3>⬆️ Firmware Güncelle</h3><div class="row"><input type="file" id="fwFile" accept=".bin"/> <button class="btn btn-p" onclick="uploadFw()">⬆️ Yükle</button></div>';
+  h+='<div style="margin-top:10px"><div class="bar" style="height:6px"><div class="bar-fill" id="fwBar" style="width:0%;background:var(--ac)"></div></div><div style="font-size:11px;color:var(--ts);margin-top:4px" id="fwStat">-</div></div></div>';
+
+  // 7. Factory Reset
+  h+='<div class="cd" style="border-color:rgba(231,76,60,.2)"><h3 style="color:#e74c3c">🧨 Fabrika Ayarları</h3>';
+  h+='<div class="row"><div style="flex:1;min-width:180px"><label class="lbl">Owner Key</label><input type="password" id="rstKey"/></div>';
+  h+='<button class="btn btn-s" onclick="rstCheck()">Doğrula</button></div>';
+  h+='<div id="rstWrap" class="hidden" style="margin-top:10px"><label><input type="checkbox" id="rstConfirm"/> Evet, sıfırla</label> <button class="btn btn-d" onclick="rstDo()" style="margin-top:8px">⚠️ Sıfırla</button></div></div>';
+
+  $('content').innerHTML=h;
+  if(ac.admins)renderAdmins(ac.admins);
+  ilceLoadCountries();
+}
+
+function toggleStatic(){var ch=$('useStatic').checked;['ipS','gwS','maskS','dns1S','dns2S'].forEach(function(id){var el=$(id);if(el)el.disabled=!ch})}
+function renderAdmins(list){var el=$('adminsList');if(!el)return;el.innerHTML='';if(!list||!list.length){el.innerHTML='<span style="font-size:12px;color:var(--ts)">-</span>';return}list.forEach(function(a){el.innerHTML+='<span class="badge bg-ok">'+a.id+(a.owner?' (OWNER)':'')+'</span>'})}
+
+// İlçe ID Bulucu API
+var _ilkeUlk=[],_ilkeSeh=[],_ilkeIlc=[];
+function ilceLoadCountries(){fetch('https://ezanvakti.emushaf.net/ulkeler').then(function(r){return r.json()}).then(function(d){_ilkeUlk=d;_ilkeUlk.sort(function(a,b){return a.UlkeAdi.localeCompare(b.UlkeAdi,'tr')});var s=$('ilceUlke');s.innerHTML='<option value="">Ülke seçin</option>';_ilkeUlk.forEach(function(u){s.innerHTML+='<option value="'+u.UlkeID+'">'+u.UlkeAdi+'</option>'});var st=$('ilceStat');if(st)st.textContent='Ülkeler yüklendi.'}).catch(function(){var st=$('ilceStat');if(st)st.textContent='Ülkeler yüklenemedi (CORS?)'})}
+function ilceLoadCities(){var uid=$('ilceUlke').value;var s2=$('ilceSehir'),s3=$('ilceIlce');s2.innerHTML='<option>Yükleniyor...</option>';s2.disabled=true;s3.innerHTML='<option>Önce şehir seçin</option>';s3.disabled=true;$('ilceResult').className='hidden';if(!uid){s2.innerHTML='<option>Önce ülke seçin</option>';return}fetch('https://ezanvakti.emushaf.net/sehirler/'+uid).then(function(r){return r.json()}).then(function(d){_ilkeSeh=d;_ilkeSeh.sort(function(a,b){return a.SehirAdi.localeCompare(b.SehirAdi,'tr')});s2.innerHTML='<option value="">Şehir seçin</option>';_ilkeSeh.forEach(function(c){s2.innerHTML+='<option value="'+c.SehirID+'">'+c.SehirAdi+'</option>'});s2.disabled=false;var st=$('ilceStat');if(st)st.textContent='Şehirler yüklendi.'}).catch(function(){s2.innerHTML='<option>Yüklenemedi</option>';var st=$('ilceStat');if(st)st.textContent='Şehirler yüklenemedi.'})}
+function ilceLoadDistricts(){var cid=$('ilceSehir').value;var s3=$('ilceIlce');s3.innerHTML='<option>Yükleniyor...</option>';s3.disabled=true;$('ilceResult').className='hidden';if(!cid){s3.innerHTML='<option>Önce şehir seçin</option>';return}fetch('https://ezanvakti.emushaf.net/ilceler/'+cid).then(function(r){return r.json()}).then(function(d){_ilkeIlc=d;_ilkeIlc.sort(function(a,b){return a.IlceAdi.localeCompare(b.IlceAdi,'tr')});s3.innerHTML='<option value="">İlçe seçin</option>';_ilkeIlc.forEach(function(i){s3.innerHTML+='<option value="'+i.IlceID+'">'+i.IlceAdi+'</option>'});s3.disabled=false;var st=$('ilceStat');if(st)st.textContent='İlçeler yüklendi.'}).catch(function(){s3.innerHTML='<option>Yüklenemedi</option>'})}
+function ilceSelect(){var v=$('ilceIlce').value;if(!v){$('ilceResult').className='hidden';return}$('ilceFoundId').textContent=v;$('ilceResult').className='';var st=$('ilceStat');if(st)st.textContent='İlçe ID bulundu: '+v}
+function ilceApply(){var v=$('ilceFoundId').textContent;if(v&&v!=='-'){var el=$('ilceId');if(el)el.value=v;toast('İlçe ID: '+v+' uygulandı')}}
+
+// Admin API calls
+function saveHicriYear(){var d=parseInt($('hnyDay').value||'1',10),m=parseInt($('hnyMon').value||'0',10),au=$('hnyAuto')?$('hnyAuto').checked:false;postAcfg({hicriYear:{day:d,mon:m,auto:au}},function(){loadAdminCfg()})}
+function postAcfg(payload,cb){api('/api/admincfg',{method:'POST',headers:{'Content-Type':'application/json'},body:JSON.stringify(payload)}).then(function(r){if(r.status===401){toast('Yetkisiz');return}return r.json()}).then(function(d){if(!d)return;toast(d.ok?(d.msg||'✅ OK'):('❌ '+(d.err||'Hata')));if(cb)cb(d)}).catch(function(){toast('Bağlantı hatası')})}
+function saveNet(){postAcfg({net:{useStatic:$('useStatic').checked,ip:$('ipS').value.trim(),gw:$('gwS').value.trim(),mask:$('maskS').value.trim(),dns1:$('dns1S').value.trim(),dns2:$('dns2S').value.trim(),httpPort:parseInt($('portS').value||'80',10)}},function(d){if(d.nextUrl){toast('🔁 Yeni: '+d.nextUrl);setTimeout(function(){location.href=d.nextUrl},2500)}else if(d.reboot)toast('🔁 Yeniden başlıyor...')})}
+function saveIlce(){postAcfg({ilceId:parseInt($('ilceId').value||'0',10),geo:{lat:parseFloat($('geoLat').value||'0'),lon:parseFloat($('geoLon').value||'0')}})}
+function adminAdd(){var id=($('adminId').value||'').trim();if(!id){toast('ID gir');return}postAcfg({adminAdd:id},function(){loadAdminCfg()})}
+function adminDel(){var id=($('adminId').value||'').trim();if(!id){toast('ID gir');return}postAcfg({adminDel:id},function(){loadAdminCfg()})}
+function saveKimlik(){
+  var payload={};
+  var wk=$('newWebKey'),bt=$('newBotToken'),ci=$('newChatId');
+  if(wk&&wk.value.trim())payload.creds={webKey:wk.value.trim()};
+  if(bt&&bt.value.trim())payload.botToken=bt.value.trim();
+  if(ci&&ci.value.trim())payload.chatId=ci.value.trim();
+  if(!Object.keys(payload).length){toast('Değişiklik yok');return}
+  postAcfg(payload,function(d){if(wk)wk.value='';if(bt)bt.value='';if(ci)ci.value='';loadAdminCfg()});
+}
+function clearBotToken(){if(!confirm('Bot Token NVS silinsin mi? secrets.h aktif olur.'))return;postAcfg({clearBotToken:true},function(){loadAdminCfg()})}
+function clearChatId(){if(!confirm('Chat ID NVS silinsin mi? secrets.h aktif olur.'))return;postAcfg({clearChatId:true},function(){loadAdminCfg()})}
+function clearWebKey(){if(!confirm('Web Şifre NVS silinsin mi? secrets.h aktif olur.'))return;postAcfg({creds:{clearWebKey:true}},function(){localStorage.removeItem('WEB_KEY');loadAdminCfg()})}
+function wifiScan(){toast('📶 Taranıyor...');api('/api/wifiscan').then(function(r){if(r.status===401){toast('Yetkisiz');return}return r.json()}).then(function(d){if(!d)return;var sel=$('wfScanList');if(!sel)return;sel.innerHTML='<option value="">-- Ağ Seçin ('+d.count+') --</option>';if(d.networks){d.networks.sort(function(a,b){return b.rssi-a.rssi});d.networks.forEach(function(n){sel.innerHTML+='<option value="'+n.ssid+'">'+n.ssid+' ('+n.rssi+' dBm'+(n.enc?' 🔒':'')+')  </option>'})}sel.className='';toast(d.count+' ağ bulundu')}).catch(function(){toast('Tarama hatası')})}
+function wfPickSsid(){var sel=$('wfScanList'),inp=$('wfSsid');if(sel&&inp&&sel.value){inp.value=sel.value;toast('SSID: '+sel.value)}}
+function saveWifi(){
+  var ss=($('wfSsid').value||'').trim();if(!ss){toast('SSID boş olamaz');return}
+  var pw=$('wfPass');var ps=pw?pw.value:'';
+  if(!confirm('WiFi test edilecek: '+ss))return;
+  toast('📶 Bağlantı test ediliyor...');
+  api('/api/wifitest',{method:'POST',headers:{'Content-Type':'application/json'},body:JSON.stringify({ssid:ss,pass:ps})}).then(function(r){return r.json()}).then(function(d){if(!d.testing){toast('⛔ '+(d.msg||'Hata'));return}
+    var done=function(s){if(s.state===3){toast('✅ '+s.msg);if(pw)pw.value='';if(s.ip)setTimeout(function(){location.href='http://'+s.ip},3000);return true}if(s.state===5){toast('⛔ '+s.msg);return true}return false};
+    // Akış açıksa sonuç oradan gelir (mesaj/IP için tek istek); yoksa 1 sn yoklama
+    if(S.es){S.wfCb=function(st){if(st===3||st===5){S.wfCb=null;api('/api/wifistatus').then(function(r){return r.json()}).then(done).catch(function(){})}};return}
+    var pollCnt=0;var pollId=setInterval(function(){pollCnt++;api('/api/wifistatus').then(function(r){return r.json()}).then(function(s){if(done(s))clearInterval(pollId)}).catch(function(){if(pollCnt>30)clearInterval(pollId)})},1000)}).catch(function(){toast('❌ Ağ hatası')})
+}
+function clearWifi(){if(!confirm('WiFi NVS silinsin mi?'))return;postAcfg({creds:{clearWifi:true}},function(d){loadAdminCfg();if(d.reboot)setTimeout(function(){location.href='/'},2500)})}
+var _rstOk=false,_rstKey='';
+function rstCheck(){var k=($('rstKey').value||'').trim();if(!k){toast('Şifre gir');return}fetch('/api/authcheck',{headers:{'X-API-KEY':k}}).then(function(r){if(r.ok){_rstOk=true;_rstKey=k;$('rstWrap').className='';toast('✅ Doğrulandı')}else{_rstOk=false;toast('❌ Yanlış')}}).catch(function(){toast('Hata')})}
+function rstDo(){if(!_rstOk){toast('Önce doğrula');return}if(!$('rstConfirm').checked){toast('Onay kutusunu işaretle');return}fetch('/api/factory_reset',{method:'POST',headers:{'Content-Type':'application/json','X-API-KEY':_rstKey},body:JSON.stringify({ownerKey:_rstKey,confirm:true})}).then(function(r){if(r.ok){toast('🧨 Sıfırlanıyor...');setTimeout(function(){location.href='/'},2500)}else toast('❌ Reddedildi')}).catch(function(){toast('Hata')})}
+function uploadFw(){var inp=$('fwFile');if(!inp||!inp.files||!inp.files.length){toast('Dosya seç');return}if(!confirm('Firmware yüklensin mi?'))return;var f=inp.files[0];var reader=new FileReader();reader.onload=function(ev){var buf=new Uint8Array(ev.target.result);var btTag=[0x7F,67,65,77,73,95,66,84,58];var fwBt=-1;for(var i=0;i<buf.length-btTag.length-1;i++){var ok=true;for(var j=0;j<btTag.length;j++){if(buf[i+j]!==btTag[j]){ok=false;break}}if(ok){fwBt=buf[i+btTag.length]-48;break}}var devBt=(S.pub&&S.pub.boardType!==undefined)?S.pub.boardType:-1;if(fwBt>=0&&devBt>=0&&fwBt!==devBt){toast('⛔ Yanlis firmware! Dosya board='+fwBt+', Cihaz board='+devBt);return}if(fwBt<0){if(!confirm('Board bilgisi bulunamadi. Devam?'))return}var vnTag=[0x7E,67,65,77,73,95,86,78,58];var fwVer=-1;for(var i=0;i<buf.length-vnTag.length-2;i++){var ok=true;for(var j=0;j<vnTag.length;j++){if(buf[i+j]!==vnTag[j]){ok=false;break}}if(ok){var ns='';for(var k=i+vnTag.length;k<buf.length&&buf[k]>=48&&buf[k]<=57;k++)ns+=String.fromCharCode(buf[k]);fwVer=parseInt(ns)||0;break}}var devVer=(S.pub&&S.pub.fwVerNum)?S.pub.fwVerNum:0;if(fwVer>0&&devVer>0&&fwVer<=devVer){toast('⛔ Firmware zaten güncel veya eski (cihaz: '+devVer+', dosya: '+fwVer+')');return}var xhr=new XMLHttpRequest();xhr.open('POST','/update',true);var k=getKey();if(k)xhr.setRequestHeader('X-API-KEY',k);if(fwBt>=0)xhr.setRequestHeader('X-Board-Type',String(fwBt));if(fwVer>0)xhr.setRequestHeader('X-Firmware-Ver',String(fwVer));xhr.upload.onprogress=function(e){if(e.lengthComputable){var p=Math.round(e.loaded*100/e.total);var b=$('fwBar');if(b)b.style.width=p+'%';var s=$('fwStat');if(s)s.textContent=p+'%'}};xhr.onload=function(){if(xhr.status===200){toast('✅ Yüklendi');setTimeout(function(){location.href='/'},5000)}else if(xhr.status===401)toast('⛔ Yetkisiz');else{try{var r=JSON.parse(xhr.responseText);toast('⛔ '+(r.msg||r.err||'Hata'))}catch(e){toast('❌ Hata: '+xhr.status)}}};xhr.onerror=function(){toast('❌ Ağ hatası')};var fd=new FormData();fd.append('firmware',f,f.name);xhr.send(fd)};reader.readAsArrayBuffer(f)}
+
+// ── Login ──
+function renderLogin(){var h='<div class="cd" style="text-align:center;padding:36px 18px"><div style="font-size:44px;margin-bottom:14px">🔐</div><h3 style="margin-bottom:6px">Yönetim Paneli</h3><p style="color:var(--ts);font-size:13px;margin-bottom:18px">Ayarları değiştirmek için giriş yapın</p><div style="max-width:280px;margin:0 auto"><input type="password" id="loginKey" placeholder="Şifre" style="text-align:center;font-size:15px;margin-bottom:10px" onkeydown="if(event.key===\'Enter\')doLogin()"/><button class="btn btn-p" style="width:100%;justify-content:center;padding:11px" onclick="doLogin()">🔓 Giriş Yap</button></div></div>';$('content').innerHTML=h;var el=$('loginKey');if(el){el.value=getKey();el.focus()}}
+
+// ── Render ──
+function renderContent(){var t=S.tab;if(t==='home'){renderHome();return}if(t==='login'&&!S.authed){renderLogin();return}if(!S.authed){renderLogin();return}if(t==='system')renderSystem();else if(t==='tolerans')renderTolerans();else if(t==='dinigun')renderDiniGunler();else if(t==='komut')renderKomut();else if(t==='log')renderLog();else if(t==='ayarlar')renderAyarlar()}
+function renderAll(){renderTabs();renderContent()}
+
+// ── Init ──
+(function(){
+  S.key=getKey();S.dark=localStorage.getItem('DARK')==='1';if(S.dark)document.body.classList.add('dk');$('darkBtn').textContent=S.dark?'☀️':'🌙';
+  if(S.key){api('/api/authcheck').then(function(r){if(r.ok){S.authed=true;if(location.pathname==='/admin')S.tab='system';renderAll();loadSettings();loadAdminCfg()}else renderAll()}).catch(function(){renderAll()})}else renderAll();
+  loadPublic();startAutoRef();
+})();